@@ -0,0 +1,78 @@
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ctm::bench {
+//-----------------------------------------------------------
+// Minimal benchmark harness, no dependency beyond the standard library.
+// Build with -DENABLE_COVERAGE=OFF -DCMAKE_BUILD_TYPE=Release for meaningful
+// numbers; coverage builds run at -O0.
+//-----------------------------------------------------------
+struct BenchOptions {
+  std::chrono::milliseconds duration{300}; // per measured point
+  std::size_t maxThreads{64};
+};
+
+// Thread counts 1, 2, 4, ... up to maxThreads.
+inline std::vector<std::size_t> ThreadCounts(const BenchOptions &options) {
+  std::vector<std::size_t> counts;
+  for (std::size_t t = 1; t <= options.maxThreads; t *= 2)
+    counts.push_back(t);
+  return counts;
+}
+
+// Run `work(thread, stop)` on `threads` threads for `duration`. Each call
+// returns the number of operations it did; the result is operations/second.
+inline double
+MeasureThroughput(std::size_t threads, std::chrono::milliseconds duration,
+                  const std::function<std::uint64_t(
+                      std::size_t, const std::atomic<bool> &)> &work) {
+  std::atomic<bool> go{false};
+  std::atomic<bool> stop{false};
+  std::atomic<std::uint64_t> total{0};
+  std::vector<std::thread> pool;
+  for (std::size_t t = 0; t < threads; ++t) {
+    pool.emplace_back([&, t] {
+      while (!go.load(std::memory_order_acquire))
+        std::this_thread::yield();
+      total.fetch_add(work(t, stop), std::memory_order_relaxed);
+    });
+  }
+  const auto start = std::chrono::steady_clock::now();
+  go.store(true, std::memory_order_release);
+  std::this_thread::sleep_for(duration);
+  stop.store(true, std::memory_order_relaxed);
+  for (auto &th : pool)
+    th.join();
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return static_cast<double>(total.load()) / elapsed.count();
+}
+
+// Benchmarks, one per file.
+void RunColumnsBench(const BenchOptions &options);
+void RunCompactBench(const BenchOptions &options);
+void RunCrdtBench(const BenchOptions &options);
+void RunIngestBench(const BenchOptions &options);
+void RunKnownPlatesBench(const BenchOptions &options);
+void RunPartitionBench(const BenchOptions &options);
+void RunLockBench(const BenchOptions &options);
+void RunPipelineBench(const BenchOptions &options);
+void RunPresenceBench(const BenchOptions &options);
+void RunRegionsBench(const BenchOptions &options);
+void RunReplayBench(const BenchOptions &options);
+void RunRetainBench(const BenchOptions &options);
+void RunSchedulerBench(const BenchOptions &options);
+void RunWatchlistBench(const BenchOptions &options);
+
+} // namespace ctm::bench
+
+#endif // BENCH_HPP
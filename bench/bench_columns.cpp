@@ -0,0 +1,94 @@
+#include "Bench.hpp"
+#include "WindowColumns.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+namespace ctm::bench {
+
+namespace {
+constexpr std::size_t kPlates = 200000;
+constexpr std::size_t kWindows = 168; // a week of hourly periods
+
+double measure(const BenchOptions &options, const std::function<void()> &op) {
+  return MeasureThroughput(1, options.duration,
+                           [&](std::size_t, const std::atomic<bool> &stop) {
+                             std::uint64_t ops = 0;
+                             while (!stop.load(std::memory_order_relaxed)) {
+                               op();
+                               ++ops;
+                             }
+                             return ops;
+                           });
+}
+
+} // namespace
+
+// Per-plate totals over a week of periods: per-period hash maps looked up
+// plate by plate against contiguous columns combined by the scalar and the
+// SSE2 kernels.
+void RunColumnsBench(const BenchOptions &options) {
+  std::mt19937 rng(120);
+  // Each plate passes in about a third of the periods, 1-3 times.
+  WindowColumns columns(kWindows);
+  std::vector<std::unordered_map<std::uint32_t, std::uint32_t>> maps(kWindows);
+  for (std::size_t w = 0; w < kWindows; ++w) {
+    for (std::uint32_t plate = 0; plate < kPlates; ++plate) {
+      if (rng() % 3 != 0)
+        continue;
+      for (std::uint32_t n = 1 + rng() % 3; n > 0; --n) {
+        columns.Increment(plate);
+        ++maps[w][plate];
+      }
+    }
+    columns.Close();
+  }
+  const std::vector<std::uint64_t> week = [] {
+    std::vector<std::uint64_t> windows(kWindows);
+    for (std::size_t w = 0; w < kWindows; ++w)
+      windows[w] = w;
+    return windows;
+  }();
+
+  std::vector<std::uint32_t> total(kPlates);
+  std::uint64_t sink = 0;
+  const double hashed = measure(options, [&] {
+    for (std::uint32_t plate = 0; plate < kPlates; ++plate) {
+      std::uint32_t sum = 0;
+      for (const auto &map : maps) {
+        if (const auto it = map.find(plate); it != map.end())
+          sum += it->second;
+      }
+      total[plate] = sum;
+    }
+    sink += total[kPlates / 2];
+  });
+  const auto withKernel = [&](void (*kernel)(std::uint32_t *,
+                                             const std::uint32_t *,
+                                             std::size_t)) {
+    return measure(options, [&] {
+      std::fill(total.begin(), total.end(), 0);
+      for (std::uint64_t w : week) {
+        const auto *column = columns.Column(w);
+        kernel(total.data(), column->data(), column->size());
+      }
+      sink += total[kPlates / 2];
+    });
+  };
+  const double scalar = withKernel(detail::AddColumnScalar);
+  const double simd = withKernel(detail::AddColumnSimd);
+  const double atLeast = measure(options, [&] {
+    sink += WindowColumns::AtLeast(total, 100).Cardinality();
+  });
+  std::printf("weekly totals, %zu plates x %zu periods (totals/s)%s\n",
+              kPlates, kWindows, sink ? "" : " ");
+  std::printf("  hash map per period %10.2f\n", hashed);
+  std::printf("  columns, scalar     %10.2f\n", scalar);
+  std::printf("  columns, simd       %10.2f\n", simd);
+  std::printf("  total >= 100        %10.2f selections/s\n", atLeast);
+  std::printf("  memory: %zu KiB in columns\n", columns.MemoryBytes() / 1024);
+}
+
+} // namespace ctm::bench
@@ -0,0 +1,58 @@
+#include "Bench.hpp"
+#include "CrossroadTrafficMonitoring.hpp"
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+namespace ctm::bench {
+
+namespace {
+// Statistics queries per second over the monitor as it stands.
+double measureStatistics(CrossroadTrafficMonitoring &monitor,
+                         const BenchOptions &options) {
+  return MeasureThroughput(1, options.duration,
+                           [&](std::size_t, const std::atomic<bool> &stop) {
+                             std::uint64_t ops = 0;
+                             while (!stop.load(std::memory_order_relaxed)) {
+                               ops += monitor.GetStatistics().empty() ? 0 : 1;
+                             }
+                             return ops;
+                           });
+}
+} // namespace
+
+// A retained pool after churn (one plate in `stride` recurring), queried
+// before and after compaction, and the cost of one compaction step.
+void RunCompactBench(const BenchOptions &options) {
+  std::printf("%7s %10s %10s %12s %12s %12s\n", "stride", "span KiB",
+              "live KiB", "stats/s", "compacted", "us/step(32)");
+  for (std::size_t stride : {2, 5, 20}) {
+    MonitorConfig config;
+    config.plateRetentionPeriods = 1;
+    CrossroadTrafficMonitoring monitor(std::chrono::hours(1), config);
+    monitor.Start();
+    for (std::size_t p = 0; p < 1000; ++p)
+      monitor.OnSignal(Car("PL" + std::to_string(p)));
+    for (int period = 0; period < 2; ++period) {
+      monitor.Reset();
+      for (std::size_t p = 0; p < 1000; p += stride)
+        monitor.OnSignal(Car("PL" + std::to_string(p)));
+    }
+    const MemoryUsage before = monitor.GetMemoryUsage();
+    const double fragmented = measureStatistics(monitor, options);
+
+    std::size_t steps = 0;
+    const auto start = std::chrono::steady_clock::now();
+    while (monitor.CompactStep(32) > 0)
+      ++steps;
+    const std::chrono::duration<double, std::micro> elapsed =
+        std::chrono::steady_clock::now() - start;
+    const double compacted = measureStatistics(monitor, options);
+    std::printf("%7zu %10.1f %10.1f %12.0f %12.0f %12.2f\n", stride,
+                before.poolSpanBytes / 1024.0, before.poolLiveBytes / 1024.0,
+                fragmented, compacted,
+                elapsed.count() / static_cast<double>(steps ? steps : 1));
+  }
+}
+
+} // namespace ctm::bench
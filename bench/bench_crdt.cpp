@@ -0,0 +1,73 @@
+#include "Bench.hpp"
+#include "CrdtReplica.hpp"
+#include "CrossroadTrafficMonitoring.hpp"
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace ctm::bench {
+
+namespace {
+double measureIngest(CrdtReplica *replica, const BenchOptions &options) {
+  CrossroadTrafficMonitoring monitor(std::chrono::hours(1));
+  monitor.SetCrdtReplica(replica);
+  monitor.Start();
+  std::vector<Car> cars;
+  for (std::size_t p = 0; p < 900; ++p)
+    cars.emplace_back("P" + std::to_string(p));
+  const double rate = MeasureThroughput(
+      1, options.duration, [&](std::size_t, const std::atomic<bool> &stop) {
+        std::uint64_t ops = 0;
+        for (std::size_t p = 0; !stop.load(std::memory_order_relaxed);
+             p = (p + 7) % cars.size()) {
+          monitor.OnSignal(cars[p]);
+          ++ops;
+        }
+        return ops;
+      });
+  monitor.SetCrdtReplica(nullptr);
+  return rate;
+}
+} // namespace
+
+// Cost of counting into a replica while ingesting, and the size and merge
+// rate of deltas between nodes.
+void RunCrdtBench(const BenchOptions &options) {
+  CrdtReplica ingestReplica(1);
+  std::printf("ingest: %.2f / %.2f (replica attached) Msignals/s\n",
+              measureIngest(nullptr, options) / 1e6,
+              measureIngest(&ingestReplica, options) / 1e6);
+
+  // Three nodes over the same 100k plates; one delta per node per period.
+  constexpr std::size_t kPlates = 100000;
+  CrdtReplica a(1), b(2), c(3);
+  for (std::size_t p = 0; p < kPlates; ++p) {
+    const std::string id = "PL" + std::to_string(p);
+    a.Record(VehicleCategory::Car, id);
+    b.Record(VehicleCategory::Car, id);
+    if (p % 3 == 0)
+      c.Record(VehicleCategory::Scooter, id);
+  }
+  const std::string deltaA = a.TakeDelta(), deltaB = b.TakeDelta();
+  const std::string deltaC = c.TakeDelta();
+  const auto start = std::chrono::steady_clock::now();
+  for (CrdtReplica *to : {&a, &b, &c}) {
+    for (const std::string *delta : {&deltaA, &deltaB, &deltaC})
+      to->Merge(*delta);
+  }
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  const std::string merged = a.TakeDelta(); // what a forwards after merging
+  std::printf("delta: %.1f bytes/plate, merged state %.1f bytes/plate\n",
+              static_cast<double>(deltaA.size()) / kPlates,
+              static_cast<double>(merged.size()) / kPlates);
+  const double plates = 3.0 * static_cast<double>(
+                                 deltaA.size() ? 2 * kPlates + (kPlates + 2) / 3
+                                               : 0);
+  std::printf("merge: %.2f Mplates/s (every delta into every node, own "
+              "ones included)\n",
+              plates / elapsed.count() / 1e6);
+}
+
+} // namespace ctm::bench
@@ -0,0 +1,71 @@
+#include "Bench.hpp"
+#include "CrossroadTrafficMonitoring.hpp"
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ctm::bench {
+
+namespace {
+constexpr std::size_t kPlates = 500; // stays within the vehicle pool
+
+struct NamedMode {
+  const char *name;
+  IngestMode mode;
+};
+const NamedMode kModes[] = {
+    {"mutex", IngestMode::Mutex},
+    {"lock-free", IngestMode::LockFree},
+    {"flat-combining", IngestMode::FlatCombining},
+};
+
+// Vehicle signals from `threads` cameras over a shared set of plates, so
+// threads keep hitting each other's entries.
+double measure(IngestMode mode, std::size_t threads,
+               const BenchOptions &options) {
+  MonitorConfig config;
+  config.ingest = mode;
+  auto monitor =
+      std::make_unique<CrossroadTrafficMonitoring>(std::chrono::hours(1), config);
+  monitor->Start();
+
+  std::vector<Car> cars;
+  std::vector<Scooter> scooters;
+  for (std::size_t p = 0; p < kPlates; ++p) {
+    cars.emplace_back("BENCH" + std::to_string(p));
+    scooters.emplace_back("BENCH" + std::to_string(p));
+  }
+  return MeasureThroughput(
+      threads, options.duration,
+      [&](std::size_t t, const std::atomic<bool> &stop) {
+        std::uint64_t ops = 0;
+        std::size_t p = t * 37;
+        while (!stop.load(std::memory_order_relaxed)) {
+          p = (p + 7) % kPlates;
+          if (p % 4 == 0)
+            monitor->OnSignal(scooters[p]);
+          else
+            monitor->OnSignal(cars[p]);
+          ++ops;
+        }
+        return ops;
+      });
+}
+} // namespace
+
+void RunIngestBench(const BenchOptions &options) {
+  std::printf("%8s", "threads");
+  for (const auto &m : kModes)
+    std::printf(" %14s", m.name);
+  std::printf("   (million signals/s)\n");
+  for (std::size_t threads : ThreadCounts(options)) {
+    std::printf("%8zu", threads);
+    for (const auto &m : kModes)
+      std::printf(" %14.2f", measure(m.mode, threads, options) / 1e6);
+    std::printf("\n");
+  }
+}
+
+} // namespace ctm::bench
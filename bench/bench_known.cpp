@@ -0,0 +1,95 @@
+#include "Bench.hpp"
+#include "CrossroadTrafficMonitoring.hpp"
+#include "KnownPlates.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ctm::bench {
+
+namespace {
+constexpr std::size_t kFleet = 900; // fits the pool, so both modes count all
+
+double measureFleet(const std::shared_ptr<const KnownPlates> &known,
+                    IngestMode mode, std::size_t threads,
+                    const BenchOptions &options) {
+  MonitorConfig config;
+  config.ingest = mode;
+  config.knownPlates = known;
+  auto monitor =
+      std::make_unique<CrossroadTrafficMonitoring>(std::chrono::hours(1), config);
+  monitor->Start();
+  std::vector<Car> cars;
+  for (std::size_t p = 0; p < kFleet; ++p)
+    cars.emplace_back("FLEET" + std::to_string(p));
+  return MeasureThroughput(threads, options.duration,
+                           [&](std::size_t t, const std::atomic<bool> &stop) {
+                             std::uint64_t ops = 0;
+                             std::size_t p = t;
+                             while (!stop.load(std::memory_order_relaxed)) {
+                               p = (p + 7) % cars.size();
+                               monitor->OnSignal(cars[p]);
+                               ++ops;
+                             }
+                             return ops;
+                           });
+}
+// Every plate seen once per period: the general index inserts (copy, sorted
+// insert) what the known-plates mode only counts.
+double measureNewPeriods(const std::shared_ptr<const KnownPlates> &known,
+                         const BenchOptions &options) {
+  MonitorConfig config;
+  config.knownPlates = known;
+  CrossroadTrafficMonitoring monitor(std::chrono::hours(1), config);
+  monitor.Start();
+  std::vector<Car> cars;
+  for (std::size_t p = 0; p < kFleet; ++p)
+    cars.emplace_back("FLEET" + std::to_string((p * 7) % kFleet));
+  return MeasureThroughput(1, options.duration,
+                           [&](std::size_t, const std::atomic<bool> &stop) {
+                             std::uint64_t ops = 0;
+                             while (!stop.load(std::memory_order_relaxed)) {
+                               monitor.Reset();
+                               for (const Car &car : cars)
+                                 monitor.OnSignal(car);
+                               ops += cars.size();
+                             }
+                             return ops;
+                           });
+}
+} // namespace
+
+// Sightings of a registered fleet: general index vs known plates.
+void RunKnownPlatesBench(const BenchOptions &options) {
+  std::vector<std::string> plates;
+  for (std::size_t p = 0; p < kFleet; ++p)
+    plates.push_back("FLEET" + std::to_string(p));
+  const auto known = std::make_shared<const KnownPlates>(plates, false);
+
+  std::printf("new period every %zu signals: %.2f / %.2f (known) Msignals/s\n",
+              kFleet, measureNewPeriods(nullptr, options) / 1e6,
+              measureNewPeriods(known, options) / 1e6);
+
+  const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+  std::printf("repeat sightings\n%9s %12s %12s %14s %14s   (million signals/s)\n", "threads",
+              "mutex", "mutex+known", "lock-free", "lock-free+known");
+  for (std::size_t threads : ThreadCounts(options)) {
+    std::printf("%8zu%c", threads, threads > cores ? '*' : ' ');
+    std::printf(" %12.2f",
+                measureFleet(nullptr, IngestMode::Mutex, threads, options) /
+                    1e6);
+    std::printf(" %12.2f",
+                measureFleet(known, IngestMode::Mutex, threads, options) / 1e6);
+    std::printf(" %14.2f",
+                measureFleet(nullptr, IngestMode::LockFree, threads, options) /
+                    1e6);
+    std::printf(" %14.2f\n",
+                measureFleet(known, IngestMode::LockFree, threads, options) /
+                    1e6);
+  }
+}
+
+} // namespace ctm::bench
@@ -0,0 +1,82 @@
+#include "AdaptiveMutex.hpp"
+#include "Bench.hpp"
+#include "CrossroadTrafficMonitoring.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ctm::bench {
+
+namespace {
+// A critical section about as long as a repeat sighting: a few counter
+// updates on one cache line.
+struct SharedCounters {
+  std::array<std::uint64_t, 4> values{};
+};
+
+template <typename Lock>
+double measureRawLock(std::size_t threads, const BenchOptions &options) {
+  Lock lock;
+  SharedCounters counters;
+  return MeasureThroughput(
+      threads, options.duration,
+      [&](std::size_t t, const std::atomic<bool> &stop) {
+        std::uint64_t ops = 0;
+        while (!stop.load(std::memory_order_relaxed)) {
+          std::lock_guard<Lock> guard(lock);
+          ++counters.values[t % counters.values.size()];
+          ++counters.values[0];
+          ++ops;
+        }
+        return ops;
+      });
+}
+
+double measureMonitor(LockPolicy policy, std::size_t threads,
+                      const BenchOptions &options) {
+  MonitorConfig config;
+  config.lockPolicy = policy;
+  auto monitor =
+      std::make_unique<CrossroadTrafficMonitoring>(std::chrono::hours(1), config);
+  monitor->Start();
+  std::vector<Car> cars;
+  for (std::size_t p = 0; p < 100; ++p)
+    cars.emplace_back("LOCK" + std::to_string(p));
+  return MeasureThroughput(threads, options.duration,
+                           [&](std::size_t t, const std::atomic<bool> &stop) {
+                             std::uint64_t ops = 0;
+                             std::size_t p = t;
+                             while (!stop.load(std::memory_order_relaxed)) {
+                               p = (p + 3) % cars.size();
+                               monitor->OnSignal(cars[p]);
+                               ++ops;
+                             }
+                             return ops;
+                           });
+}
+} // namespace
+
+void RunLockBench(const BenchOptions &options) {
+  const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+  std::printf("%u hardware threads; rows marked * are oversubscribed\n", cores);
+  std::printf("%9s %12s %12s %14s %14s   (million ops/s)\n", "threads",
+              "std::mutex", "adaptive", "monitor/std", "monitor/adapt");
+  for (std::size_t threads : ThreadCounts(options)) {
+    std::printf("%8zu%c", threads, threads > cores ? '*' : ' ');
+    std::printf(" %12.2f", measureRawLock<std::mutex>(threads, options) / 1e6);
+    std::printf(" %12.2f",
+                measureRawLock<AdaptiveMutex>(threads, options) / 1e6);
+    std::printf(" %14.2f",
+                measureMonitor(LockPolicy::StdMutex, threads, options) / 1e6);
+    std::printf(" %14.2f\n",
+                measureMonitor(LockPolicy::SpinThenPark, threads, options) /
+                    1e6);
+  }
+}
+
+} // namespace ctm::bench
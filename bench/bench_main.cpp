@@ -0,0 +1,66 @@
+#include "Bench.hpp"
+#include <cstring>
+#include <iostream>
+#include <string>
+
+using namespace ctm::bench;
+
+namespace {
+struct BenchEntry {
+  const char *name;
+  void (*run)(const BenchOptions &);
+};
+
+const BenchEntry kBenches[] = {
+    {"columns", RunColumnsBench},
+    {"compact", RunCompactBench},
+    {"crdt", RunCrdtBench},
+    {"ingest", RunIngestBench},
+    {"known", RunKnownPlatesBench},
+    {"lock", RunLockBench},
+    {"partition", RunPartitionBench},
+    {"pipeline", RunPipelineBench},
+    {"presence", RunPresenceBench},
+    {"regions", RunRegionsBench},
+    {"replay", RunReplayBench},
+    {"retain", RunRetainBench},
+    {"scheduler", RunSchedulerBench},
+    {"watchlist", RunWatchlistBench},
+};
+
+void usage() {
+  std::cout << "Usage: TrafficMonitoringBench [--duration-ms N] "
+               "[--max-threads N] [bench...]\nBenches:";
+  for (const auto &b : kBenches)
+    std::cout << ' ' << b.name;
+  std::cout << '\n';
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  BenchOptions options;
+  std::vector<std::string> selected;
+  for (int i = 1; i < argc; ++i) {
+    if (!std::strcmp(argv[i], "--duration-ms") && i + 1 < argc) {
+      options.duration = std::chrono::milliseconds(std::stoul(argv[++i]));
+    } else if (!std::strcmp(argv[i], "--max-threads") && i + 1 < argc) {
+      options.maxThreads = std::stoul(argv[++i]);
+    } else if (argv[i][0] == '-') {
+      usage();
+      return 1;
+    } else {
+      selected.emplace_back(argv[i]);
+    }
+  }
+
+  for (const auto &b : kBenches) {
+    bool run = selected.empty();
+    for (const auto &name : selected)
+      run = run || name == b.name;
+    if (run) {
+      std::cout << "== " << b.name << " ==\n";
+      b.run(options);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,45 @@
+#include "Bench.hpp"
+#include "PartitionedMonitor.hpp"
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace ctm::bench {
+
+// Coordinator throughput (canonicalize, route, batch, send) and the cost of
+// a fanned-out statistics query, by worker count. Workers are separate
+// processes, so they count in parallel with the coordinator.
+void RunPartitionBench(const BenchOptions &options) {
+  for (std::size_t workers : {1, 2, 4, 8}) {
+    // 600 plates per worker, below a monitor's capacity whatever the split
+    std::vector<Car> cars;
+    for (std::size_t p = 0; p < 600 * workers; ++p)
+      cars.emplace_back("PL" + std::to_string(p));
+    PartitionConfig config;
+    config.workers = workers;
+    config.period = std::chrono::hours(1);
+    PartitionedMonitor monitor(config);
+    monitor.Start();
+    const double rate = MeasureThroughput(
+        1, options.duration, [&](std::size_t, const std::atomic<bool> &stop) {
+          std::uint64_t ops = 0;
+          for (std::size_t p = 0; !stop.load(std::memory_order_relaxed);
+               p = (p + 7) % cars.size()) {
+            monitor.OnSignal(cars[p]);
+            ++ops;
+          }
+          monitor.Flush();
+          return ops;
+        });
+    const auto start = std::chrono::steady_clock::now();
+    const std::size_t lines = monitor.GetStatistics().size();
+    const std::chrono::duration<double, std::milli> query =
+        std::chrono::steady_clock::now() - start;
+    std::printf("%zu workers: %.2f Msignals/s, statistics (%zu lines) "
+                "%.1f ms\n",
+                workers, rate / 1e6, lines, query.count());
+  }
+}
+
+} // namespace ctm::bench
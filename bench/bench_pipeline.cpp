@@ -0,0 +1,55 @@
+#include "Bench.hpp"
+#include "IngestPipeline.hpp"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace ctm::bench {
+
+namespace {
+struct Shape {
+  std::size_t decoders, routers, shards;
+};
+const Shape kShapes[] = {{1, 1, 1}, {2, 1, 2}, {4, 2, 4}, {8, 2, 8}};
+} // namespace
+
+// Frames/s through the whole pipeline, one producer thread per decoder.
+void RunPipelineBench(const BenchOptions &options) {
+  std::printf("%24s %12s %14s %14s %14s\n", "decoders/routers/shards",
+              "Mframes/s", "decode lat us", "route lat us", "apply lat us");
+  for (const Shape &shape : kShapes) {
+    PipelineConfig config;
+    config.decoders = shape.decoders;
+    config.routers = shape.routers;
+    config.shards = shape.shards;
+    IngestPipeline pipeline(config);
+
+    std::vector<std::vector<std::string>> templates(shape.decoders);
+    for (std::size_t d = 0; d < shape.decoders; ++d) {
+      for (std::size_t i = 0; i < 256; ++i)
+        templates[d].push_back("Car,ab-" + std::to_string((i * 31 + d) % 900) +
+                               "," + std::to_string(d));
+    }
+    const double rate = MeasureThroughput(
+        shape.decoders, options.duration,
+        [&](std::size_t d, const std::atomic<bool> &stop) {
+          std::uint64_t frames = 0;
+          while (!stop.load(std::memory_order_relaxed)) {
+            pipeline.Submit(d, templates[d]);
+            frames += templates[d].size();
+          }
+          return frames;
+        });
+    pipeline.Stop();
+
+    const PipelineMetrics m = pipeline.GetMetrics();
+    char label[32];
+    std::snprintf(label, sizeof(label), "%zu/%zu/%zu", shape.decoders,
+                  shape.routers, shape.shards);
+    std::printf("%24s %12.2f %14.1f %14.1f %14.1f\n", label, rate / 1e6,
+                m.stages[0].meanLatencyNs / 1e3, m.stages[1].meanLatencyNs / 1e3,
+                m.stages[2].meanLatencyNs / 1e3);
+  }
+}
+
+} // namespace ctm::bench
@@ -0,0 +1,156 @@
+#include "Bench.hpp"
+#include "CrossroadTrafficMonitoring.hpp"
+#include "PresenceBitmap.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace ctm::bench {
+
+namespace {
+// Two periods' indices: `n` each out of `range`, about half shared.
+struct PeriodPair {
+  std::vector<std::uint32_t> a, b; // sorted
+  PresenceBitmap bitmapA, bitmapB;
+};
+
+PeriodPair makePair(std::size_t n, std::uint32_t range) {
+  std::mt19937 rng(119);
+  std::uniform_int_distribution<std::uint32_t> value(0, range - 1);
+  PeriodPair pair;
+  for (std::size_t i = 0; i < n; ++i) {
+    const std::uint32_t shared = value(rng);
+    pair.a.push_back(i % 2 ? value(rng) : shared);
+    pair.b.push_back(i % 2 ? value(rng) : shared);
+  }
+  for (auto *v : {&pair.a, &pair.b}) {
+    std::sort(v->begin(), v->end());
+    v->erase(std::unique(v->begin(), v->end()), v->end());
+  }
+  for (std::uint32_t x : pair.a)
+    pair.bitmapA.Add(x);
+  for (std::uint32_t x : pair.b)
+    pair.bitmapB.Add(x);
+  return pair;
+}
+
+double measure(const BenchOptions &options, const std::function<void()> &op) {
+  return MeasureThroughput(1, options.duration,
+                           [&](std::size_t, const std::atomic<bool> &stop) {
+                             std::uint64_t ops = 0;
+                             while (!stop.load(std::memory_order_relaxed)) {
+                               op();
+                               ++ops;
+                             }
+                             return ops;
+                           });
+}
+
+void runQueries(const char *name, std::size_t n, std::uint32_t range,
+                const BenchOptions &options) {
+  const PeriodPair pair = makePair(n, range);
+  std::vector<std::uint32_t> both;
+  std::uint64_t sink = 0;
+  const double sorted = measure(options, [&] {
+    both.clear();
+    std::set_intersection(pair.a.begin(), pair.a.end(), pair.b.begin(),
+                          pair.b.end(), std::back_inserter(both));
+    sink += both.size();
+  });
+  const double count = measure(options, [&] {
+    sink += PresenceBitmap::AndCardinality(pair.bitmapA, pair.bitmapB);
+  });
+  const double intersect = measure(options, [&] {
+    sink += PresenceBitmap::And(pair.bitmapA, pair.bitmapB).Empty();
+  });
+  const double merge = measure(options, [&] {
+    sink += PresenceBitmap::Or(pair.bitmapA, pair.bitmapB).Empty();
+  });
+  std::printf("%-18s %10.0f %10.0f %10.0f %10.0f   %6zu / %6zu KiB%s\n",
+              name, sorted, count, intersect, merge,
+              pair.a.size() * sizeof(std::uint32_t) / 1024,
+              pair.bitmapA.MemoryBytes() / 1024, sink ? "" : " ");
+}
+
+void runKernels(const BenchOptions &options) {
+  std::mt19937 rng(1190);
+  std::vector<std::uint16_t> a, b, out(4096);
+  for (std::uint32_t v = 0; v < 65536; ++v) {
+    if (rng() % 32 == 0)
+      a.push_back(static_cast<std::uint16_t>(v));
+    if (rng() % 32 == 0)
+      b.push_back(static_cast<std::uint16_t>(v));
+  }
+  std::vector<std::uint64_t> wa(1024), wb(1024), wout(1024);
+  for (std::size_t w = 0; w < wa.size(); ++w) {
+    wa[w] = (std::uint64_t{rng()} << 32) | rng();
+    wb[w] = (std::uint64_t{rng()} << 32) | rng();
+  }
+  std::uint64_t sink = 0;
+  const double arrayScalar = measure(options, [&] {
+    sink += detail::IntersectArraysScalar(a.data(), a.size(), b.data(),
+                                          b.size(), out.data());
+  });
+  const double arraySimd = measure(options, [&] {
+    sink += detail::IntersectArraysSimd(a.data(), a.size(), b.data(),
+                                        b.size(), out.data());
+  });
+  const double wordsScalar = measure(options, [&] {
+    sink += detail::AndWordsScalar(wa.data(), wb.data(), wout.data(), 1024);
+  });
+  const double wordsSimd = measure(options, [&] {
+    sink += detail::AndWordsSimd(wa.data(), wb.data(), wout.data(), 1024);
+  });
+  std::printf("container kernels      scalar       simd   (million/s)%s\n",
+              sink ? "" : " ");
+  std::printf("  array & array  %10.2f %10.2f   (%zu x %zu values)\n",
+              arrayScalar / 1e6, arraySimd / 1e6, a.size(), b.size());
+  std::printf("  bitmap & bitmap%10.2f %10.2f\n", wordsScalar / 1e6,
+              wordsSimd / 1e6);
+}
+
+double measureIngest(bool attached, const BenchOptions &options) {
+  MonitorConfig config;
+  if (attached)
+    config.plateIndexPeriods = 24;
+  CrossroadTrafficMonitoring monitor(std::chrono::hours(1), config);
+  PresenceHistory history(24);
+  if (attached)
+    monitor.SetPresenceHistory(&history);
+  monitor.Start();
+  std::vector<Car> cars;
+  for (std::size_t p = 0; p < 900; ++p)
+    cars.emplace_back("P" + std::to_string(p));
+  return MeasureThroughput(1, options.duration,
+                           [&](std::size_t, const std::atomic<bool> &stop) {
+                             std::uint64_t ops = 0;
+                             for (std::size_t p = 0;
+                                  !stop.load(std::memory_order_relaxed);
+                                  p = (p + 7) % cars.size()) {
+                               monitor.OnSignal(cars[p]);
+                               ++ops;
+                             }
+                             return ops;
+                           });
+}
+} // namespace
+
+// Set queries across two periods, the container kernels, and the cost of
+// recording presence while ingesting.
+void RunPresenceBench(const BenchOptions &options) {
+  std::printf("%-18s %10s %10s %10s %10s   %s\n", "two periods",
+              "sorted&", "count&", "bitmap&", "bitmap|",
+              "(queries/s; sorted / bitmap size)");
+  runQueries("sparse 20k of 4M", 20000, 1u << 22, options);
+  runQueries("dense 200k of 256k", 200000, 1u << 18, options);
+  runKernels(options);
+  std::printf("ingest: %.2f / %.2f (history attached) Msignals/s\n",
+              measureIngest(false, options) / 1e6,
+              measureIngest(true, options) / 1e6);
+}
+
+} // namespace ctm::bench
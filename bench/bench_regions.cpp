@@ -0,0 +1,42 @@
+#include "Bench.hpp"
+#include "CrossroadTrafficMonitoring.hpp"
+#include <cstdio>
+#include <string>
+
+namespace ctm::bench {
+
+namespace {
+// Per-category statistics queries per second, cars being a third of the
+// pool, interleaved with bicycles and scooters in arrival order.
+double measureCategoryScan(const MonitorConfig &config,
+                           const BenchOptions &options) {
+  CrossroadTrafficMonitoring monitor(std::chrono::hours(1), config);
+  monitor.Start();
+  for (std::size_t p = 0; p < 330; ++p) {
+    monitor.OnSignal(Bicycle("B" + std::to_string(p)));
+    monitor.OnSignal(Car("C" + std::to_string(p)));
+    monitor.OnSignal(Scooter("S" + std::to_string(p)));
+  }
+  return MeasureThroughput(1, options.duration,
+                           [&](std::size_t, const std::atomic<bool> &stop) {
+                             std::uint64_t ops = 0;
+                             while (!stop.load(std::memory_order_relaxed)) {
+                               ops += monitor.GetStatistics(VehicleCategory::Car)
+                                          .size() > 0;
+                             }
+                             return ops;
+                           });
+}
+} // namespace
+
+// GetStatistics(Car) over a shared pool and over per-category regions.
+void RunRegionsBench(const BenchOptions &options) {
+  MonitorConfig shared;
+  MonitorConfig split;
+  split.poolSplit = {1, 1, 1};
+  std::printf("shared pool: %.0f scans/s, category regions: %.0f scans/s\n",
+              measureCategoryScan(shared, options),
+              measureCategoryScan(split, options));
+}
+
+} // namespace ctm::bench
@@ -0,0 +1,89 @@
+#include "Bench.hpp"
+#include "SignalTap.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ctm::bench {
+
+namespace {
+constexpr std::size_t kRecords = 2000000;
+constexpr std::size_t kResetEvery = 200000;
+
+// A recovery trace: Start, then vehicle records over 900 plates with a
+// Reset every kResetEvery records.
+std::vector<SignalTraceRecord> makeTrace() {
+  std::vector<SignalTraceRecord> records;
+  records.reserve(kRecords + kRecords / kResetEvery + 1);
+  SignalTraceRecord r{};
+  r.kind = SignalKind::Start;
+  records.push_back(r);
+  for (std::size_t i = 0; i < kRecords; ++i) {
+    if (i > 0 && i % kResetEvery == 0) {
+      r = SignalTraceRecord{};
+      r.kind = SignalKind::Reset;
+      records.push_back(r);
+    }
+    const std::string id = "AB" + std::to_string((i * 7919) % 900);
+    r = SignalTraceRecord{};
+    r.kind = static_cast<SignalKind>(i % 3);
+    r.camera = static_cast<CameraId>(i % 8);
+    r.idLength = static_cast<std::uint8_t>(id.size());
+    std::memcpy(r.id, id.data(), id.size());
+    records.push_back(r);
+  }
+  return records;
+}
+
+template <typename F> double recordsPerSecond(std::size_t records, F &&run) {
+  const auto start = std::chrono::steady_clock::now();
+  run();
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return static_cast<double>(records) / elapsed.count();
+}
+} // namespace
+
+// Recovery throughput: sequential replay against ReplaySignalTraceParallel
+// into one lock-free monitor and into one monitor per thread.
+void RunReplayBench(const BenchOptions &options) {
+  const std::vector<SignalTraceRecord> records = makeTrace();
+  MonitorConfig lockFree;
+  lockFree.ingest = IngestMode::LockFree;
+  {
+    CrossroadTrafficMonitoring monitor(std::chrono::hours(1));
+    const double rate = recordsPerSecond(
+        records.size(), [&] { ReplaySignalTrace(monitor, records); });
+    std::printf("%zu records, sequential: %.2f Mrecords/s\n", records.size(),
+                rate / 1e6);
+  }
+
+  const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+  std::printf("%9s %14s %14s   (million records/s)\n", "threads",
+              "one monitor", "shard/thread");
+  for (std::size_t threads : ThreadCounts(options)) {
+    std::printf("%8zu%c", threads, threads > cores ? '*' : ' ');
+    CrossroadTrafficMonitoring single(std::chrono::hours(1), lockFree);
+    std::printf(" %14.2f", recordsPerSecond(records.size(), [&] {
+                  ReplaySignalTraceParallel({&single}, records, threads);
+                }) / 1e6);
+
+    std::vector<std::unique_ptr<CrossroadTrafficMonitoring>> shards;
+    std::vector<CrossroadTrafficMonitoring *> targets;
+    for (std::size_t s = 0; s < threads; ++s) {
+      shards.push_back(
+          std::make_unique<CrossroadTrafficMonitoring>(std::chrono::hours(1)));
+      targets.push_back(shards.back().get());
+    }
+    std::printf(" %14.2f\n", recordsPerSecond(records.size(), [&] {
+                  ReplaySignalTraceParallel(targets, records, threads);
+                }) / 1e6);
+  }
+}
+
+} // namespace ctm::bench
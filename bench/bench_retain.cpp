@@ -0,0 +1,54 @@
+#include "Bench.hpp"
+#include "CrossroadTrafficMonitoring.hpp"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace ctm::bench {
+
+namespace {
+constexpr std::size_t kPeriodSignals = 900;
+
+// One period = a reset plus kPeriodSignals first sightings, `recurring` of
+// them commuters seen every period and the rest plates never seen before.
+double measurePeriods(unsigned retention, std::size_t recurring,
+                      const BenchOptions &options) {
+  MonitorConfig config;
+  config.plateRetentionPeriods = retention;
+  CrossroadTrafficMonitoring monitor(std::chrono::hours(1), config);
+  monitor.Start();
+  std::vector<Car> commuters;
+  for (std::size_t p = 0; p < recurring; ++p)
+    commuters.emplace_back("COMMUTER" + std::to_string((p * 7) % recurring));
+  std::uint64_t passing = 0;
+  return MeasureThroughput(1, options.duration,
+                           [&](std::size_t, const std::atomic<bool> &stop) {
+                             std::uint64_t ops = 0;
+                             while (!stop.load(std::memory_order_relaxed)) {
+                               monitor.Reset();
+                               for (const Car &car : commuters)
+                                 monitor.OnSignal(car);
+                               for (std::size_t p = recurring;
+                                    p < kPeriodSignals; ++p)
+                                 monitor.OnSignal(
+                                     Car("PASSING" + std::to_string(passing++)));
+                               ops += kPeriodSignals;
+                             }
+                             return ops;
+                           });
+}
+} // namespace
+
+// Window-to-window cost: vehicles freed at every reset vs plates retained.
+void RunRetainBench(const BenchOptions &options) {
+  std::printf("%9s %12s %12s   (million signals/s, %zu per period)\n",
+              "recurring", "freed", "retained", kPeriodSignals);
+  for (std::size_t percent : {100, 90, 50, 0}) {
+    const std::size_t recurring = kPeriodSignals * percent / 100;
+    std::printf("%8zu%% %12.2f %12.2f\n", percent,
+                measurePeriods(0, recurring, options) / 1e6,
+                measurePeriods(1, recurring, options) / 1e6);
+  }
+}
+
+} // namespace ctm::bench
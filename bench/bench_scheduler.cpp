@@ -0,0 +1,85 @@
+#include "Bench.hpp"
+#include "CrossroadTrafficMonitoring.hpp"
+#include "ResetScheduler.hpp"
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ctm::bench {
+
+namespace {
+constexpr std::size_t kMonitors = 64;
+
+// Repeat sightings spread over kMonitors monitors, each checking its own
+// deadline on every signal or reset by a shared scheduler.
+double measureIngest(ResetScheduler *scheduler, const BenchOptions &options) {
+  MonitorConfig config;
+  config.resetScheduler = scheduler;
+  std::vector<std::unique_ptr<CrossroadTrafficMonitoring>> monitors;
+  for (std::size_t m = 0; m < kMonitors; ++m) {
+    monitors.push_back(std::make_unique<CrossroadTrafficMonitoring>(
+        std::chrono::hours(1), config));
+    monitors.back()->Start();
+  }
+  std::vector<Car> cars;
+  for (std::size_t p = 0; p < 500; ++p)
+    cars.emplace_back("P" + std::to_string(p));
+  return MeasureThroughput(1, options.duration,
+                           [&](std::size_t, const std::atomic<bool> &stop) {
+                             std::uint64_t ops = 0;
+                             for (std::size_t i = 0;
+                                  !stop.load(std::memory_order_relaxed); ++i) {
+                               monitors[i % kMonitors]->OnSignal(
+                                   cars[(i * 7) % cars.size()]);
+                               ++ops;
+                             }
+                             return ops;
+                           });
+}
+
+// Fire `timers` hourly timers for a simulated day; returns fires/s and the
+// largest batch.
+std::pair<double, std::size_t> measureFiring(std::size_t timers,
+                                             std::chrono::milliseconds spread) {
+  SchedulerConfig config;
+  config.startThread = false;
+  config.spread = spread;
+  ResetScheduler scheduler(config);
+  std::uint64_t sink = 0;
+  for (std::size_t t = 0; t < timers; ++t)
+    scheduler.Add(std::chrono::hours(1), [&sink] { ++sink; });
+  const auto start = std::chrono::steady_clock::now();
+  scheduler.AdvanceTo(scheduler.Now() + std::chrono::hours(24));
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  const SchedulerStats stats = scheduler.GetStats();
+  return {static_cast<double>(stats.fired) / elapsed.count(),
+          stats.maxBatchSize};
+}
+} // namespace
+
+// Per-signal deadline checks against a shared timing wheel, and the cost of
+// firing many monitors' periods.
+void RunSchedulerBench(const BenchOptions &options) {
+  {
+    ResetScheduler scheduler;
+    std::printf("ingest over %zu monitors: %.2f (clock per signal) / %.2f "
+                "(scheduler) Msignals/s\n",
+                kMonitors, measureIngest(nullptr, options) / 1e6,
+                measureIngest(&scheduler, options) / 1e6);
+  }
+  std::printf("%8s %10s %14s %14s\n", "timers", "spread", "fires/s",
+              "largest batch");
+  for (std::size_t timers : {1000, 100000}) {
+    for (auto spread : {std::chrono::milliseconds(0),
+                        std::chrono::milliseconds(60000)}) {
+      const auto [rate, batch] = measureFiring(timers, spread);
+      std::printf("%8zu %9llds %14.0f %14zu\n", timers,
+                  static_cast<long long>(spread.count() / 1000), rate, batch);
+    }
+  }
+}
+
+} // namespace ctm::bench
@@ -0,0 +1,72 @@
+#include "Bench.hpp"
+#include "CrossroadTrafficMonitoring.hpp"
+#include "Watchlist.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ctm::bench {
+
+namespace {
+constexpr std::size_t kListedPlates = 1000000;
+
+double measureIngest(WatchlistAlerts *alerts, std::size_t threads,
+                     const BenchOptions &options) {
+  auto monitor = std::make_unique<CrossroadTrafficMonitoring>(
+      std::chrono::hours(1), MonitorConfig{});
+  monitor->SetWatchlistAlerts(alerts);
+  monitor->Start();
+  // One plate in 20 is listed (W0, W20, ...).
+  std::vector<Car> cars;
+  for (std::size_t p = 0; p < 400; ++p)
+    cars.emplace_back((p % 20 ? "V" : "W") + std::to_string(p));
+  const double rate = MeasureThroughput(
+      threads, options.duration,
+      [&](std::size_t t, const std::atomic<bool> &stop) {
+        std::uint64_t ops = 0;
+        std::size_t p = t;
+        while (!stop.load(std::memory_order_relaxed)) {
+          p = (p + 7) % cars.size();
+          monitor->OnSignal(cars[p]);
+          ++ops;
+        }
+        return ops;
+      });
+  monitor->SetWatchlistAlerts(nullptr);
+  return rate;
+}
+} // namespace
+
+void RunWatchlistBench(const BenchOptions &options) {
+  std::vector<std::string> plates;
+  plates.reserve(kListedPlates);
+  for (std::size_t i = 0; i < kListedPlates; ++i)
+    plates.push_back("W" + std::to_string(i));
+  const auto buildStart = std::chrono::steady_clock::now();
+  auto list = std::make_unique<Watchlist>(plates);
+  const std::chrono::duration<double, std::milli> buildTime =
+      std::chrono::steady_clock::now() - buildStart;
+  std::printf("%zu plates: built in %.0f ms, %.1f MiB\n", list->Size(),
+              buildTime.count(), list->MemoryBytes() / (1024.0 * 1024.0));
+
+  std::uint64_t delivered = 0;
+  WatchlistAlerts alerts([&](const WatchlistMatch &) { ++delivered; }, 1 << 16);
+  alerts.Swap(std::move(list));
+
+  const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+  std::printf("%9s %14s %14s   (million signals/s, 5%% listed)\n", "threads",
+              "no watchlist", "watchlist");
+  for (std::size_t threads : ThreadCounts(options)) {
+    std::printf("%8zu%c", threads, threads > cores ? '*' : ' ');
+    std::printf(" %14.2f", measureIngest(nullptr, threads, options) / 1e6);
+    std::printf(" %14.2f\n", measureIngest(&alerts, threads, options) / 1e6);
+  }
+  std::printf("matches %llu, dropped %llu\n",
+              static_cast<unsigned long long>(alerts.GetMatchCount()),
+              static_cast<unsigned long long>(alerts.GetDroppedCount()));
+}
+
+} // namespace ctm::bench
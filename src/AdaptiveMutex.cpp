@@ -0,0 +1,54 @@
+#include "AdaptiveMutex.hpp"
+#include <algorithm>
+#include <thread>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace ctm // ctm == CrossRoad Traffic Monitoring
+{
+
+static void cpuRelax() {
+#if defined(__SSE2__)
+  _mm_pause();
+#else
+  std::this_thread::yield();
+#endif
+}
+
+void AdaptiveMutex::LockContended() {
+  // Spin while the budget lasts, re-checking with plain loads so waiters do
+  // not steal the cache line from the owner.
+  const std::uint32_t budget = spinBudget.load(std::memory_order_relaxed);
+  std::uint32_t spun = 0;
+  for (std::uint32_t backoff = 1; spun < budget;
+       backoff = std::min<std::uint32_t>(backoff * 2, 64)) {
+    for (std::uint32_t i = 0; i < backoff; ++i)
+      cpuRelax();
+    spun += backoff;
+    std::uint32_t current = word.load(std::memory_order_relaxed);
+    if (current == Unlocked &&
+        word.compare_exchange_weak(current, Locked, std::memory_order_acquire,
+                                   std::memory_order_relaxed)) {
+      // Spinning paid off: move the budget towards twice what it took.
+      const std::uint32_t target =
+          std::clamp<std::uint32_t>(2 * spun, MIN_SPIN, MAX_SPIN);
+      const std::int64_t step =
+          (static_cast<std::int64_t>(target) - budget) / 8;
+      spinBudget.store(static_cast<std::uint32_t>(budget + step),
+                       std::memory_order_relaxed);
+      return;
+    }
+  }
+
+  // Spinning did not pay off: shrink the budget and park.
+  spinBudget.store(std::max<std::uint32_t>(MIN_SPIN, budget - budget / 8),
+                   std::memory_order_relaxed);
+  // Mark the lock as possibly having parked waiters; whoever gets it this way
+  // keeps the mark, so unlock() always wakes the next one.
+  while (word.exchange(Parked, std::memory_order_acquire) != Unlocked)
+    word.wait(Parked, std::memory_order_relaxed);
+}
+
+} // namespace ctm
@@ -0,0 +1,106 @@
+#ifndef ADAPTIVE_MUTEX_HPP
+#define ADAPTIVE_MUTEX_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+namespace ctm // ctm == CrossRoad Traffic Monitoring
+{
+//-----------------------------------------------------------
+// Spin-then-park mutex for very short critical sections.
+//
+// A contended lock() first spins (with a pause instruction and exponential
+// backoff) for up to an adaptive budget, then parks on the lock word
+// (std::atomic::wait, a futex on Linux). The budget follows how long recent
+// acquisitions needed to spin: it grows while spinning pays off and shrinks
+// when waiters end up parking anyway (e.g. more threads than cores), so an
+// oversubscribed lock stops burning CPU.
+//
+// Meets the Lockable requirements (lock, try_lock, unlock).
+//-----------------------------------------------------------
+class AdaptiveMutex {
+public:
+  static constexpr std::uint32_t MIN_SPIN = 16;
+  static constexpr std::uint32_t MAX_SPIN = 4096; // pause instructions
+
+  AdaptiveMutex() = default;
+  AdaptiveMutex(const AdaptiveMutex &) = delete;
+  AdaptiveMutex &operator=(const AdaptiveMutex &) = delete;
+
+  void lock() {
+    std::uint32_t expected = Unlocked;
+    if (!word.compare_exchange_strong(expected, Locked,
+                                      std::memory_order_acquire,
+                                      std::memory_order_relaxed))
+      LockContended();
+  }
+
+  bool try_lock() {
+    std::uint32_t expected = Unlocked;
+    return word.compare_exchange_strong(expected, Locked,
+                                        std::memory_order_acquire,
+                                        std::memory_order_relaxed);
+  }
+
+  void unlock() {
+    if (word.exchange(Unlocked, std::memory_order_release) == Parked)
+      word.notify_one();
+  }
+
+  // Current spin budget, for benchmarks and tests.
+  std::uint32_t SpinBudget() const {
+    return spinBudget.load(std::memory_order_relaxed);
+  }
+
+private:
+  enum : std::uint32_t {
+    Unlocked = 0,
+    Locked = 1, // no thread parked
+    Parked = 2  // locked, and a thread may be parked
+  };
+
+  void LockContended();
+
+  std::atomic<std::uint32_t> word{Unlocked};
+  std::atomic<std::uint32_t> spinBudget{MIN_SPIN * 8};
+};
+
+// Lock used for monitorMutex, see MonitorConfig::lockPolicy.
+enum class LockPolicy {
+  StdMutex,    // std::mutex
+  SpinThenPark // AdaptiveMutex
+};
+
+// Lockable that forwards to std::mutex or AdaptiveMutex, chosen at
+// construction.
+class PolicyMutex {
+public:
+  explicit PolicyMutex(LockPolicy policy = LockPolicy::StdMutex)
+      : adaptive{policy == LockPolicy::SpinThenPark} {}
+
+  void lock() {
+    if (adaptive)
+      spinThenPark.lock();
+    else
+      mutex.lock();
+  }
+  bool try_lock() {
+    return adaptive ? spinThenPark.try_lock() : mutex.try_lock();
+  }
+  void unlock() {
+    if (adaptive)
+      spinThenPark.unlock();
+    else
+      mutex.unlock();
+  }
+
+private:
+  const bool adaptive;
+  std::mutex mutex;
+  AdaptiveMutex spinThenPark;
+};
+
+} // namespace ctm
+
+#endif // ADAPTIVE_MUTEX_HPP
@@ -0,0 +1,73 @@
+#include "ConcurrentVehicleIndex.hpp"
+
+namespace ctm // ctm == CrossRoad Traffic Monitoring
+{
+
+ConcurrentVehicleIndex::ConcurrentVehicleIndex(Vehicle *pool,
+                                               std::size_t poolSize,
+                                               EpochManager &epochs,
+                                               bool keyByIdOnly)
+    : pool{pool}, poolSize{poolSize}, epochs{epochs}, keyByIdOnly{keyByIdOnly},
+      capacity{std::bit_ceil(2 * poolSize)},
+      tables{Table(capacity), Table(capacity)}, active{&tables[0]},
+      nextFree(new std::atomic<std::uint32_t>[poolSize]) {
+  // Chain the pool in order, so vehicles are handed out from index 0 up.
+  for (std::size_t i = 0; i < poolSize; ++i) {
+    nextFree[i].store(i + 1 < poolSize ? static_cast<std::uint32_t>(i + 2) : 0,
+                      std::memory_order_relaxed);
+  }
+  freeHead.store(poolSize > 0 ? Pack(0, 0) : 0, std::memory_order_release);
+}
+
+Vehicle *ConcurrentVehicleIndex::PopFree() {
+  std::uint64_t head = freeHead.load(std::memory_order_acquire);
+  for (;;) {
+    const auto top = static_cast<std::uint32_t>(head);
+    if (top == 0)
+      return nullptr;
+    // May read a stale link if `top` is popped and pushed concurrently; the
+    // ABA tag then makes the CAS fail.
+    const std::uint32_t next = nextFree[top - 1].load(std::memory_order_relaxed);
+    const std::uint64_t newHead = (((head >> 32) + 1) << 32) | next;
+    if (freeHead.compare_exchange_weak(head, newHead,
+                                       std::memory_order_acquire,
+                                       std::memory_order_acquire)) {
+      return &pool[top - 1];
+    }
+  }
+}
+
+void ConcurrentVehicleIndex::PushFree(Vehicle *v) {
+  const auto index = static_cast<std::uint32_t>(v - pool);
+  std::uint64_t head = freeHead.load(std::memory_order_relaxed);
+  do {
+    nextFree[index].store(static_cast<std::uint32_t>(head),
+                          std::memory_order_relaxed);
+  } while (!freeHead.compare_exchange_weak(
+      head, (((head >> 32) + 1) << 32) | (index + 1u),
+      std::memory_order_release, std::memory_order_relaxed));
+}
+
+Vehicle *ConcurrentVehicleIndex::Find(VehicleCategory cat,
+                                      std::string_view id) const {
+  const Table *table = active.load(std::memory_order_acquire);
+  const std::uint64_t hash = Hash(id);
+  const std::uint32_t tag = Tag(hash);
+  for (std::size_t probe = 0; probe < capacity; ++probe) {
+    const std::uint64_t value =
+        table->slots[(hash + probe) & (capacity - 1)].load(
+            std::memory_order_acquire);
+    if (value == 0)
+      return nullptr; // slots never empty out, the key cannot be further on
+    if (Tag(value) == tag && Matches(*VehicleAt(value), cat, id))
+      return VehicleAt(value);
+  }
+  return nullptr;
+}
+
+std::size_t ConcurrentVehicleIndex::MemoryBytes() const {
+  return 2 * capacity * sizeof(std::atomic<std::uint64_t>) +
+         poolSize * sizeof(std::atomic<std::uint32_t>);
+}
+
+} // namespace ctm
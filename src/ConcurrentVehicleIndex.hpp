@@ -0,0 +1,198 @@
+#ifndef CONCURRENT_VEHICLE_INDEX_HPP
+#define CONCURRENT_VEHICLE_INDEX_HPP
+
+#include "CrossroadTrafficMonitoring.hpp"
+#include "EpochReclamation.hpp"
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string_view>
+#include <thread>
+
+namespace ctm // ctm == CrossRoad Traffic Monitoring
+{
+//-----------------------------------------------------------
+// Lock-free index over a monitor's vehicle pool, used with
+// IngestMode::LockFree.
+//
+//    - Open addressing with linear probing. A slot holds
+//      (hash tag << 32) | (pool index + 1), so probing compares tags
+//      without touching the vehicles. Slots only go from empty to full,
+//      which keeps find-or-insert correct with a single CAS.
+//    - Two tables: Clear() publishes the empty one, waits until no pinned
+//      thread can still use the old one, then empties it into the free
+//      list. Threads never see a table while it is being emptied.
+//    - Free vehicles are kept on a Treiber stack of pool indices with an
+//      ABA tag.
+//
+// Every call except Clear() must be made while pinned on the EpochManager
+// given at construction. Clear() must not be called while pinned, and
+// callers serialize Clear() among themselves.
+//-----------------------------------------------------------
+class ConcurrentVehicleIndex {
+public:
+  // keyByIdOnly: PerPlate layout, one entry per ID whatever the category.
+  ConcurrentVehicleIndex(Vehicle *pool, std::size_t poolSize,
+                         EpochManager &epochs, bool keyByIdOnly);
+
+  struct InsertResult {
+    Vehicle *vehicle{nullptr}; // nullptr => pool exhausted
+    bool inserted{false};      // this call published the vehicle
+    std::size_t table{0};      // searched, see ActiveTable()
+  };
+
+  // Find the entry for (cat, id) or publish a new one. `init(Vehicle *)`
+  // fills a freshly allocated vehicle (id, category) before it becomes
+  // visible; it may run for a vehicle that loses the race and is returned
+  // to the free list unpublished.
+  template <typename Init>
+  InsertResult FindOrInsert(VehicleCategory cat, std::string_view id,
+                            Init &&init);
+
+  Vehicle *Find(VehicleCategory cat, std::string_view id) const;
+
+  // Which of the two tables is current (0 or 1); Clear() switches. While
+  // pinned, a table read here is not emptied.
+  std::size_t ActiveTable() const {
+    return active.load(std::memory_order_acquire) == &tables[0] ? 0 : 1;
+  }
+
+  // Visit every published vehicle of the current table.
+  template <typename F> void ForEach(F &&f) const;
+
+  // Start a new, empty period (see above). `release(Vehicle *)` is called for
+  // each vehicle of the old table before it goes back to the free list.
+  template <typename Release> void Clear(Release &&release);
+
+  std::size_t MemoryBytes() const;
+
+  // Counts are updated with relaxed atomics on the plain counters.
+  static unsigned LoadCount(const Vehicle &v, std::size_t cat) {
+    return std::atomic_ref<unsigned>(const_cast<unsigned &>(v.counts[cat]))
+        .load(std::memory_order_relaxed);
+  }
+  static unsigned IncrementCount(Vehicle &v, std::size_t cat) {
+    return std::atomic_ref<unsigned>(v.counts[cat])
+        .fetch_add(1, std::memory_order_relaxed);
+  }
+
+private:
+  struct Table {
+    explicit Table(std::size_t capacity)
+        : slots(new std::atomic<std::uint64_t>[capacity]) {
+      for (std::size_t i = 0; i < capacity; ++i)
+        slots[i].store(0, std::memory_order_relaxed);
+    }
+    std::unique_ptr<std::atomic<std::uint64_t>[]> slots;
+  };
+
+  static std::uint64_t Hash(std::string_view id) {
+    return std::hash<std::string_view>{}(id);
+  }
+  static std::uint32_t Tag(std::uint64_t hash) {
+    return static_cast<std::uint32_t>(hash >> 32);
+  }
+  static std::uint64_t Pack(std::uint32_t tag, std::uint32_t index) {
+    return (static_cast<std::uint64_t>(tag) << 32) | (index + 1u);
+  }
+  Vehicle *VehicleAt(std::uint64_t slot) const {
+    return &pool[static_cast<std::uint32_t>(slot) - 1u];
+  }
+  bool Matches(const Vehicle &v, VehicleCategory cat,
+               std::string_view id) const {
+    return (keyByIdOnly || v.category == cat) && v.id == id;
+  }
+
+  Vehicle *PopFree();
+  void PushFree(Vehicle *v);
+
+  Vehicle *const pool;
+  const std::size_t poolSize;
+  EpochManager &epochs;
+  const bool keyByIdOnly;
+  const std::size_t capacity; // power of 2, at least twice the pool
+  Table tables[2];
+  std::atomic<Table *> active;
+
+  // Free stack: head = (aba tag << 32) | (pool index + 1), 0 = empty
+  std::unique_ptr<std::atomic<std::uint32_t>[]> nextFree;
+  alignas(64) std::atomic<std::uint64_t> freeHead{0};
+};
+
+template <typename Init>
+ConcurrentVehicleIndex::InsertResult
+ConcurrentVehicleIndex::FindOrInsert(VehicleCategory cat, std::string_view id,
+                                     Init &&init) {
+  Table *table = active.load(std::memory_order_acquire);
+  const std::size_t tableIndex = table == &tables[0] ? 0 : 1;
+  const std::uint64_t hash = Hash(id);
+  const std::uint32_t tag = Tag(hash);
+  Vehicle *candidate = nullptr;
+
+  for (std::size_t probe = 0; probe < capacity; ++probe) {
+    auto &slot = table->slots[(hash + probe) & (capacity - 1)];
+    std::uint64_t value = slot.load(std::memory_order_acquire);
+    if (value == 0) {
+      if (!candidate) {
+        candidate = PopFree();
+        if (!candidate)
+          return {nullptr, false, tableIndex};
+        init(candidate);
+      }
+      const auto index = static_cast<std::uint32_t>(candidate - pool);
+      if (slot.compare_exchange_strong(value, Pack(tag, index),
+                                       std::memory_order_acq_rel,
+                                       std::memory_order_acquire)) {
+        return {candidate, true, tableIndex};
+      }
+      // Lost the slot; `value` now holds the winner, check it below.
+    }
+    if (Tag(value) == tag && Matches(*VehicleAt(value), cat, id)) {
+      if (candidate)
+        PushFree(candidate); // never published, reusable right away
+      return {VehicleAt(value), false, tableIndex};
+    }
+  }
+  if (candidate)
+    PushFree(candidate);
+  return {nullptr, false, tableIndex};
+}
+
+template <typename F> void ConcurrentVehicleIndex::ForEach(F &&f) const {
+  const Table *table = active.load(std::memory_order_acquire);
+  for (std::size_t i = 0; i < capacity; ++i) {
+    const std::uint64_t value = table->slots[i].load(std::memory_order_acquire);
+    if (value != 0)
+      f(*VehicleAt(value));
+  }
+}
+
+template <typename Release>
+void ConcurrentVehicleIndex::Clear(Release &&release) {
+  Table *old = active.load(std::memory_order_acquire);
+  active.store(old == &tables[0] ? &tables[1] : &tables[0],
+               std::memory_order_seq_cst);
+
+  // Grace period: anyone pinned before the switch may still use `old`.
+  const std::uint64_t switched = epochs.CurrentEpoch();
+  while (!epochs.IsSafe(switched)) {
+    if (!epochs.TryAdvance())
+      std::this_thread::yield();
+  }
+
+  for (std::size_t i = 0; i < capacity; ++i) {
+    const std::uint64_t value =
+        old->slots[i].exchange(0, std::memory_order_relaxed);
+    if (value != 0) {
+      release(VehicleAt(value));
+      PushFree(VehicleAt(value));
+    }
+  }
+}
+
+} // namespace ctm
+
+#endif // CONCURRENT_VEHICLE_INDEX_HPP
@@ -0,0 +1,64 @@
+#include "ConsistentHashRing.hpp"
+#include <algorithm>
+
+namespace ctm // ctm == CrossRoad Traffic Monitoring
+{
+namespace {
+// MurmurHash3 finalizer: spreads close inputs over the whole ring.
+std::uint64_t mix(std::uint64_t x) {
+  x ^= x >> 33;
+  x *= 0xff51afd7ed558ccdull;
+  x ^= x >> 33;
+  x *= 0xc4ceb9fe1a85ec53ull;
+  x ^= x >> 33;
+  return x;
+}
+} // namespace
+
+ConsistentHashRing::ConsistentHashRing(std::size_t virtualNodes)
+    : virtualNodes{std::max<std::size_t>(1, virtualNodes)} {}
+
+std::uint64_t ConsistentHashRing::Hash(std::string_view key) {
+  std::uint64_t hash = 0xcbf29ce484222325ull; // FNV-1a
+  for (char c : key) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 0x100000001b3ull;
+  }
+  return mix(hash);
+}
+
+void ConsistentHashRing::AddNode(NodeId node) {
+  const auto owned = [node](const auto &point) { return point.second == node; };
+  if (std::any_of(points.begin(), points.end(), owned))
+    return;
+  for (std::size_t v = 0; v < virtualNodes; ++v)
+    points.emplace_back(mix((std::uint64_t{node} << 32) | v), node);
+  std::sort(points.begin(), points.end());
+}
+
+void ConsistentHashRing::RemoveNode(NodeId node) {
+  std::erase_if(points,
+                [node](const auto &point) { return point.second == node; });
+}
+
+ConsistentHashRing::NodeId
+ConsistentHashRing::NodeFor(std::string_view key) const {
+  const std::uint64_t hash = Hash(key);
+  auto it = std::lower_bound(
+      points.begin(), points.end(), hash,
+      [](const auto &point, std::uint64_t h) { return point.first < h; });
+  if (it == points.end())
+    it = points.begin(); // wrap around
+  return it->second;
+}
+
+std::vector<ConsistentHashRing::NodeId> ConsistentHashRing::Nodes() const {
+  std::vector<NodeId> nodes;
+  for (const auto &point : points)
+    nodes.push_back(point.second);
+  std::sort(nodes.begin(), nodes.end());
+  nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+  return nodes;
+}
+
+} // namespace ctm
@@ -0,0 +1,44 @@
+#ifndef CONSISTENT_HASH_RING_HPP
+#define CONSISTENT_HASH_RING_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace ctm // ctm == CrossRoad Traffic Monitoring
+{
+//-----------------------------------------------------------
+// Consistent hashing of plates onto nodes (see PartitionedMonitor):
+//    - Every node owns virtualNodes points on a 64-bit ring; a key belongs
+//      to the first point at or after its hash.
+//    - Adding a node moves only the keys that now fall on its points
+//      (about 1/N of them), all to the new node; removing one moves only
+//      its own keys, spread over the others.
+// Hashes are stable across processes and runs (no std::hash).
+// Not thread-safe.
+//-----------------------------------------------------------
+class ConsistentHashRing {
+public:
+  using NodeId = std::uint32_t;
+
+  explicit ConsistentHashRing(std::size_t virtualNodes = 160);
+
+  void AddNode(NodeId node); // no-op if present
+  void RemoveNode(NodeId node);
+
+  NodeId NodeFor(std::string_view key) const; // ring must not be empty
+  bool Empty() const { return points.empty(); }
+  std::vector<NodeId> Nodes() const; // ascending
+
+  static std::uint64_t Hash(std::string_view key);
+
+private:
+  const std::size_t virtualNodes;
+  std::vector<std::pair<std::uint64_t, NodeId>> points; // sorted by hash
+};
+
+} // namespace ctm
+
+#endif // CONSISTENT_HASH_RING_HPP
@@ -0,0 +1,383 @@
+#include "CrdtReplica.hpp"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <optional>
+
+namespace ctm // ctm == CrossRoad Traffic Monitoring
+{
+//-----------------------------------------------------------
+// GCounter
+//-----------------------------------------------------------
+void GCounter::Increment(NodeId node, std::uint64_t by) {
+  if (by == 0)
+    return; // a zero count is no entry, as in Raise()
+  auto it = std::lower_bound(
+      entries.begin(), entries.end(), node,
+      [](const auto &entry, NodeId n) { return entry.first < n; });
+  if (it == entries.end() || it->first != node)
+    it = entries.insert(it, {node, 0});
+  it->second += by;
+}
+
+bool GCounter::Raise(NodeId node, std::uint64_t count) {
+  auto it = std::lower_bound(
+      entries.begin(), entries.end(), node,
+      [](const auto &entry, NodeId n) { return entry.first < n; });
+  if (it == entries.end() || it->first != node) {
+    if (count == 0)
+      return false;
+    entries.insert(it, {node, count});
+    return true;
+  }
+  if (it->second >= count)
+    return false;
+  it->second = count;
+  return true;
+}
+
+bool GCounter::Merge(const GCounter &other) {
+  bool changed = false;
+  for (const auto &[n, count] : other.entries)
+    changed |= Raise(n, count);
+  return changed;
+}
+
+std::uint64_t GCounter::Value() const {
+  std::uint64_t value = 0;
+  for (const auto &entry : entries)
+    value += entry.second;
+  return value;
+}
+
+std::uint64_t GCounter::Get(NodeId node) const {
+  for (const auto &entry : entries) {
+    if (entry.first == node)
+      return entry.second;
+  }
+  return 0;
+}
+
+//-----------------------------------------------------------
+// Payload encoding
+//-----------------------------------------------------------
+namespace {
+constexpr char kPayloadMagic[4] = {'C', 'R', 'D', 'T'};
+constexpr std::uint8_t kPayloadVersion = 2;
+
+void putVarint(std::string &out, std::uint64_t value) {
+  while (value >= 0x80) {
+    out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<char>(value));
+}
+
+// Reads from the front of `in`; nothing on truncation or overlong input.
+std::optional<std::uint64_t> getVarint(std::string_view &in) {
+  std::uint64_t value = 0;
+  for (unsigned shift = 0; shift < 64 && !in.empty(); shift += 7) {
+    const auto byte = static_cast<std::uint8_t>(in.front());
+    in.remove_prefix(1);
+    value |= std::uint64_t{byte & 0x7fu} << shift;
+    if ((byte & 0x80) == 0)
+      return value;
+  }
+  return std::nullopt;
+}
+
+// A payload checked in full before anything is applied.
+struct DecodedPlate {
+  std::string_view id;
+  std::array<GCounter, kCategoryCount> counters;
+};
+struct DecodedEpoch {
+  std::uint64_t epoch{0};
+  std::vector<DecodedPlate> plates;
+};
+
+bool decodePlate(std::string_view &in, DecodedPlate &plate) {
+  const auto length = getVarint(in);
+  if (!length || *length > in.size())
+    return false;
+  plate.id = in.substr(0, static_cast<std::size_t>(*length));
+  in.remove_prefix(plate.id.size());
+  if (in.empty())
+    return false;
+  const auto mask = static_cast<std::uint8_t>(in.front());
+  in.remove_prefix(1);
+  if (mask >> kCategoryCount != 0)
+    return false;
+  for (std::size_t c = 0; c < kCategoryCount; ++c) {
+    if ((mask >> c & 1) == 0)
+      continue;
+    const auto entries = getVarint(in);
+    if (!entries || *entries > in.size())
+      return false;
+    for (std::uint64_t e = 0; e < *entries; ++e) {
+      const auto from = getVarint(in);
+      const auto value = getVarint(in);
+      if (!from || !value || *from > UINT32_MAX)
+        return false;
+      plate.counters[c].Raise(static_cast<NodeId>(*from), *value);
+    }
+  }
+  return true;
+}
+
+bool decodePayload(std::string_view in, std::vector<DecodedEpoch> &epochs) {
+  if (in.size() < sizeof(kPayloadMagic) + 1 ||
+      std::memcmp(in.data(), kPayloadMagic, sizeof(kPayloadMagic)) != 0 ||
+      static_cast<std::uint8_t>(in[sizeof(kPayloadMagic)]) != kPayloadVersion)
+    return false;
+  in.remove_prefix(sizeof(kPayloadMagic) + 1);
+  const auto sender = getVarint(in);
+  const auto epochCount = getVarint(in);
+  if (!sender || !epochCount || *epochCount > in.size())
+    return false;
+  epochs.resize(static_cast<std::size_t>(*epochCount));
+  for (DecodedEpoch &epoch : epochs) {
+    const auto number = getVarint(in);
+    const auto count = getVarint(in);
+    if (!number || !count || *count > in.size())
+      return false;
+    epoch.epoch = *number;
+    epoch.plates.resize(static_cast<std::size_t>(*count));
+    for (DecodedPlate &plate : epoch.plates) {
+      if (!decodePlate(in, plate))
+        return false;
+    }
+  }
+  return in.empty();
+}
+} // namespace
+
+//-----------------------------------------------------------
+// CrdtReplica
+//-----------------------------------------------------------
+CrdtReplica::CrdtReplica(NodeId node, std::size_t keepEpochs)
+    : node{node}, keepEpochs{std::max<std::size_t>(keepEpochs, 1)} {}
+
+bool CrdtReplica::KeptLocked(std::uint64_t epoch) const {
+  return epoch <= currentEpoch ? currentEpoch - epoch < keepEpochs
+                               : epoch - currentEpoch == 1;
+}
+
+const CrdtReplica::EntryMap *
+CrdtReplica::FindEpochLocked(std::uint64_t epoch) const {
+  const auto it =
+      epochs.find(epoch == kCurrentEpoch ? currentEpoch : epoch);
+  return it == epochs.end() ? nullptr : &it->second;
+}
+
+void CrdtReplica::MarkDirtyLocked(std::uint64_t epoch,
+                                  EntryMap::value_type &entry) {
+  if (!entry.second.dirty) {
+    entry.second.dirty = true;
+    dirty.emplace_back(epoch, &entry);
+  }
+}
+
+void CrdtReplica::BeginEpoch(std::uint64_t epoch) {
+  std::lock_guard<std::mutex> lock(replicaMutex);
+  if (epoch <= currentEpoch)
+    return;
+  currentEpoch = epoch;
+  while (!epochs.empty() && !KeptLocked(epochs.begin()->first)) {
+    const std::uint64_t dropped = epochs.begin()->first;
+    std::erase_if(dirty, [dropped](const auto &ref) {
+      return ref.first == dropped;
+    });
+    epochs.erase(epochs.begin());
+  }
+}
+
+std::uint64_t CrdtReplica::Epoch() const {
+  std::lock_guard<std::mutex> lock(replicaMutex);
+  return currentEpoch;
+}
+
+void CrdtReplica::Record(std::uint64_t epoch, VehicleCategory cat,
+                         std::string_view id) {
+  std::lock_guard<std::mutex> lock(replicaMutex);
+  if (epoch == kCurrentEpoch)
+    epoch = currentEpoch;
+  else if (!KeptLocked(epoch))
+    return;
+  EntryMap &entries = epochs[epoch];
+  auto it = entries.find(id);
+  if (it == entries.end())
+    it = entries.emplace(std::string(id), Entry{}).first;
+  it->second.counters[static_cast<std::size_t>(cat)].Increment(node);
+  MarkDirtyLocked(epoch, *it);
+}
+
+void CrdtReplica::Record(VehicleCategory cat, std::string_view id) {
+  Record(kCurrentEpoch, cat, id);
+}
+
+std::string CrdtReplica::EncodeLocked(const std::vector<PlateRef> &plates) const {
+  std::string out(kPayloadMagic, sizeof(kPayloadMagic));
+  out.push_back(static_cast<char>(kPayloadVersion));
+  putVarint(out, node);
+  std::size_t epochCount = 0;
+  for (std::size_t i = 0; i < plates.size(); ++i)
+    epochCount += i == 0 || plates[i].first != plates[i - 1].first;
+  putVarint(out, epochCount);
+  for (std::size_t first = 0; first < plates.size();) {
+    std::size_t last = first;
+    while (last < plates.size() && plates[last].first == plates[first].first)
+      ++last;
+    putVarint(out, plates[first].first);
+    putVarint(out, last - first);
+    for (; first < last; ++first) {
+      const EntryMap::value_type &plate = *plates[first].second;
+      putVarint(out, plate.first.size());
+      out += plate.first;
+      std::uint8_t mask = 0;
+      for (std::size_t c = 0; c < kCategoryCount; ++c) {
+        if (!plate.second.counters[c].Empty())
+          mask |= static_cast<std::uint8_t>(1u << c);
+      }
+      out.push_back(static_cast<char>(mask));
+      for (const GCounter &counter : plate.second.counters) {
+        if (counter.Empty())
+          continue;
+        putVarint(out, counter.Entries().size());
+        for (const auto &[from, count] : counter.Entries()) {
+          putVarint(out, from);
+          putVarint(out, count);
+        }
+      }
+    }
+  }
+  return out;
+}
+
+std::string CrdtReplica::TakeDelta() {
+  std::lock_guard<std::mutex> lock(replicaMutex);
+  if (dirty.empty())
+    return {};
+  std::vector<PlateRef> plates;
+  plates.reserve(dirty.size());
+  for (const auto &[epoch, entry] : dirty) {
+    entry->second.dirty = false;
+    plates.emplace_back(epoch, entry);
+  }
+  dirty.clear();
+  std::stable_sort(plates.begin(), plates.end(),
+                   [](const PlateRef &a, const PlateRef &b) {
+                     return a.first < b.first;
+                   });
+  ++stats.deltasTaken;
+  return EncodeLocked(plates);
+}
+
+std::string CrdtReplica::Serialize() const {
+  std::lock_guard<std::mutex> lock(replicaMutex);
+  std::vector<PlateRef> plates;
+  for (const auto &[epoch, entries] : epochs) {
+    for (const auto &entry : entries)
+      plates.emplace_back(epoch, &entry);
+  }
+  return EncodeLocked(plates);
+}
+
+bool CrdtReplica::Merge(std::string_view payload) {
+  std::vector<DecodedEpoch> decoded;
+  const bool valid = decodePayload(payload, decoded);
+  std::lock_guard<std::mutex> lock(replicaMutex);
+  if (!valid) {
+    ++stats.payloadsRejected;
+    return false;
+  }
+  ++stats.payloadsMerged;
+  for (const DecodedEpoch &epoch : decoded) {
+    if (!KeptLocked(epoch.epoch)) {
+      stats.platesSkipped += epoch.plates.size();
+      continue;
+    }
+    EntryMap &entries = epochs[epoch.epoch];
+    for (const DecodedPlate &plate : epoch.plates) {
+      auto it = entries.find(plate.id);
+      if (it == entries.end())
+        it = entries.emplace(std::string(plate.id), Entry{}).first;
+      bool changed = false;
+      for (std::size_t c = 0; c < kCategoryCount; ++c) {
+        for (const auto &[from, count] : plate.counters[c].Entries()) {
+          if (it->second.counters[c].Raise(from, count)) {
+            ++stats.entriesRaised;
+            changed = true;
+          }
+        }
+      }
+      if (changed)
+        MarkDirtyLocked(epoch.epoch, *it);
+    }
+  }
+  return true;
+}
+
+VehicleCount CrdtReplica::GetVehicleCount(std::string_view id,
+                                          std::uint64_t epoch) const {
+  VehicleCount result;
+  std::lock_guard<std::mutex> lock(replicaMutex);
+  const EntryMap *entries = FindEpochLocked(epoch);
+  if (!entries)
+    return result;
+  const auto it = entries->find(id);
+  if (it == entries->end())
+    return result;
+  for (std::size_t c = 0; c < kCategoryCount; ++c)
+    result.perCategory[c] = static_cast<unsigned>(
+        std::min<std::uint64_t>(it->second.counters[c].Value(),
+                                std::numeric_limits<unsigned>::max()));
+  return result;
+}
+
+std::uint64_t CrdtReplica::GetNodeCount(NodeId from, VehicleCategory cat,
+                                        std::string_view id,
+                                        std::uint64_t epoch) const {
+  std::lock_guard<std::mutex> lock(replicaMutex);
+  const EntryMap *entries = FindEpochLocked(epoch);
+  if (!entries)
+    return 0;
+  const auto it = entries->find(id);
+  return it == entries->end()
+             ? 0
+             : it->second.counters[static_cast<std::size_t>(cat)].Get(from);
+}
+
+std::vector<std::string>
+CrdtReplica::GetStatistics(std::uint64_t epoch) const {
+  std::vector<const EntryMap::value_type *> plates;
+  std::lock_guard<std::mutex> lock(replicaMutex);
+  if (const EntryMap *entries = FindEpochLocked(epoch)) {
+    for (const auto &entry : *entries)
+      plates.push_back(&entry);
+  }
+  std::sort(plates.begin(), plates.end(),
+            [](const auto *a, const auto *b) { return a->first < b->first; });
+  std::vector<std::string> lines;
+  for (const auto *plate : plates) {
+    for (std::size_t c = 0; c < kCategoryCount; ++c) {
+      const std::uint64_t count = plate->second.counters[c].Value();
+      if (count > 0)
+        lines.push_back(plate->first + " - " +
+                        ToString(static_cast<VehicleCategory>(c)) + " (" +
+                        std::to_string(count) + ")");
+    }
+  }
+  return lines;
+}
+
+ReplicaStats CrdtReplica::GetStats() const {
+  std::lock_guard<std::mutex> lock(replicaMutex);
+  ReplicaStats result = stats;
+  result.epochs = epochs.size();
+  for (const auto &[epoch, entries] : epochs)
+    result.plates += entries.size();
+  return result;
+}
+
+} // namespace ctm
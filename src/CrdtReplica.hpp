@@ -0,0 +1,162 @@
+#ifndef CRDT_REPLICA_HPP
+#define CRDT_REPLICA_HPP
+
+#include "CrossroadTrafficMonitoring.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace ctm // ctm == CrossRoad Traffic Monitoring
+{
+using NodeId = std::uint32_t;
+
+//-----------------------------------------------------------
+// Grow-only counter: one monotonic count per node, the value is their sum.
+// Merging keeps the larger count of each node, so it is commutative,
+// associative and idempotent: replicas that have seen the same updates hold
+// the same counter whatever the order and number of merges.
+//-----------------------------------------------------------
+class GCounter {
+public:
+  void Increment(NodeId node, std::uint64_t by = 1);
+  // Raise `node`'s count to at least `count`; true if it changed.
+  bool Raise(NodeId node, std::uint64_t count);
+  bool Merge(const GCounter &other); // true if anything changed
+
+  std::uint64_t Value() const;
+  std::uint64_t Get(NodeId node) const;
+  bool Empty() const { return entries.empty(); }
+  // (node, count), ascending node
+  const std::vector<std::pair<NodeId, std::uint64_t>> &Entries() const {
+    return entries;
+  }
+
+  bool operator==(const GCounter &) const = default;
+
+private:
+  std::vector<std::pair<NodeId, std::uint64_t>> entries; // few nodes
+};
+
+struct ReplicaStats {
+  std::size_t plates{0}; // in every kept epoch
+  std::size_t epochs{0};
+  std::uint64_t deltasTaken{0};
+  std::uint64_t payloadsMerged{0};
+  std::uint64_t payloadsRejected{0}; // malformed, nothing applied
+  std::uint64_t entriesRaised{0};    // node counts a merge increased
+  std::uint64_t platesSkipped{0};    // merged for an epoch not kept
+};
+
+//-----------------------------------------------------------
+// One node's replica of per-vehicle counts, for redundant monitor nodes
+// whose views are combined without coordination (see
+// CrossroadTrafficMonitoring::SetCrdtReplica):
+//    - Every (plate, category) is a GCounter keyed by node ID. A node only
+//      increments its own entry, so the same sighting is never counted
+//      twice however often it is exchanged.
+//    - TakeDelta() returns the counters changed since the previous call,
+//      by local sightings or by merges, so deltas also travel through
+//      intermediate nodes. Serialize() returns the full state for a node
+//      that joins late; both are merged with Merge().
+//    - Deltas may be lost, duplicated or reordered: replicas converge once
+//      every delta (or a later full state) has reached every node.
+//    - Counters are kept per epoch, the monitor's reset period: the
+//      monitor opens one with BeginEpoch() at every reset, numbered by
+//      wall-clock period, so nodes whose resets are aligned (see
+//      ResetScheduler) agree on it. The last keepEpochs epochs are kept,
+//      so deltas for the period just closed still merge; merges for
+//      older epochs, or for one more than an epoch ahead, are skipped.
+// Counts only grow within an epoch.
+//
+// IDs are taken as they are: the monitor records its canonical IDs (see
+// MonitorConfig::canonicalizePlates), so query with those.
+//
+// Payload format, varints are LEB128:
+//    "CRDT", version byte, varint sender node, varint epoch count, then per
+//    epoch: varint epoch, varint plate count, then per plate: varint
+//    length, ID bytes, category mask byte, and per category in the mask:
+//    varint entry count, (varint node, varint count) * n.
+//
+// Thread-safe; calls are serialized on one mutex.
+//-----------------------------------------------------------
+class CrdtReplica {
+public:
+  static constexpr std::uint64_t kCurrentEpoch = UINT64_MAX;
+
+  explicit CrdtReplica(NodeId node, std::size_t keepEpochs = 2);
+
+  NodeId Node() const { return node; }
+
+  // Make `epoch` the current one (never goes back) and drop the epochs
+  // that are no longer kept.
+  void BeginEpoch(std::uint64_t epoch);
+  std::uint64_t Epoch() const;
+
+  // One sighting counted by this node, in `epoch` (ignored if not kept) or
+  // in the current one.
+  void Record(std::uint64_t epoch, VehicleCategory cat, std::string_view id);
+  void Record(VehicleCategory cat, std::string_view id);
+
+  std::string TakeDelta();       // empty payload if nothing changed
+  std::string Serialize() const; // full state
+  // Apply a delta or a full state. false (and nothing applied) if the
+  // payload is malformed.
+  bool Merge(std::string_view payload);
+
+  // Counts of one plate across all nodes in one epoch (counts beyond
+  // UINT_MAX saturate), and one node's share.
+  VehicleCount GetVehicleCount(std::string_view id,
+                               std::uint64_t epoch = kCurrentEpoch) const;
+  std::uint64_t GetNodeCount(NodeId from, VehicleCategory cat,
+                             std::string_view id,
+                             std::uint64_t epoch = kCurrentEpoch) const;
+  // "ID - Category (count)" of one epoch, alphabetical, categories in
+  // category order.
+  std::vector<std::string>
+  GetStatistics(std::uint64_t epoch = kCurrentEpoch) const;
+
+  ReplicaStats GetStats() const;
+
+private:
+  struct IdHash {
+    using is_transparent = void;
+    std::size_t operator()(std::string_view id) const {
+      return std::hash<std::string_view>{}(id);
+    }
+  };
+  struct Entry {
+    std::array<GCounter, kCategoryCount> counters;
+    bool dirty{false}; // listed in `dirty`
+  };
+  using EntryMap =
+      std::unordered_map<std::string, Entry, IdHash, std::equal_to<>>;
+
+  using PlateRef = std::pair<std::uint64_t, const EntryMap::value_type *>;
+
+  bool KeptLocked(std::uint64_t epoch) const;
+  const EntryMap *FindEpochLocked(std::uint64_t epoch) const;
+  void MarkDirtyLocked(std::uint64_t epoch, EntryMap::value_type &entry);
+  // (epoch, entry), ascending epoch
+  std::string EncodeLocked(const std::vector<PlateRef> &plates) const;
+
+  const NodeId node;
+  const std::size_t keepEpochs;
+  mutable std::mutex replicaMutex;
+  std::uint64_t currentEpoch{0};
+  std::map<std::uint64_t, EntryMap> epochs;
+  // (epoch, entry) changed since TakeDelta()
+  std::vector<std::pair<std::uint64_t, EntryMap::value_type *>> dirty;
+  ReplicaStats stats;
+};
+
+} // namespace ctm
+
+#endif // CRDT_REPLICA_HPP
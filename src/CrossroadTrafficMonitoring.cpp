@@ -1,10 +1,26 @@
 #include "CrossroadTrafficMonitoring.hpp"
+#include "ConcurrentVehicleIndex.hpp"
+#include "CrdtReplica.hpp"
+#include "KnownPlates.hpp"
+#include "PlateCanonicalizer.hpp"
+#include "PlateDictionary.hpp"
+#include "PresenceBitmap.hpp"
+#include "ResetScheduler.hpp"
+#include "SignalTap.hpp"
+#include "Watchlist.hpp"
 #include <algorithm>
+#include <bit>
 #include <boost/intrusive/list.hpp>
 #include <cassert>
 #include <chrono>
 #include <iostream>
+#include <functional>
+#include <iterator>
+#include <numeric>
+#include <stdexcept>
 #include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 
 namespace ctm // ctm == CrossRoad Traffic Monitoring
@@ -12,57 +28,372 @@ namespace ctm // ctm == CrossRoad Traffic Monitoring
 
 // Constructor
 CrossroadTrafficMonitoring::CrossroadTrafficMonitoring(
-    std::chrono::milliseconds period)
-    : period{period} {
-  InitializeFreeList();
+    std::chrono::milliseconds period, MonitorConfig config)
+    : monitorMutex{config.lockPolicy}, config{config}, period{period} {
+  if (config.knownPlates &&
+      config.knownPlates->Canonical() != config.canonicalizePlates)
+    throw std::invalid_argument(
+        "MonitorConfig: knownPlates canonicalization differs from "
+        "canonicalizePlates");
+  if (config.ingest == IngestMode::LockFree) {
+    // The lock-free index hands out pool entries itself.
+    concurrentIndex = std::make_unique<ConcurrentVehicleIndex>(
+        vehiclePool, MAX_VEHICLES, readerEpochs,
+        config.layout == StorageLayout::PerPlate);
+    ingestStripes = std::make_unique<IngestStripe[]>(INGEST_STRIPES);
+  } else {
+    InitializeFreeList();
+    const auto &split = config.poolSplit;
+    splitPool = config.adaptivePoolSplit ||
+                std::any_of(split.begin(), split.end(),
+                            [](unsigned weight) { return weight > 0; });
+    if (splitPool) {
+      std::array<std::size_t, kCategoryCount> weights;
+      const bool even = std::all_of(split.begin(), split.end(),
+                                    [](unsigned weight) { return weight == 0; });
+      for (std::size_t c = 0; c < kCategoryCount; ++c)
+        weights[c] = even ? 1 : split[c];
+      SetRegionSizes(weights);
+    }
+  }
+  if (config.ingest == IngestMode::FlatCombining)
+    combiningSlots = std::make_unique<CombiningSlot[]>(COMBINING_SLOTS);
+  errorBuffer.resize(config.errorBufferCapacity);
+  if (config.knownPlates)
+    knownCounts = std::make_unique<unsigned[]>(config.knownPlates->Size() *
+                                               kCategoryCount);
+  if (config.plateIndexPeriods > 0) {
+    plateDictionary = std::make_unique<PlateDictionary>(
+        config.plateIndexPeriods,
+        config.knownPlates
+            ? static_cast<std::uint32_t>(config.knownPlates->Size())
+            : 0u);
+  }
   scheduleNextReset();
+  if (config.resetScheduler)
+    resetTimer =
+        config.resetScheduler->Add(period, [this] { ScheduledReset(); });
+}
+
+CrossroadTrafficMonitoring::~CrossroadTrafficMonitoring() {
+  // Waits for a reset the scheduler is running on this monitor.
+  if (config.resetScheduler)
+    config.resetScheduler->Remove(resetTimer);
+}
+
+// Heap bytes behind an ID: 0 while it fits the small string buffer.
+static std::size_t idHeapBytes(const std::string &id) {
+  static const std::size_t smallCapacity = std::string().capacity();
+  return id.capacity() > smallCapacity ? id.capacity() + 1 : 0;
+}
+
+// GetTopVehicles order: count descending, then ID, then category.
+static bool ranksBefore(unsigned countA, std::string_view idA,
+                        std::size_t catA, unsigned countB,
+                        std::string_view idB, std::size_t catB) {
+  if (countA != countB)
+    return countA > countB;
+  const int byId = idA.compare(idB);
+  return byId != 0 ? byId < 0 : catA < catB;
+}
+
+// Pool entry bitmaps: index of the lowest / highest set bit in [begin,
+// end), or `end` if there is none.
+template <std::size_t N>
+static std::size_t lowestSlot(const std::array<std::uint64_t, N> &bits,
+                              std::size_t begin, std::size_t end) {
+  for (std::size_t slot = begin; slot < end; slot = (slot / 64 + 1) * 64) {
+    const std::uint64_t word = bits[slot / 64] & (~std::uint64_t{0} << slot % 64);
+    if (word) {
+      const std::size_t found =
+          slot / 64 * 64 + static_cast<std::size_t>(std::countr_zero(word));
+      return found < end ? found : end;
+    }
+  }
+  return end;
+}
+
+template <std::size_t N>
+static std::size_t highestSlot(const std::array<std::uint64_t, N> &bits,
+                               std::size_t begin, std::size_t end) {
+  for (std::size_t limit = end; limit > begin; limit = (limit - 1) / 64 * 64) {
+    const std::size_t w = (limit - 1) / 64;
+    const std::size_t valid = limit - w * 64; // low bits of the word, 1..64
+    std::uint64_t word = bits[w];
+    if (valid < 64)
+      word &= (std::uint64_t{1} << valid) - 1;
+    if (word) {
+      const std::size_t found =
+          w * 64 + 63 - static_cast<std::size_t>(std::countl_zero(word));
+      return found >= begin ? found : end;
+    }
+  }
+  return end;
+}
+
+template <std::size_t N>
+static void setSlot(std::array<std::uint64_t, N> &bits, std::size_t slot) {
+  bits[slot / 64] |= std::uint64_t{1} << (slot % 64);
 }
 
-// Free list initialization
+template <std::size_t N>
+static void clearSlot(std::array<std::uint64_t, N> &bits, std::size_t slot) {
+  bits[slot / 64] &= ~(std::uint64_t{1} << (slot % 64));
+}
+
+template <std::size_t N>
+static std::size_t countSlots(const std::array<std::uint64_t, N> &bits,
+                              std::size_t begin, std::size_t end) {
+  std::size_t count = 0;
+  for (std::size_t slot = lowestSlot(bits, begin, end); slot < end;
+       slot = lowestSlot(bits, slot + 1, end))
+    ++count;
+  return count;
+}
+
+// Free list initialization: every pool entry is free.
 void CrossroadTrafficMonitoring::InitializeFreeList() {
-  // Create a singly-linked list out of vehiclePool.
-  // freeListHead will be the head of linked structure.
-  freeListHead = &vehiclePool[0];
-  for (std::size_t i = 0; i < MAX_VEHICLES - 1; ++i) {
+  for (std::size_t i = 0; i < MAX_VEHICLES; ++i) {
     vehiclePool[i].category_hook.unlink();
     vehiclePool[i].alphabetical_hook.unlink();
-    // link i-th to (i+1)-th
-    vehiclePool[i].nextFree = &vehiclePool[i + 1];
+    setSlot(freeSlots, i);
+  }
+  for (SlotBits &live : liveSlots)
+    live.fill(0);
+}
+
+std::pair<std::size_t, std::size_t>
+CrossroadTrafficMonitoring::RegionOf(VehicleCategory cat) const {
+  if (!splitPool)
+    return {0, MAX_VEHICLES};
+  const auto c = static_cast<std::size_t>(cat);
+  return {regionBounds[c], regionBounds[c + 1]};
+}
+
+// Region sizes proportional to `weights` (not all zero), rounded so they
+// cover the pool exactly.
+void CrossroadTrafficMonitoring::SetRegionSizes(
+    const std::array<std::size_t, kCategoryCount> &weights) {
+  const std::size_t total =
+      std::accumulate(weights.begin(), weights.end(), std::size_t{0});
+  std::size_t weightSoFar = 0;
+  regionBounds[0] = 0;
+  for (std::size_t c = 0; c < kCategoryCount; ++c) {
+    weightSoFar += weights[c];
+    regionBounds[c + 1] = MAX_VEHICLES * weightSoFar / total;
   }
-  // Mark the tail
-  vehiclePool[MAX_VEHICLES - 1].category_hook.unlink();
-  vehiclePool[MAX_VEHICLES - 1].alphabetical_hook.unlink();
-  vehiclePool[MAX_VEHICLES - 1].nextFree = nullptr;
 }
 
-// AllocateVehicle: push from free list
-Vehicle *CrossroadTrafficMonitoring::AllocateVehicle() {
-  if (!freeListHead) {
-    return nullptr; // no more space
+// Move the split halfway towards the closing period's share of new vehicles,
+// with a floor so a quiet category keeps some room. Entries left outside
+// their new region count as borrowed until CompactStep() moves them.
+void CrossroadTrafficMonitoring::RebalanceRegionsLocked() {
+  const std::size_t total = std::accumulate(
+      uniqueVehicles.begin(), uniqueVehicles.end(), std::size_t{0});
+  if (total == 0)
+    return;
+  constexpr std::size_t kFloor = MAX_VEHICLES / 64;
+  std::array<std::size_t, kCategoryCount> sizes{};
+  for (std::size_t c = 0; c < kCategoryCount; ++c) {
+    const std::size_t current = regionBounds[c + 1] - regionBounds[c];
+    const std::size_t target = MAX_VEHICLES * uniqueVehicles[c] / total;
+    sizes[c] = std::max(kFloor, (current + target) / 2);
   }
-  Vehicle *v = freeListHead;
-  // Move head
-  freeListHead = v->nextFree;
+  const auto before = regionBounds;
+  SetRegionSizes(sizes);
+  if (regionBounds != before)
+    ++regionRebalances;
+}
+
+// AllocateVehicle: take the lowest free entry of the category's region, or
+// borrow the lowest free entry elsewhere
+Vehicle *CrossroadTrafficMonitoring::AllocateVehicle(VehicleCategory cat) {
+  const auto [begin, end] = RegionOf(cat);
+  std::size_t slot = lowestSlot(freeSlots, begin, end);
+  if (slot == end) {
+    ReclaimRetiredVehicles();
+    slot = lowestSlot(freeSlots, begin, end);
+  }
+  if (slot == end) {
+    // region full: borrow (a shared pool has nothing else to offer)
+    slot = lowestSlot(freeSlots, 0, MAX_VEHICLES);
+    if (slot == MAX_VEHICLES) {
+      return nullptr; // no more space
+    }
+    ++regionBorrows;
+  }
+  clearSlot(freeSlots, slot);
+  setSlot(liveSlots[static_cast<std::size_t>(cat)], slot);
+  Vehicle *v = &vehiclePool[slot];
   // Clear out the data
   v->reset();
+  v->category = cat;
+  ++liveVehicles;
   return v;
 }
 
-// Free vehicle: pop from free list
+// Move retired vehicles no reader can observe anymore to the free list.
+// Two advances are enough when no reader is pinned.
+std::size_t CrossroadTrafficMonitoring::ReclaimRetiredVehicles() {
+  readerEpochs.TryAdvance();
+  readerEpochs.TryAdvance();
+  return retiredVehicles.ReclaimSafe(readerEpochs, [this](Vehicle *v) {
+    setSlot(freeSlots, static_cast<std::size_t>(v - vehiclePool));
+  });
+}
+
+// Free vehicle: retire it, it is reused once no reader can still see it
 void CrossroadTrafficMonitoring::FreeVehicle(Vehicle *v) {
   // unlink from any intrusive lists if it's linked
   if (v->category_hook.is_linked())
     v->category_hook.unlink();
   if (v->alphabetical_hook.is_linked())
     v->alphabetical_hook.unlink();
+  if (v->index_hook.is_linked())
+    v->index_hook.unlink();
+  if (v->age_hook.is_linked())
+    v->age_hook.unlink();
+  if (v->topMask)
+    DropTopVehicleLocked(v);
+
+  if (idHeapBytes(v->id) > 0)
+    idHeapLive -= v->id.size() + 1;
+
+  // The data stays intact until reuse: AllocateVehicle() clears it.
+  clearSlot(liveSlots[static_cast<std::size_t>(v->category)],
+            static_cast<std::size_t>(v - vehiclePool));
+  retiredVehicles.Retire(v, readerEpochs.CurrentEpoch());
+  --liveVehicles;
+}
+
+// Relocate: `to` takes the place of `from` in every list it is linked in,
+// and in the index. The IDs swap buffers, so the ID heap figures hold.
+void CrossroadTrafficMonitoring::RelocateVehicleLocked(Vehicle &from,
+                                                       Vehicle &to) {
+  to.reset();
+  to.category = from.category;
+  to.id.swap(from.id);
+  to.counts = from.counts;
+  to.lastPeriod = from.lastPeriod;
+  to.topMask = from.topMask;
+  to.plateIndex = from.plateIndex;
+  if (to.topMask) {
+    for (std::size_t i = 0; i < topCount; ++i) {
+      if (topVehicles[i].vehicle == &from)
+        topVehicles[i].vehicle = &to;
+    }
+  }
+  to.category_hook.swap_nodes(from.category_hook);
+  to.alphabetical_hook.swap_nodes(from.alphabetical_hook);
+  to.age_hook.swap_nodes(from.age_hook);
+  from.index_hook.unlink();
+  vehicleIndex.insert(to);
+  from.reset();
+
+  SlotBits &live = liveSlots[static_cast<std::size_t>(to.category)];
+  const auto fromSlot = static_cast<std::size_t>(&from - vehiclePool);
+  const auto toSlot = static_cast<std::size_t>(&to - vehiclePool);
+  clearSlot(live, fromSlot);
+  setSlot(freeSlots, fromSlot);
+  clearSlot(freeSlots, toSlot);
+  setSlot(live, toSlot);
+}
+
+// Count of `cat` in `v` just grew: move the pair up the board, entering it
+// if it now ranks before the last entry.
+void CrossroadTrafficMonitoring::RaiseTopVehicleLocked(Vehicle *v,
+                                                       std::size_t cat) {
+  auto before = [](const TopEntry &a, const TopEntry &b) {
+    return ranksBefore(a.vehicle->counts[a.category], a.vehicle->id,
+                       a.category, b.vehicle->counts[b.category],
+                       b.vehicle->id, b.category);
+  };
+  const TopEntry entry{v, cat};
+  const auto bit = static_cast<std::uint8_t>(1u << cat);
+  std::size_t pos = 0;
+  if (v->topMask & bit) {
+    while (topVehicles[pos].vehicle != v || topVehicles[pos].category != cat)
+      ++pos;
+  } else if (topCount < TOP_TRACKED) {
+    pos = topCount++;
+  } else if (before(entry, topVehicles[TOP_TRACKED - 1])) {
+    pos = TOP_TRACKED - 1;
+    TopEntry &last = topVehicles[pos];
+    last.vehicle->topMask &= static_cast<std::uint8_t>(~(1u << last.category));
+  } else {
+    return;
+  }
+  topVehicles[pos] = entry;
+  v->topMask |= bit;
+  for (; pos > 0 && before(topVehicles[pos], topVehicles[pos - 1]); --pos)
+    std::swap(topVehicles[pos], topVehicles[pos - 1]);
+}
+
+// A freed vehicle leaves the board (only entries without a count are freed
+// outside a reset, so this is rare)
+void CrossroadTrafficMonitoring::DropTopVehicleLocked(Vehicle *v) {
+  auto end = std::remove_if(
+      topVehicles.begin(), topVehicles.begin() + topCount,
+      [v](const TopEntry &e) { return e.vehicle == v; });
+  topCount = static_cast<std::size_t>(end - topVehicles.begin());
+  v->topMask = 0;
+}
+
+// Move vehicles into the first free entries of their region, a few at a
+// time: borrowed ones (outside the region) first, then the last ones of the
+// region. With a shared pool, every region is the whole pool.
+std::size_t CrossroadTrafficMonitoring::CompactStep(std::size_t maxMoves) {
+  if (concurrentIndex)
+    return 0; // the lock-free index owns the pool
+  std::lock_guard<PolicyMutex> lock(monitorMutex);
+  // Only lock-free readers pin entries, so every retired one comes back.
+  ReclaimRetiredVehicles();
+  std::size_t moved = 0;
+  for (bool progress = true; progress && moved < maxMoves;) {
+    progress = false;
+    for (std::size_t c = 0; c < kCategoryCount && moved < maxMoves; ++c) {
+      const auto [begin, end] = RegionOf(static_cast<VehicleCategory>(c));
+      const std::size_t to = lowestSlot(freeSlots, begin, end);
+      if (to == end)
+        continue; // region full
+      std::size_t from = highestSlot(liveSlots[c], end, MAX_VEHICLES);
+      if (from == MAX_VEHICLES)
+        from = highestSlot(liveSlots[c], 0, begin);
+      if (from == begin)
+        from = highestSlot(liveSlots[c], to, end);
+      if (from == end)
+        continue; // dense
+      RelocateVehicleLocked(vehiclePool[from], vehiclePool[to]);
+      ++moved;
+      progress = true;
+    }
+  }
+  return moved;
+}
 
-  // push front to free list
-  v->nextFree = freeListHead;
-  freeListHead = v;
+PoolRegions CrossroadTrafficMonitoring::GetPoolRegions() const {
+  std::lock_guard<PolicyMutex> lock(monitorMutex);
+  PoolRegions regions;
+  for (std::size_t c = 0; c < kCategoryCount; ++c) {
+    const auto [begin, end] = RegionOf(static_cast<VehicleCategory>(c));
+    regions.begin[c] = begin;
+    regions.size[c] = end - begin;
+    regions.live[c] = countSlots(liveSlots[c], 0, MAX_VEHICLES);
+    regions.borrowed[c] = regions.live[c] - countSlots(liveSlots[c], begin, end);
+  }
+  regions.borrows = regionBorrows;
+  regions.rebalances = regionRebalances;
+  return regions;
 }
 
-// InsertVehicle: add to category & alphabetical lists
+// InsertVehicle: add to the index, category & alphabetical lists
 void CrossroadTrafficMonitoring::InsertVehicle(Vehicle *v) {
+  vehicleIndex.insert(*v);
+  // PerPlate entries span categories, they only live in the alphabetical list
+  if (config.layout == StorageLayout::PerPlate) {
+    InsertAlphaSorted(v);
+    return;
+  }
   // Insert into category-specific list
   switch (v->category) {
   case VehicleCategory::Bicycle:
@@ -92,123 +423,460 @@ void CrossroadTrafficMonitoring::InsertAlphaSorted(Vehicle *v) {
   alphabeticalList.push_back(*v);
 }
 
-// FindVehicle in the category list
+// FindVehicle through the hash index
+const Vehicle *
+CrossroadTrafficMonitoring::FindVehicle(VehicleCategory cat,
+                                        std::string_view id) const {
+  // PerPlate: one entry per ID, whatever the category
+  const bool anyCategory = config.layout == StorageLayout::PerPlate;
+  auto it = vehicleIndex.find(
+      id, IdHash{}, [cat, anyCategory](std::string_view key, const Vehicle &v) {
+        return (anyCategory || v.category == cat) && v.id == key;
+      });
+  return it == vehicleIndex.end() ? nullptr : &*it;
+}
+
 Vehicle *CrossroadTrafficMonitoring::FindVehicle(VehicleCategory cat,
-                                                 const std::string &id) {
-  switch (cat) {
-  case VehicleCategory::Bicycle:
-    for (auto &x : bicycleList) {
-      if (x.id == id)
-        return &x;
-    }
-    break;
-  case VehicleCategory::Car:
-    for (auto &x : carList) {
-      if (x.id == id)
-        return &x;
-    }
-    break;
-  case VehicleCategory::Scooter:
-    for (auto &x : scooterList) {
-      if (x.id == id)
-        return &x;
-    }
-    break;
-  }
-  return nullptr;
+                                                 std::string_view id) {
+  return const_cast<Vehicle *>(std::as_const(*this).FindVehicle(cat, id));
+}
+
+const std::string *
+CrossroadTrafficMonitoring::ResolveId(const std::string &raw,
+                                      std::string &scratch) const {
+  if (!config.canonicalizePlates)
+    return &raw;
+  if (CanonicalizePlate(raw, scratch) != PlateStatus::Ok)
+    return nullptr;
+  return &scratch;
 }
 
 void CrossroadTrafficMonitoring::scheduleNextReset() {
+  if (config.resetScheduler)
+    return; // the scheduler keeps the deadline
   nextResetTime = std::chrono::steady_clock::now() + period;
 }
 
 void CrossroadTrafficMonitoring::CheckAndHandlePeriodicReset() {
-  // If we're in Stopped state, do not reset.
-  if (state == State::Stopped)
+  {
+    std::lock_guard<PolicyMutex> lock(monitorMutex);
+    CheckAndHandlePeriodicResetLocked();
+  }
+  CheckReplayedSignals();
+}
+
+void CrossroadTrafficMonitoring::CheckAndHandlePeriodicResetLocked() {
+  // If we're in Stopped state, do not reset. With a scheduler, resets come
+  // from ScheduledReset() and signals do not read the clock.
+  if (state == State::Stopped || config.resetScheduler)
     return;
 
   const auto now = std::chrono::steady_clock::now();
-  if (now >= nextResetTime) {
+  if (now >= nextResetTime.load()) {
     std::cout << "Periodic reset triggered!\n";
     // Perform reset and become Active
-    Reset();
+    ResetLocked();
   }
 }
 
+// Called by config.resetScheduler on its thread.
+void CrossroadTrafficMonitoring::ScheduledReset() {
+  {
+    std::lock_guard<PolicyMutex> lock(monitorMutex);
+    if (state == State::Active || state == State::Error)
+      ResetLocked();
+  }
+  CheckReplayedSignals();
+}
+
 // State management
 void CrossroadTrafficMonitoring::Start() {
-  // Start() transitions from Init -> Active
-  std::lock_guard<std::mutex> lock(monitorMutex);
-  if (state == State::Init) {
-    state = State::Active;
-    scheduleNextReset();
+  SignalOutcome outcome = SignalOutcome::Ignored;
+  {
+    // Start() transitions from Init -> Active
+    std::lock_guard<PolicyMutex> lock(monitorMutex);
+    if (state == State::Init)
+      outcome = SignalOutcome::StateChange;
+    const std::uint32_t number =
+        RecordTapLocked(SignalKind::Start, outcome, 0, {});
+    if (outcome == SignalOutcome::StateChange) {
+      if (concurrentIndex) // before lock-free signals see Active
+        tableSequences[concurrentIndex->ActiveTable()].store(
+            number, std::memory_order_relaxed);
+      state = State::Active;
+      scheduleNextReset();
+    }
   }
 }
 
 void CrossroadTrafficMonitoring::Stop() {
-  std::lock_guard<std::mutex> lock(monitorMutex);
-  // Stop(): Active -> Stopped
-  if (state == State::Active) {
-    state = State::Stopped;
+  SignalOutcome outcome = SignalOutcome::Ignored;
+  {
+    std::lock_guard<PolicyMutex> lock(monitorMutex);
+    // Stop(): Active -> Stopped
+    if (state == State::Active) {
+      state = State::Stopped;
+      outcome = SignalOutcome::StateChange;
+    }
+    RecordTapLocked(SignalKind::Stop, outcome, 0, {});
   }
 }
 
 void CrossroadTrafficMonitoring::Reset() {
+  {
+    std::lock_guard<PolicyMutex> lock(monitorMutex);
+    ResetLocked();
+  }
+  CheckReplayedSignals();
+}
+
+void CrossroadTrafficMonitoring::ResetLocked() {
   // Reset(): Transitions to Active from any state, per the spec ("any ->
   // Active"). Even if Stopped, Reset() forces Active and clears stats and error
   // counters.
+  // Recorded here, so periodic and scheduled resets are in the trace too.
+  const std::uint32_t traceSequence =
+      RecordTapLocked(SignalKind::Reset, SignalOutcome::Reset, 0, {});
   state = State::Active;
   errorCount = 0;
+  cameraErrors = 0;
+  rejectedPlates.fill(0);
+  if (splitPool && config.adaptivePoolSplit)
+    RebalanceRegionsLocked();
+  uniqueVehicles.fill(0);
+  sightings.fill(0);
+  for (std::size_t i = 0; i < topCount; ++i)
+    topVehicles[i].vehicle->topMask = 0;
+  topCount = 0;
 
-  // Free all vehicles in each category
-  for (auto it = bicycleList.begin(); it != bicycleList.end();) {
-    auto *v = &(*it);
-    ++it;
-    FreeVehicle(v);
+  if (CrdtReplica *replica = crdtReplica.load(std::memory_order_acquire)) {
+    replicaEpoch = std::max(replicaEpoch + 1, WallClockPeriod(true));
+    replica->BeginEpoch(replicaEpoch);
+    if (concurrentIndex) // the table Clear() switches to below
+      tableEpochs[1 - concurrentIndex->ActiveTable()].store(
+          replicaEpoch, std::memory_order_relaxed);
   }
-  for (auto it = carList.begin(); it != carList.end();) {
-    auto *v = &(*it);
-    ++it;
-    FreeVehicle(v);
+
+  // The closing period's plates, from the counters about to be cleared.
+  PresenceHistory *history = presenceHistory.load(std::memory_order_acquire);
+  std::vector<std::pair<std::uint32_t, std::uint32_t>> seen;
+  auto noteSeen = [&seen](std::uint32_t plateIndex, std::uint32_t count) {
+    if (count > 0 && plateIndex != PlateDictionary::npos)
+      seen.emplace_back(plateIndex, count);
+  };
+  if (history && !concurrentIndex) {
+    auto sum = [](const Vehicle &v) {
+      return std::accumulate(v.counts.begin(), v.counts.end(), 0u);
+    };
+    if (RetainsPlates()) {
+      for (const Vehicle &v : seenVehicles)
+        noteSeen(v.plateIndex, sum(v));
+    } else {
+      for (const Vehicle &v : alphabeticalList)
+        noteSeen(v.plateIndex, sum(v));
+    }
   }
-  for (auto it = scooterList.begin(); it != scooterList.end();) {
-    auto *v = &(*it);
-    ++it;
-    FreeVehicle(v);
+
+  if (RetainsPlates()) {
+    RetainVehiclesLocked();
+  } else {
+    // Free all vehicles. Every entry is in the alphabetical list whatever the
+    // layout; FreeVehicle unlinks it from its category list as well.
+    for (auto it = alphabeticalList.begin(); it != alphabeticalList.end();) {
+      auto *v = &(*it);
+      ++it;
+      FreeVehicle(v);
+    }
   }
 
-  alphabeticalList.clear();
+  // Before the switch: a thread still in the old table marks its plate in
+  // the closing period at the latest, never one period too early.
+  if (plateDictionary)
+    plateDictionary->NextPeriod();
+  if (concurrentIndex) {
+    tableSequences[1 - concurrentIndex->ActiveTable()].store(
+        traceSequence, std::memory_order_relaxed);
+    // Waits until no camera thread is still in the old table, so the
+    // vehicles go straight back to the index's free list.
+    concurrentIndex->Clear([&](Vehicle *v) {
+      if (history) {
+        unsigned count = 0;
+        for (std::size_t c = 0; c < kCategoryCount; ++c)
+          count += ConcurrentVehicleIndex::LoadCount(*v, c);
+        noteSeen(v->plateIndex, count);
+      }
+      if (idHeapBytes(v->id) > 0)
+        idHeapLive -= v->id.size() + 1; // may wrap, the stripes add it back
+      --liveVehicles;
+    });
+    for (std::size_t i = 0; i < INGEST_STRIPES; ++i) {
+      for (std::size_t c = 0; c < kCategoryCount; ++c) {
+        ingestStripes[i].uniqueVehicles[c].store(0, std::memory_order_relaxed);
+        ingestStripes[i].sightings[c].store(0, std::memory_order_relaxed);
+      }
+    }
+  }
+  if (knownCounts) {
+    const std::size_t slots = config.knownPlates->Size() * kCategoryCount;
+    if (history) {
+      for (std::uint32_t i = 0; i < config.knownPlates->Size(); ++i) {
+        unsigned count = 0;
+        for (std::size_t c = 0; c < kCategoryCount; ++c)
+          count += LoadKnownCount(i * kCategoryCount + c);
+        noteSeen(i, count);
+      }
+    }
+    if (concurrentIndex) {
+      for (std::size_t i = 0; i < slots; ++i)
+        std::atomic_ref<unsigned>(knownCounts[i])
+            .store(0, std::memory_order_relaxed);
+    } else {
+      std::fill_n(knownCounts.get(), slots, 0u);
+    }
+  }
   scheduleNextReset();
+  if (history)
+    ClosePresenceWindow(*history, seen);
+  ReplayErrorBufferLocked();
+}
+
+void CrossroadTrafficMonitoring::ClosePresenceWindow(
+    PresenceHistory &history,
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> &seen) {
+  std::sort(seen.begin(), seen.end());
+  std::vector<std::uint32_t> indices, sightings;
+  indices.reserve(seen.size());
+  sightings.reserve(seen.size());
+  for (const auto &[plateIndex, count] : seen) {
+    if (!indices.empty() && indices.back() == plateIndex) {
+      sightings.back() += count; // another category's entry
+    } else {
+      indices.push_back(plateIndex);
+      sightings.push_back(count);
+    }
+  }
+  history.CloseWindow(indices, sightings);
+}
+
+bool CrossroadTrafficMonitoring::RetainsPlates() const {
+  return config.plateRetentionPeriods > 0 && !concurrentIndex;
+}
+
+// Close the period for retained plates: the vehicles seen in it get their
+// counters zeroed and become the newest idle ones, then whatever has been
+// idle for too long is freed. Only the seen and the expired entries are
+// visited.
+void CrossroadTrafficMonitoring::RetainVehiclesLocked() {
+  ++periodNumber;
+  while (!seenVehicles.empty()) {
+    Vehicle &v = seenVehicles.front();
+    seenVehicles.pop_front();
+    v.counts.fill(0);
+    idleVehicles.push_back(v);
+    ++idleCount;
+  }
+  while (!idleVehicles.empty() &&
+         periodNumber - idleVehicles.front().lastPeriod >
+             config.plateRetentionPeriods)
+    EvictIdleVehicleLocked();
+}
+
+// A sighting with plate retention: new and idle vehicles join the seen list.
+void CrossroadTrafficMonitoring::MarkSeenLocked(Vehicle *v) {
+  if (v->age_hook.is_linked()) {
+    if (v->lastPeriod == periodNumber)
+      return; // already seen in this period
+    v->age_hook.unlink();
+    --idleCount;
+    // idle for longer than plateIndexPeriods may have cost it its index
+    if (plateDictionary)
+      v->plateIndex = plateDictionary->Acquire(v->id);
+  }
+  v->lastPeriod = periodNumber;
+  seenVehicles.push_back(*v);
+}
+
+// Free the vehicle idle longest; false if none is idle.
+bool CrossroadTrafficMonitoring::EvictIdleVehicleLocked() {
+  if (idleVehicles.empty())
+    return false;
+  --idleCount;
+  FreeVehicle(&idleVehicles.front());
+  return true;
+}
+
+// Count what was buffered in Error state, oldest first, as if it arrived
+// now. A signal that errors again (pool exhausted) is not buffered again.
+// Counted ones are queued for the watchlist (see CheckReplayedSignals).
+void CrossroadTrafficMonitoring::ReplayErrorBufferLocked() {
+  WatchlistAlerts *alerts = watchlistAlerts.load(std::memory_order_acquire);
+  for (; errorBufferSize > 0; --errorBufferSize) {
+    const BufferedSignal &signal = errorBuffer[errorBufferHead];
+    errorBufferHead = (errorBufferHead + 1) % errorBuffer.size();
+    ++errorBufferReplayed;
+    SignalOutcome outcome = SignalOutcome::Rejected;
+    if (!concurrentIndex) {
+      outcome =
+          ApplyVehicleSignalLocked(signal.category, signal.rawId, signal.camera);
+    } else {
+      std::string canonical;
+      const std::string *id = ResolveId(signal.rawId, canonical);
+      if (!id) {
+        ++rejectedPlates[signal.camera];
+      } else {
+        outcome = CountLockFree(signal.category, *id);
+        if (outcome == SignalOutcome::PoolExhausted) {
+          ++errorCount;
+          std::cerr << "[AllocationError] No space left for new vehicle.\n";
+        }
+      }
+    }
+    // the raw ID, as a live signal would pass it
+    if (alerts && (outcome == SignalOutcome::Counted ||
+                   outcome == SignalOutcome::NewVehicle)) {
+      replayedSignals.push_back({signal.category, signal.camera, signal.rawId});
+      replayedPending.store(true, std::memory_order_release);
+    }
+  }
+  errorBufferHead = 0;
+}
+
+// Replayed signals meet the watchlist like live ones, outside the lock.
+// Whichever thread released the lock after the reset checks them.
+void CrossroadTrafficMonitoring::CheckReplayedSignals() {
+  if (!replayedPending.load(std::memory_order_acquire))
+    return;
+  std::vector<ReplayedSignal> replayed;
+  {
+    std::lock_guard<PolicyMutex> lock(monitorMutex);
+    replayed.swap(replayedSignals);
+    replayedPending.store(false, std::memory_order_relaxed);
+  }
+  if (WatchlistAlerts *alerts =
+          watchlistAlerts.load(std::memory_order_acquire)) {
+    for (const ReplayedSignal &signal : replayed)
+      alerts->Check(signal.category, signal.id, signal.camera);
+  }
+}
+
+// Keep a vehicle signal received in Error state; false if the policy
+// dropped it.
+bool CrossroadTrafficMonitoring::BufferErrorSignalLocked(
+    VehicleCategory cat, const std::string &rawId, CameraId camera) {
+  const std::size_t capacity = errorBuffer.size();
+  if (errorBufferSize == capacity) {
+    ++errorBufferOverflows;
+    if (config.errorBufferPolicy == ErrorBufferPolicy::DropNewest)
+      return false;
+    errorBufferHead = (errorBufferHead + 1) % capacity; // drop the oldest
+    --errorBufferSize;
+  }
+  BufferedSignal &slot =
+      errorBuffer[(errorBufferHead + errorBufferSize) % capacity];
+  const std::size_t heapBefore = idHeapBytes(slot.rawId);
+  slot.category = cat;
+  slot.camera = camera;
+  slot.rawId = rawId;
+  errorBufferIdHeap += idHeapBytes(slot.rawId) - heapBefore;
+  ++errorBufferSize;
+  return true;
 }
 
 // OnSignal(ResetSignal)
 void CrossroadTrafficMonitoring::OnSignal(ResetSignal) {
-  std::lock_guard<std::mutex> lock(monitorMutex);
-  Reset();
+  {
+    std::lock_guard<PolicyMutex> lock(monitorMutex);
+    ResetLocked();
+  }
+  CheckReplayedSignals();
 }
 
 // OnSignal() => camera error
 void CrossroadTrafficMonitoring::OnSignal() {
-  // check for periodic reset first
-  std::lock_guard<std::mutex> lock(monitorMutex);
-  CheckAndHandlePeriodicReset();
+  {
+    // check for periodic reset first
+    std::lock_guard<PolicyMutex> lock(monitorMutex);
+    CheckAndHandlePeriodicResetLocked();
+    RecordTapLocked(SignalKind::Error, ApplyErrorSignalLocked(), 0, {});
+  }
+  CheckReplayedSignals();
+}
+
+// Camera error with monitorMutex held.
+SignalOutcome CrossroadTrafficMonitoring::ApplyErrorSignalLocked() {
   // If in Init or Stopped => ignore
   if (state == State::Init || state == State::Stopped) {
-    return;
+    return SignalOutcome::Ignored;
   }
 
   // If in Active => switch to Error state
   if (state == State::Active) {
     ++errorCount; // increment for first error signal
+    ++cameraErrors;
     state = State::Error;
-    return;
+    return SignalOutcome::Error;
   }
 
   // If in Error => increment error count and log
-  if (state == State::Error) {
-    ++errorCount;
-    std::cerr << "[CameraError]: Received empty signal while in Error state\n";
+  ++errorCount;
+  ++cameraErrors;
+  std::cerr << "[CameraError]: Received empty signal while in Error state\n";
+  return SignalOutcome::Error;
+}
+
+void CrossroadTrafficMonitoring::SetSignalTap(SignalTap *tap) {
+  std::lock_guard<PolicyMutex> lock(monitorMutex);
+  if (tap) {
+    // numbers of a previous tap mean nothing to this one
+    for (auto &number : tableSequences)
+      number.store(tap->Sequence(), std::memory_order_relaxed);
+  }
+  signalTap.store(tap, std::memory_order_release);
+}
+
+// Under the lock, so records of different threads sort in the order they
+// were applied (see SignalTraceRecord::sequence).
+std::uint32_t CrossroadTrafficMonitoring::RecordTapLocked(
+    SignalKind kind, SignalOutcome outcome, CameraId camera,
+    std::string_view id) {
+  if (SignalTap *tap = signalTap.load(std::memory_order_acquire))
+    return tap->Record(kind, outcome, camera, id);
+  return 0;
+}
+
+void CrossroadTrafficMonitoring::SetWatchlistAlerts(WatchlistAlerts *alerts) {
+  watchlistAlerts.store(alerts, std::memory_order_release);
+}
+
+bool CrossroadTrafficMonitoring::SetPresenceHistory(PresenceHistory *history) {
+  if (history && (!plateDictionary ||
+                  history->KeepWindows() > config.plateIndexPeriods))
+    return false;
+  presenceHistory.store(history, std::memory_order_release);
+  return true;
+}
+
+void CrossroadTrafficMonitoring::SetCrdtReplica(CrdtReplica *replica) {
+  std::lock_guard<PolicyMutex> lock(monitorMutex);
+  if (replica) {
+    replicaEpoch = std::max(replicaEpoch, WallClockPeriod(false));
+    replica->BeginEpoch(replicaEpoch);
+    for (auto &epoch : tableEpochs)
+      epoch.store(replicaEpoch, std::memory_order_relaxed);
   }
+  crdtReplica.store(replica, std::memory_order_release);
+}
+
+// Number of the wall-clock period now is in; rounded to the nearest
+// boundary at a reset, which happens at one.
+std::uint64_t CrossroadTrafficMonitoring::WallClockPeriod(bool rounded) const {
+  const auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::system_clock::now().time_since_epoch());
+  const auto length = std::max<std::int64_t>(period.count(), 1);
+  auto number = now.count() / length;
+  if (rounded && now.count() % length * 2 >= length)
+    ++number;
+  return static_cast<std::uint64_t>(number);
 }
 
 // Category deduction
@@ -222,46 +890,356 @@ static VehicleCategory deduceCategory(const Scooter &) {
   return VehicleCategory::Scooter;
 }
 
-// Declared as a friend of CrossroadTrafficMonitoring so it can access private
-// members without changing the core logic.
-template <typename T>
-void CrossroadTrafficMonitoring_OnSignal_Helper(
-    CrossroadTrafficMonitoring *self, const T &vehicle) {
-  self->CheckAndHandlePeriodicReset();
-
-  std::lock_guard<std::mutex> lock(self->monitorMutex);
-
-  if (self->GetCurrentState() == State::Init ||
-      self->GetCurrentState() == State::Stopped) {
-    return;
+// Vehicle signal with monitorMutex held: the state machine and counting.
+SignalOutcome CrossroadTrafficMonitoring::ApplyVehicleSignalLocked(
+    VehicleCategory cat, const std::string &rawId, CameraId camera) {
+  if (state == State::Init || state == State::Stopped) {
+    return SignalOutcome::Ignored;
   }
 
   // if in Error => increment errorCount, log, do not count the vehicle
-  if (self->GetCurrentState() == State::Error) {
-    ++(self->errorCount);
+  // (unless the error buffer keeps it for after the next reset)
+  if (state == State::Error) {
+    ++errorCount;
+    if (!errorBuffer.empty() && BufferErrorSignalLocked(cat, rawId, camera))
+      return SignalOutcome::Buffered;
     std::cerr << "Vehicle signal received in Error state. Not counted.\n";
-    return;
+    return SignalOutcome::Error;
   }
 
   // Otherwise (Active):
+  // canonicalize the plate first, so "ab-123" and "AB 123" share one entry
+  std::string canonical;
+  const std::string *id = ResolveId(rawId, canonical);
+  if (!id) {
+    ++rejectedPlates[camera];
+    return SignalOutcome::Rejected;
+  }
+
+  // registered fleet: a flat counter, no vehicle entry
+  if (knownCounts) {
+    const std::uint32_t known = config.knownPlates->Find(*id);
+    if (known != KnownPlates::npos) {
+      const SignalOutcome outcome = CountKnownPlate(known, cat);
+      RecordReplicaLocked(cat, *id);
+      return outcome;
+    }
+  }
+
   // find or create a vehicle
-  VehicleCategory cat = deduceCategory(vehicle);
-  Vehicle *existing = self->FindVehicle(cat, vehicle.id);
+  SignalOutcome outcome = SignalOutcome::Counted;
+  Vehicle *existing = FindVehicle(cat, *id);
+  const auto catIndex = static_cast<std::size_t>(cat);
   if (existing) {
-    existing->count += 1;
+    if (RetainsPlates())
+      MarkSeenLocked(existing);
+    // PerPlate: a known plate may still be new in this category
+    if (existing->counts[catIndex]++ == 0) {
+      ++uniqueVehicles[catIndex];
+      outcome = SignalOutcome::NewVehicle;
+    }
+    RaiseTopVehicleLocked(existing, catIndex);
   } else {
-    // allocate from free list
-    Vehicle *v = self->AllocateVehicle();
+    Vehicle *v = CreateVehicleLocked(cat, *id);
     if (!v) {
       // no more space, increment errorCount, go to error state
-      ++(self->errorCount);
+      ++errorCount;
       std::cerr << "[AllocationError] No space left for new vehicle.\n";
-      return;
+      return SignalOutcome::PoolExhausted;
+    }
+    v->counts[catIndex] = 1;
+    RaiseTopVehicleLocked(v, catIndex);
+    if (RetainsPlates())
+      MarkSeenLocked(v);
+    ++uniqueVehicles[catIndex];
+    outcome = SignalOutcome::NewVehicle;
+  }
+  ++sightings[catIndex];
+  ++acceptedSignals;
+  RecordReplicaLocked(cat, *id);
+  return outcome;
+}
+
+Vehicle *CrossroadTrafficMonitoring::CreateVehicleLocked(VehicleCategory cat,
+                                                         const std::string &id) {
+  // allocate from free list
+  Vehicle *v = AllocateVehicle(cat);
+  if (!v && RetainsPlates() && EvictIdleVehicleLocked())
+    v = AllocateVehicle(cat);
+  if (!v)
+    return nullptr;
+  v->category = cat;
+  // reset() keeps the old buffer, so only a grown buffer changes reserved
+  const std::size_t heapBefore = idHeapBytes(v->id);
+  v->id = id;
+  idHeapReserved += idHeapBytes(v->id) - heapBefore;
+  if (idHeapBytes(v->id) > 0)
+    idHeapLive += v->id.size() + 1;
+  if (plateDictionary)
+    v->plateIndex = plateDictionary->Acquire(v->id);
+  InsertVehicle(v);
+  return v;
+}
+
+// Under the lock, so the sighting lands in the epoch of the period that
+// counted it, replayed signals included.
+void CrossroadTrafficMonitoring::RecordReplicaLocked(VehicleCategory cat,
+                                                     const std::string &id) {
+  if (CrdtReplica *replica = crdtReplica.load(std::memory_order_acquire))
+    replica->Record(replicaEpoch, cat, id);
+}
+
+CrossroadTrafficMonitoring::IngestStripe &
+CrossroadTrafficMonitoring::StripeForThisThread() {
+  static std::atomic<std::size_t> nextStripe{0};
+  thread_local const std::size_t stripe =
+      nextStripe.fetch_add(1, std::memory_order_relaxed);
+  return ingestStripes[stripe % INGEST_STRIPES];
+}
+
+// Vehicle signal for IngestMode::LockFree. Only the Active-state path is
+// lock-free; everything rare goes through the lock. Nothing here takes the
+// lock while pinned, since Reset waits for pinned threads under the lock.
+SignalOutcome CrossroadTrafficMonitoring::ApplyVehicleSignalLockFree(
+    VehicleCategory cat, const std::string &rawId, CameraId camera) {
+  if (state != State::Stopped && !config.resetScheduler &&
+      std::chrono::steady_clock::now() >= nextResetTime.load()) {
+    std::lock_guard<PolicyMutex> lock(monitorMutex);
+    CheckAndHandlePeriodicResetLocked();
+  }
+  if (state != State::Active) {
+    std::lock_guard<PolicyMutex> lock(monitorMutex);
+    if (state != State::Active) {
+      const SignalOutcome outcome =
+          ApplyVehicleSignalLocked(cat, rawId, camera);
+      RecordTapLocked(ToSignalKind(cat), outcome, camera, rawId);
+      return outcome;
     }
+  }
+
+  std::string canonical;
+  const std::string *id = ResolveId(rawId, canonical);
+  if (!id) {
+    std::lock_guard<PolicyMutex> lock(monitorMutex);
+    ++rejectedPlates[camera];
+    RecordTapLocked(ToSignalKind(cat), SignalOutcome::Rejected, camera, rawId);
+    return SignalOutcome::Rejected;
+  }
+
+  // Not under the lock: the record carries the number of the period the
+  // signal was counted in instead.
+  SignalTap *tap = signalTap.load(std::memory_order_acquire);
+  std::uint32_t traceSequence = 0;
+  const SignalOutcome outcome =
+      CountLockFree(cat, *id, tap ? &traceSequence : nullptr);
+  if (tap)
+    tap->Record(ToSignalKind(cat), outcome, camera, rawId, traceSequence);
+  if (outcome != SignalOutcome::PoolExhausted)
+    return outcome;
+
+  // no more space, counted as an error like in the mutex path
+  std::lock_guard<PolicyMutex> lock(monitorMutex);
+  ++errorCount;
+  std::cerr << "[AllocationError] No space left for new vehicle.\n";
+  return SignalOutcome::PoolExhausted;
+}
+
+SignalOutcome
+CrossroadTrafficMonitoring::CountLockFree(VehicleCategory cat,
+                                          const std::string &id,
+                                          std::uint32_t *traceSequence) {
+  CrdtReplica *replica = crdtReplica.load(std::memory_order_acquire);
+  if (knownCounts) {
+    const std::uint32_t known = config.knownPlates->Find(id);
+    if (known != KnownPlates::npos) {
+      if (!replica && !traceSequence)
+        return CountKnownPlate(known, cat);
+      // pinned, so the reset waits for the count and the period's numbers
+      // to be read
+      auto pin = readerEpochs.Pin();
+      const SignalOutcome outcome = CountKnownPlate(known, cat);
+      const std::size_t table = concurrentIndex->ActiveTable();
+      if (replica)
+        replica->Record(tableEpochs[table].load(std::memory_order_relaxed),
+                        cat, id);
+      if (traceSequence)
+        *traceSequence =
+            tableSequences[table].load(std::memory_order_relaxed);
+      return outcome;
+    }
+  }
+  IngestStripe &stripe = StripeForThisThread();
+  const auto catIndex = static_cast<std::size_t>(cat);
+  auto pin = readerEpochs.Pin();
+  const auto entry = concurrentIndex->FindOrInsert(cat, id, [&](Vehicle *v) {
+    v->reset();
     v->category = cat;
-    v->id = vehicle.id;
-    v->count = 1;
-    self->InsertVehicle(v);
+    const std::size_t heapBefore = idHeapBytes(v->id);
+    v->id = id;
+    stripe.idHeapReserved.fetch_add(idHeapBytes(v->id) - heapBefore,
+                                    std::memory_order_relaxed);
+    if (plateDictionary)
+      v->plateIndex = plateDictionary->Acquire(v->id);
+  });
+  if (traceSequence)
+    *traceSequence =
+        tableSequences[entry.table].load(std::memory_order_relaxed);
+  if (!entry.vehicle)
+    return SignalOutcome::PoolExhausted;
+
+  SignalOutcome outcome = SignalOutcome::Counted;
+  if (entry.inserted) {
+    stripe.liveVehicles.fetch_add(1, std::memory_order_relaxed);
+    if (idHeapBytes(entry.vehicle->id) > 0)
+      stripe.idHeapLive.fetch_add(entry.vehicle->id.size() + 1,
+                                  std::memory_order_relaxed);
+  }
+  if (ConcurrentVehicleIndex::IncrementCount(*entry.vehicle, catIndex) == 0) {
+    stripe.uniqueVehicles[catIndex].fetch_add(1, std::memory_order_relaxed);
+    outcome = SignalOutcome::NewVehicle;
+  }
+  stripe.sightings[catIndex].fetch_add(1, std::memory_order_relaxed);
+  stripe.acceptedSignals.fetch_add(1, std::memory_order_relaxed);
+  if (replica) {
+    // still pinned: the period of the table counted in
+    replica->Record(tableEpochs[entry.table].load(std::memory_order_relaxed),
+                    cat, id);
+  }
+  return outcome;
+}
+
+// Known plate: lock held, or IngestMode::LockFree (atomic, striped totals).
+SignalOutcome CrossroadTrafficMonitoring::CountKnownPlate(std::uint32_t index,
+                                                          VehicleCategory cat) {
+  const auto catIndex = static_cast<std::size_t>(cat);
+  unsigned &count = knownCounts[index * kCategoryCount + catIndex];
+  bool first;
+  if (concurrentIndex) {
+    IngestStripe &stripe = StripeForThisThread();
+    first = std::atomic_ref<unsigned>(count).fetch_add(
+                1, std::memory_order_relaxed) == 0;
+    if (first)
+      stripe.uniqueVehicles[catIndex].fetch_add(1, std::memory_order_relaxed);
+    stripe.sightings[catIndex].fetch_add(1, std::memory_order_relaxed);
+    stripe.acceptedSignals.fetch_add(1, std::memory_order_relaxed);
+  } else {
+    first = count++ == 0;
+    if (first)
+      ++uniqueVehicles[catIndex];
+    ++sightings[catIndex];
+    ++acceptedSignals;
+  }
+  return first ? SignalOutcome::NewVehicle : SignalOutcome::Counted;
+}
+
+unsigned CrossroadTrafficMonitoring::LoadKnownCount(std::size_t slot) const {
+  if (concurrentIndex)
+    return std::atomic_ref<unsigned>(knownCounts[slot]).load(
+        std::memory_order_relaxed);
+  return knownCounts[slot];
+}
+
+namespace {
+enum CombiningState : std::uint8_t {
+  SlotFree,
+  SlotWriting, // claimed, request not published yet
+  SlotPending, // waiting for a combiner
+  SlotDone     // outcome filled in, the owner frees the slot
+};
+} // namespace
+
+// Vehicle signal for IngestMode::FlatCombining: publish the request, then
+// either get the lock and combine, or find it served by another combiner.
+SignalOutcome CrossroadTrafficMonitoring::ApplyVehicleSignalCombining(
+    VehicleCategory cat, const std::string &rawId, CameraId camera) {
+  // Slots are claimed per call (so threads coming and going never leak one),
+  // starting at a per-thread home slot so claims rarely collide.
+  thread_local const std::size_t home =
+      std::hash<std::thread::id>{}(std::this_thread::get_id());
+  CombiningSlot *slot = nullptr;
+  for (std::size_t i = 0; i < COMBINING_SLOTS && !slot; ++i) {
+    const std::size_t index = (home + i) % COMBINING_SLOTS;
+    std::uint8_t expected = SlotFree;
+    if (combiningSlots[index].state.compare_exchange_strong(
+            expected, SlotWriting, std::memory_order_acquire)) {
+      slot = &combiningSlots[index];
+      std::size_t used = combiningSlotsUsed.load(std::memory_order_relaxed);
+      while (used < index + 1 &&
+             !combiningSlotsUsed.compare_exchange_weak(used, index + 1)) {
+      }
+    }
+  }
+  if (!slot) {
+    // every slot busy: take the plain mutex path
+    std::lock_guard<PolicyMutex> lock(monitorMutex);
+    CheckAndHandlePeriodicResetLocked();
+    const SignalOutcome outcome = ApplyVehicleSignalLocked(cat, rawId, camera);
+    RecordTapLocked(ToSignalKind(cat), outcome, camera, rawId);
+    return outcome;
+  }
+
+  slot->category = cat;
+  slot->camera = camera;
+  slot->rawId = &rawId;
+  slot->state.store(SlotPending, std::memory_order_release);
+  while (slot->state.load(std::memory_order_acquire) != SlotDone) {
+    if (monitorMutex.try_lock()) {
+      CombineLocked();
+      monitorMutex.unlock();
+    } else {
+      std::this_thread::yield();
+    }
+  }
+  const SignalOutcome outcome = slot->outcome;
+  slot->state.store(SlotFree, std::memory_order_release);
+  return outcome;
+}
+
+// Apply every pending slot, with monitorMutex held. The periodic reset is
+// checked once per pass rather than once per signal.
+void CrossroadTrafficMonitoring::CombineLocked() {
+  CheckAndHandlePeriodicResetLocked();
+  const std::size_t used = combiningSlotsUsed.load(std::memory_order_acquire);
+  for (std::size_t i = 0; i < used; ++i) {
+    CombiningSlot &slot = combiningSlots[i];
+    if (slot.state.load(std::memory_order_acquire) != SlotPending)
+      continue;
+    slot.outcome =
+        ApplyVehicleSignalLocked(slot.category, *slot.rawId, slot.camera);
+    RecordTapLocked(ToSignalKind(slot.category), slot.outcome, slot.camera,
+                    *slot.rawId);
+    slot.state.store(SlotDone, std::memory_order_release);
+  }
+}
+
+// Declared as a friend of CrossroadTrafficMonitoring so it can access private
+// members without changing the core logic.
+template <typename T>
+void CrossroadTrafficMonitoring_OnSignal_Helper(
+    CrossroadTrafficMonitoring *self, const T &vehicle) {
+  const VehicleCategory cat = deduceCategory(vehicle);
+  SignalOutcome outcome;
+  if (self->concurrentIndex) {
+    outcome =
+        self->ApplyVehicleSignalLockFree(cat, vehicle.id, vehicle.camera);
+  } else if (self->combiningSlots) {
+    outcome =
+        self->ApplyVehicleSignalCombining(cat, vehicle.id, vehicle.camera);
+  } else {
+    std::lock_guard<PolicyMutex> lock(self->monitorMutex);
+    self->CheckAndHandlePeriodicResetLocked();
+    outcome = self->ApplyVehicleSignalLocked(cat, vehicle.id, vehicle.camera);
+    self->RecordTapLocked(ToSignalKind(cat), outcome, vehicle.camera,
+                          vehicle.id);
+  }
+  // a periodic reset on the way may have replayed buffered signals
+  self->CheckReplayedSignals();
+  if (outcome == SignalOutcome::Counted ||
+      outcome == SignalOutcome::NewVehicle) {
+    if (WatchlistAlerts *alerts =
+            self->watchlistAlerts.load(std::memory_order_acquire)) {
+      alerts->Check(cat, vehicle.id, vehicle.camera);
+    }
   }
 }
 
@@ -278,35 +1256,160 @@ void CrossroadTrafficMonitoring::OnSignal(const Scooter &s) {
 
 // Getters
 unsigned CrossroadTrafficMonitoring::GetErrorCount() const {
-  std::lock_guard<std::mutex> lock(monitorMutex);
+  std::lock_guard<PolicyMutex> lock(monitorMutex);
   return errorCount;
 }
 
+unsigned
+CrossroadTrafficMonitoring::GetRejectedPlateCount(CameraId camera) const {
+  std::lock_guard<PolicyMutex> lock(monitorMutex);
+  return rejectedPlates[camera];
+}
+
+unsigned CrossroadTrafficMonitoring::GetRejectedPlateCount() const {
+  std::lock_guard<PolicyMutex> lock(monitorMutex);
+  return std::accumulate(rejectedPlates.begin(), rejectedPlates.end(), 0u);
+}
+
+// "ID - Category (count)"
+static std::string formatLine(const Vehicle &v, VehicleCategory cat) {
+  return v.id + " - " + ToString(cat) + " (" +
+         std::to_string(v.counts[static_cast<std::size_t>(cat)]) + ")";
+}
+
+// Copy the lock-free index while pinned; the ordering the lists keep in the
+// mutex modes is done here at query time instead.
+// Category range of a snapshot: [only, only + 1), or all of them.
+static std::pair<std::size_t, std::size_t> snapshotCategories(std::size_t only) {
+  if (only < kCategoryCount)
+    return {only, only + 1};
+  return {0, kCategoryCount};
+}
+
+std::vector<VehicleStats>
+CrossroadTrafficMonitoring::SnapshotConcurrentIndex(std::size_t only) const {
+  const auto [first, last] = snapshotCategories(only);
+  std::vector<VehicleStats> snapshot;
+  {
+    auto pin = readerEpochs.Pin();
+    concurrentIndex->ForEach([&](const Vehicle &v) {
+      for (std::size_t c = first; c < last; ++c) {
+        if (const unsigned count = ConcurrentVehicleIndex::LoadCount(v, c))
+          snapshot.push_back(
+              VehicleStats{v.id, static_cast<VehicleCategory>(c), count});
+      }
+    });
+  }
+  std::sort(snapshot.begin(), snapshot.end(),
+            [](const VehicleStats &a, const VehicleStats &b) {
+              return a.id != b.id ? a.id < b.id : a.category < b.category;
+            });
+  return snapshot;
+}
+
+// Known plates with a count, alphabetical by construction of the dictionary.
+std::vector<VehicleStats>
+CrossroadTrafficMonitoring::SnapshotKnownPlates(std::size_t only) const {
+  const auto [first, last] = snapshotCategories(only);
+  const KnownPlates &known = *config.knownPlates;
+  std::vector<VehicleStats> snapshot;
+  for (std::uint32_t index : known.Alphabetical()) {
+    for (std::size_t c = first; c < last; ++c) {
+      if (const unsigned count = LoadKnownCount(index * kCategoryCount + c))
+        snapshot.push_back(VehicleStats{std::string(known.Plate(index)),
+                                        static_cast<VehicleCategory>(c),
+                                        count});
+    }
+  }
+  return snapshot;
+}
+
+// A plate is either known or in the vehicle store, never both, so the two
+// sorted sequences merge by ID alone.
+std::vector<VehicleStats>
+CrossroadTrafficMonitoring::SnapshotWithKnownPlates(std::size_t only) const {
+  const auto [first, last] = snapshotCategories(only);
+  std::vector<VehicleStats> general;
+  if (concurrentIndex) {
+    general = SnapshotConcurrentIndex(only);
+  } else {
+    for (const auto &x : alphabeticalList) {
+      for (std::size_t c = first; c < last; ++c) {
+        if (x.counts[c] > 0)
+          general.push_back(
+              VehicleStats{x.id, static_cast<VehicleCategory>(c), x.counts[c]});
+      }
+    }
+  }
+  const std::vector<VehicleStats> known = SnapshotKnownPlates(only);
+  std::vector<VehicleStats> merged;
+  merged.reserve(general.size() + known.size());
+  std::merge(general.begin(), general.end(), known.begin(), known.end(),
+             std::back_inserter(merged),
+             [](const VehicleStats &a, const VehicleStats &b) {
+               return a.id < b.id;
+             });
+  return merged;
+}
+
+bool CrossroadTrafficMonitoring::FindKnownCount(const std::string &id,
+                                                VehicleCount &count) const {
+  if (!knownCounts)
+    return false;
+  const std::uint32_t index = config.knownPlates->Find(id);
+  if (index == KnownPlates::npos)
+    return false;
+  for (std::size_t c = 0; c < kCategoryCount; ++c)
+    count.perCategory[c] = LoadKnownCount(index * kCategoryCount + c);
+  return true;
+}
+
+static std::string formatLine(const VehicleStats &s) {
+  return s.id + " - " + ToString(s.category) + " (" +
+         std::to_string(s.count) + ")";
+}
+
 std::vector<std::string>
 CrossroadTrafficMonitoring::GetStatistics(VehicleCategory cat) const {
-  std::lock_guard<std::mutex> lock(monitorMutex);
   std::vector<std::string> result;
+  const auto catIndex = static_cast<std::size_t>(cat);
+  if (knownCounts) {
+    std::unique_lock<PolicyMutex> lock(monitorMutex, std::defer_lock);
+    if (!concurrentIndex)
+      lock.lock();
+    for (const auto &s : SnapshotWithKnownPlates(catIndex))
+      result.push_back(formatLine(s));
+    return result;
+  }
+  if (concurrentIndex) {
+    for (const auto &s : SnapshotConcurrentIndex(catIndex))
+      result.push_back(formatLine(s));
+    return result;
+  }
+  std::lock_guard<PolicyMutex> lock(monitorMutex);
+  if (config.layout == StorageLayout::PerPlate) {
+    for (auto &x : alphabeticalList) {
+      if (x.counts[static_cast<std::size_t>(cat)] > 0)
+        result.push_back(formatLine(x, cat));
+    }
+    return result;
+  }
+  // Retained entries not seen in this period stay listed with a zero count.
+  auto appendCounted = [&](const CategoryList &list) {
+    for (auto &x : list) {
+      if (x.counts[static_cast<std::size_t>(cat)] > 0)
+        result.push_back(formatLine(x, cat));
+    }
+  };
   switch (cat) {
   case VehicleCategory::Bicycle:
-    for (auto &x : bicycleList) {
-      std::string line = x.id + " - " + ToString(x.category) + " (" +
-                         std::to_string(x.count) + ")";
-      result.push_back(line);
-    }
+    appendCounted(bicycleList);
     break;
   case VehicleCategory::Car:
-    for (auto &x : carList) {
-      std::string line = x.id + " - " + ToString(x.category) + " (" +
-                         std::to_string(x.count) + ")";
-      result.push_back(line);
-    }
+    appendCounted(carList);
     break;
   case VehicleCategory::Scooter:
-    for (auto &x : scooterList) {
-      std::string line = x.id + " - " + ToString(x.category) + " (" +
-                         std::to_string(x.count) + ")";
-      result.push_back(line);
-    }
+    appendCounted(scooterList);
     break;
   }
   return result;
@@ -314,12 +1417,365 @@ CrossroadTrafficMonitoring::GetStatistics(VehicleCategory cat) const {
 
 // GetStatistics() => alphabetical
 std::vector<std::string> CrossroadTrafficMonitoring::GetStatistics() const {
-  std::lock_guard<std::mutex> lock(monitorMutex);
   std::vector<std::string> result;
+  if (knownCounts) {
+    std::unique_lock<PolicyMutex> lock(monitorMutex, std::defer_lock);
+    if (!concurrentIndex)
+      lock.lock();
+    for (const auto &s : SnapshotWithKnownPlates())
+      result.push_back(formatLine(s));
+    return result;
+  }
+  if (concurrentIndex) {
+    for (const auto &s : SnapshotConcurrentIndex())
+      result.push_back(formatLine(s));
+    return result;
+  }
+  std::lock_guard<PolicyMutex> lock(monitorMutex);
   for (auto &x : alphabeticalList) {
-    std::string line = x.id + " - " + ToString(x.category) + " (" +
-                       std::to_string(x.count) + ")";
-    result.push_back(line);
+    // one line per category the entry was counted in, in category order
+    for (std::size_t c = 0; c < kCategoryCount; ++c) {
+      if (x.counts[c] > 0)
+        result.push_back(formatLine(x, static_cast<VehicleCategory>(c)));
+    }
+  }
+  return result;
+}
+
+std::vector<VehicleStats> CrossroadTrafficMonitoring::ExportVehicles() const {
+  std::unique_lock<PolicyMutex> lock(monitorMutex, std::defer_lock);
+  if (!concurrentIndex)
+    lock.lock();
+  if (knownCounts)
+    return SnapshotWithKnownPlates();
+  if (concurrentIndex)
+    return SnapshotConcurrentIndex();
+  std::vector<VehicleStats> vehicles;
+  for (const auto &x : alphabeticalList) {
+    for (std::size_t c = 0; c < kCategoryCount; ++c) {
+      if (x.counts[c] > 0)
+        vehicles.push_back(
+            VehicleStats{x.id, static_cast<VehicleCategory>(c), x.counts[c]});
+    }
+  }
+  return vehicles;
+}
+
+bool CrossroadTrafficMonitoring::ImportVehicles(
+    const std::vector<VehicleStats> &vehicles) {
+  if (concurrentIndex)
+    return false;
+  std::lock_guard<PolicyMutex> lock(monitorMutex);
+  for (const VehicleStats &s : vehicles) {
+    if (s.count == 0)
+      continue;
+    const auto catIndex = static_cast<std::size_t>(s.category);
+    unsigned *count = nullptr;
+    Vehicle *v = nullptr;
+    if (knownCounts) {
+      const std::uint32_t known = config.knownPlates->Find(s.id);
+      if (known != KnownPlates::npos)
+        count = &knownCounts[known * kCategoryCount + catIndex];
+    }
+    if (!count) {
+      v = FindVehicle(s.category, s.id);
+      if (!v)
+        v = CreateVehicleLocked(s.category, s.id);
+      if (!v)
+        return false;
+      if (RetainsPlates())
+        MarkSeenLocked(v);
+      count = &v->counts[catIndex];
+    }
+    if (*count == 0)
+      ++uniqueVehicles[catIndex];
+    *count += s.count;
+    sightings[catIndex] += s.count;
+    if (v)
+      RaiseTopVehicleLocked(v, catIndex);
+  }
+  return true;
+}
+
+bool CrossroadTrafficMonitoring::EraseVehicles(
+    const std::vector<std::string> &ids) {
+  if (concurrentIndex)
+    return false;
+  std::lock_guard<PolicyMutex> lock(monitorMutex);
+  auto uncount = [this](unsigned &count, std::size_t c) {
+    if (count == 0)
+      return;
+    --uniqueVehicles[c];
+    sightings[c] -= count;
+    count = 0;
+  };
+  // A full board may have pushed out pairs that rank next once the erased
+  // ones leave it.
+  const bool boardFull = topCount == TOP_TRACKED;
+  bool leftBoard = false;
+  for (const std::string &id : ids) {
+    if (knownCounts) {
+      const std::uint32_t known = config.knownPlates->Find(id);
+      if (known != KnownPlates::npos) {
+        for (std::size_t c = 0; c < kCategoryCount; ++c)
+          uncount(knownCounts[known * kCategoryCount + c], c);
+        continue;
+      }
+    }
+    // PerPlate finds its one entry on the first pass
+    for (std::size_t c = 0; c < kCategoryCount; ++c) {
+      Vehicle *v = FindVehicle(static_cast<VehicleCategory>(c), id);
+      if (!v)
+        continue;
+      for (std::size_t k = 0; k < kCategoryCount; ++k)
+        uncount(v->counts[k], k);
+      // retained and not seen in this period
+      if (v->age_hook.is_linked() && v->lastPeriod != periodNumber)
+        --idleCount;
+      leftBoard = leftBoard || v->topMask != 0;
+      FreeVehicle(v);
+    }
+  }
+  if (boardFull && leftBoard) {
+    for (std::size_t i = 0; i < topCount; ++i)
+      topVehicles[i].vehicle->topMask = 0;
+    topCount = 0;
+    for (auto &x : alphabeticalList) {
+      for (std::size_t c = 0; c < kCategoryCount; ++c) {
+        if (x.counts[c] > 0)
+          RaiseTopVehicleLocked(&x, c);
+      }
+    }
+  }
+  return true;
+}
+
+MonitorTotals CrossroadTrafficMonitoring::GetTotals() const {
+  std::lock_guard<PolicyMutex> lock(monitorMutex);
+  MonitorTotals totals;
+  totals.state = state;
+  totals.errorCount = errorCount;
+  totals.cameraErrors = cameraErrors;
+  totals.uniqueVehicles = uniqueVehicles;
+  totals.sightings = sightings;
+  totals.acceptedSignals = acceptedSignals;
+  totals.poolInUse = liveVehicles;
+  totals.poolIdle = idleCount;
+  totals.poolCapacity = MAX_VEHICLES;
+  if (ingestStripes) {
+    for (std::size_t i = 0; i < INGEST_STRIPES; ++i) {
+      const IngestStripe &stripe = ingestStripes[i];
+      for (std::size_t c = 0; c < kCategoryCount; ++c) {
+        totals.uniqueVehicles[c] += stripe.uniqueVehicles[c].load();
+        totals.sightings[c] += stripe.sightings[c].load();
+      }
+      totals.acceptedSignals += stripe.acceptedSignals.load();
+      totals.poolInUse += stripe.liveVehicles.load();
+    }
+  }
+  return totals;
+}
+
+MemoryUsage CrossroadTrafficMonitoring::GetMemoryUsage() const {
+  std::lock_guard<PolicyMutex> lock(monitorMutex);
+  MemoryUsage usage;
+  usage.instanceBytes = sizeof(*this);
+  usage.poolReservedBytes = sizeof(vehiclePool);
+  usage.poolLiveBytes = liveVehicles * sizeof(Vehicle);
+  for (std::size_t c = 0; c < kCategoryCount && !concurrentIndex; ++c) {
+    const std::size_t last = highestSlot(liveSlots[c], 0, MAX_VEHICLES);
+    if (last < MAX_VEHICLES)
+      usage.poolSpanBytes =
+          std::max(usage.poolSpanBytes, (last + 1) * sizeof(Vehicle));
+  }
+  usage.indexBytes = sizeof(indexBuckets);
+  usage.idHeapReservedBytes = idHeapReserved;
+  usage.idHeapLiveBytes = idHeapLive;
+  usage.poolRetiredBytes = retiredVehicles.Size() * sizeof(Vehicle);
+  usage.errorBufferBytes =
+      errorBuffer.capacity() * sizeof(BufferedSignal) + errorBufferIdHeap;
+  if (knownCounts) {
+    usage.knownPlatesBytes =
+        config.knownPlates->Size() * kCategoryCount * sizeof(unsigned) +
+        config.knownPlates->MemoryBytes();
+  }
+  if (plateDictionary)
+    usage.plateIndexBytes = plateDictionary->MemoryBytes();
+  if (concurrentIndex) {
+    std::size_t live = liveVehicles;
+    for (std::size_t i = 0; i < INGEST_STRIPES; ++i) {
+      live += ingestStripes[i].liveVehicles.load();
+      usage.idHeapReservedBytes += ingestStripes[i].idHeapReserved.load();
+      usage.idHeapLiveBytes += ingestStripes[i].idHeapLive.load();
+    }
+    usage.poolLiveBytes = live * sizeof(Vehicle);
+    usage.heapIndexBytes = concurrentIndex->MemoryBytes() +
+                           INGEST_STRIPES * sizeof(IngestStripe);
+  }
+  return usage;
+}
+
+ErrorBufferStats CrossroadTrafficMonitoring::GetErrorBufferStats() const {
+  std::lock_guard<PolicyMutex> lock(monitorMutex);
+  ErrorBufferStats stats;
+  stats.capacity = errorBuffer.size();
+  stats.buffered = errorBufferSize;
+  stats.overflowed = errorBufferOverflows;
+  stats.replayed = errorBufferReplayed;
+  return stats;
+}
+
+VehicleCount
+CrossroadTrafficMonitoring::GetVehicleCount(const std::string &id) const {
+  std::string canonical;
+  VehicleCount result;
+  if (concurrentIndex) {
+    const std::string *key = ResolveId(id, canonical);
+    if (!key || FindKnownCount(*key, result))
+      return result;
+    auto pin = readerEpochs.Pin();
+    for (std::size_t c = 0; c < kCategoryCount; ++c) {
+      const auto cat = static_cast<VehicleCategory>(c);
+      if (const Vehicle *v = concurrentIndex->Find(cat, *key))
+        result.perCategory[c] = ConcurrentVehicleIndex::LoadCount(*v, c);
+    }
+    return result;
+  }
+  std::lock_guard<PolicyMutex> lock(monitorMutex);
+  const std::string *key = ResolveId(id, canonical);
+  if (!key || FindKnownCount(*key, result))
+    return result;
+  if (config.layout == StorageLayout::PerPlate) {
+    if (const Vehicle *v = FindVehicle(VehicleCategory::Bicycle, *key))
+      result.perCategory = v->counts;
+    return result;
+  }
+  for (std::size_t c = 0; c < kCategoryCount; ++c) {
+    if (const Vehicle *v = FindVehicle(static_cast<VehicleCategory>(c), *key))
+      result.perCategory[c] = v->counts[c];
+  }
+  return result;
+}
+
+unsigned CrossroadTrafficMonitoring::GetVehicleCount(
+    VehicleCategory cat, const std::string &id) const {
+  std::string canonical;
+  VehicleCount known;
+  const auto catIndex = static_cast<std::size_t>(cat);
+  if (concurrentIndex) {
+    const std::string *key = ResolveId(id, canonical);
+    if (!key)
+      return 0;
+    if (FindKnownCount(*key, known))
+      return known.perCategory[catIndex];
+    auto pin = readerEpochs.Pin();
+    const Vehicle *v = concurrentIndex->Find(cat, *key);
+    return v ? ConcurrentVehicleIndex::LoadCount(
+                   *v, static_cast<std::size_t>(cat))
+             : 0;
+  }
+  std::lock_guard<PolicyMutex> lock(monitorMutex);
+  const std::string *key = ResolveId(id, canonical);
+  if (key && FindKnownCount(*key, known))
+    return known.perCategory[catIndex];
+  const Vehicle *v = key ? FindVehicle(cat, *key) : nullptr;
+  return v ? v->counts[catIndex] : 0;
+}
+
+std::uint32_t
+CrossroadTrafficMonitoring::GetPlateIndex(const std::string &id) const {
+  if (!plateDictionary)
+    return PlateDictionary::npos;
+  std::string canonical;
+  const std::string *key = ResolveId(id, canonical);
+  if (!key)
+    return PlateDictionary::npos;
+  if (knownCounts) {
+    const std::uint32_t known = config.knownPlates->Find(*key);
+    if (known != KnownPlates::npos)
+      return known;
+  }
+  return plateDictionary->Find(*key);
+}
+
+std::string
+CrossroadTrafficMonitoring::GetIndexedPlate(std::uint32_t index) const {
+  if (!plateDictionary)
+    return {};
+  if (config.knownPlates && index < config.knownPlates->Size())
+    return std::string(config.knownPlates->Plate(index));
+  return plateDictionary->Plate(index);
+}
+
+std::vector<std::string>
+CrossroadTrafficMonitoring::GetIndexedPlates(const PresenceBitmap &bitmap) const {
+  std::vector<std::string> plates;
+  for (std::uint32_t index : bitmap.ToVector()) {
+    std::string plate = GetIndexedPlate(index);
+    if (!plate.empty())
+      plates.push_back(std::move(plate));
+  }
+  std::sort(plates.begin(), plates.end());
+  return plates;
+}
+
+std::vector<VehicleStats>
+CrossroadTrafficMonitoring::GetTopVehicles(std::size_t n) const {
+  auto byRank = [](const VehicleStats &a, const VehicleStats &b) {
+    return ranksBefore(a.count, a.id, static_cast<std::size_t>(a.category),
+                       b.count, b.id, static_cast<std::size_t>(b.category));
+  };
+  if (concurrentIndex || knownCounts) {
+    std::unique_lock<PolicyMutex> lock(monitorMutex, std::defer_lock);
+    if (!concurrentIndex)
+      lock.lock();
+    std::vector<VehicleStats> all = knownCounts ? SnapshotWithKnownPlates()
+                                                : SnapshotConcurrentIndex();
+    const std::size_t keep = std::min(n, all.size());
+    std::partial_sort(all.begin(), all.begin() + keep, all.end(), byRank);
+    all.resize(keep);
+    return all;
+  }
+  std::vector<VehicleStats> result;
+  std::lock_guard<PolicyMutex> lock(monitorMutex);
+  if (n <= TOP_TRACKED) {
+    // the running board: no walk over the table
+    const std::size_t keep = std::min(n, topCount);
+    result.reserve(keep);
+    for (std::size_t i = 0; i < keep; ++i) {
+      const TopEntry &e = topVehicles[i];
+      result.push_back(VehicleStats{e.vehicle->id,
+                                    static_cast<VehicleCategory>(e.category),
+                                    e.vehicle->counts[e.category]});
+    }
+    return result;
+  }
+  // Longer lists walk the table keeping only the best `n` entries (as
+  // pointers), so nothing is copied or formatted for the rest of it.
+  using Entry = std::pair<const Vehicle *, std::size_t>; // vehicle, category
+  auto countOf = [](const Entry &e) { return e.first->counts[e.second]; };
+  auto better = [&](const Entry &a, const Entry &b) {
+    return ranksBefore(countOf(a), a.first->id, a.second, countOf(b),
+                       b.first->id, b.second);
+  };
+  std::vector<Entry> top;
+  top.reserve(n + 1);
+  for (auto &x : alphabeticalList) {
+    for (std::size_t c = 0; c < kCategoryCount; ++c) {
+      const Entry e{&x, c};
+      if (countOf(e) == 0 || (top.size() == n && !better(e, top.back())))
+        continue;
+      top.insert(std::upper_bound(top.begin(), top.end(), e, better), e);
+      if (top.size() > n)
+        top.pop_back();
+    }
+  }
+
+  result.reserve(top.size());
+  for (const Entry &e : top) {
+    result.push_back(VehicleStats{e.first->id,
+                                  static_cast<VehicleCategory>(e.second),
+                                  countOf(e)});
   }
   return result;
 }
@@ -2,18 +2,28 @@
 #define CROSSROAD_TRAFFIC_MONITORING_HPP
 
 #include <algorithm>
+#include "AdaptiveMutex.hpp"
+#include "EpochReclamation.hpp"
 #include <boost/intrusive/list.hpp>
+#include <boost/intrusive/unordered_set.hpp>
+#include <array>
+#include <atomic>
 #include <chrono>
 #include <cstddef>
+#include <cstdint>
 #include <iostream>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 namespace ctm // ctm == CrossRoad Traffic Monitoring
 {
 // Vehicle Category enumeration
 enum class VehicleCategory { Bicycle, Car, Scooter };
+static constexpr std::size_t kCategoryCount = 3;
 
 inline const char *ToString(VehicleCategory cat) {
   switch (cat) {
@@ -29,30 +39,158 @@ inline const char *ToString(VehicleCategory cat) {
 
 struct ResetSignal {};
 
+// Identifies the camera that produced a signal (0 when unknown).
+using CameraId = std::uint8_t;
+
 /*
 Lightweight wrappers to signal OnSignal
 */
 struct Bicycle {
   std::string id;
-  explicit Bicycle(std::string id) : id(std::move(id)) {}
+  CameraId camera{0};
+  explicit Bicycle(std::string id, CameraId camera = 0)
+      : id(std::move(id)), camera(camera) {}
 };
 
 struct Car {
   std::string id;
-  explicit Car(std::string id) : id(std::move(id)) {}
+  CameraId camera{0};
+  explicit Car(std::string id, CameraId camera = 0)
+      : id(std::move(id)), camera(camera) {}
 };
 
 struct Scooter {
   std::string id;
-  explicit Scooter(std::string id) : id(std::move(id)) {}
+  CameraId camera{0};
+  explicit Scooter(std::string id, CameraId camera = 0)
+      : id(std::move(id)), camera(camera) {}
+};
+
+// How vehicles are stored, see MonitorConfig::layout.
+enum class StorageLayout {
+  PerCategory, // one Vehicle per (ID, category)
+  PerPlate     // one Vehicle per ID, with a counter per category
+};
+
+// How vehicle signals reach the store, see MonitorConfig::ingest.
+enum class IngestMode {
+  Mutex,        // every signal takes monitorMutex
+  LockFree,     // signals in Active state never take monitorMutex
+  FlatCombining // signals are queued in slots, the lock holder applies them
+};
+
+class KnownPlates;
+class PlateDictionary;
+class ResetScheduler;
+
+// What a full error buffer (see MonitorConfig::errorBufferCapacity) gives up.
+enum class ErrorBufferPolicy {
+  DropNewest, // keep what is buffered, lose the incoming signal
+  DropOldest  // overwrite the oldest buffered signal
+};
+
+// Optional behaviour of a monitor. Everything is off by default, so a
+// default-constructed config keeps the behaviour described in the README.
+struct MonitorConfig {
+  // Canonicalize plates at ingest ("ab-123", "AB 123" -> "AB123") and reject
+  // malformed ones, see PlateCanonicalizer.hpp.
+  bool canonicalizePlates{false};
+
+  // PerPlate stores a plate seen in several categories once (one ID copy,
+  // one alphabetical node, one lookup) instead of once per category. Both
+  // layouts produce the same statistics lines and the same alphabetical
+  // order; per-category statistics are alphabetical in PerPlate layout.
+  StorageLayout layout{StorageLayout::PerCategory};
+
+  // LockFree lets camera threads insert vehicles and count sightings
+  // concurrently through a lock-free hash index (ConcurrentVehicleIndex.hpp).
+  // State changes, errors and rejected plates still take the lock. Queries
+  // are lock-free as well; statistics are alphabetical for every category,
+  // and one ID's categories come in category order (as with PerPlate).
+  // Totals are exact once ingestion is quiet, but signals that race with a
+  // Reset may be missing from (or left over in) the period totals.
+  //
+  // FlatCombining keeps the mutex store but batches the writer path: each
+  // signal is published in a per-thread slot, and whichever thread gets the
+  // lock applies all pending slots in one pass. Results are the same as with
+  // Mutex, with fewer lock handoffs under contention.
+  IngestMode ingest{IngestMode::Mutex};
+
+  // Lock behind monitorMutex. SpinThenPark (AdaptiveMutex.hpp) spins briefly
+  // before parking, which suits the tens-of-nanoseconds critical section of
+  // a repeat sighting better than parking right away.
+  LockPolicy lockPolicy{LockPolicy::StdMutex};
+
+  // Vehicle signals received in Error state are counted as errors and
+  // otherwise lost. With a capacity > 0 they are also kept in a ring of that
+  // many signals and counted once the next reset (manual, ResetSignal or
+  // periodic) makes the monitor Active again, so a short camera glitch
+  // loses no traffic. The policy decides which signal a full ring drops.
+  std::size_t errorBufferCapacity{0};
+  ErrorBufferPolicy errorBufferPolicy{ErrorBufferPolicy::DropNewest};
+
+  // Registered fleet (KnownPlates.hpp), built with the same canonicalization
+  // as canonicalizePlates (the constructor throws std::invalid_argument
+  // otherwise, the list would never match). Listed plates are counted in a
+  // flat counter array by their perfect-hash index, outside the vehicle
+  // pool; other plates go to the general index as usual. Statistics include
+  // both; per-category statistics are then alphabetical in every layout.
+  // May be shared.
+  std::shared_ptr<const KnownPlates> knownPlates;
+
+  // Keep plates across resets (Mutex and FlatCombining ingest). A reset then
+  // only zeroes the counters of the plates seen in the period it closes:
+  // each keeps its pool entry, its ID and its place in the hash index and
+  // the alphabetical list, so a recurring plate costs a lookup instead of an
+  // insert. A plate not seen for this many periods is freed at a reset, and
+  // a full pool frees the plate idle longest before giving up. 0 frees
+  // every vehicle at each reset. Ignored in LockFree mode. Pays off for
+  // recurring traffic; with mostly one-off plates the idle entries make the
+  // alphabetical list, and so each insert, longer.
+  unsigned plateRetentionPeriods{0};
+
+  // Periodic resets fired by a shared ResetScheduler (ResetScheduler.hpp)
+  // instead of a clock read on every signal. The monitor registers its
+  // period at construction and unregisters in its destructor. Resets then
+  // follow the scheduler's cadence (aligned and spread as configured there):
+  // a manual reset does not move the next periodic one, and monitors in
+  // Init or Stopped state are skipped. Not owned, must outlive the monitor.
+  ResetScheduler *resetScheduler{nullptr};
+
+  // Per-category pool regions (Mutex and FlatCombining ingest): each
+  // category allocates from its own contiguous part of the vehicle pool, so
+  // a scan of one category (GetStatistics(cat), snapshots, exports) sweeps
+  // neighbouring entries instead of the whole pool. Weights, e.g. {1, 6, 1}
+  // gives cars 6/8 of the pool; all zero keeps one shared pool. The total
+  // capacity stays MAX_VEHICLES: a full region borrows a free entry from
+  // another one, and CompactStep() moves borrowed entries home once there is
+  // room. With adaptivePoolSplit every reset moves the split halfway towards
+  // the share of new vehicles per category in the period it closes (the
+  // weights, or an even split, give the starting point). PerPlate entries
+  // live in the region of the category they were first seen in.
+  std::array<unsigned, kCategoryCount> poolSplit{};
+  bool adaptivePoolSplit{false};
+
+  // Give every counted plate a stable dense index (GetPlateIndex(), see
+  // PlateDictionary.hpp) that survives resets and pool moves, for
+  // per-period stores such as PresenceHistory. A plate keeps its index while
+  // it is seen at least once every this many periods; after that the index
+  // may go to another plate, so consumers keep at most this many closed
+  // periods. Known plates use their KnownPlates index, the others are
+  // numbered after them. 0 keeps no index.
+  std::uint32_t plateIndexPeriods{0};
 };
 
 //-----------------------------------------------------------
 // Represents a single vehicle stored in Boost.Intrusive lists.
 // Contains:
-//    - ID, category, and appearance count
-//    - category_hook: for category-specific list
+//    - ID, category, and appearance counts per category. With the
+//      PerCategory layout only counts[category] is used; with PerPlate
+//      the entry stands for the plate in every category.
+//    - category_hook: for category-specific list (PerCategory only)
 //    - alphabetical_hook: for alphabetical list
+//    - index_hook: for the hash index used by lookups
+//    - age_hook: for the seen / idle lists of plate retention
 //-----------------------------------------------------------
 class Vehicle {
 public:
@@ -60,9 +198,13 @@ public:
 
   VehicleCategory category;
   std::string id;
-  unsigned count{0};
+  std::array<unsigned, kCategoryCount> counts{};
 
-  Vehicle *nextFree{nullptr}; // for free list
+  Vehicle *nextFree{nullptr}; // for the retired list
+  std::uint64_t retiredAt{0}; // epoch of FreeVehicle, see EpochManager
+  std::uint32_t lastPeriod{0}; // last period seen in, for plate retention
+  std::uint8_t topMask{0};     // categories on the top-vehicles board
+  std::uint32_t plateIndex{UINT32_MAX}; // MonitorConfig::plateIndexPeriods
 
   // Intrusive hooks: one for category list, one for alphabetical list.
   // Use list_member_hook to store the hooks inside the object.
@@ -72,13 +214,26 @@ public:
 
   Hook category_hook;
   Hook alphabetical_hook;
+  Hook age_hook;
+
+  // Hash index hook, keyed by ID (and category for PerCategory layout).
+  typedef boost::intrusive::unordered_set_member_hook<
+      boost::intrusive::link_mode<boost::intrusive::auto_unlink>,
+      boost::intrusive::store_hash<true>>
+      IndexHook;
+
+  IndexHook index_hook;
 
   // For convenience in resetting this object
   void reset() {
     category = VehicleCategory::Bicycle;
     id.clear();
-    count = 0;
+    counts.fill(0);
     nextFree = nullptr;
+    retiredAt = 0;
+    lastPeriod = 0;
+    topMask = 0;
+    plateIndex = UINT32_MAX;
   }
 };
 
@@ -90,6 +245,126 @@ enum class State {
   Stopped // Inactive, signals are ignored.
 };
 
+inline const char *ToString(State state) {
+  switch (state) {
+  case State::Init:
+    return "Init";
+  case State::Active:
+    return "Active";
+  case State::Error:
+    return "Error";
+  case State::Stopped:
+    return "Stopped";
+  }
+  return "Unknown";
+}
+
+// One vehicle entry, without any formatting.
+struct VehicleStats {
+  std::string id;
+  VehicleCategory category{VehicleCategory::Bicycle};
+  unsigned count{0};
+};
+
+// Running totals of a monitor, maintained on every signal so reading them is
+// O(1) regardless of how many vehicles are stored. Indexed by
+// static_cast<std::size_t>(VehicleCategory).
+struct MonitorTotals {
+  State state{State::Init};
+  unsigned errorCount{0};
+  unsigned cameraErrors{0}; // part of errorCount from OnSignal()
+  std::array<std::size_t, kCategoryCount> uniqueVehicles{}; // this period
+  std::array<std::uint64_t, kCategoryCount> sightings{};    // this period
+  std::uint64_t acceptedSignals{0}; // since construction, never reset
+  std::size_t poolInUse{0}; // includes poolIdle
+  std::size_t poolIdle{0};  // kept from earlier periods, not seen in this one
+  std::size_t poolCapacity{0};
+};
+
+// Sightings of one plate in the current period, indexed by
+// static_cast<std::size_t>(VehicleCategory).
+struct VehicleCount {
+  std::array<unsigned, kCategoryCount> perCategory{};
+
+  unsigned Total() const {
+    return perCategory[0] + perCategory[1] + perCategory[2];
+  }
+  bool Found() const { return Total() > 0; }
+};
+
+// Memory held by one monitor, in bytes. "Reserved" is what the instance
+// holds on to (fixed arrays are reserved up front, heap buffers are kept for
+// reuse), "live" the part currently backing data. All figures are kept up to
+// date incrementally, so reading them is O(1).
+struct MemoryUsage {
+  std::size_t instanceBytes{0};    // sizeof the monitor, incl. pool & index
+  std::size_t poolReservedBytes{0}; // whole vehicle pool
+  std::size_t poolLiveBytes{0};     // pool entries in use
+  // Pool prefix up to the last entry in use, i.e. what a walk over the live
+  // entries spreads across (see CompactStep). 0 in IngestMode::LockFree.
+  std::size_t poolSpanBytes{0};
+  std::size_t indexBytes{0};        // hash index buckets
+  std::size_t idHeapReservedBytes{0}; // out-of-line ID buffers, all entries
+  std::size_t idHeapLiveBytes{0};     // out-of-line ID bytes of live entries
+  std::size_t poolRetiredBytes{0}; // freed entries waiting for readers
+  std::size_t heapIndexBytes{0};   // IngestMode::LockFree tables & counters
+  std::size_t errorBufferBytes{0}; // error buffer slots and their IDs
+  std::size_t knownPlatesBytes{0}; // known-plate counters and dictionary
+  std::size_t plateIndexBytes{0};  // MonitorConfig::plateIndexPeriods
+
+  std::size_t ReservedBytes() const {
+    return instanceBytes + idHeapReservedBytes + heapIndexBytes +
+           errorBufferBytes + knownPlatesBytes + plateIndexBytes;
+  }
+  std::size_t LiveBytes() const {
+    return instanceBytes - poolReservedBytes + poolLiveBytes +
+           idHeapLiveBytes + heapIndexBytes + errorBufferBytes +
+           knownPlatesBytes + plateIndexBytes;
+  }
+};
+
+// Pool regions (MonitorConfig::poolSplit) by category: entries [begin,
+// begin + size). borrowed counts live entries outside their region; borrows
+// and rebalances count since construction.
+struct PoolRegions {
+  std::array<std::size_t, kCategoryCount> begin{};
+  std::array<std::size_t, kCategoryCount> size{};
+  std::array<std::size_t, kCategoryCount> live{};
+  std::array<std::size_t, kCategoryCount> borrowed{};
+  std::uint64_t borrows{0};    // allocations outside the category's region
+  std::uint64_t rebalances{0}; // adaptive split changes at resets
+};
+
+// Error buffer (MonitorConfig::errorBufferCapacity) fill level and history.
+// overflowed and replayed count since construction.
+struct ErrorBufferStats {
+  std::size_t capacity{0};
+  std::size_t buffered{0};    // waiting for the next reset
+  std::uint64_t overflowed{0}; // signals lost to a full buffer
+  std::uint64_t replayed{0};   // signals applied after a reset
+};
+
+// What the monitor did with one OnSignal call.
+enum class SignalOutcome : std::uint8_t {
+  Counted,       // known vehicle, count incremented
+  NewVehicle,    // first sighting, vehicle added
+  Ignored,       // Init or Stopped state
+  Error,         // counted as an error (camera error or signal in Error)
+  PoolExhausted, // no space left for a new vehicle, counted as an error
+  Rejected,      // malformed plate, see MonitorConfig::canonicalizePlates
+  Reset,         // reset signal applied
+  Buffered,      // Error state, kept for after the next reset (and an error)
+  StateChange    // Start() or Stop() changed the state
+};
+
+class SignalTap;
+enum class SignalKind : std::uint8_t;
+class ConcurrentVehicleIndex;
+class WatchlistAlerts;
+class PresenceBitmap;
+class PresenceHistory;
+class CrdtReplica;
+
 // declare the helper so we can make it a friend
 template <typename T>
 void CrossroadTrafficMonitoring_OnSignal_Helper(
@@ -101,7 +376,9 @@ public:
   // Constructor with a configurable reset period.
   // The monitoring automatically resets after this period,
   // except if in Stopped state.
-  explicit CrossroadTrafficMonitoring(std::chrono::milliseconds period);
+  explicit CrossroadTrafficMonitoring(std::chrono::milliseconds period,
+                                      MonitorConfig config = {});
+  ~CrossroadTrafficMonitoring();
 
   // State transitions:
   void Start();
@@ -118,15 +395,105 @@ public:
   // Get the number of errors that occurred
   unsigned GetErrorCount() const;
 
+  // Get the number of malformed plates rejected by plate canonicalization,
+  // for one camera or for all cameras.
+  unsigned GetRejectedPlateCount(CameraId camera) const;
+  unsigned GetRejectedPlateCount() const;
+
   // Get statistics by category, as lines "ID - Category (count)"
   std::vector<std::string> GetStatistics(VehicleCategory cat) const;
 
   // Get *all* statistics in alphabetical order
   std::vector<std::string> GetStatistics() const;
 
+  // Move plates between monitors (see PartitionedMonitor), without going
+  // through text or signals:
+  //    - ExportVehicles: what GetStatistics() lists, unformatted.
+  //    - ImportVehicles: add counts to the current period in any state, as
+  //      if counted here. They are not signals: acceptedSignals, the tap,
+  //      the watchlist and the replica do not see them. false if the pool
+  //      runs out (the ones before are imported).
+  //    - EraseVehicles: forget plates (canonical IDs), their counts leave
+  //      the totals.
+  // Import and erase need a mutex ingest mode and return false with
+  // IngestMode::LockFree.
+  std::vector<VehicleStats> ExportVehicles() const;
+  bool ImportVehicles(const std::vector<VehicleStats> &vehicles);
+  bool EraseVehicles(const std::vector<std::string> &ids);
+
+  // Get running totals (counts per category, errors, pool occupancy) in O(1).
+  MonitorTotals GetTotals() const;
+
+  // Point queries through the hash index: how often was this plate seen in
+  // the current period (in every category, or in one). No formatting, no
+  // table scan. IDs are canonicalized first when canonicalizePlates is set.
+  VehicleCount GetVehicleCount(const std::string &id) const;
+  unsigned GetVehicleCount(VehicleCategory cat, const std::string &id) const;
+
+  // MonitorConfig::plateIndexPeriods: the stable index of a plate
+  // (canonicalized first like GetVehicleCount), or UINT32_MAX if it has
+  // none; and the plate holding an index, empty if none.
+  std::uint32_t GetPlateIndex(const std::string &id) const;
+  std::string GetIndexedPlate(std::uint32_t index) const;
+  // Plates behind a bitmap of plate indices (see PresenceHistory),
+  // alphabetical.
+  std::vector<std::string> GetIndexedPlates(const PresenceBitmap &bitmap) const;
+
+  // Get the memory footprint of this monitor in O(1).
+  MemoryUsage GetMemoryUsage() const;
+
+  // Incremental pool compaction: move up to `maxMoves` live vehicles from
+  // the back of the pool (or of their category's region, borrowed entries
+  // first, see MonitorConfig::poolSplit) into the lowest free entries,
+  // keeping their place in every list and in the index. Returns how many
+  // moved; 0 once the live vehicles form a dense prefix of their region.
+  // Each step holds the lock for a bounded time, so a caller can spread the
+  // work between signals. Does nothing in IngestMode::LockFree, where the
+  // lock-free index owns the pool.
+  std::size_t CompactStep(std::size_t maxMoves = 32);
+
+  // Pool regions per category; one shared region unless poolSplit is set.
+  PoolRegions GetPoolRegions() const;
+
+  ErrorBufferStats GetErrorBufferStats() const;
+
+  // Get the `n` most frequently seen vehicles, highest count first. Ties are
+  // broken alphabetically, then by category. O(n) for n <= 32 with the
+  // mutex ingest modes, which keep a running top list.
+  std::vector<VehicleStats> GetTopVehicles(std::size_t n) const;
+
   // Get current state
   State GetCurrentState() const { return state; }
 
+  // Attach a tap that records every OnSignal, Start, Stop and Reset call,
+  // and the periodic and scheduled resets (nullptr detaches). The tap is
+  // not owned and must outlive its attachment.
+  void SetSignalTap(SignalTap *tap);
+
+  // Check every accepted vehicle signal (Counted or NewVehicle, replayed
+  // error-buffer signals included) against a watchlist (nullptr detaches).
+  // Checked after the signal is applied, never under the monitor lock;
+  // replayed signals by the thread that ran the reset. Not owned, must
+  // outlive its attachment.
+  void SetWatchlistAlerts(WatchlistAlerts *alerts);
+
+  // Close a period of `history` at every reset of this monitor, with the
+  // plate index and sightings of every plate counted in the period
+  // (replayed error-buffer signals included); nullptr detaches. Needs
+  // MonitorConfig::plateIndexPeriods of at least history->KeepWindows(),
+  // false otherwise. One history per monitor. Not owned, must outlive its
+  // attachment.
+  bool SetPresenceHistory(PresenceHistory *history);
+
+  // Count every accepted vehicle signal (replayed error-buffer signals
+  // included) in `replica` under its node ID and the canonical ID, for
+  // merging with the replicas of redundant nodes (nullptr detaches). Each
+  // reset begins a replica epoch numbered by wall-clock period (rounded, so
+  // resets a little off the boundary agree), and every sighting lands in
+  // the epoch of the period that counted it. Not owned, must outlive its
+  // attachment.
+  void SetCrdtReplica(CrdtReplica *replica);
+
   // helper for checking periodic reset status
   void CheckAndHandlePeriodicReset();
 
@@ -139,16 +506,91 @@ private:
 
   // memory pool management
   static constexpr size_t MAX_VEHICLES = 1000;
+  static constexpr size_t MAX_CAMERAS = 256;
+  static constexpr size_t POOL_WORDS = (MAX_VEHICLES + 63) / 64;
   Vehicle vehiclePool[MAX_VEHICLES];
-  Vehicle *freeListHead{nullptr};
+  // Pool entries by index, one bit each, live ones by category. Allocation
+  // takes the lowest free entry of the category's region, so live vehicles
+  // gather at the front of it; retired entries are in no set until
+  // reclaimed.
+  using SlotBits = std::array<std::uint64_t, POOL_WORDS>;
+  SlotBits freeSlots{};
+  std::array<SlotBits, kCategoryCount> liveSlots{};
+
+  // MonitorConfig::poolSplit: category c owns [regionBounds[c],
+  // regionBounds[c + 1]), all of the pool when the pool is shared.
+  bool splitPool{false};
+  std::array<std::size_t, kCategoryCount + 1> regionBounds{};
+  std::uint64_t regionBorrows{0};
+  std::uint64_t regionRebalances{0};
+  std::pair<std::size_t, std::size_t> RegionOf(VehicleCategory cat) const;
+  void SetRegionSizes(const std::array<std::size_t, kCategoryCount> &weights);
+  void RebalanceRegionsLocked(); // adaptivePoolSplit, before a reset
 
   // Protect shared data
-  mutable std::mutex monitorMutex;
+  mutable PolicyMutex monitorMutex;
+
+  // Reset and periodic reset with monitorMutex already held
+  void ResetLocked();
+  void CheckAndHandlePeriodicResetLocked();
+  void ScheduledReset(); // from MonitorConfig::resetScheduler
+
+  // Signal handling with monitorMutex already held
+  SignalOutcome ApplyVehicleSignalLocked(VehicleCategory cat,
+                                         const std::string &rawId,
+                                         CameraId camera);
+  SignalOutcome ApplyErrorSignalLocked();
+
+  // Error buffer: a ring of errorBufferCapacity slots, allocated up front.
+  // Slots keep their ID buffers, so buffering rarely allocates.
+  struct BufferedSignal {
+    VehicleCategory category{VehicleCategory::Bicycle};
+    CameraId camera{0};
+    std::string rawId;
+  };
+  std::vector<BufferedSignal> errorBuffer;
+  std::size_t errorBufferHead{0}; // oldest buffered signal
+  std::size_t errorBufferSize{0};
+  std::size_t errorBufferIdHeap{0}; // out-of-line ID bytes of all slots
+  std::uint64_t errorBufferOverflows{0};
+  std::uint64_t errorBufferReplayed{0};
+  bool BufferErrorSignalLocked(VehicleCategory cat, const std::string &rawId,
+                               CameraId camera);
+  // Replayed signals counted while alerts are attached, by raw ID as live
+  // signals are, checked against the watchlist once the lock is released.
+  struct ReplayedSignal {
+    VehicleCategory category{VehicleCategory::Bicycle};
+    CameraId camera{0};
+    std::string id;
+  };
+  std::vector<ReplayedSignal> replayedSignals;
+  std::atomic<bool> replayedPending{false};
+  void CheckReplayedSignals(); // without the lock
+  void ReplayErrorBufferLocked(); // in Active state, right after a reset
+
+  // Vehicle signal for IngestMode::LockFree, called without the lock
+  SignalOutcome ApplyVehicleSignalLockFree(VehicleCategory cat,
+                                           const std::string &rawId,
+                                           CameraId camera);
+  // Count a canonical ID in the lock-free index; PoolExhausted is left to
+  // the caller. With or without the lock. traceSequence, if given, receives
+  // the tap sequence number of the period counted in.
+  SignalOutcome CountLockFree(VehicleCategory cat, const std::string &id,
+                              std::uint32_t *traceSequence = nullptr);
 
   // Helpers to free list
   void InitializeFreeList();
-  Vehicle *AllocateVehicle(); // get from free list
+  Vehicle *AllocateVehicle(VehicleCategory cat); // lowest free entry
   void FreeVehicle(Vehicle *v);
+  // Move a live vehicle into the free entry `to` (see CompactStep)
+  void RelocateVehicleLocked(Vehicle &from, Vehicle &to);
+
+  // Freed vehicles are retired first and only go back to the free list once
+  // no lock-free reader can still see them (epoch-based reclamation).
+  mutable EpochManager readerEpochs; // pinned by const queries too
+  RetiredList<Vehicle, &Vehicle::nextFree, &Vehicle::retiredAt>
+      retiredVehicles;
+  std::size_t ReclaimRetiredVehicles();
 
   // Intrusive list definitions
   using CategoryMemberOption =
@@ -173,20 +615,177 @@ private:
 
   AlphabeticalList alphabeticalList;
 
+  // Hash index over all live vehicles. Lookups pass their own key and
+  // comparator (see FindVehicle), so duplicates are never checked on insert.
+  using IndexMemberOption =
+      boost::intrusive::member_hook<Vehicle, Vehicle::IndexHook,
+                                    &Vehicle::index_hook>;
+
+  struct IdHash {
+    std::size_t operator()(std::string_view id) const {
+      return std::hash<std::string_view>{}(id);
+    }
+    std::size_t operator()(const Vehicle &v) const { return (*this)(v.id); }
+  };
+
+  struct SameEntry { // only used by the container itself, not by lookups
+    bool operator()(const Vehicle &a, const Vehicle &b) const {
+      return a.category == b.category && a.id == b.id;
+    }
+  };
+
+  using VehicleIndex = boost::intrusive::unordered_multiset<
+      Vehicle, IndexMemberOption, boost::intrusive::hash<IdHash>,
+      boost::intrusive::equal<SameEntry>,
+      boost::intrusive::power_2_buckets<true>,
+      boost::intrusive::constant_time_size<false>>;
+
+  static constexpr size_t INDEX_BUCKETS = 1024; // >= MAX_VEHICLES, power of 2
+  VehicleIndex::bucket_type indexBuckets[INDEX_BUCKETS];
+  VehicleIndex vehicleIndex{
+      VehicleIndex::bucket_traits(indexBuckets, INDEX_BUCKETS)};
+
+  // MonitorConfig::plateRetentionPeriods: entries seen in this period, and
+  // entries kept from earlier ones ordered by lastPeriod, oldest first.
+  using AgeMemberOption =
+      boost::intrusive::member_hook<Vehicle, Vehicle::Hook,
+                                    &Vehicle::age_hook>;
+
+  using AgeList =
+      boost::intrusive::list<Vehicle, AgeMemberOption,
+                             boost::intrusive::constant_time_size<false>>;
+
+  AgeList seenVehicles;
+  AgeList idleVehicles;
+  std::size_t idleCount{0};
+  std::uint32_t periodNumber{0}; // resets so far
+  bool RetainsPlates() const;
+  void MarkSeenLocked(Vehicle *v);
+  void RetainVehiclesLocked(); // the reset's part with retention
+  // The reset's part for PresenceHistory: `seen` holds (plate index,
+  // sightings) of the closing period, a plate possibly more than once.
+  static void
+  ClosePresenceWindow(PresenceHistory &history,
+                      std::vector<std::pair<std::uint32_t, std::uint32_t>> &seen);
+  bool EvictIdleVehicleLocked();
+
   // insert newly created Vehicle into both category and alphabetical lists
   void InsertVehicle(Vehicle *v);
 
-  // Find a vehicle in a category list by ID. Return nullptr if not found.
-  Vehicle *FindVehicle(VehicleCategory cat, const std::string &id);
+  // The TOP_TRACKED most seen (vehicle, category) pairs of this period, in
+  // GetTopVehicles order. Counts only grow between resets, so raising an
+  // entry whenever its count grows keeps the board exact.
+  static constexpr size_t TOP_TRACKED = 32;
+  struct TopEntry {
+    Vehicle *vehicle{nullptr};
+    std::size_t category{0};
+  };
+  std::array<TopEntry, TOP_TRACKED> topVehicles{};
+  std::size_t topCount{0};
+  void RaiseTopVehicleLocked(Vehicle *v, std::size_t cat);
+  void DropTopVehicleLocked(Vehicle *v);
+
+  // Find the entry counting `id` in `cat` (for PerPlate: the plate's entry,
+  // whatever categories it was seen in). Return nullptr if not found.
+  Vehicle *FindVehicle(VehicleCategory cat, std::string_view id);
+  const Vehicle *FindVehicle(VehicleCategory cat, std::string_view id) const;
+
+  // The ID as stored: canonicalized when canonicalizePlates is set (using
+  // `scratch`), otherwise `raw` itself. nullptr for a malformed plate.
+  const std::string *ResolveId(const std::string &raw,
+                               std::string &scratch) const;
 
   // Insert vehicle in alphabetical order (by v->id) into list
   void InsertAlphaSorted(Vehicle *v);
 
+  // IngestMode::LockFree: the index owns the pool instead of the free list,
+  // and the totals updated without the lock are spread over per-thread
+  // stripes (summed on read) so camera threads do not share a cache line.
+  struct alignas(64) IngestStripe {
+    std::array<std::atomic<std::uint64_t>, kCategoryCount> uniqueVehicles{};
+    std::array<std::atomic<std::uint64_t>, kCategoryCount> sightings{};
+    std::atomic<std::uint64_t> acceptedSignals{0};
+    std::atomic<std::size_t> liveVehicles{0};
+    std::atomic<std::size_t> idHeapReserved{0};
+    std::atomic<std::size_t> idHeapLive{0};
+  };
+  static constexpr size_t INGEST_STRIPES = 16;
+  std::unique_ptr<ConcurrentVehicleIndex> concurrentIndex;
+  std::unique_ptr<IngestStripe[]> ingestStripes;
+  IngestStripe &StripeForThisThread();
+
+  // IngestMode::FlatCombining: a signal waits in a slot until the thread
+  // holding monitorMutex applies it (CombineLocked).
+  struct alignas(64) CombiningSlot {
+    std::atomic<std::uint8_t> state{0}; // free, writing, pending, done
+    VehicleCategory category{VehicleCategory::Bicycle};
+    CameraId camera{0};
+    SignalOutcome outcome{SignalOutcome::Ignored};
+    const std::string *rawId{nullptr};
+  };
+  static constexpr size_t COMBINING_SLOTS = 64;
+  std::unique_ptr<CombiningSlot[]> combiningSlots;
+  std::atomic<std::size_t> combiningSlotsUsed{0}; // highest claimed + 1
+  SignalOutcome ApplyVehicleSignalCombining(VehicleCategory cat,
+                                            const std::string &rawId,
+                                            CameraId camera);
+  void CombineLocked();
+
+  // Statistics of the lock-free index, sorted by ID then category. The
+  // snapshots take a category index to keep only that one, or
+  // kCategoryCount for all.
+  std::vector<VehicleStats>
+  SnapshotConcurrentIndex(std::size_t only = kCategoryCount) const;
+
+  // MonitorConfig::knownPlates: counts by [index * kCategoryCount + category].
+  // Accessed through atomic_ref in IngestMode::LockFree, under the lock
+  // otherwise.
+  std::unique_ptr<unsigned[]> knownCounts;
+  std::unique_ptr<PlateDictionary> plateDictionary; // plateIndexPeriods
+  unsigned LoadKnownCount(std::size_t slot) const;
+  SignalOutcome CountKnownPlate(std::uint32_t index, VehicleCategory cat);
+  // Known plates with a count, sorted by ID then category
+  std::vector<VehicleStats>
+  SnapshotKnownPlates(std::size_t only = kCategoryCount) const;
+  // Everything counted, sorted by ID then category (lock held unless
+  // LockFree)
+  std::vector<VehicleStats>
+  SnapshotWithKnownPlates(std::size_t only = kCategoryCount) const;
+  bool FindKnownCount(const std::string &id, VehicleCount &count) const;
+  // A pool entry for a new plate, indexed and listed with zero counts;
+  // nullptr if the pool is exhausted. Lock held.
+  Vehicle *CreateVehicleLocked(VehicleCategory cat, const std::string &id);
+
   // private members
-  State state{State::Init};
+  MonitorConfig config;
+  std::atomic<State> state{State::Init}; // read without the lock by getters
   unsigned errorCount{0};
+  unsigned cameraErrors{0}; // see MonitorTotals
+  std::size_t liveVehicles{0};
+  std::array<std::size_t, kCategoryCount> uniqueVehicles{};
+  std::array<std::uint64_t, kCategoryCount> sightings{};
+  std::uint64_t acceptedSignals{0};
+  std::size_t idHeapReserved{0}; // see MemoryUsage
+  std::size_t idHeapLive{0};
+  std::atomic<SignalTap *> signalTap{nullptr};
+  // In IngestMode::LockFree, the tap sequence number of the control record
+  // that opened the period each index table counts.
+  std::array<std::atomic<std::uint32_t>, 2> tableSequences{};
+  std::uint32_t RecordTapLocked(SignalKind kind, SignalOutcome outcome,
+                                CameraId camera, std::string_view id);
+  std::atomic<WatchlistAlerts *> watchlistAlerts{nullptr};
+  std::atomic<PresenceHistory *> presenceHistory{nullptr};
+  std::atomic<CrdtReplica *> crdtReplica{nullptr};
+  // CrdtReplica epoch of the open period (under the lock), and in
+  // IngestMode::LockFree of the period each index table counts.
+  std::uint64_t replicaEpoch{0};
+  std::array<std::atomic<std::uint64_t>, 2> tableEpochs{};
+  std::uint64_t WallClockPeriod(bool rounded) const;
+  void RecordReplicaLocked(VehicleCategory cat, const std::string &id);
+  std::array<unsigned, MAX_CAMERAS> rejectedPlates{}; // per camera
   std::chrono::milliseconds period{};
-  std::chrono::steady_clock::time_point nextResetTime{};
+  std::atomic<std::chrono::steady_clock::time_point> nextResetTime{};
+  std::uint64_t resetTimer{0}; // in config.resetScheduler
 
   void scheduleNextReset();
 };
@@ -0,0 +1,47 @@
+#include "EpochReclamation.hpp"
+#include <functional>
+#include <thread>
+
+namespace ctm // ctm == CrossRoad Traffic Monitoring
+{
+
+static std::uint64_t pinned(std::uint64_t epoch) { return (epoch << 1) | 1; }
+
+EpochManager::Guard EpochManager::Pin() {
+  // Start probing at a per-thread position so threads rarely collide.
+  const std::size_t start =
+      std::hash<std::thread::id>{}(std::this_thread::get_id()) % MAX_READERS;
+  for (;;) {
+    for (std::size_t i = 0; i < MAX_READERS; ++i) {
+      auto &slot = readers[(start + i) % MAX_READERS].value;
+      std::uint64_t epoch = globalEpoch.load(std::memory_order_seq_cst);
+      std::uint64_t expected = 0;
+      if (!slot.compare_exchange_strong(expected, pinned(epoch),
+                                        std::memory_order_seq_cst)) {
+        continue;
+      }
+      // The epoch may have moved between reading and announcing it;
+      // re-announce until they agree so TryAdvance sees what we read.
+      for (std::uint64_t now;
+           (now = globalEpoch.load(std::memory_order_seq_cst)) != epoch;) {
+        epoch = now;
+        slot.store(pinned(epoch), std::memory_order_seq_cst);
+      }
+      return Guard(&slot);
+    }
+    std::this_thread::yield(); // all slots busy
+  }
+}
+
+bool EpochManager::TryAdvance() {
+  std::uint64_t epoch = globalEpoch.load(std::memory_order_seq_cst);
+  for (const auto &r : readers) {
+    const std::uint64_t v = r.value.load(std::memory_order_seq_cst);
+    if (v != 0 && v != pinned(epoch))
+      return false; // a reader is still in an older epoch
+  }
+  return globalEpoch.compare_exchange_strong(epoch, epoch + 1,
+                                             std::memory_order_seq_cst);
+}
+
+} // namespace ctm
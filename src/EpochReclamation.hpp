@@ -0,0 +1,113 @@
+#ifndef EPOCH_RECLAMATION_HPP
+#define EPOCH_RECLAMATION_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace ctm // ctm == CrossRoad Traffic Monitoring
+{
+//-----------------------------------------------------------
+// Epoch-based reclamation for lock-free readers.
+//
+// Readers Pin() for the duration of a read. Writers unlink an object, then
+// retire it stamped with CurrentEpoch(). The epoch only advances once every
+// pinned reader has seen the current epoch, so an object retired at epoch e
+// is unreachable for all readers once the epoch reaches e + 2.
+//
+// Reader slots are a fixed array, pinning never allocates. When all slots
+// are taken, Pin() waits for one to free up.
+//-----------------------------------------------------------
+class EpochManager {
+public:
+  static constexpr std::size_t MAX_READERS = 32;
+
+  // RAII read-side critical section.
+  class Guard {
+  public:
+    Guard(Guard &&other) noexcept : slot(other.slot) { other.slot = nullptr; }
+    Guard(const Guard &) = delete;
+    Guard &operator=(const Guard &) = delete;
+    Guard &operator=(Guard &&) = delete;
+    ~Guard() {
+      if (slot)
+        slot->store(0, std::memory_order_release);
+    }
+
+  private:
+    friend class EpochManager;
+    explicit Guard(std::atomic<std::uint64_t> *slot) : slot(slot) {}
+    std::atomic<std::uint64_t> *slot;
+  };
+
+  Guard Pin();
+
+  std::uint64_t CurrentEpoch() const {
+    return globalEpoch.load(std::memory_order_seq_cst);
+  }
+
+  // Advance the epoch if no reader is pinned in an older one.
+  bool TryAdvance();
+
+  // No reader can still reference an object retired at `retireEpoch`.
+  bool IsSafe(std::uint64_t retireEpoch) const {
+    return CurrentEpoch() >= retireEpoch + 2;
+  }
+
+private:
+  // 0 = free, otherwise (epoch << 1) | 1
+  struct alignas(64) ReaderSlot {
+    std::atomic<std::uint64_t> value{0};
+  };
+  std::array<ReaderSlot, MAX_READERS> readers{};
+  alignas(64) std::atomic<std::uint64_t> globalEpoch{1};
+};
+
+//-----------------------------------------------------------
+// FIFO of retired objects, linked through T::*Next and stamped in
+// T::*RetiredAt. Epochs only grow, so the oldest entries become safe first
+// and reclaiming stops at the first entry that is not. Not thread-safe: the
+// owner serializes Retire/Reclaim (e.g. under its writer lock).
+//-----------------------------------------------------------
+template <typename T, T *T::*Next, std::uint64_t T::*RetiredAt>
+class RetiredList {
+public:
+  void Retire(T *object, std::uint64_t epoch) {
+    object->*RetiredAt = epoch;
+    object->*Next = nullptr;
+    if (tail)
+      tail->*Next = object;
+    else
+      head = object;
+    tail = object;
+    ++count;
+  }
+
+  // Hand every object that is safe to reuse to `reclaim(T *)`.
+  template <typename F>
+  std::size_t ReclaimSafe(const EpochManager &epochs, F &&reclaim) {
+    std::size_t reclaimed = 0;
+    while (head && epochs.IsSafe(head->*RetiredAt)) {
+      T *object = head;
+      head = object->*Next;
+      if (!head)
+        tail = nullptr;
+      --count;
+      ++reclaimed;
+      reclaim(object);
+    }
+    return reclaimed;
+  }
+
+  std::size_t Size() const { return count; }
+
+private:
+  T *head{nullptr};
+  T *tail{nullptr};
+  std::size_t count{0};
+};
+
+} // namespace ctm
+
+#endif // EPOCH_RECLAMATION_HPP
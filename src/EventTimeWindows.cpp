@@ -0,0 +1,180 @@
+#include "EventTimeWindows.hpp"
+#include <algorithm>
+#include <limits>
+
+namespace ctm // ctm == CrossRoad Traffic Monitoring
+{
+
+namespace {
+std::int64_t toMillis(EventTime at) {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             at.time_since_epoch())
+      .count();
+}
+
+EventTime fromMillis(std::int64_t ms) {
+  return EventTime(std::chrono::duration_cast<EventTime::duration>(
+      std::chrono::milliseconds(ms)));
+}
+
+WindowConfig sanitize(WindowConfig config) {
+  config.windowSize = std::max(config.windowSize, std::chrono::milliseconds(1));
+  config.maxOutOfOrder =
+      std::max(config.maxOutOfOrder, std::chrono::milliseconds(0));
+  config.maxFutureSkew =
+      std::max(config.maxFutureSkew, std::chrono::milliseconds(0));
+  return config;
+}
+
+// Windows are counted by event time only; the monitors must never reset on
+// their own.
+constexpr auto kNoPeriodicReset = std::chrono::hours(24 * 365 * 100);
+} // namespace
+
+EventTimeWindows::EventTimeWindows(WindowConfig windowConfig)
+    : config{sanitize(windowConfig)},
+      watermark{std::numeric_limits<Millis>::min()} {}
+
+EventTimeWindows::~EventTimeWindows() = default;
+
+EventTimeWindows::Millis EventTimeWindows::WindowStart(Millis at) const {
+  const Millis size = config.windowSize.count();
+  const Millis q = at / size;
+  return (at % size < 0 ? q - 1 : q) * size; // floor, also before the epoch
+}
+
+void EventTimeWindows::AdvanceWatermarkLocked(Millis newWatermark) {
+  if (newWatermark <= watermark)
+    return;
+  watermark = newWatermark;
+  const Millis size = config.windowSize.count();
+  const Millis lateness = config.allowedLateness.count();
+  std::size_t finalized = 0;
+  for (auto it = windows.rbegin(); it != windows.rend(); ++it) {
+    Window &w = it->second;
+    const Millis end = it->first + size;
+    if (w.state == WindowState::Open && watermark >= end)
+      w.state = WindowState::Closed;
+    if (w.state == WindowState::Closed && watermark >= end + lateness)
+      w.state = WindowState::Finalized;
+    if (w.state == WindowState::Finalized)
+      ++finalized;
+  }
+  // Discard the oldest finalized windows beyond the retained ones.
+  for (auto it = windows.begin();
+       it != windows.end() && finalized > config.retainedWindows;) {
+    if (it->second.state != WindowState::Finalized) {
+      ++it;
+      continue;
+    }
+    it = windows.erase(it);
+    --finalized;
+  }
+}
+
+template <typename T>
+WindowOutcome EventTimeWindows::Apply(const T &vehicle, EventTime at) {
+  const Millis time = toMillis(at);
+  std::lock_guard<std::mutex> lock(windowsMutex);
+  const Millis maxOutOfOrder = config.maxOutOfOrder.count();
+  const Millis maxFutureSkew = config.maxFutureSkew.count();
+  // Difference taken unsigned: both ends may be near the limits of Millis.
+  if (maxFutureSkew > 0 && watermark != std::numeric_limits<Millis>::min() &&
+      time > watermark &&
+      static_cast<std::uint64_t>(time) - static_cast<std::uint64_t>(watermark) >
+          static_cast<std::uint64_t>(maxOutOfOrder + maxFutureSkew)) {
+    ++metrics.rejected;
+    return WindowOutcome::Rejected;
+  }
+  if (time > std::numeric_limits<Millis>::min() + maxOutOfOrder)
+    AdvanceWatermarkLocked(time - maxOutOfOrder);
+
+  const Millis start = WindowStart(time);
+  const Millis end = start + config.windowSize.count();
+  if (watermark >= end + config.allowedLateness.count()) {
+    ++metrics.dropped;
+    return WindowOutcome::Dropped;
+  }
+
+  auto it = windows.find(start);
+  if (it == windows.end()) {
+    Window w;
+    w.monitor = std::make_unique<CrossroadTrafficMonitoring>(kNoPeriodicReset,
+                                                             config.monitor);
+    w.monitor->Start();
+    // A window first seen late is created already closed.
+    if (watermark >= end)
+      w.state = WindowState::Closed;
+    it = windows.emplace(start, std::move(w)).first;
+  }
+  Window &w = it->second;
+  w.monitor->OnSignal(vehicle);
+
+  if (time >= watermark) {
+    ++metrics.onTime;
+    return WindowOutcome::OnTime;
+  }
+  ++w.lateSignals;
+  metrics.maxLateness = std::max(metrics.maxLateness,
+                                 std::chrono::milliseconds(watermark - time));
+  if (w.state == WindowState::Open) {
+    ++metrics.late;
+    return WindowOutcome::Late;
+  }
+  ++w.amendments;
+  ++metrics.amended;
+  return WindowOutcome::Amended;
+}
+
+WindowOutcome EventTimeWindows::OnSignal(const Bicycle &b, EventTime at) {
+  return Apply(b, at);
+}
+WindowOutcome EventTimeWindows::OnSignal(const Car &c, EventTime at) {
+  return Apply(c, at);
+}
+WindowOutcome EventTimeWindows::OnSignal(const Scooter &s, EventTime at) {
+  return Apply(s, at);
+}
+
+void EventTimeWindows::AdvanceWatermark(EventTime newWatermark) {
+  std::lock_guard<std::mutex> lock(windowsMutex);
+  AdvanceWatermarkLocked(toMillis(newWatermark));
+}
+
+EventTime EventTimeWindows::GetWatermark() const {
+  std::lock_guard<std::mutex> lock(windowsMutex);
+  return watermark == std::numeric_limits<Millis>::min() ? EventTime::min()
+                                                         : fromMillis(watermark);
+}
+
+std::vector<WindowSummary> EventTimeWindows::GetWindows() const {
+  std::lock_guard<std::mutex> lock(windowsMutex);
+  std::vector<WindowSummary> result;
+  result.reserve(windows.size());
+  for (const auto &[start, w] : windows) {
+    WindowSummary s;
+    s.start = fromMillis(start);
+    s.end = fromMillis(start + config.windowSize.count());
+    s.state = w.state;
+    s.lateSignals = w.lateSignals;
+    s.amendments = w.amendments;
+    s.totals = w.monitor->GetTotals();
+    result.push_back(s);
+  }
+  return result;
+}
+
+std::vector<std::string> EventTimeWindows::GetStatistics(EventTime at) const {
+  std::lock_guard<std::mutex> lock(windowsMutex);
+  const auto it = windows.find(WindowStart(toMillis(at)));
+  if (it == windows.end())
+    return {};
+  return it->second.monitor->GetStatistics();
+}
+
+LatenessMetrics EventTimeWindows::GetLatenessMetrics() const {
+  std::lock_guard<std::mutex> lock(windowsMutex);
+  return metrics;
+}
+
+} // namespace ctm
@@ -0,0 +1,150 @@
+#ifndef EVENT_TIME_WINDOWS_HPP
+#define EVENT_TIME_WINDOWS_HPP
+
+#include "CrossroadTrafficMonitoring.hpp"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ctm // ctm == CrossRoad Traffic Monitoring
+{
+// Camera timestamp of a detection.
+using EventTime = std::chrono::system_clock::time_point;
+
+struct WindowConfig {
+  // Length of a window; windows are aligned to multiples of it since the
+  // clock's epoch, like a periodic reset every windowSize.
+  std::chrono::milliseconds windowSize{std::chrono::minutes(10)};
+  // The watermark trails the newest event time by this much, so events that
+  // are at most this late still count as on time.
+  std::chrono::milliseconds maxOutOfOrder{std::chrono::seconds(5)};
+  // How long after a window closed late events still amend it.
+  std::chrono::milliseconds allowedLateness{std::chrono::minutes(1)};
+  // Events stamped more than this ahead of the newest event time (the
+  // watermark plus maxOutOfOrder) are rejected, so one camera with a wrong
+  // clock cannot finalize every window at once. Feed AdvanceWatermark() on
+  // quiet streams so that real gaps stay within it; zero disables the check.
+  std::chrono::milliseconds maxFutureSkew{std::chrono::hours(1)};
+  // Finalized windows kept for queries; older ones are discarded.
+  std::size_t retainedWindows{4};
+  // Configuration of the monitor behind every window.
+  MonitorConfig monitor{};
+};
+
+enum class WindowState {
+  Open,     // watermark before the window end
+  Closed,   // past the end, late events within allowedLateness amend it
+  Finalized // past end + allowedLateness, no longer changes
+};
+
+inline const char *ToString(WindowState state) {
+  switch (state) {
+  case WindowState::Open:
+    return "Open";
+  case WindowState::Closed:
+    return "Closed";
+  case WindowState::Finalized:
+    return "Finalized";
+  }
+  return "Unknown";
+}
+
+// Where one detection went.
+enum class WindowOutcome {
+  OnTime,  // at or after the watermark
+  Late,    // before the watermark, its window still open
+  Amended, // its window had closed, the window was amended
+  Dropped, // its window was finalized (or discarded)
+  Rejected // too far ahead of the watermark, see WindowConfig::maxFutureSkew
+};
+
+struct WindowSummary {
+  EventTime start{};
+  EventTime end{}; // exclusive
+  WindowState state{WindowState::Open};
+  std::uint64_t lateSignals{0};    // Late + Amended
+  std::uint64_t amendments{0};     // Amended only
+  MonitorTotals totals{};
+};
+
+struct LatenessMetrics {
+  std::uint64_t onTime{0};
+  std::uint64_t late{0};
+  std::uint64_t amended{0};
+  std::uint64_t dropped{0};
+  std::uint64_t rejected{0}; // beyond maxFutureSkew, watermark unchanged
+  std::chrono::milliseconds maxLateness{0}; // behind the watermark, accepted
+};
+
+//-----------------------------------------------------------
+// Event-time windowing on top of CrossroadTrafficMonitoring.
+//
+// Periodic reset works on arrival time, so detections a gateway buffered or
+// retransmitted land in whatever period is current when they arrive. Here
+// every detection carries its camera timestamp and is counted in the window
+// that timestamp falls in, each window being its own monitor:
+//
+//    - The watermark is the newest event time minus maxOutOfOrder (or what
+//      AdvanceWatermark() was told). A window closes when the watermark
+//      passes its end.
+//    - Events behind the watermark still go to their own window: an open one
+//      as Late, a closed one (within allowedLateness) as an amendment.
+//    - Events for finalized windows are dropped and counted.
+//    - Events too far in the future are rejected and counted, without moving
+//      the watermark.
+//
+// Thread-safe; all calls are serialized on one mutex.
+//-----------------------------------------------------------
+class EventTimeWindows {
+public:
+  explicit EventTimeWindows(WindowConfig config = {});
+  ~EventTimeWindows();
+
+  WindowOutcome OnSignal(const Bicycle &b, EventTime at);
+  WindowOutcome OnSignal(const Car &c, EventTime at);
+  WindowOutcome OnSignal(const Scooter &s, EventTime at);
+
+  // Move the watermark forward without an event, e.g. on a gateway
+  // heartbeat while the cameras are quiet. Never moves it back.
+  void AdvanceWatermark(EventTime watermark);
+
+  // Minimum EventTime until the first event.
+  EventTime GetWatermark() const;
+
+  // Retained windows, oldest first.
+  std::vector<WindowSummary> GetWindows() const;
+
+  // Statistics of the window containing `at` (empty if it is not retained).
+  std::vector<std::string> GetStatistics(EventTime at) const;
+
+  LatenessMetrics GetLatenessMetrics() const;
+
+private:
+  struct Window {
+    std::unique_ptr<CrossroadTrafficMonitoring> monitor;
+    WindowState state{WindowState::Open};
+    std::uint64_t lateSignals{0};
+    std::uint64_t amendments{0};
+  };
+
+  using Millis = std::int64_t; // event time in ms since the clock's epoch
+
+  template <typename T> WindowOutcome Apply(const T &vehicle, EventTime at);
+  Millis WindowStart(Millis at) const;
+  void AdvanceWatermarkLocked(Millis watermark);
+
+  const WindowConfig config;
+  mutable std::mutex windowsMutex;
+  std::map<Millis, Window> windows; // by window start
+  Millis watermark;
+  LatenessMetrics metrics;
+};
+
+} // namespace ctm
+
+#endif // EVENT_TIME_WINDOWS_HPP
@@ -0,0 +1,376 @@
+#include "IngestPipeline.hpp"
+#include "PlateCanonicalizer.hpp"
+#include <algorithm>
+#include <charconv>
+#include <functional>
+
+namespace ctm // ctm == CrossRoad Traffic Monitoring
+{
+
+namespace {
+PipelineConfig sanitize(PipelineConfig config) {
+  config.decoders = std::max<std::size_t>(config.decoders, 1);
+  config.routers = std::max<std::size_t>(config.routers, 1);
+  config.shards = std::max<std::size_t>(config.shards, 1);
+  config.batchSize = std::max<std::size_t>(config.batchSize, 1);
+  return config;
+}
+
+std::size_t stageIndex(PipelineStage stage) {
+  return static_cast<std::size_t>(stage);
+}
+
+// Run `step` (returns whether it found work) until `stop` is set and one
+// more pass finds nothing, so everything queued before the stop is handled.
+template <typename Step>
+void runStage(const std::atomic<bool> &stop, Step &&step) {
+  unsigned idlePasses = 0;
+  for (;;) {
+    if (step()) {
+      idlePasses = 0;
+      continue;
+    }
+    if (stop.load(std::memory_order_acquire)) {
+      if (!step())
+        return;
+      continue;
+    }
+    if (++idlePasses < 64)
+      std::this_thread::yield();
+    else
+      std::this_thread::sleep_for(std::chrono::microseconds(50));
+  }
+}
+
+// "Category,ID[,camera]"
+bool parseFrame(std::string_view frame, VehicleCategory &category,
+                std::string_view &id, CameraId &camera) {
+  const auto comma = frame.find(',');
+  if (comma == std::string_view::npos)
+    return false;
+  const std::string_view kind = frame.substr(0, comma);
+  if (kind == "Bicycle")
+    category = VehicleCategory::Bicycle;
+  else if (kind == "Car")
+    category = VehicleCategory::Car;
+  else if (kind == "Scooter")
+    category = VehicleCategory::Scooter;
+  else
+    return false;
+
+  id = frame.substr(comma + 1);
+  camera = 0;
+  const auto second = id.find(',');
+  if (second != std::string_view::npos) {
+    const std::string_view number = id.substr(second + 1);
+    id = id.substr(0, second);
+    unsigned value = 0;
+    const auto [end, ec] =
+        std::from_chars(number.data(), number.data() + number.size(), value);
+    if (ec != std::errc{} || end != number.data() + number.size() ||
+        value > 255)
+      return false;
+    camera = static_cast<CameraId>(value);
+  }
+  return !id.empty();
+}
+
+// "ID - Category (count)": the ID is everything before the last " - ".
+std::string_view lineId(const std::string &line) {
+  return std::string_view(line).substr(0, line.rfind(" - "));
+}
+} // namespace
+
+void IngestPipeline::StageCounters::Record(
+    std::size_t n, std::chrono::steady_clock::time_point queuedAt) {
+  const auto ns = static_cast<std::uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now() - queuedAt)
+          .count());
+  items.fetch_add(n, std::memory_order_relaxed);
+  batches.fetch_add(1, std::memory_order_relaxed);
+  latencyNs.fetch_add(ns, std::memory_order_relaxed);
+  std::uint64_t max = maxLatencyNs.load(std::memory_order_relaxed);
+  while (ns > max && !maxLatencyNs.compare_exchange_weak(max, ns)) {
+  }
+}
+
+void IngestPipeline::StageCounters::SeeDepth(std::size_t depth) {
+  std::size_t max = maxQueueDepth.load(std::memory_order_relaxed);
+  while (depth > max && !maxQueueDepth.compare_exchange_weak(max, depth)) {
+  }
+}
+
+IngestPipeline::IngestPipeline(PipelineConfig pipelineConfig)
+    : config{sanitize(pipelineConfig)} {
+  MonitorConfig shardConfig;
+  shardConfig.layout = config.layout; // plates arrive canonicalized already
+  for (std::size_t s = 0; s < config.shards; ++s) {
+    shards.push_back(
+        std::make_unique<CrossroadTrafficMonitoring>(config.period, shardConfig));
+    shards.back()->Start();
+  }
+  for (std::size_t d = 0; d < config.decoders; ++d) {
+    sourceQueues.push_back(std::make_unique<FrameQueue>(config.queueBatches));
+    decodedQueues.push_back(std::make_unique<SignalQueue>(config.queueBatches));
+  }
+  for (std::size_t q = 0; q < config.routers * config.shards; ++q)
+    routedQueues.push_back(std::make_unique<SignalQueue>(config.queueBatches));
+
+  for (std::size_t s = 0; s < config.shards; ++s)
+    applyThreads.emplace_back([this, s] { ApplyLoop(s); });
+  for (std::size_t r = 0; r < config.routers; ++r)
+    routerThreads.emplace_back([this, r] { RouteLoop(r); });
+  for (std::size_t d = 0; d < config.decoders; ++d)
+    decoderThreads.emplace_back([this, d] { DecodeLoop(d); });
+}
+
+IngestPipeline::~IngestPipeline() { Stop(); }
+
+template <typename T>
+bool IngestPipeline::Push(SpscQueue<Batch<T>> &queue, Batch<T> &batch,
+                          StageCounters &next,
+                          const std::atomic<bool> &abandon) {
+  batch.queuedAt = std::chrono::steady_clock::now();
+  while (!queue.TryPush(batch)) {
+    if (abandon.load(std::memory_order_acquire))
+      return false;
+    std::this_thread::yield(); // backpressure
+  }
+  next.SeeDepth(queue.Size());
+  batch = Batch<T>{};
+  return true;
+}
+
+bool IngestPipeline::Submit(std::size_t source,
+                            std::vector<std::string> frames) {
+  // Stop() waits for Submit() calls that got past `closed`, so whatever they
+  // queue still reaches a running decoder.
+  activeSubmits.fetch_add(1);
+  if (closed.load()) {
+    activeSubmits.fetch_sub(1);
+    return false;
+  }
+  const std::size_t count = frames.size();
+  Batch<std::string> batch{std::move(frames), {}};
+  const bool queued =
+      count == 0 || Push(*sourceQueues[source % config.decoders], batch,
+                         counters[stageIndex(PipelineStage::Decode)], closed);
+  if (queued)
+    submittedFrames.fetch_add(count, std::memory_order_relaxed);
+  activeSubmits.fetch_sub(1);
+  return queued;
+}
+
+void IngestPipeline::DecodeLoop(std::size_t decoder) {
+  FrameQueue &in = *sourceQueues[decoder];
+  SignalQueue &out = *decodedQueues[decoder];
+  StageCounters &stats = counters[stageIndex(PipelineStage::Decode)];
+  StageCounters &next = counters[stageIndex(PipelineStage::Route)];
+  Batch<std::string> frames;
+  std::string canonical;
+
+  runStage(stopStage[stageIndex(PipelineStage::Decode)], [&] {
+    if (!in.TryPop(frames))
+      return false;
+    Batch<DecodedSignal> decoded;
+    decoded.items.reserve(frames.items.size());
+    std::uint64_t malformed = 0, rejected = 0;
+    for (const std::string &frame : frames.items) {
+      DecodedSignal signal;
+      std::string_view id;
+      if (!parseFrame(frame, signal.category, id, signal.camera)) {
+        ++malformed;
+        continue;
+      }
+      if (config.canonicalizePlates) {
+        if (CanonicalizePlate(id, canonical) != PlateStatus::Ok) {
+          ++rejected;
+          continue;
+        }
+        signal.id = canonical;
+      } else {
+        signal.id = id;
+      }
+      decoded.items.push_back(std::move(signal));
+    }
+    malformedFrames.fetch_add(malformed, std::memory_order_relaxed);
+    rejectedPlates.fetch_add(rejected, std::memory_order_relaxed);
+    finishedFrames.fetch_add(malformed + rejected, std::memory_order_release);
+    stats.Record(frames.items.size(), frames.queuedAt);
+    if (!decoded.items.empty())
+      Push(out, decoded, next, stopStage[stageIndex(PipelineStage::Route)]);
+    return true;
+  });
+}
+
+std::size_t IngestPipeline::ShardFor(std::string_view id) const {
+  // Take the high bits of a multiplicative mix: the shard monitors index by
+  // the low bits of the same std::hash, which must stay evenly spread.
+  const std::uint64_t hash = std::hash<std::string_view>{}(id);
+  return static_cast<std::size_t>(((hash * 0x9E3779B97F4A7C15ull) >> 32) %
+                                  config.shards);
+}
+
+void IngestPipeline::RouteLoop(std::size_t router) {
+  StageCounters &stats = counters[stageIndex(PipelineStage::Route)];
+  StageCounters &next = counters[stageIndex(PipelineStage::Apply)];
+  const std::atomic<bool> &stopApply =
+      stopStage[stageIndex(PipelineStage::Apply)];
+  std::vector<Batch<DecodedSignal>> pending(config.shards);
+  Batch<DecodedSignal> decoded;
+
+  runStage(stopStage[stageIndex(PipelineStage::Route)], [&] {
+    bool worked = false;
+    for (std::size_t d = router; d < config.decoders; d += config.routers) {
+      if (!decodedQueues[d]->TryPop(decoded))
+        continue;
+      worked = true;
+      for (DecodedSignal &signal : decoded.items) {
+        const std::size_t shard = ShardFor(signal.id);
+        pending[shard].items.push_back(std::move(signal));
+        if (pending[shard].items.size() >= config.batchSize)
+          Push(*routedQueues[router * config.shards + shard], pending[shard],
+               next, stopApply);
+      }
+      // Hand over partial batches too, so latency stays bounded when quiet.
+      for (std::size_t s = 0; s < config.shards; ++s) {
+        if (!pending[s].items.empty())
+          Push(*routedQueues[router * config.shards + s], pending[s], next,
+               stopApply);
+      }
+      stats.Record(decoded.items.size(), decoded.queuedAt);
+    }
+    return worked;
+  });
+}
+
+void IngestPipeline::ApplyLoop(std::size_t shard) {
+  CrossroadTrafficMonitoring &monitor = *shards[shard];
+  StageCounters &stats = counters[stageIndex(PipelineStage::Apply)];
+  Batch<DecodedSignal> batch;
+
+  runStage(stopStage[stageIndex(PipelineStage::Apply)], [&] {
+    bool worked = false;
+    for (std::size_t r = 0; r < config.routers; ++r) {
+      if (!routedQueues[r * config.shards + shard]->TryPop(batch))
+        continue;
+      worked = true;
+      for (DecodedSignal &signal : batch.items) {
+        switch (signal.category) {
+        case VehicleCategory::Bicycle:
+          monitor.OnSignal(Bicycle(std::move(signal.id), signal.camera));
+          break;
+        case VehicleCategory::Car:
+          monitor.OnSignal(Car(std::move(signal.id), signal.camera));
+          break;
+        case VehicleCategory::Scooter:
+          monitor.OnSignal(Scooter(std::move(signal.id), signal.camera));
+          break;
+        }
+      }
+      stats.Record(batch.items.size(), batch.queuedAt);
+      finishedFrames.fetch_add(batch.items.size(), std::memory_order_release);
+    }
+    return worked;
+  });
+}
+
+void IngestPipeline::Flush() {
+  while (finishedFrames.load(std::memory_order_acquire) <
+         submittedFrames.load(std::memory_order_relaxed)) {
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+}
+
+void IngestPipeline::Stop() {
+  if (stopped)
+    return;
+  stopped = true;
+  closed.store(true);
+  while (activeSubmits.load() != 0)
+    std::this_thread::yield();
+  // Upstream first: a stage only stops once nothing can reach it anymore.
+  const std::array<std::vector<std::thread> *, kPipelineStageCount> stages{
+      &decoderThreads, &routerThreads, &applyThreads};
+  for (std::size_t s = 0; s < kPipelineStageCount; ++s) {
+    stopStage[s].store(true, std::memory_order_release);
+    for (auto &t : *stages[s])
+      t.join();
+  }
+}
+
+std::vector<std::string> IngestPipeline::GetStatistics() const {
+  // Shards hold disjoint plates, each list is alphabetical: merge by ID.
+  std::vector<std::string> merged;
+  for (const auto &shard : shards) {
+    std::vector<std::string> lines = shard->GetStatistics();
+    std::vector<std::string> next;
+    next.reserve(merged.size() + lines.size());
+    std::merge(std::make_move_iterator(merged.begin()),
+               std::make_move_iterator(merged.end()),
+               std::make_move_iterator(lines.begin()),
+               std::make_move_iterator(lines.end()), std::back_inserter(next),
+               [](const std::string &a, const std::string &b) {
+                 return lineId(a) < lineId(b);
+               });
+    merged = std::move(next);
+  }
+  return merged;
+}
+
+MonitorTotals IngestPipeline::GetTotals() const {
+  MonitorTotals sum;
+  for (const auto &shard : shards) {
+    const MonitorTotals t = shard->GetTotals();
+    sum.state = t.state;
+    sum.errorCount += t.errorCount;
+    for (std::size_t c = 0; c < kCategoryCount; ++c) {
+      sum.uniqueVehicles[c] += t.uniqueVehicles[c];
+      sum.sightings[c] += t.sightings[c];
+    }
+    sum.acceptedSignals += t.acceptedSignals;
+    sum.poolInUse += t.poolInUse;
+    sum.poolCapacity += t.poolCapacity;
+  }
+  return sum;
+}
+
+VehicleCount IngestPipeline::GetVehicleCount(const std::string &id) const {
+  std::string canonical;
+  if (config.canonicalizePlates) {
+    if (CanonicalizePlate(id, canonical) != PlateStatus::Ok)
+      return {};
+  } else {
+    canonical = id;
+  }
+  return shards[ShardFor(canonical)]->GetVehicleCount(canonical);
+}
+
+PipelineMetrics IngestPipeline::GetMetrics() const {
+  PipelineMetrics metrics;
+  for (std::size_t s = 0; s < kPipelineStageCount; ++s) {
+    const StageCounters &c = counters[s];
+    StageMetrics &m = metrics.stages[s];
+    m.items = c.items.load(std::memory_order_relaxed);
+    m.batches = c.batches.load(std::memory_order_relaxed);
+    m.maxQueueDepth = c.maxQueueDepth.load(std::memory_order_relaxed);
+    m.maxLatencyNs = c.maxLatencyNs.load(std::memory_order_relaxed);
+    m.meanLatencyNs =
+        m.batches ? c.latencyNs.load(std::memory_order_relaxed) / m.batches : 0;
+  }
+  for (const auto &q : sourceQueues)
+    metrics.stages[stageIndex(PipelineStage::Decode)].queueDepth += q->Size();
+  for (const auto &q : decodedQueues)
+    metrics.stages[stageIndex(PipelineStage::Route)].queueDepth += q->Size();
+  for (const auto &q : routedQueues)
+    metrics.stages[stageIndex(PipelineStage::Apply)].queueDepth += q->Size();
+  metrics.submittedFrames = submittedFrames.load(std::memory_order_relaxed);
+  metrics.malformedFrames = malformedFrames.load(std::memory_order_relaxed);
+  metrics.rejectedPlates = rejectedPlates.load(std::memory_order_relaxed);
+  metrics.appliedSignals =
+      metrics.stages[stageIndex(PipelineStage::Apply)].items;
+  return metrics;
+}
+
+} // namespace ctm
@@ -0,0 +1,169 @@
+#ifndef INGEST_PIPELINE_HPP
+#define INGEST_PIPELINE_HPP
+
+#include "CrossroadTrafficMonitoring.hpp"
+#include "SpscQueue.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace ctm // ctm == CrossRoad Traffic Monitoring
+{
+// Sizing of an IngestPipeline. Every stage scales on its own.
+struct PipelineConfig {
+  std::size_t decoders{2}; // = number of sources, see Submit()
+  std::size_t routers{1};
+  std::size_t shards{2}; // one monitor and one apply thread each
+  std::size_t batchSize{64};    // items per routed batch
+  std::size_t queueBatches{64}; // capacity of every queue, in batches
+  bool canonicalizePlates{true};
+  std::chrono::milliseconds period{std::chrono::minutes(10)}; // shard reset
+  StorageLayout layout{StorageLayout::PerCategory};
+};
+
+enum class PipelineStage { Decode, Route, Apply };
+static constexpr std::size_t kPipelineStageCount = 3;
+
+inline const char *ToString(PipelineStage stage) {
+  switch (stage) {
+  case PipelineStage::Decode:
+    return "Decode";
+  case PipelineStage::Route:
+    return "Route";
+  case PipelineStage::Apply:
+    return "Apply";
+  }
+  return "Unknown";
+}
+
+// Instrumentation of one stage. Latency is per batch, from being queued for
+// the stage until the stage is done with it (queue wait + processing).
+struct StageMetrics {
+  std::uint64_t items{0};
+  std::uint64_t batches{0};
+  std::size_t queueDepth{0};    // batches waiting in the stage's inputs now
+  std::size_t maxQueueDepth{0}; // highest depth seen by a producer
+  std::uint64_t meanLatencyNs{0};
+  std::uint64_t maxLatencyNs{0};
+};
+
+struct PipelineMetrics {
+  std::array<StageMetrics, kPipelineStageCount> stages{}; // by PipelineStage
+  std::uint64_t submittedFrames{0};
+  std::uint64_t malformedFrames{0}; // not "Category,ID[,camera]"
+  std::uint64_t rejectedPlates{0};  // see canonicalizePlates
+  std::uint64_t appliedSignals{0};
+};
+
+//-----------------------------------------------------------
+// Staged ingestion for high-volume sites:
+//
+//   Submit(source) -> decoder -> router -> apply (one per shard) -> monitor
+//
+//    - Decoders parse text frames "Category,ID[,camera]" (e.g.
+//      "Car,ab-123,4") and canonicalize plates.
+//    - Routers hash plates to shards, so every plate is counted by exactly
+//      one shard monitor.
+//    - Apply threads are the only writers of their shard's monitor.
+//
+// Stages are connected by SpscQueues of batches: decoder d feeds router
+// d % routers, every router has one queue per shard. A full queue blocks
+// its producer (backpressure up to Submit()).
+//-----------------------------------------------------------
+class IngestPipeline {
+public:
+  explicit IngestPipeline(PipelineConfig config = {});
+  ~IngestPipeline(); // Stop()
+
+  // Queue frames for decoder `source` (< decoders). Each source must be fed
+  // by one thread at a time. Blocks while the decoder's queue is full.
+  // Returns false, dropping the frames, once Stop() has begun.
+  bool Submit(std::size_t source, std::vector<std::string> frames);
+
+  // Wait until every frame submitted so far has been applied or dropped.
+  void Flush();
+
+  // Drain everything and stop all stage threads. Queries keep working.
+  // Blocked Submit() calls return false.
+  void Stop();
+
+  std::size_t ShardCount() const { return shards.size(); }
+  std::size_t ShardFor(std::string_view id) const;
+  const CrossroadTrafficMonitoring &Shard(std::size_t shard) const {
+    return *shards[shard];
+  }
+
+  // All shards merged: alphabetical statistics, summed totals, and the
+  // counts of one plate (canonicalized like the frames).
+  std::vector<std::string> GetStatistics() const;
+  MonitorTotals GetTotals() const;
+  VehicleCount GetVehicleCount(const std::string &id) const;
+
+  PipelineMetrics GetMetrics() const;
+
+private:
+  struct DecodedSignal {
+    VehicleCategory category{VehicleCategory::Bicycle};
+    CameraId camera{0};
+    std::string id;
+  };
+
+  template <typename T> struct Batch {
+    std::vector<T> items;
+    std::chrono::steady_clock::time_point queuedAt{};
+  };
+  using FrameQueue = SpscQueue<Batch<std::string>>;
+  using SignalQueue = SpscQueue<Batch<DecodedSignal>>;
+
+  struct alignas(64) StageCounters {
+    std::atomic<std::uint64_t> items{0};
+    std::atomic<std::uint64_t> batches{0};
+    std::atomic<std::uint64_t> latencyNs{0};
+    std::atomic<std::uint64_t> maxLatencyNs{0};
+    std::atomic<std::size_t> maxQueueDepth{0};
+
+    void Record(std::size_t n, std::chrono::steady_clock::time_point queuedAt);
+    void SeeDepth(std::size_t depth);
+  };
+
+  // Wait for room in `queue`; false if `abandon` is set first (the batch is
+  // left as it is).
+  template <typename T>
+  bool Push(SpscQueue<Batch<T>> &queue, Batch<T> &batch, StageCounters &next,
+            const std::atomic<bool> &abandon);
+
+  void DecodeLoop(std::size_t decoder);
+  void RouteLoop(std::size_t router);
+  void ApplyLoop(std::size_t shard);
+
+  const PipelineConfig config;
+  std::vector<std::unique_ptr<CrossroadTrafficMonitoring>> shards;
+
+  std::vector<std::unique_ptr<FrameQueue>> sourceQueues;  // [decoder]
+  std::vector<std::unique_ptr<SignalQueue>> decodedQueues; // [decoder]
+  std::vector<std::unique_ptr<SignalQueue>> routedQueues; // [router*shards+s]
+
+  std::array<StageCounters, kPipelineStageCount> counters;
+  std::atomic<std::uint64_t> submittedFrames{0};
+  std::atomic<std::uint64_t> finishedFrames{0}; // applied or dropped
+  std::atomic<std::uint64_t> malformedFrames{0};
+  std::atomic<std::uint64_t> rejectedPlates{0};
+
+  // Stages stop in order, each after the one feeding it has exited.
+  std::array<std::atomic<bool>, kPipelineStageCount> stopStage{};
+  std::atomic<bool> closed{false}; // Stop() has begun, Submit() refuses
+  std::atomic<std::size_t> activeSubmits{0};
+  std::vector<std::thread> decoderThreads, routerThreads, applyThreads;
+  bool stopped{false};
+};
+
+} // namespace ctm
+
+#endif // INGEST_PIPELINE_HPP
@@ -0,0 +1,176 @@
+#include "KnownPlates.hpp"
+#include "PlateCanonicalizer.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <functional>
+#include <limits>
+
+namespace ctm // ctm == CrossRoad Traffic Monitoring
+{
+
+namespace {
+// Stored plates carry a one byte length.
+constexpr std::size_t kMaxKnownLength = std::numeric_limits<std::uint8_t>::max();
+
+std::uint64_t hashPlate(std::string_view plate) {
+  return std::hash<std::string_view>{}(plate);
+}
+
+// Position of a key in level `level` (of `size` bits): an independent hash
+// per level, mapped onto [0, size) with a multiply instead of a modulo.
+std::uint64_t levelPosition(std::uint64_t hash, std::size_t level,
+                            std::uint64_t size) {
+  std::uint64_t h = hash + (level + 1) * 0x9e3779b97f4a7c15ULL;
+  h ^= h >> 30;
+  h *= 0xbf58476d1ce4e5b9ULL;
+  h ^= h >> 27;
+  h *= 0x94d049bb133111ebULL;
+  h ^= h >> 31;
+#if defined(__SIZEOF_INT128__)
+  return static_cast<std::uint64_t>(
+      (static_cast<unsigned __int128>(h) * size) >> 64);
+#else
+  return h % size;
+#endif
+}
+} // namespace
+
+KnownPlates::KnownPlates(const std::vector<std::string> &plates,
+                         bool canonicalize)
+    : canonical{canonicalize} {
+  // Canonical, sorted, unique plates: their order is the alphabetical one.
+  std::vector<std::string> keys;
+  keys.reserve(plates.size());
+  std::string canonicalPlate;
+  for (const std::string &raw : plates) {
+    const std::string *plate = &raw;
+    if (canonical) {
+      if (CanonicalizePlate(raw, canonicalPlate) != PlateStatus::Ok) {
+        ++skipped;
+        continue;
+      }
+      plate = &canonicalPlate;
+    }
+    if (plate->empty() || plate->size() > kMaxKnownLength) {
+      ++skipped;
+      continue;
+    }
+    keys.push_back(*plate);
+  }
+  std::sort(keys.begin(), keys.end());
+  const auto last = std::unique(keys.begin(), keys.end());
+  skipped += static_cast<std::size_t>(keys.end() - last);
+  keys.erase(last, keys.end());
+  const std::size_t n = keys.size();
+
+  std::vector<std::uint64_t> hashes(n);
+  std::vector<std::uint32_t> pending(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    hashes[i] = hashPlate(keys[i]);
+    pending[i] = static_cast<std::uint32_t>(i);
+  }
+
+  // Levels: keys alone on their bit stay, the others try the next level.
+  std::uint64_t offset = 0;
+  std::vector<std::uint64_t> collided;
+  for (std::size_t l = 0; l < kMaxLevels && !pending.empty(); ++l) {
+    const std::uint64_t size =
+        std::max<std::uint64_t>(64, (pending.size() * 2 + 63) / 64 * 64);
+    levels.push_back(Level{offset, size});
+    bits.resize((offset + size) / 64, 0);
+    std::uint64_t *level = &bits[offset / 64];
+    collided.assign(size / 64, 0);
+    for (std::uint32_t k : pending) {
+      const std::uint64_t pos = levelPosition(hashes[k], l, size);
+      const std::uint64_t mask = std::uint64_t{1} << (pos & 63);
+      if (level[pos >> 6] & mask)
+        collided[pos >> 6] |= mask;
+      level[pos >> 6] |= mask;
+    }
+    for (std::size_t w = 0; w < size / 64; ++w)
+      level[w] &= ~collided[w];
+    std::erase_if(pending, [&](std::uint32_t k) {
+      const std::uint64_t pos = levelPosition(hashes[k], l, size);
+      return !(collided[pos >> 6] & (std::uint64_t{1} << (pos & 63)));
+    });
+    offset += size;
+  }
+
+  ranks.resize(bits.size());
+  std::uint64_t placed = 0;
+  for (std::size_t w = 0; w < bits.size(); ++w) {
+    ranks[w] = static_cast<std::uint32_t>(placed);
+    placed += static_cast<std::uint64_t>(std::popcount(bits[w]));
+  }
+  for (std::uint32_t k : pending) // after the last level, numbered last
+    leftovers.emplace_back(hashes[k], static_cast<std::uint32_t>(placed++));
+  std::sort(leftovers.begin(), leftovers.end());
+
+  plateSlots.resize(n);
+  alphabetical.resize(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    const std::uint32_t index = Lookup(hashes[i]);
+    alphabetical[i] = index;
+    PlateSlot &slot = plateSlots[index];
+    const std::string &plate = keys[i];
+    if (plate.size() < kSlotSize) {
+      slot.bytes[0] = static_cast<char>(plate.size());
+      std::memcpy(slot.bytes + 1, plate.data(), plate.size());
+      continue;
+    }
+    const auto offset = static_cast<std::uint32_t>(arena.size());
+    slot.bytes[0] = static_cast<char>(kLongPlate);
+    std::memcpy(slot.bytes + 4, &offset, sizeof(offset));
+    arena.push_back(static_cast<char>(plate.size()));
+    arena.insert(arena.end(), plate.begin(), plate.end());
+  }
+}
+
+std::uint32_t KnownPlates::Lookup(std::uint64_t hash) const {
+  for (std::size_t l = 0; l < levels.size(); ++l) {
+    const std::uint64_t bit =
+        levels[l].bitOffset + levelPosition(hash, l, levels[l].size);
+    if (TestBit(bit))
+      return static_cast<std::uint32_t>(Rank(bit));
+  }
+  const auto it = std::lower_bound(
+      leftovers.begin(), leftovers.end(),
+      std::pair<std::uint64_t, std::uint32_t>{hash, 0});
+  return it != leftovers.end() && it->first == hash ? it->second : npos;
+}
+
+std::uint32_t KnownPlates::Find(std::string_view plate) const {
+  if (plate.empty() || plate.size() > kMaxKnownLength)
+    return npos;
+  const std::uint32_t index = Lookup(hashPlate(plate));
+  if (index == npos || Plate(index) != plate)
+    return npos;
+  return index;
+}
+
+std::string_view KnownPlates::Plate(std::uint32_t index) const {
+  const char *p = plateSlots[index].bytes;
+  if (static_cast<std::uint8_t>(p[0]) == kLongPlate) {
+    std::uint32_t offset;
+    std::memcpy(&offset, p + 4, sizeof(offset));
+    p = &arena[offset];
+  }
+  return {p + 1, static_cast<std::uint8_t>(p[0])};
+}
+
+std::size_t KnownPlates::HashBits() const {
+  return bits.size() * 64 + ranks.size() * 32 +
+         leftovers.size() * sizeof(leftovers[0]) * 8;
+}
+
+std::size_t KnownPlates::MemoryBytes() const {
+  return sizeof(*this) + levels.capacity() * sizeof(Level) +
+         bits.capacity() * sizeof(std::uint64_t) +
+         ranks.capacity() * sizeof(std::uint32_t) +
+         leftovers.capacity() * sizeof(leftovers[0]) +
+         plateSlots.capacity() * sizeof(PlateSlot) + arena.capacity() +
+         alphabetical.capacity() * sizeof(std::uint32_t);
+}
+
+} // namespace ctm
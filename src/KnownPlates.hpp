@@ -0,0 +1,95 @@
+#ifndef KNOWN_PLATES_HPP
+#define KNOWN_PLATES_HPP
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace ctm // ctm == CrossRoad Traffic Monitoring
+{
+//-----------------------------------------------------------
+// Dictionary of a registered fleet's plates (depots, campus gates), built
+// once at startup and then only read, see MonitorConfig::knownPlates.
+//
+// Every plate gets a dense index in [0, Size()) from a BBHash-style minimal
+// perfect hash:
+//    - Level i is a bit array of 2x the keys still unplaced. Each key sets
+//      the bit at its level-i hash; keys that collide move on to level i+1.
+//    - A key's index is the number of set bits before its bit (rank, kept
+//      per 64-bit word), so all levels together number the keys 0..n-1.
+//    - The few keys left after the last level are looked up by hash.
+// Find() is one hash, a bit probe per level tried (1.6 on average), one
+// popcount and a single compare against the plate stored in the index's
+// 16-byte slot (an unlisted plate also maps to some index, the compare
+// rejects it). About 5 bits per plate for the hash itself.
+//-----------------------------------------------------------
+class KnownPlates {
+public:
+  static constexpr std::uint32_t npos = UINT32_MAX;
+
+  // With `canonicalize`, plates are canonicalized (see PlateCanonicalizer)
+  // and malformed ones skipped; use the monitor's canonicalizePlates setting.
+  explicit KnownPlates(const std::vector<std::string> &plates,
+                       bool canonicalize = true);
+
+  // Index of `plate`, or npos if it is not listed. `plate` must already be
+  // in the list's form.
+  std::uint32_t Find(std::string_view plate) const;
+
+  std::string_view Plate(std::uint32_t index) const;
+
+  // Indices ordered by plate, for alphabetical statistics.
+  const std::vector<std::uint32_t> &Alphabetical() const {
+    return alphabetical;
+  }
+
+  bool Canonical() const { return canonical; }
+  std::size_t Size() const { return alphabetical.size(); }
+  std::size_t SkippedCount() const { return skipped; } // malformed, duplicate
+  std::size_t MemoryBytes() const;
+  std::size_t HashBits() const; // bits and rank samples of the perfect hash
+
+private:
+  static constexpr std::size_t kMaxLevels = 24;
+
+  struct Level {
+    std::uint64_t bitOffset{0}; // into bits
+    std::uint64_t size{0};      // bits in this level
+  };
+
+  bool TestBit(std::uint64_t bit) const {
+    return (bits[bit >> 6] >> (bit & 63)) & 1;
+  }
+  std::uint64_t Rank(std::uint64_t bit) const { // set bits before `bit`
+    const std::uint64_t below = (std::uint64_t{1} << (bit & 63)) - 1;
+    return ranks[bit >> 6] +
+           static_cast<std::uint64_t>(std::popcount(bits[bit >> 6] & below));
+  }
+  std::uint32_t Lookup(std::uint64_t hash) const; // unverified index
+
+  bool canonical;
+  std::size_t skipped{0};
+  std::vector<Level> levels;
+  std::vector<std::uint64_t> bits;
+  std::vector<std::uint32_t> ranks; // set bits before each word
+  std::vector<std::pair<std::uint64_t, std::uint32_t>> leftovers; // hash, idx
+
+  // By index: length + plate inline when it fits (every canonical plate
+  // does), otherwise kLongPlate + offset of length byte + plate in `arena`.
+  static constexpr std::size_t kSlotSize = 16;
+  static constexpr std::uint8_t kLongPlate = 0xff;
+  struct PlateSlot {
+    char bytes[kSlotSize];
+  };
+  std::vector<PlateSlot> plateSlots;
+  std::vector<char> arena;
+  std::vector<std::uint32_t> alphabetical;
+};
+
+} // namespace ctm
+
+#endif // KNOWN_PLATES_HPP
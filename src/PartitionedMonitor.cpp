@@ -0,0 +1,548 @@
+#include "PartitionedMonitor.hpp"
+#include "PlateCanonicalizer.hpp"
+#include "ResetScheduler.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <system_error>
+#include <unistd.h>
+
+namespace ctm // ctm == CrossRoad Traffic Monitoring
+{
+//-----------------------------------------------------------
+// Wire protocol, host byte order (both ends are the same binary):
+//    request: u32 size, op byte, payload (size - 1 bytes)
+//    reply:   u32 size, payload (queries only)
+// Requests are applied in order, so a query reply covers every earlier
+// request on the same socket.
+//-----------------------------------------------------------
+namespace {
+enum Op : char {
+  OpSignals = 'S', // (u8 category, u8 camera, u16 length, ID) * n
+  OpStart = 'B',
+  OpStop = 'P',
+  OpReset = 'R',
+  OpError = 'E',
+  OpExport = 'X', // reply: (u8 category, u32 count, u16 length, ID) * n,
+                  // alphabetical
+  OpTotals = 'T', // reply: MonitorTotals
+  OpCount = 'C',  // payload: ID; reply: VehicleCount
+  OpImport = 'I', // (u8 category, u32 count, u16 length, ID) * n
+  OpErase = 'D',  // (u16 length, ID) * n
+  OpQuit = 'Z'
+};
+
+template <typename T> void put(std::string &out, T value) {
+  out.append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+template <typename T> bool get(std::string_view &in, T &value) {
+  if (in.size() < sizeof(value))
+    return false;
+  std::memcpy(&value, in.data(), sizeof(value));
+  in.remove_prefix(sizeof(value));
+  return true;
+}
+
+bool getId(std::string_view &in, std::string_view &id) {
+  std::uint16_t length = 0;
+  if (!get(in, length) || in.size() < length)
+    return false;
+  id = in.substr(0, length);
+  in.remove_prefix(length);
+  return true;
+}
+
+void putId(std::string &out, std::string_view id) {
+  const auto length =
+      static_cast<std::uint16_t>(std::min<std::size_t>(id.size(), UINT16_MAX));
+  put(out, length);
+  out.append(id.data(), length);
+}
+
+void putVehicle(std::string &out, const VehicleStats &vehicle) {
+  put(out, static_cast<std::uint8_t>(vehicle.category));
+  put(out, static_cast<std::uint32_t>(vehicle.count));
+  putId(out, vehicle.id);
+}
+
+std::vector<VehicleStats> getVehicles(std::string_view in) {
+  std::vector<VehicleStats> vehicles;
+  std::uint8_t cat = 0;
+  std::uint32_t count = 0;
+  std::string_view id;
+  while (get(in, cat) && get(in, count) && getId(in, id) &&
+         cat < kCategoryCount)
+    vehicles.push_back(
+        VehicleStats{std::string(id), static_cast<VehicleCategory>(cat), count});
+  return vehicles;
+}
+
+bool writeAll(int fd, const char *data, std::size_t size) {
+  while (size > 0) {
+    const ssize_t n = ::send(fd, data, size, MSG_NOSIGNAL);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      return false;
+    data += n;
+    size -= static_cast<std::size_t>(n);
+  }
+  return true;
+}
+
+bool readAll(int fd, char *data, std::size_t size) {
+  while (size > 0) {
+    const ssize_t n = ::read(fd, data, size);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      return false;
+    data += n;
+    size -= static_cast<std::size_t>(n);
+  }
+  return true;
+}
+
+// One framed message (a request's op and payload, or a reply).
+bool readMessage(int fd, std::string &message) {
+  std::uint32_t size = 0;
+  if (!readAll(fd, reinterpret_cast<char *>(&size), sizeof(size)))
+    return false;
+  message.resize(size);
+  return readAll(fd, message.data(), size);
+}
+
+bool writeMessage(int fd, std::string_view head, std::string_view body) {
+  const auto size = static_cast<std::uint32_t>(head.size() + body.size());
+  return writeAll(fd, reinterpret_cast<const char *>(&size), sizeof(size)) &&
+         writeAll(fd, head.data(), head.size()) &&
+         writeAll(fd, body.data(), body.size());
+}
+
+//-----------------------------------------------------------
+// Worker process
+//-----------------------------------------------------------
+class PartitionWorker {
+public:
+  explicit PartitionWorker(const PartitionConfig &config) {
+    SchedulerConfig schedulerConfig;
+    schedulerConfig.alignToWallClock = true;
+    scheduler = std::make_unique<ResetScheduler>(schedulerConfig);
+    MonitorConfig monitorConfig;
+    monitorConfig.layout = config.layout;
+    monitorConfig.resetScheduler = scheduler.get();
+    monitor = std::make_unique<CrossroadTrafficMonitoring>(config.period,
+                                                           monitorConfig);
+  }
+
+  void Serve(int fd) {
+    std::string message;
+    while (readMessage(fd, message) && !message.empty()) {
+      const char op = message[0];
+      std::string_view payload(message);
+      payload.remove_prefix(1);
+      std::string reply;
+      switch (op) {
+      case OpSignals:
+        ApplySignals(payload);
+        break;
+      case OpStart:
+        monitor->Start();
+        break;
+      case OpStop:
+        monitor->Stop();
+        break;
+      case OpReset:
+        monitor->Reset();
+        break;
+      case OpError:
+        monitor->OnSignal();
+        break;
+      case OpExport:
+        for (const VehicleStats &vehicle : monitor->ExportVehicles())
+          putVehicle(reply, vehicle);
+        break;
+      case OpTotals:
+        put(reply, monitor->GetTotals());
+        break;
+      case OpCount:
+        put(reply, monitor->GetVehicleCount(std::string(payload)));
+        break;
+      case OpImport:
+        monitor->ImportVehicles(getVehicles(payload));
+        break;
+      case OpErase: {
+        std::vector<std::string> ids;
+        std::string_view id;
+        while (getId(payload, id))
+          ids.emplace_back(id);
+        monitor->EraseVehicles(ids);
+        break;
+      }
+      case OpQuit:
+        return;
+      }
+      if ((op == OpExport || op == OpTotals || op == OpCount) &&
+          !writeMessage(fd, reply, {}))
+        return;
+    }
+  }
+
+private:
+  void ApplySignals(std::string_view in) {
+    std::uint8_t cat = 0, camera = 0;
+    std::string_view id;
+    std::string buffer;
+    while (get(in, cat) && get(in, camera) && getId(in, id)) {
+      buffer.assign(id);
+      switch (static_cast<VehicleCategory>(cat)) {
+      case VehicleCategory::Bicycle:
+        monitor->OnSignal(Bicycle(buffer, camera));
+        break;
+      case VehicleCategory::Car:
+        monitor->OnSignal(Car(buffer, camera));
+        break;
+      case VehicleCategory::Scooter:
+        monitor->OnSignal(Scooter(buffer, camera));
+        break;
+      }
+    }
+  }
+
+  std::unique_ptr<ResetScheduler> scheduler;
+  std::unique_ptr<CrossroadTrafficMonitoring> monitor;
+};
+} // namespace
+
+//-----------------------------------------------------------
+// Coordinator
+//-----------------------------------------------------------
+PartitionedMonitor::PartitionedMonitor(PartitionConfig config)
+    : config{config}, ring{config.virtualNodes} {
+  std::lock_guard<std::mutex> lock(partitionMutex);
+  for (std::size_t w = 0; w < std::max<std::size_t>(1, config.workers); ++w)
+    SpawnLocked(nextWorkerId++);
+}
+
+PartitionedMonitor::~PartitionedMonitor() {
+  std::lock_guard<std::mutex> lock(partitionMutex);
+  for (Worker &worker : workers)
+    StopWorkerLocked(worker);
+}
+
+void PartitionedMonitor::SpawnLocked(std::uint32_t id) {
+  int sockets[2];
+  if (::socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0)
+    throw std::system_error(errno, std::generic_category(), "socketpair");
+  std::fflush(nullptr); // or the child would flush our buffers again
+  const pid_t pid = ::fork();
+  if (pid < 0) {
+    const int error = errno;
+    ::close(sockets[0]);
+    ::close(sockets[1]);
+    throw std::system_error(error, std::generic_category(), "fork");
+  }
+  if (pid == 0) {
+    // Worker: keep only its own socket, so the others see EOF when the
+    // coordinator goes away.
+    ::close(sockets[0]);
+    for (const Worker &other : workers)
+      ::close(other.fd);
+    {
+      PartitionWorker worker(config);
+      worker.Serve(sockets[1]);
+    }
+    ::_exit(0); // no atexit handlers or stdio of the coordinator
+  }
+  ::close(sockets[1]);
+  Worker worker;
+  worker.id = id;
+  worker.pid = pid;
+  worker.fd = sockets[0];
+  workers.push_back(std::move(worker));
+  ring.AddNode(id);
+  stats.workers = workers.size();
+
+  // Follow the other workers' state.
+  if (control != State::Init)
+    SendLocked(workers.back(), OpStart, {});
+  if (control == State::Stopped)
+    SendLocked(workers.back(), OpStop, {});
+}
+
+void PartitionedMonitor::StopWorkerLocked(Worker &worker) {
+  if (worker.fd < 0)
+    return;
+  FlushLocked(worker);
+  SendLocked(worker, OpQuit, {});
+  ::close(worker.fd);
+  worker.fd = -1;
+  int status = 0;
+  while (::waitpid(worker.pid, &status, 0) < 0 && errno == EINTR) {
+  }
+}
+
+PartitionedMonitor::Worker &
+PartitionedMonitor::WorkerLocked(std::uint32_t id) const {
+  return *std::lower_bound(
+      workers.begin(), workers.end(), id,
+      [](const Worker &w, std::uint32_t target) { return w.id < target; });
+}
+
+void PartitionedMonitor::SendLocked(Worker &worker, char op,
+                                    std::string_view payload) const {
+  // A worker that died loses what is sent to it; queries then see it empty.
+  writeMessage(worker.fd, std::string_view(&op, 1), payload);
+}
+
+void PartitionedMonitor::FlushLocked(Worker &worker) const {
+  if (worker.pendingSignals == 0)
+    return;
+  SendLocked(worker, OpSignals, worker.pending);
+  stats.signalsSent += worker.pendingSignals;
+  ++stats.batchesSent;
+  worker.pending.clear();
+  worker.pendingSignals = 0;
+}
+
+std::string PartitionedMonitor::QueryLocked(Worker &worker, char op,
+                                            std::string_view payload) const {
+  FlushLocked(worker);
+  SendLocked(worker, op, payload);
+  std::string reply;
+  if (!readMessage(worker.fd, reply))
+    reply.clear();
+  return reply;
+}
+
+void PartitionedMonitor::BroadcastLocked(char op) {
+  for (Worker &worker : workers) {
+    FlushLocked(worker);
+    SendLocked(worker, op, {});
+  }
+}
+
+void PartitionedMonitor::Start() {
+  std::lock_guard<std::mutex> lock(partitionMutex);
+  if (control == State::Init)
+    control = State::Active;
+  BroadcastLocked(OpStart);
+}
+
+void PartitionedMonitor::Stop() {
+  std::lock_guard<std::mutex> lock(partitionMutex);
+  if (control == State::Active)
+    control = State::Stopped;
+  BroadcastLocked(OpStop);
+}
+
+void PartitionedMonitor::Reset() {
+  std::lock_guard<std::mutex> lock(partitionMutex);
+  control = State::Active;
+  BroadcastLocked(OpReset);
+}
+
+void PartitionedMonitor::OnSignal() {
+  std::lock_guard<std::mutex> lock(partitionMutex);
+  BroadcastLocked(OpError);
+}
+
+void PartitionedMonitor::OnSignal(const Bicycle &b) {
+  Route(VehicleCategory::Bicycle, b.id, b.camera);
+}
+void PartitionedMonitor::OnSignal(const Car &c) {
+  Route(VehicleCategory::Car, c.id, c.camera);
+}
+void PartitionedMonitor::OnSignal(const Scooter &s) {
+  Route(VehicleCategory::Scooter, s.id, s.camera);
+}
+
+void PartitionedMonitor::Route(VehicleCategory cat, const std::string &id,
+                                     CameraId camera) {
+  std::string canonical; // fits the small string buffer, no allocation
+  std::string_view plate = id;
+  if (config.canonicalizePlates) {
+    if (CanonicalizePlate(id, canonical) != PlateStatus::Ok) {
+      std::lock_guard<std::mutex> lock(partitionMutex);
+      ++stats.rejectedPlates;
+      return;
+    }
+    plate = canonical;
+  }
+  std::lock_guard<std::mutex> lock(partitionMutex);
+  Worker &worker = WorkerLocked(ring.NodeFor(plate));
+  put(worker.pending, static_cast<std::uint8_t>(cat));
+  put(worker.pending, camera);
+  putId(worker.pending, plate);
+  if (++worker.pendingSignals >= config.batchSize)
+    FlushLocked(worker);
+}
+
+void PartitionedMonitor::Flush() {
+  std::lock_guard<std::mutex> lock(partitionMutex);
+  for (Worker &worker : workers)
+    FlushLocked(worker);
+}
+
+std::vector<std::string> PartitionedMonitor::GetStatistics() const {
+  std::lock_guard<std::mutex> lock(partitionMutex);
+  // Ask every worker first, so they export in parallel.
+  for (Worker &worker : workers) {
+    FlushLocked(worker);
+    SendLocked(worker, OpExport, {});
+  }
+  // Workers hold disjoint plates, each list is alphabetical: merge by ID.
+  std::vector<VehicleStats> merged;
+  std::string reply;
+  for (Worker &worker : workers) {
+    std::vector<VehicleStats> vehicles;
+    if (readMessage(worker.fd, reply))
+      vehicles = getVehicles(reply);
+    std::vector<VehicleStats> next;
+    next.reserve(merged.size() + vehicles.size());
+    std::merge(std::make_move_iterator(merged.begin()),
+               std::make_move_iterator(merged.end()),
+               std::make_move_iterator(vehicles.begin()),
+               std::make_move_iterator(vehicles.end()),
+               std::back_inserter(next),
+               [](const VehicleStats &a, const VehicleStats &b) {
+                 return a.id < b.id;
+               });
+    merged = std::move(next);
+  }
+  std::vector<std::string> lines;
+  lines.reserve(merged.size());
+  for (const VehicleStats &s : merged)
+    lines.push_back(s.id + " - " + ToString(s.category) + " (" +
+                    std::to_string(s.count) + ")");
+  return lines;
+}
+
+MonitorTotals PartitionedMonitor::GetTotals() const {
+  std::lock_guard<std::mutex> lock(partitionMutex);
+  MonitorTotals sum;
+  unsigned localErrors = 0;
+  for (Worker &worker : workers) {
+    const std::string reply = QueryLocked(worker, OpTotals);
+    MonitorTotals t;
+    std::string_view in(reply);
+    if (!get(in, t))
+      continue;
+    sum.state = t.state;
+    // Camera errors are broadcast, every worker counts each one; the rest
+    // (signals in Error state, a full pool) happened on this worker only.
+    sum.cameraErrors = std::max(sum.cameraErrors, t.cameraErrors);
+    localErrors += t.errorCount - t.cameraErrors;
+    for (std::size_t c = 0; c < kCategoryCount; ++c) {
+      sum.uniqueVehicles[c] += t.uniqueVehicles[c];
+      sum.sightings[c] += t.sightings[c];
+    }
+    sum.acceptedSignals += t.acceptedSignals;
+    sum.poolInUse += t.poolInUse;
+    sum.poolIdle += t.poolIdle;
+    sum.poolCapacity += t.poolCapacity;
+  }
+  sum.errorCount = sum.cameraErrors + localErrors;
+  return sum;
+}
+
+VehicleCount PartitionedMonitor::GetVehicleCount(const std::string &id) const {
+  std::string canonical;
+  if (config.canonicalizePlates) {
+    if (CanonicalizePlate(id, canonical) != PlateStatus::Ok)
+      return {};
+  } else {
+    canonical = id;
+  }
+  std::lock_guard<std::mutex> lock(partitionMutex);
+  const std::string reply =
+      QueryLocked(WorkerLocked(ring.NodeFor(canonical)), OpCount, canonical);
+  VehicleCount count;
+  std::string_view in(reply);
+  get(in, count);
+  return count;
+}
+
+void PartitionedMonitor::HandOffLocked(Worker &from) {
+  const std::vector<VehicleStats> vehicles =
+      getVehicles(QueryLocked(from, OpExport));
+  std::vector<std::string> imports(workers.size()); // by worker position
+  std::string erase;
+  std::uint64_t moved = 0;
+  const std::string *previous = nullptr;
+  for (const VehicleStats &vehicle : vehicles) {
+    const std::uint32_t owner = ring.NodeFor(vehicle.id);
+    if (owner == from.id)
+      continue;
+    putVehicle(
+        imports[static_cast<std::size_t>(&WorkerLocked(owner) - &workers[0])],
+        vehicle);
+    // the entries of one ID are adjacent
+    if (!previous || vehicle.id != *previous) {
+      putId(erase, vehicle.id);
+      ++moved;
+      previous = &vehicle.id;
+    }
+  }
+  if (moved == 0)
+    return;
+  SendLocked(from, OpErase, erase);
+  for (std::size_t w = 0; w < workers.size(); ++w) {
+    if (imports[w].empty())
+      continue;
+    FlushLocked(workers[w]);
+    SendLocked(workers[w], OpImport, imports[w]);
+  }
+  stats.platesMoved += moved;
+}
+
+std::uint32_t PartitionedMonitor::AddWorker() {
+  std::lock_guard<std::mutex> lock(partitionMutex);
+  const std::uint32_t id = nextWorkerId++;
+  SpawnLocked(id);
+  for (Worker &worker : workers) {
+    if (worker.id != id)
+      HandOffLocked(worker);
+  }
+  return id;
+}
+
+bool PartitionedMonitor::RemoveWorker(std::uint32_t id) {
+  std::lock_guard<std::mutex> lock(partitionMutex);
+  const auto it = std::find_if(workers.begin(), workers.end(),
+                               [id](const Worker &w) { return w.id == id; });
+  if (it == workers.end() || workers.size() == 1)
+    return false;
+  ring.RemoveNode(id);
+  HandOffLocked(*it); // every plate of it moves
+  StopWorkerLocked(*it);
+  workers.erase(it);
+  stats.workers = workers.size();
+  return true;
+}
+
+std::vector<std::uint32_t> PartitionedMonitor::Workers() const {
+  std::lock_guard<std::mutex> lock(partitionMutex);
+  std::vector<std::uint32_t> ids;
+  for (const Worker &worker : workers)
+    ids.push_back(worker.id);
+  return ids;
+}
+
+std::uint32_t PartitionedMonitor::WorkerFor(std::string_view id) const {
+  std::lock_guard<std::mutex> lock(partitionMutex);
+  return ring.NodeFor(id);
+}
+
+PartitionStats PartitionedMonitor::GetStats() const {
+  std::lock_guard<std::mutex> lock(partitionMutex);
+  return stats;
+}
+
+} // namespace ctm
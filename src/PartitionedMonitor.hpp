@@ -0,0 +1,130 @@
+#ifndef PARTITIONED_MONITOR_HPP
+#define PARTITIONED_MONITOR_HPP
+
+#include "ConsistentHashRing.hpp"
+#include "CrossroadTrafficMonitoring.hpp"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <sys/types.h>
+#include <vector>
+
+namespace ctm // ctm == CrossRoad Traffic Monitoring
+{
+struct PartitionConfig {
+  std::size_t workers{4};       // processes started by the constructor
+  std::size_t virtualNodes{160}; // ring points per worker
+  // Reset period of every worker, aligned to the wall clock so workers
+  // added later reset together with the others.
+  std::chrono::milliseconds period{std::chrono::minutes(10)};
+  bool canonicalizePlates{true};
+  StorageLayout layout{StorageLayout::PerCategory};
+  std::size_t batchSize{256}; // signals buffered per worker before a send
+};
+
+struct PartitionStats {
+  std::size_t workers{0};
+  std::uint64_t signalsSent{0};
+  std::uint64_t batchesSent{0};
+  std::uint64_t platesMoved{0}; // by AddWorker / RemoveWorker
+  unsigned rejectedPlates{0};   // see canonicalizePlates
+};
+
+//-----------------------------------------------------------
+// Partitioned deployment for districts with more plates than one process
+// holds. The coordinator forks N local worker processes, each running its
+// own monitor, and routes every plate to one of them by consistent hashing
+// (ConsistentHashRing):
+//
+//   OnSignal -> canonicalize -> ring -> batch per worker -> socket -> worker
+//
+//    - Signals are sent in batches over a Unix socket pair per worker.
+//      Queries are sent on the same sockets, so a reply covers every
+//      signal sent before it.
+//    - Queries fan out to every worker and are merged: statistics by ID
+//      (each worker exports its plates alphabetically, IDs length-prefixed),
+//      totals summed; a point query goes to the plate's worker only.
+//    - Start, Stop, Reset and camera errors go to every worker. A camera
+//      error is counted by each; GetTotals() counts it once, plus the
+//      errors of every worker's own signals.
+//    - AddWorker / RemoveWorker move only the plates whose worker changed
+//      on the ring, with their counts: the old worker erases them, the new
+//      one imports them (CrossroadTrafficMonitoring::ExportVehicles and
+//      friends). States, error counts and acceptedSignals stay as they
+//      are; a removed worker's own errors go with it.
+//
+// Thread-safe; calls are serialized on one mutex. Workers are forked, so
+// create the coordinator (and add workers) before starting other threads
+// in the process.
+//-----------------------------------------------------------
+class PartitionedMonitor {
+public:
+  explicit PartitionedMonitor(PartitionConfig config = {});
+  ~PartitionedMonitor(); // stops every worker
+
+  PartitionedMonitor(const PartitionedMonitor &) = delete;
+  PartitionedMonitor &operator=(const PartitionedMonitor &) = delete;
+
+  void Start();
+  void Stop();
+  void Reset();
+
+  void OnSignal(const Bicycle &b);
+  void OnSignal(const Car &c);
+  void OnSignal(const Scooter &s);
+  void OnSignal(); // camera error, sent to every worker
+
+  // Send the buffered signals (queries do it as well).
+  void Flush();
+
+  std::vector<std::string> GetStatistics() const; // alphabetical
+  MonitorTotals GetTotals() const;
+  VehicleCount GetVehicleCount(const std::string &id) const;
+
+  // Start one more worker and hand it its share of the plates; returns its
+  // ID. RemoveWorker hands a worker's plates to the others and stops it
+  // (the last worker cannot be removed). Both return false / do nothing for
+  // unknown IDs.
+  std::uint32_t AddWorker();
+  bool RemoveWorker(std::uint32_t worker);
+
+  std::vector<std::uint32_t> Workers() const;
+  std::uint32_t WorkerFor(std::string_view id) const; // canonical ID
+  PartitionStats GetStats() const;
+
+private:
+  struct Worker {
+    std::uint32_t id{0};
+    pid_t pid{-1};
+    int fd{-1};
+    std::string pending; // encoded signals not sent yet
+    std::size_t pendingSignals{0};
+  };
+
+  void SpawnLocked(std::uint32_t id);
+  void StopWorkerLocked(Worker &worker);
+  Worker &WorkerLocked(std::uint32_t id) const;
+  void SendLocked(Worker &worker, char op, std::string_view payload) const;
+  std::string QueryLocked(Worker &worker, char op,
+                          std::string_view payload = {}) const;
+  void FlushLocked(Worker &worker) const;
+  void BroadcastLocked(char op);
+  void Route(VehicleCategory cat, const std::string &id, CameraId camera);
+  // Move the plates of `from` that the ring no longer maps to it.
+  void HandOffLocked(Worker &from);
+
+  const PartitionConfig config;
+  mutable std::mutex partitionMutex;
+  mutable std::vector<Worker> workers; // ascending ID
+  ConsistentHashRing ring;
+  std::uint32_t nextWorkerId{0};
+  State control{State::Init}; // last Start / Stop / Reset sent
+  mutable PartitionStats stats;
+};
+
+} // namespace ctm
+
+#endif // PARTITIONED_MONITOR_HPP
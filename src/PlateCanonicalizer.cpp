@@ -0,0 +1,117 @@
+#include "PlateCanonicalizer.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace ctm // ctm == CrossRoad Traffic Monitoring
+{
+namespace detail {
+
+static bool isSeparator(char c) { return c == ' ' || c == '-' || c == '.'; }
+
+PlateStatus CanonicalizePlateScalar(std::string_view raw, char *out,
+                                    std::size_t &length) {
+  length = 0;
+  for (char c : raw) {
+    if (isSeparator(c))
+      continue;
+    if (c >= 'a' && c <= 'z') {
+      c = static_cast<char>(c - ('a' - 'A'));
+    } else if (!((c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9'))) {
+      return PlateStatus::InvalidCharacter;
+    }
+    if (length == MAX_PLATE_LENGTH)
+      return PlateStatus::TooLong;
+    out[length++] = c;
+  }
+  return length == 0 ? PlateStatus::Empty : PlateStatus::Ok;
+}
+
+#if defined(__SSE2__)
+// Lanes of `x` in [lo, hi]. SSE2 only has signed byte compares, so shift the
+// range to start at -128 and test with a single signed compare.
+static __m128i inRange(__m128i x, char lo, char hi) {
+  const __m128i shifted =
+      _mm_add_epi8(x, _mm_set1_epi8(static_cast<char>(-128 - lo)));
+  return _mm_cmplt_epi8(shifted,
+                        _mm_set1_epi8(static_cast<char>(-128 + (hi - lo) + 1)));
+}
+
+PlateStatus CanonicalizePlateSimd(std::string_view raw, char *out,
+                                  std::size_t &length) {
+  length = 0;
+  std::size_t pos = 0;
+  while (pos < raw.size()) {
+    const std::size_t chunk = std::min<std::size_t>(16, raw.size() - pos);
+
+    // Never read past the end of the input: short tails go through a
+    // zero-padded copy and the padding lanes are masked off below.
+    alignas(16) char block[16] = {};
+    std::memcpy(block, raw.data() + pos, chunk);
+    const __m128i x = _mm_load_si128(reinterpret_cast<const __m128i *>(block));
+
+    const __m128i lower = inRange(x, 'a', 'z');
+    const __m128i upper = inRange(x, 'A', 'Z');
+    const __m128i digit = inRange(x, '0', '9');
+    const __m128i sep =
+        _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8(' ')),
+                                  _mm_cmpeq_epi8(x, _mm_set1_epi8('-'))),
+                     _mm_cmpeq_epi8(x, _mm_set1_epi8('.')));
+    const __m128i keep = _mm_or_si128(_mm_or_si128(lower, upper), digit);
+
+    const unsigned valid = (1u << chunk) - 1u;
+    const unsigned keepMask =
+        static_cast<unsigned>(_mm_movemask_epi8(keep)) & valid;
+    const unsigned sepMask =
+        static_cast<unsigned>(_mm_movemask_epi8(sep)) & valid;
+    // Report what the scalar loop would meet first: the character that
+    // overflows the length limit, or the first invalid one.
+    const unsigned invalidMask = valid & ~(keepMask | sepMask);
+    const unsigned keptBefore =
+        invalidMask ? keepMask & ((invalidMask & (0u - invalidMask)) - 1u)
+                    : keepMask;
+    if (length + static_cast<std::size_t>(__builtin_popcount(keptBefore)) >
+        MAX_PLATE_LENGTH)
+      return PlateStatus::TooLong;
+    if (invalidMask)
+      return PlateStatus::InvalidCharacter;
+
+    // Upper-case in place: subtract 0x20 from the lower case lanes only.
+    const __m128i folded =
+        _mm_sub_epi8(x, _mm_and_si128(lower, _mm_set1_epi8(0x20)));
+    alignas(16) char canon[16];
+    _mm_store_si128(reinterpret_cast<__m128i *>(canon), folded);
+
+    // Compact the kept lanes into the output.
+    for (unsigned m = keepMask; m != 0; m &= m - 1)
+      out[length++] = canon[__builtin_ctz(m)];
+    pos += chunk;
+  }
+  return length == 0 ? PlateStatus::Empty : PlateStatus::Ok;
+}
+#else
+PlateStatus CanonicalizePlateSimd(std::string_view raw, char *out,
+                                  std::size_t &length) {
+  return CanonicalizePlateScalar(raw, out, length);
+}
+#endif
+
+} // namespace detail
+
+PlateStatus CanonicalizePlate(std::string_view raw, std::string &out) {
+  char buffer[MAX_PLATE_LENGTH];
+  std::size_t length = 0;
+  const PlateStatus status =
+      detail::CanonicalizePlateSimd(raw, buffer, length);
+  if (status == PlateStatus::Ok)
+    out.assign(buffer, length);
+  return status;
+}
+
+} // namespace ctm
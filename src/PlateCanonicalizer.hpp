@@ -0,0 +1,60 @@
+#ifndef PLATE_CANONICALIZER_HPP
+#define PLATE_CANONICALIZER_HPP
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace ctm // ctm == CrossRoad Traffic Monitoring
+{
+// Longest canonical plate we accept. 15 characters fit into the small string
+// buffer of std::string, so canonical IDs never allocate.
+static constexpr std::size_t MAX_PLATE_LENGTH = 15;
+
+// Result of canonicalizing a raw plate read by a camera.
+enum class PlateStatus {
+  Ok,              // canonical plate written to the output
+  Empty,           // nothing left after stripping separators
+  TooLong,         // more than MAX_PLATE_LENGTH significant characters
+  InvalidCharacter // contains something other than A-Z, a-z, 0-9, separators
+};
+
+inline const char *ToString(PlateStatus status) {
+  switch (status) {
+  case PlateStatus::Ok:
+    return "Ok";
+  case PlateStatus::Empty:
+    return "Empty";
+  case PlateStatus::TooLong:
+    return "TooLong";
+  case PlateStatus::InvalidCharacter:
+    return "InvalidCharacter";
+  }
+  return "Unknown";
+}
+
+//-----------------------------------------------------------
+// Plate canonicalization:
+//    - lower case letters are upper-cased ("ab-123" -> "AB123")
+//    - separators (' ', '-', '.') are stripped
+//    - any other character rejects the plate
+// `out` is only meaningful when PlateStatus::Ok is returned.
+//
+// Uses SSE2 (16 bytes per step) when available, otherwise the scalar
+// implementation. Both produce identical results, statuses included: the
+// first problem in input order (overflow or invalid character) is reported.
+//-----------------------------------------------------------
+PlateStatus CanonicalizePlate(std::string_view raw, std::string &out);
+
+namespace detail {
+// Exposed for tests so both implementations can be checked against each
+// other. `out` must have room for MAX_PLATE_LENGTH characters.
+PlateStatus CanonicalizePlateScalar(std::string_view raw, char *out,
+                                    std::size_t &length);
+PlateStatus CanonicalizePlateSimd(std::string_view raw, char *out,
+                                  std::size_t &length);
+} // namespace detail
+
+} // namespace ctm
+
+#endif // PLATE_CANONICALIZER_HPP
@@ -0,0 +1,109 @@
+#include "PlateDictionary.hpp"
+#include <utility>
+
+namespace ctm // ctm == CrossRoad Traffic Monitoring
+{
+
+PlateDictionary::PlateDictionary(std::uint32_t keepPeriods,
+                                 std::uint32_t firstIndex)
+    : keepPeriods{keepPeriods}, firstIndex{firstIndex} {}
+
+void PlateDictionary::UnlinkLocked(std::uint32_t slot) {
+  Entry &e = entries[slot];
+  if (e.older != npos)
+    entries[e.older].newer = e.newer;
+  else
+    oldest = e.newer;
+  if (e.newer != npos)
+    entries[e.newer].older = e.older;
+  else
+    newest = e.older;
+  e.older = e.newer = npos;
+}
+
+void PlateDictionary::AppendLocked(std::uint32_t slot) {
+  Entry &e = entries[slot];
+  e.older = newest;
+  e.newer = npos;
+  if (newest != npos)
+    entries[newest].newer = slot;
+  else
+    oldest = slot;
+  newest = slot;
+}
+
+void PlateDictionary::MarkSeenLocked(std::uint32_t slot) {
+  Entry &e = entries[slot];
+  if (e.lastSeen == period)
+    return; // already among this period's, the list stays ordered
+  UnlinkLocked(slot);
+  e.lastSeen = period;
+  AppendLocked(slot);
+}
+
+std::uint32_t PlateDictionary::Acquire(std::string_view plate) {
+  std::lock_guard<std::mutex> lock(dictionaryMutex);
+  if (const auto it = indices.find(plate); it != indices.end()) {
+    MarkSeenLocked(it->second - firstIndex);
+    return it->second;
+  }
+  std::uint32_t slot;
+  if (!freeSlots.empty()) {
+    slot = freeSlots.back();
+    freeSlots.pop_back();
+  } else {
+    slot = static_cast<std::uint32_t>(entries.size());
+    entries.emplace_back();
+  }
+  const auto it = indices.emplace(std::string(plate), firstIndex + slot).first;
+  entries[slot].plate = &it->first;
+  entries[slot].lastSeen = period;
+  AppendLocked(slot);
+  return it->second;
+}
+
+std::size_t PlateDictionary::NextPeriod() {
+  std::lock_guard<std::mutex> lock(dictionaryMutex);
+  ++period;
+  std::size_t evicted = 0;
+  while (oldest != npos && period - entries[oldest].lastSeen > keepPeriods) {
+    const std::uint32_t slot = oldest;
+    UnlinkLocked(slot);
+    indices.erase(*entries[slot].plate);
+    entries[slot].plate = nullptr;
+    freeSlots.push_back(slot);
+    ++evicted;
+  }
+  return evicted;
+}
+
+std::uint32_t PlateDictionary::Find(std::string_view plate) const {
+  std::lock_guard<std::mutex> lock(dictionaryMutex);
+  const auto it = indices.find(plate);
+  return it == indices.end() ? npos : it->second;
+}
+
+std::string PlateDictionary::Plate(std::uint32_t index) const {
+  std::lock_guard<std::mutex> lock(dictionaryMutex);
+  const std::uint32_t slot = index - firstIndex;
+  if (index < firstIndex || slot >= entries.size() || !entries[slot].plate)
+    return {};
+  return *entries[slot].plate;
+}
+
+std::size_t PlateDictionary::Size() const {
+  std::lock_guard<std::mutex> lock(dictionaryMutex);
+  return indices.size();
+}
+
+std::size_t PlateDictionary::MemoryBytes() const {
+  std::lock_guard<std::mutex> lock(dictionaryMutex);
+  // Map nodes are estimated: entry, next pointer, cached hash.
+  return sizeof(*this) + entries.capacity() * sizeof(Entry) +
+         freeSlots.capacity() * sizeof(std::uint32_t) +
+         indices.bucket_count() * sizeof(void *) +
+         indices.size() * (sizeof(std::pair<const std::string, std::uint32_t>) +
+                           2 * sizeof(void *));
+}
+
+} // namespace ctm
@@ -0,0 +1,86 @@
+#ifndef PLATE_DICTIONARY_HPP
+#define PLATE_DICTIONARY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace ctm // ctm == CrossRoad Traffic Monitoring
+{
+//-----------------------------------------------------------
+// Stable plate -> dense uint32 index map of a monitor (see
+// MonitorConfig::plateIndexPeriods), kept across resets:
+//    - A plate keeps its index while it is seen at least once every
+//      keepPeriods periods; pool entries move (CompactStep, region
+//      rebalancing), indices do not.
+//    - Entries are kept in order of the period they were last seen in, so
+//      NextPeriod() only visits the ones it evicts.
+//    - An evicted plate's index is reused. A plate last seen in period p is
+//      evicted when period p + keepPeriods + 1 opens, so a consumer keeping
+//      at most keepPeriods closed periods never holds an index that has
+//      changed plates since.
+// Indices below firstIndex are left to the caller (the monitor numbers its
+// known plates there).
+//
+// Thread-safe; calls are serialized on one mutex. The monitor only calls in
+// when a plate gets a pool entry or is first seen in a period, not per
+// signal.
+//-----------------------------------------------------------
+class PlateDictionary {
+public:
+  static constexpr std::uint32_t npos = UINT32_MAX;
+
+  explicit PlateDictionary(std::uint32_t keepPeriods,
+                           std::uint32_t firstIndex = 0);
+
+  // Index of `plate`, added if new; either way seen in the open period.
+  std::uint32_t Acquire(std::string_view plate);
+  // Open the next period, evicting the plates it leaves unseen for more than
+  // keepPeriods periods; returns how many.
+  std::size_t NextPeriod();
+
+  std::uint32_t Find(std::string_view plate) const; // npos if absent
+  std::string Plate(std::uint32_t index) const;     // empty if unused
+
+  std::size_t Size() const;
+  std::size_t MemoryBytes() const;
+
+private:
+  struct IdHash {
+    using is_transparent = void;
+    std::size_t operator()(std::string_view id) const {
+      return std::hash<std::string_view>{}(id);
+    }
+  };
+
+  struct Entry {
+    const std::string *plate{nullptr}; // key in `indices`, null while free
+    std::uint64_t lastSeen{0};
+    std::uint32_t older{npos}; // age list links, by index - firstIndex
+    std::uint32_t newer{npos};
+  };
+
+  void UnlinkLocked(std::uint32_t slot);
+  void AppendLocked(std::uint32_t slot); // as the newest
+  void MarkSeenLocked(std::uint32_t slot);
+
+  const std::uint32_t keepPeriods;
+  const std::uint32_t firstIndex;
+  mutable std::mutex dictionaryMutex;
+  std::unordered_map<std::string, std::uint32_t, IdHash, std::equal_to<>>
+      indices;
+  std::vector<Entry> entries;          // by index - firstIndex
+  std::vector<std::uint32_t> freeSlots; // evicted, reused first
+  std::uint32_t oldest{npos};
+  std::uint32_t newest{npos};
+  std::uint64_t period{0};
+};
+
+} // namespace ctm
+
+#endif // PLATE_DICTIONARY_HPP
@@ -0,0 +1,553 @@
+#include "PresenceBitmap.hpp"
+#include "WindowColumns.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace ctm // ctm == CrossRoad Traffic Monitoring
+{
+namespace detail {
+
+// Merge, or a binary search per value of the smaller array when the sizes
+// are far apart.
+std::size_t IntersectArraysScalar(const std::uint16_t *a, std::size_t na,
+                                  const std::uint16_t *b, std::size_t nb,
+                                  std::uint16_t *out) {
+  if (na > nb)
+    return IntersectArraysScalar(b, nb, a, na, out);
+  std::size_t n = 0;
+  if (na * 32 < nb) {
+    const std::uint16_t *from = b;
+    for (std::size_t i = 0; i < na; ++i) {
+      from = std::lower_bound(from, b + nb, a[i]);
+      if (from == b + nb)
+        break;
+      if (*from == a[i])
+        out[n++] = a[i];
+    }
+    return n;
+  }
+  std::size_t i = 0, j = 0;
+  while (i < na && j < nb) {
+    if (a[i] < b[j]) {
+      ++i;
+    } else if (b[j] < a[i]) {
+      ++j;
+    } else {
+      out[n++] = a[i];
+      ++i;
+      ++j;
+    }
+  }
+  return n;
+}
+
+// Branch-free merge: which side advances is data, not control flow, so
+// interleaved inputs cost no mispredictions.
+std::size_t UnionArrays(const std::uint16_t *a, std::size_t na,
+                        const std::uint16_t *b, std::size_t nb,
+                        std::uint16_t *out) {
+  std::size_t i = 0, j = 0, n = 0;
+  while (i < na && j < nb) {
+    const std::uint16_t x = a[i], y = b[j];
+    out[n++] = std::min(x, y);
+    i += x <= y;
+    j += y <= x;
+  }
+  std::copy(a + i, a + na, out + n);
+  n += na - i;
+  std::copy(b + j, b + nb, out + n);
+  return n + nb - j;
+}
+
+std::size_t AndWordsScalar(const std::uint64_t *a, const std::uint64_t *b,
+                           std::uint64_t *out, std::size_t words) {
+  std::size_t cardinality = 0;
+  for (std::size_t w = 0; w < words; ++w) {
+    const std::uint64_t x = a[w] & b[w];
+    if (out)
+      out[w] = x;
+    cardinality += static_cast<std::size_t>(std::popcount(x));
+  }
+  return cardinality;
+}
+
+std::size_t OrWordsScalar(const std::uint64_t *a, const std::uint64_t *b,
+                          std::uint64_t *out, std::size_t words) {
+  std::size_t cardinality = 0;
+  for (std::size_t w = 0; w < words; ++w) {
+    out[w] = a[w] | b[w];
+    cardinality += static_cast<std::size_t>(std::popcount(out[w]));
+  }
+  return cardinality;
+}
+
+#if defined(__SSE2__)
+// Rotate the eight 16-bit lanes by one.
+static __m128i rotateLanes(__m128i x) {
+  return _mm_or_si128(_mm_srli_si128(x, 2), _mm_slli_si128(x, 14));
+}
+
+// Blocks of 8 against 8: every lane of the `a` block is compared with every
+// lane of the `b` block (8 rotations), then the block with the smaller
+// maximum is replaced. The tails are merged.
+std::size_t IntersectArraysSimd(const std::uint16_t *a, std::size_t na,
+                                const std::uint16_t *b, std::size_t nb,
+                                std::uint16_t *out) {
+  if (na * 32 < nb || nb * 32 < na)
+    return IntersectArraysScalar(a, na, b, nb, out);
+  const std::size_t blocksA = na & ~std::size_t{7};
+  const std::size_t blocksB = nb & ~std::size_t{7};
+  std::size_t i = 0, j = 0, n = 0;
+  if (blocksA > 0 && blocksB > 0) {
+    for (;;) {
+      const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+      __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + j));
+      __m128i match = _mm_cmpeq_epi16(va, vb);
+      for (int r = 1; r < 8; ++r) {
+        vb = rotateLanes(vb);
+        match = _mm_or_si128(match, _mm_cmpeq_epi16(va, vb));
+      }
+      // Two mask bits per 16-bit lane, keep one.
+      for (unsigned m = static_cast<unsigned>(_mm_movemask_epi8(match)) & 0x5555u;
+           m != 0; m &= m - 1)
+        out[n++] = a[i + static_cast<std::size_t>(std::countr_zero(m)) / 2];
+
+      const std::uint16_t lastA = a[i + 7];
+      const std::uint16_t lastB = b[j + 7];
+      if (lastA <= lastB)
+        i += 8;
+      if (lastB <= lastA)
+        j += 8;
+      if (i == blocksA || j == blocksB)
+        break;
+    }
+  }
+  return n + IntersectArraysScalar(a + i, na - i, b + j, nb - j, out + n);
+}
+
+std::size_t AndWordsSimd(const std::uint64_t *a, const std::uint64_t *b,
+                         std::uint64_t *out, std::size_t words) {
+  std::size_t cardinality = 0;
+  std::size_t w = 0;
+  for (; w + 2 <= words; w += 2) {
+    const __m128i x =
+        _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(a + w)),
+                      _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + w)));
+    alignas(16) std::uint64_t lanes[2];
+    _mm_store_si128(reinterpret_cast<__m128i *>(lanes), x);
+    if (out) {
+      out[w] = lanes[0];
+      out[w + 1] = lanes[1];
+    }
+    cardinality += static_cast<std::size_t>(std::popcount(lanes[0]) +
+                                            std::popcount(lanes[1]));
+  }
+  return cardinality +
+         AndWordsScalar(a + w, b + w, out ? out + w : nullptr, words - w);
+}
+
+std::size_t OrWordsSimd(const std::uint64_t *a, const std::uint64_t *b,
+                        std::uint64_t *out, std::size_t words) {
+  std::size_t cardinality = 0;
+  std::size_t w = 0;
+  for (; w + 2 <= words; w += 2) {
+    const __m128i x =
+        _mm_or_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(a + w)),
+                     _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + w)));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + w), x);
+    cardinality += static_cast<std::size_t>(std::popcount(out[w]) +
+                                            std::popcount(out[w + 1]));
+  }
+  return cardinality + OrWordsScalar(a + w, b + w, out + w, words - w);
+}
+#else
+std::size_t IntersectArraysSimd(const std::uint16_t *a, std::size_t na,
+                                const std::uint16_t *b, std::size_t nb,
+                                std::uint16_t *out) {
+  return IntersectArraysScalar(a, na, b, nb, out);
+}
+
+std::size_t AndWordsSimd(const std::uint64_t *a, const std::uint64_t *b,
+                         std::uint64_t *out, std::size_t words) {
+  return AndWordsScalar(a, b, out, words);
+}
+
+std::size_t OrWordsSimd(const std::uint64_t *a, const std::uint64_t *b,
+                        std::uint64_t *out, std::size_t words) {
+  return OrWordsScalar(a, b, out, words);
+}
+#endif
+
+} // namespace detail
+
+namespace {
+bool testBit(const std::vector<std::uint64_t> &bits, std::uint16_t low) {
+  return (bits[low >> 6] >> (low & 63)) & 1;
+}
+} // namespace
+
+//-----------------------------------------------------------
+// PresenceBitmap
+//-----------------------------------------------------------
+void PresenceBitmap::Add(std::uint32_t value) {
+  const auto key = static_cast<std::uint16_t>(value >> 16);
+  const auto low = static_cast<std::uint16_t>(value);
+  auto it = std::lower_bound(
+      containers.begin(), containers.end(), key,
+      [](const Container &c, std::uint16_t k) { return c.key < k; });
+  if (it == containers.end() || it->key != key) {
+    it = containers.insert(it, Container{});
+    it->key = key;
+  }
+  Container &c = *it;
+  if (!c.IsBitmap()) {
+    const auto pos = std::lower_bound(c.array.begin(), c.array.end(), low);
+    if (pos != c.array.end() && *pos == low)
+      return;
+    if (c.cardinality < kArrayMax) {
+      c.array.insert(pos, low);
+      ++c.cardinality;
+      return;
+    }
+    ToBitmap(c);
+  }
+  std::uint64_t &word = c.bits[low >> 6];
+  const std::uint64_t mask = std::uint64_t{1} << (low & 63);
+  if (!(word & mask)) {
+    word |= mask;
+    ++c.cardinality;
+  }
+}
+
+bool PresenceBitmap::Contains(std::uint32_t value) const {
+  const auto key = static_cast<std::uint16_t>(value >> 16);
+  const auto low = static_cast<std::uint16_t>(value);
+  const auto it = std::lower_bound(
+      containers.begin(), containers.end(), key,
+      [](const Container &c, std::uint16_t k) { return c.key < k; });
+  if (it == containers.end() || it->key != key)
+    return false;
+  if (it->IsBitmap())
+    return testBit(it->bits, low);
+  return std::binary_search(it->array.begin(), it->array.end(), low);
+}
+
+std::uint64_t PresenceBitmap::Cardinality() const {
+  std::uint64_t total = 0;
+  for (const Container &c : containers)
+    total += c.cardinality;
+  return total;
+}
+
+std::vector<std::uint32_t> PresenceBitmap::ToVector() const {
+  std::vector<std::uint32_t> values;
+  values.reserve(Cardinality());
+  for (const Container &c : containers) {
+    const std::uint32_t high = std::uint32_t{c.key} << 16;
+    if (!c.IsBitmap()) {
+      for (std::uint16_t low : c.array)
+        values.push_back(high | low);
+      continue;
+    }
+    for (std::size_t w = 0; w < kBitmapWords; ++w) {
+      for (std::uint64_t word = c.bits[w]; word != 0; word &= word - 1)
+        values.push_back(high | static_cast<std::uint32_t>(
+                                    w * 64 + std::countr_zero(word)));
+    }
+  }
+  return values;
+}
+
+std::size_t PresenceBitmap::MemoryBytes() const {
+  std::size_t bytes = sizeof(*this) + containers.capacity() * sizeof(Container);
+  for (const Container &c : containers)
+    bytes += c.array.capacity() * sizeof(std::uint16_t) +
+             c.bits.capacity() * sizeof(std::uint64_t);
+  return bytes;
+}
+
+void PresenceBitmap::ToBitmap(Container &c) {
+  c.bits.assign(kBitmapWords, 0);
+  for (std::uint16_t low : c.array)
+    c.bits[low >> 6] |= std::uint64_t{1} << (low & 63);
+  std::vector<std::uint16_t>().swap(c.array); // release, not just clear
+}
+
+void PresenceBitmap::ToArray(Container &c) {
+  c.array.clear();
+  c.array.reserve(c.cardinality);
+  for (std::size_t w = 0; w < kBitmapWords; ++w) {
+    for (std::uint64_t word = c.bits[w]; word != 0; word &= word - 1)
+      c.array.push_back(
+          static_cast<std::uint16_t>(w * 64 + std::countr_zero(word)));
+  }
+  std::vector<std::uint64_t>().swap(c.bits);
+}
+
+PresenceBitmap::Container PresenceBitmap::AndContainers(const Container &a,
+                                                        const Container &b) {
+  Container out;
+  out.key = a.key;
+  if (a.IsBitmap() && b.IsBitmap()) {
+    out.bits.resize(kBitmapWords);
+    out.cardinality = static_cast<std::uint32_t>(detail::AndWordsSimd(
+        a.bits.data(), b.bits.data(), out.bits.data(), kBitmapWords));
+    if (out.cardinality <= kArrayMax)
+      ToArray(out);
+    return out;
+  }
+  if (!a.IsBitmap() && !b.IsBitmap()) {
+    out.array.resize(std::min(a.array.size(), b.array.size()));
+    out.cardinality = static_cast<std::uint32_t>(
+        detail::IntersectArraysSimd(a.array.data(), a.array.size(),
+                                    b.array.data(), b.array.size(),
+                                    out.array.data()));
+    out.array.resize(out.cardinality);
+    return out;
+  }
+  const Container &array = a.IsBitmap() ? b : a;
+  const Container &bitmap = a.IsBitmap() ? a : b;
+  for (std::uint16_t low : array.array) {
+    if (testBit(bitmap.bits, low))
+      out.array.push_back(low);
+  }
+  out.cardinality = static_cast<std::uint32_t>(out.array.size());
+  return out;
+}
+
+PresenceBitmap::Container PresenceBitmap::OrContainers(const Container &a,
+                                                       const Container &b) {
+  Container out;
+  out.key = a.key;
+  if (a.IsBitmap() && b.IsBitmap()) {
+    out.bits.resize(kBitmapWords);
+    out.cardinality = static_cast<std::uint32_t>(detail::OrWordsSimd(
+        a.bits.data(), b.bits.data(), out.bits.data(), kBitmapWords));
+    return out;
+  }
+  if (!a.IsBitmap() && !b.IsBitmap()) {
+    out.array.resize(a.array.size() + b.array.size());
+    out.cardinality = static_cast<std::uint32_t>(
+        detail::UnionArrays(a.array.data(), a.array.size(), b.array.data(),
+                            b.array.size(), out.array.data()));
+    out.array.resize(out.cardinality);
+    if (out.cardinality > kArrayMax)
+      ToBitmap(out);
+    return out;
+  }
+  const Container &array = a.IsBitmap() ? b : a;
+  const Container &bitmap = a.IsBitmap() ? a : b;
+  out.bits = bitmap.bits;
+  out.cardinality = bitmap.cardinality;
+  for (std::uint16_t low : array.array) {
+    std::uint64_t &word = out.bits[low >> 6];
+    const std::uint64_t mask = std::uint64_t{1} << (low & 63);
+    out.cardinality += (word & mask) ? 0 : 1;
+    word |= mask;
+  }
+  return out;
+}
+
+std::uint64_t PresenceBitmap::AndCount(const Container &a, const Container &b) {
+  if (a.IsBitmap() && b.IsBitmap())
+    return detail::AndWordsSimd(a.bits.data(), b.bits.data(), nullptr,
+                                kBitmapWords);
+  if (!a.IsBitmap() && !b.IsBitmap()) {
+    std::uint16_t scratch[kArrayMax];
+    return detail::IntersectArraysSimd(a.array.data(), a.array.size(),
+                                       b.array.data(), b.array.size(),
+                                       scratch);
+  }
+  const Container &array = a.IsBitmap() ? b : a;
+  const Container &bitmap = a.IsBitmap() ? a : b;
+  std::uint64_t count = 0;
+  for (std::uint16_t low : array.array)
+    count += testBit(bitmap.bits, low);
+  return count;
+}
+
+PresenceBitmap PresenceBitmap::And(const PresenceBitmap &a,
+                                   const PresenceBitmap &b) {
+  PresenceBitmap out;
+  auto i = a.containers.begin(), j = b.containers.begin();
+  while (i != a.containers.end() && j != b.containers.end()) {
+    if (i->key < j->key) {
+      ++i;
+    } else if (j->key < i->key) {
+      ++j;
+    } else {
+      Container c = AndContainers(*i++, *j++);
+      if (c.cardinality > 0)
+        out.containers.push_back(std::move(c));
+    }
+  }
+  return out;
+}
+
+PresenceBitmap PresenceBitmap::Or(const PresenceBitmap &a,
+                                  const PresenceBitmap &b) {
+  PresenceBitmap out;
+  auto i = a.containers.begin(), j = b.containers.begin();
+  while (i != a.containers.end() || j != b.containers.end()) {
+    if (j == b.containers.end() ||
+        (i != a.containers.end() && i->key < j->key)) {
+      out.containers.push_back(*i++);
+    } else if (i == a.containers.end() || j->key < i->key) {
+      out.containers.push_back(*j++);
+    } else {
+      out.containers.push_back(OrContainers(*i++, *j++));
+    }
+  }
+  return out;
+}
+
+std::uint64_t PresenceBitmap::AndCardinality(const PresenceBitmap &a,
+                                             const PresenceBitmap &b) {
+  std::uint64_t count = 0;
+  auto i = a.containers.begin(), j = b.containers.begin();
+  while (i != a.containers.end() && j != b.containers.end()) {
+    if (i->key < j->key)
+      ++i;
+    else if (j->key < i->key)
+      ++j;
+    else
+      count += AndCount(*i++, *j++);
+  }
+  return count;
+}
+
+//-----------------------------------------------------------
+// PresenceHistory
+//-----------------------------------------------------------
+PresenceHistory::PresenceHistory(std::size_t keepWindows, bool countSightings)
+    : keepWindows{keepWindows} {
+  if (countSightings)
+    counts = std::make_unique<WindowColumns>(keepWindows);
+}
+
+PresenceHistory::~PresenceHistory() = default;
+
+std::uint64_t
+PresenceHistory::CloseWindow(const std::vector<std::uint32_t> &indices,
+                             const std::vector<std::uint32_t> &sightings) {
+  PresenceBitmap window; // ascending adds only append
+  for (std::uint32_t index : indices)
+    window.Add(index);
+  std::lock_guard<std::mutex> lock(historyMutex);
+  closed.push_back(std::move(window));
+  if (closed.size() > keepWindows)
+    closed.pop_front();
+  if (counts) {
+    for (std::size_t i = 0; i < indices.size() && i < sightings.size(); ++i)
+      counts->Increment(indices[i], sightings[i]);
+    counts->Close();
+  }
+  return openWindow++;
+}
+
+std::uint64_t PresenceHistory::OpenWindow() const {
+  std::lock_guard<std::mutex> lock(historyMutex);
+  return openWindow;
+}
+
+std::vector<std::uint64_t> PresenceHistory::ClosedWindows() const {
+  std::lock_guard<std::mutex> lock(historyMutex);
+  std::vector<std::uint64_t> windows;
+  for (std::uint64_t w = openWindow - closed.size(); w < openWindow; ++w)
+    windows.push_back(w);
+  return windows;
+}
+
+const PresenceBitmap *
+PresenceHistory::WindowLocked(std::uint64_t window) const {
+  if (window >= openWindow || openWindow - window > closed.size())
+    return nullptr;
+  return &closed[closed.size() - (openWindow - window)];
+}
+
+PresenceBitmap PresenceHistory::Window(std::uint64_t window) const {
+  std::lock_guard<std::mutex> lock(historyMutex);
+  const PresenceBitmap *bitmap = WindowLocked(window);
+  return bitmap ? *bitmap : PresenceBitmap{};
+}
+
+PresenceBitmap
+PresenceHistory::SeenInAll(const std::vector<std::uint64_t> &windows) const {
+  std::lock_guard<std::mutex> lock(historyMutex);
+  std::vector<const PresenceBitmap *> bitmaps;
+  for (std::uint64_t w : windows) {
+    const PresenceBitmap *bitmap = WindowLocked(w);
+    if (!bitmap)
+      return {};
+    bitmaps.push_back(bitmap);
+  }
+  if (bitmaps.empty())
+    return {};
+  // Smallest first, so the running intersection shrinks fastest.
+  std::sort(bitmaps.begin(), bitmaps.end(),
+            [](const PresenceBitmap *a, const PresenceBitmap *b) {
+              return a->Cardinality() < b->Cardinality();
+            });
+  PresenceBitmap result = *bitmaps[0];
+  for (std::size_t i = 1; i < bitmaps.size() && !result.Empty(); ++i)
+    result = PresenceBitmap::And(result, *bitmaps[i]);
+  return result;
+}
+
+PresenceBitmap
+PresenceHistory::SeenInAny(const std::vector<std::uint64_t> &windows) const {
+  std::lock_guard<std::mutex> lock(historyMutex);
+  PresenceBitmap result;
+  for (std::uint64_t w : windows) {
+    if (const PresenceBitmap *bitmap = WindowLocked(w))
+      result = PresenceBitmap::Or(result, *bitmap);
+  }
+  return result;
+}
+
+std::uint64_t PresenceHistory::CountSeenInAll(
+    const std::vector<std::uint64_t> &windows) const {
+  if (windows.size() == 2) {
+    std::lock_guard<std::mutex> lock(historyMutex);
+    const PresenceBitmap *a = WindowLocked(windows[0]);
+    const PresenceBitmap *b = WindowLocked(windows[1]);
+    return a && b ? PresenceBitmap::AndCardinality(*a, *b) : 0;
+  }
+  return SeenInAll(windows).Cardinality();
+}
+
+std::vector<std::uint32_t>
+PresenceHistory::SumCounts(const std::vector<std::uint64_t> &windows) const {
+  std::lock_guard<std::mutex> lock(historyMutex);
+  return counts ? counts->Sum(windows) : std::vector<std::uint32_t>{};
+}
+
+std::vector<std::uint32_t>
+PresenceHistory::MaxCounts(const std::vector<std::uint64_t> &windows) const {
+  std::lock_guard<std::mutex> lock(historyMutex);
+  return counts ? counts->Max(windows) : std::vector<std::uint32_t>{};
+}
+
+std::vector<std::uint32_t>
+PresenceHistory::WindowsSeen(const std::vector<std::uint64_t> &windows) const {
+  std::lock_guard<std::mutex> lock(historyMutex);
+  return counts ? counts->WindowsSeen(windows) : std::vector<std::uint32_t>{};
+}
+
+std::size_t PresenceHistory::MemoryBytes() const {
+  std::lock_guard<std::mutex> lock(historyMutex);
+  std::size_t bytes = sizeof(*this);
+  for (const PresenceBitmap &bitmap : closed)
+    bytes += bitmap.MemoryBytes();
+  if (counts)
+    bytes += counts->MemoryBytes();
+  return bytes;
+}
+
+} // namespace ctm
@@ -0,0 +1,160 @@
+#ifndef PRESENCE_BITMAP_HPP
+#define PRESENCE_BITMAP_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace ctm // ctm == CrossRoad Traffic Monitoring
+{
+//-----------------------------------------------------------
+// Compressed set of 32-bit indices, Roaring style:
+//    - Values are grouped by their high 16 bits into containers.
+//    - A container with up to 4096 values is a sorted array of the low 16
+//      bits (2 bytes per value); a fuller one is a 65536-bit bitmap (8 KiB).
+// Each container always uses the smaller form, so equal sets compare equal.
+//
+// Bitmap containers are combined 128 bits at a time and array containers
+// intersected 8 values against 8 with SSE2 when available, otherwise with
+// the scalar kernels. Both produce identical results.
+//-----------------------------------------------------------
+class PresenceBitmap {
+public:
+  void Add(std::uint32_t value);
+  bool Contains(std::uint32_t value) const;
+
+  std::uint64_t Cardinality() const;
+  bool Empty() const { return containers.empty(); }
+  std::vector<std::uint32_t> ToVector() const; // ascending
+  std::size_t MemoryBytes() const;
+
+  static PresenceBitmap And(const PresenceBitmap &a, const PresenceBitmap &b);
+  static PresenceBitmap Or(const PresenceBitmap &a, const PresenceBitmap &b);
+  // |a & b| without building the intersection.
+  static std::uint64_t AndCardinality(const PresenceBitmap &a,
+                                      const PresenceBitmap &b);
+
+  bool operator==(const PresenceBitmap &) const = default;
+
+private:
+  static constexpr std::size_t kArrayMax = 4096;
+  static constexpr std::size_t kBitmapWords = 65536 / 64;
+
+  struct Container {
+    std::uint16_t key{0}; // high 16 bits
+    std::uint32_t cardinality{0};
+    std::vector<std::uint16_t> array; // sorted, while cardinality <= kArrayMax
+    std::vector<std::uint64_t> bits;  // kBitmapWords words otherwise
+
+    bool IsBitmap() const { return !bits.empty(); }
+    bool operator==(const Container &) const = default;
+  };
+
+  static Container AndContainers(const Container &a, const Container &b);
+  static Container OrContainers(const Container &a, const Container &b);
+  static std::uint64_t AndCount(const Container &a, const Container &b);
+  static void ToArray(Container &c);  // bitmap -> array
+  static void ToBitmap(Container &c); // array -> bitmap
+
+  std::vector<Container> containers; // by key
+};
+
+namespace detail {
+// Container kernels, exposed for tests so the SSE2 and the scalar versions
+// can be checked against each other. `out` needs room for min(|a|, |b|)
+// values (intersections) or |a| + |b| values (unions); the return value is
+// the number written, or the cardinality for the word kernels (AndWords
+// only counts when `out` is nullptr).
+std::size_t IntersectArraysScalar(const std::uint16_t *a, std::size_t na,
+                                  const std::uint16_t *b, std::size_t nb,
+                                  std::uint16_t *out);
+std::size_t IntersectArraysSimd(const std::uint16_t *a, std::size_t na,
+                                const std::uint16_t *b, std::size_t nb,
+                                std::uint16_t *out);
+std::size_t UnionArrays(const std::uint16_t *a, std::size_t na,
+                        const std::uint16_t *b, std::size_t nb,
+                        std::uint16_t *out);
+std::size_t AndWordsScalar(const std::uint64_t *a, const std::uint64_t *b,
+                           std::uint64_t *out, std::size_t words);
+std::size_t AndWordsSimd(const std::uint64_t *a, const std::uint64_t *b,
+                         std::uint64_t *out, std::size_t words);
+std::size_t OrWordsScalar(const std::uint64_t *a, const std::uint64_t *b,
+                          std::uint64_t *out, std::size_t words);
+std::size_t OrWordsSimd(const std::uint64_t *a, const std::uint64_t *b,
+                        std::uint64_t *out, std::size_t words);
+} // namespace detail
+
+class WindowColumns;
+
+//-----------------------------------------------------------
+// Which plates were seen in which period (see
+// CrossroadTrafficMonitoring::SetPresenceHistory), for questions such as
+// "seen in both the 8:00 and the 17:00 period" or "seen every weekday":
+//    - Plates are the monitor's stable plate indices
+//      (MonitorConfig::plateIndexPeriods); GetIndexedPlates() turns a
+//      bitmap back into plates.
+//    - Each reset of the monitor closes the period with the plates it
+//      counted, taken from the monitor's own counters under its lock, so a
+//      sighting always lands in the period that counted it. Nothing is
+//      recorded per signal; the open period stays empty until it closes.
+//    - The last keepWindows closed periods are kept for queries. An index
+//      only changes plates after plateIndexPeriods unseen periods, so the
+//      monitor accepts a history only if keepWindows is not larger.
+//    - With countSightings, each period also keeps a counter per plate in a
+//      WindowColumns store, for per-plate totals across periods.
+// Periods are numbered from 0 in the order they were opened.
+//
+// Thread-safe; calls are serialized on one mutex.
+//-----------------------------------------------------------
+class PresenceHistory {
+public:
+  explicit PresenceHistory(std::size_t keepWindows = 7 * 24,
+                           bool countSightings = false);
+  ~PresenceHistory();
+
+  // Close the open period (its number is returned) with the plates seen in
+  // it, ascending and unique, and their sightings (used with countSightings
+  // only); then open the next.
+  std::uint64_t CloseWindow(const std::vector<std::uint32_t> &indices,
+                            const std::vector<std::uint32_t> &sightings);
+
+  std::size_t KeepWindows() const { return keepWindows; }
+  std::uint64_t OpenWindow() const; // number of the open period
+  // Numbers of the closed periods still kept, oldest first.
+  std::vector<std::uint64_t> ClosedWindows() const;
+
+  // Plates of one closed period; empty if not kept.
+  PresenceBitmap Window(std::uint64_t window) const;
+  // Plates seen in every / any of `windows` (periods not kept are empty).
+  PresenceBitmap SeenInAll(const std::vector<std::uint64_t> &windows) const;
+  PresenceBitmap SeenInAny(const std::vector<std::uint64_t> &windows) const;
+  std::uint64_t CountSeenInAll(const std::vector<std::uint64_t> &windows) const;
+
+  // With countSightings (empty otherwise), per plate index over `windows`:
+  // sightings in total, sightings in the busiest period, and the number of
+  // periods the plate was seen in. Select with WindowColumns::AtLeast().
+  std::vector<std::uint32_t>
+  SumCounts(const std::vector<std::uint64_t> &windows) const;
+  std::vector<std::uint32_t>
+  MaxCounts(const std::vector<std::uint64_t> &windows) const;
+  std::vector<std::uint32_t>
+  WindowsSeen(const std::vector<std::uint64_t> &windows) const;
+
+  std::size_t MemoryBytes() const;
+
+private:
+  const PresenceBitmap *WindowLocked(std::uint64_t window) const;
+
+  const std::size_t keepWindows;
+  mutable std::mutex historyMutex;
+  std::uint64_t openWindow{0};
+  std::deque<PresenceBitmap> closed; // periods openWindow - closed.size() ...
+  std::unique_ptr<WindowColumns> counts; // countSightings only
+};
+
+} // namespace ctm
+
+#endif // PRESENCE_BITMAP_HPP
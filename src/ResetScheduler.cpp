@@ -0,0 +1,218 @@
+#include "ResetScheduler.hpp"
+#include <algorithm>
+#include <bit>
+
+namespace ctm // ctm == CrossRoad Traffic Monitoring
+{
+namespace detail {
+std::chrono::milliseconds AlignedDelay(std::chrono::system_clock::time_point now,
+                                       std::chrono::milliseconds period) {
+  const auto sinceEpoch =
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          now.time_since_epoch());
+  return period - sinceEpoch % period;
+}
+} // namespace detail
+
+namespace {
+// Whole ticks in `d`, rounded up.
+std::uint64_t toTicks(std::chrono::milliseconds d,
+                      std::chrono::milliseconds tick) {
+  return static_cast<std::uint64_t>((d.count() + tick.count() - 1) /
+                                    tick.count());
+}
+} // namespace
+
+ResetScheduler::ResetScheduler(SchedulerConfig config)
+    : config{config}, origin{std::chrono::steady_clock::now()} {
+  if (config.startThread)
+    thread = std::thread(&ResetScheduler::Run, this);
+}
+
+ResetScheduler::~ResetScheduler() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  wake.notify_all();
+  if (thread.joinable())
+    thread.join();
+}
+
+ResetScheduler::TimerId ResetScheduler::Add(std::chrono::milliseconds period,
+                                            Callback fire) {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (config.startThread && timers.empty()) {
+    // The idle thread does not advance the wheel: catch up first.
+    current = std::max<std::uint64_t>(
+        current, (std::chrono::steady_clock::now() - origin) / config.tick);
+  }
+  auto timer = std::make_unique<Timer>();
+  timer->id = nextId++;
+  timer->period = std::max<std::uint64_t>(1, toTicks(period, config.tick));
+  timer->fire = std::move(fire);
+
+  std::chrono::milliseconds delay =
+      config.alignToWallClock
+          ? detail::AlignedDelay(std::chrono::system_clock::now(), period)
+          : period;
+  if (config.spread.count() > 0) {
+    // Golden-ratio sequence: consecutive timers land far apart, and any
+    // number of them covers [0, spread) evenly.
+    const std::uint64_t fraction = (timer->id * 0x9E3779B97F4A7C15ull) >> 32;
+    const auto spread = static_cast<std::uint64_t>(config.spread.count());
+    delay += std::chrono::milliseconds((fraction * spread) >> 32);
+  }
+  timer->expiry = current + toTicks(delay, config.tick);
+  InsertLocked(*timer);
+  const TimerId id = timer->id;
+  timers.emplace(id, std::move(timer));
+  stats.timers = timers.size();
+  wake.notify_all();
+  return id;
+}
+
+void ResetScheduler::Remove(TimerId id) {
+  std::unique_lock<std::mutex> lock(mutex);
+  const auto it = timers.find(id);
+  if (it == timers.end())
+    return;
+  Timer *timer = it->second.get();
+  while (timer->firing)
+    fireDone.wait_for(lock, config.tick);
+  timers.erase(it); // the hook unlinks itself
+  stats.timers = timers.size();
+}
+
+void ResetScheduler::InsertLocked(Timer &timer) {
+  const std::uint64_t expiry = std::max(timer.expiry, current);
+  const std::uint64_t delta = expiry - current;
+  std::size_t level = 0;
+  while (level + 1 < kLevels && delta >> (kSlotBits * (level + 1)) != 0)
+    ++level;
+  // Too far for the last level: park it at its far end, it is re-inserted
+  // with its real deadline when that slot is cascaded.
+  const std::uint64_t horizon = (std::uint64_t{1} << (kSlotBits * kLevels)) - 1;
+  const std::uint64_t slotTick = std::min(expiry, current + horizon);
+  const std::size_t slot = (slotTick >> (kSlotBits * level)) & (kSlots - 1);
+  wheel[level][slot].push_back(timer);
+  occupied[level] |= std::uint64_t{1} << slot;
+}
+
+void ResetScheduler::TickLocked() {
+  // Levels whose slot boundary is reached at this tick, highest first so a
+  // timer cascaded twice still ends up in level 0 before it is due.
+  std::size_t levels = 0;
+  while (levels + 1 < kLevels &&
+         (current & ((std::uint64_t{1} << (kSlotBits * (levels + 1))) - 1)) ==
+             0)
+    ++levels;
+  for (std::size_t level = levels; level > 0; --level) {
+    const std::size_t slot = (current >> (kSlotBits * level)) & (kSlots - 1);
+    TimerList cascaded;
+    cascaded.splice(cascaded.end(), wheel[level][slot]);
+    occupied[level] &= ~(std::uint64_t{1} << slot);
+    while (!cascaded.empty()) {
+      Timer &timer = cascaded.front();
+      cascaded.pop_front();
+      InsertLocked(timer);
+    }
+  }
+  const std::size_t slot = current & (kSlots - 1);
+  due.splice(due.end(), wheel[0][slot]);
+  occupied[0] &= ~(std::uint64_t{1} << slot);
+  ++current;
+}
+
+void ResetScheduler::FireDueLocked(std::unique_lock<std::mutex> &lock) {
+  std::vector<Timer *> batch;
+  while (!due.empty() &&
+         (config.maxBatch == 0 || batch.size() < config.maxBatch)) {
+    Timer &timer = due.front();
+    due.pop_front();
+    timer.firing = true;
+    if (timer.expiry + 1 < current)
+      ++stats.deferred;
+    batch.push_back(&timer);
+  }
+  if (batch.empty())
+    return;
+  ++stats.batches;
+  stats.fired += batch.size();
+  stats.maxBatchSize = std::max(stats.maxBatchSize, batch.size());
+
+  lock.unlock();
+  for (Timer *timer : batch)
+    timer->fire();
+  lock.lock();
+
+  for (Timer *timer : batch) {
+    timer->firing = false;
+    timer->expiry += timer->period;
+    while (timer->expiry < current) {
+      timer->expiry += timer->period;
+      ++stats.skipped;
+    }
+    InsertLocked(*timer);
+  }
+  fireDone.notify_all();
+}
+
+void ResetScheduler::AdvanceTo(std::chrono::steady_clock::time_point now) {
+  std::unique_lock<std::mutex> lock(mutex);
+  if (now < origin)
+    return;
+  const auto last = static_cast<std::uint64_t>((now - origin) / config.tick);
+  while (current <= last) {
+    if (timers.empty()) {
+      current = last + 1;
+      break;
+    }
+    const std::size_t offset = current & (kSlots - 1);
+    if (due.empty() && offset != 0) {
+      // Nothing to do before the next level-0 slot in use or the next
+      // cascade (slots below `offset` are in the next rotation).
+      const std::uint64_t ahead = occupied[0] >> offset;
+      const std::uint64_t idle =
+          ahead != 0 ? std::countr_zero(ahead) : kSlots - offset;
+      current = std::min(current + idle, last);
+    }
+    TickLocked();
+    FireDueLocked(lock);
+  }
+}
+
+std::chrono::steady_clock::time_point
+ResetScheduler::TickStart(std::uint64_t tick) const {
+  return origin + config.tick * static_cast<std::int64_t>(tick);
+}
+
+std::chrono::steady_clock::time_point ResetScheduler::Now() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return TickStart(current);
+}
+
+SchedulerStats ResetScheduler::GetStats() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return stats;
+}
+
+void ResetScheduler::Run() {
+  std::unique_lock<std::mutex> lock(mutex);
+  while (!stopping) {
+    if (timers.empty())
+      wake.wait_for(lock, std::chrono::seconds(1)); // Add() wakes it up
+    else
+      wake.wait_until(lock, TickStart(current));
+    if (stopping)
+      break;
+    const auto now = std::chrono::steady_clock::now();
+    if (TickStart(current) <= now) {
+      lock.unlock();
+      AdvanceTo(now);
+      lock.lock();
+    }
+  }
+}
+
+} // namespace ctm
@@ -0,0 +1,142 @@
+#ifndef RESET_SCHEDULER_HPP
+#define RESET_SCHEDULER_HPP
+
+#include <boost/intrusive/list.hpp>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace ctm // ctm == CrossRoad Traffic Monitoring
+{
+struct SchedulerConfig {
+  std::chrono::milliseconds tick{10}; // wheel resolution
+  // First deadline of a timer on the next multiple of its period on the
+  // system clock (an hourly period fires on the hour), not one period after
+  // Add().
+  bool alignToWallClock{false};
+  // Timers are offset by evenly spread amounts in [0, spread), so monitors
+  // sharing a period and a boundary do not all reset on the same tick.
+  std::chrono::milliseconds spread{0};
+  // Callbacks fired per tick at most; the rest wait for the next ticks.
+  // 0: no limit.
+  std::size_t maxBatch{0};
+  // Without the thread, nothing fires unless AdvanceTo() is called
+  // (simulations, tests).
+  bool startThread{true};
+};
+
+struct SchedulerStats {
+  std::size_t timers{0};
+  std::uint64_t fired{0};    // callbacks run
+  std::uint64_t batches{0};  // ticks that fired something
+  std::size_t maxBatchSize{0};
+  std::uint64_t deferred{0}; // fires pushed to a later tick by maxBatch
+  std::uint64_t skipped{0};  // periods missed because firing ran late
+};
+
+//-----------------------------------------------------------
+// Process-wide timing service for periodic resets (see
+// MonitorConfig::resetScheduler): the deadlines of every registered timer
+// live in one hierarchical timing wheel, advanced by a single thread.
+//
+//    - 4 levels of 64 slots. Level k holds the timers due within 64^(k+1)
+//      ticks; a slot of a higher level is cascaded into the lower ones when
+//      the wheel reaches it. Adding, removing and firing are O(1), whatever
+//      the number of timers; deadlines further than 64^4 ticks (about 46
+//      hours at 10 ms) wait in the last level and are re-inserted.
+//    - Ticks with nothing due and no cascade are skipped, using a bit per
+//      slot in use, so catching up after a stall is cheap.
+//    - Due timers fire in batches, one per tick, outside the scheduler
+//      lock. A periodic timer keeps its cadence: its next deadline is one
+//      period after the previous one, not after the callback returned.
+//-----------------------------------------------------------
+class ResetScheduler {
+public:
+  using TimerId = std::uint64_t;
+  using Callback = std::function<void()>;
+
+  explicit ResetScheduler(SchedulerConfig config = {});
+  ~ResetScheduler(); // stops the thread; remaining timers never fire
+
+  ResetScheduler(const ResetScheduler &) = delete;
+  ResetScheduler &operator=(const ResetScheduler &) = delete;
+
+  // Call `fire` every `period` (rounded up to whole ticks) from the firing
+  // thread. Thread-safe.
+  TimerId Add(std::chrono::milliseconds period, Callback fire);
+  // Waits while the timer's callback runs, so it must not be called from
+  // that callback. Thread-safe; unknown IDs are ignored.
+  void Remove(TimerId id);
+
+  // Fire everything due up to `now`, on the calling thread. Only without
+  // the scheduler's own thread (SchedulerConfig::startThread).
+  void AdvanceTo(std::chrono::steady_clock::time_point now);
+  // Time the wheel has reached (start of the next tick to process).
+  std::chrono::steady_clock::time_point Now() const;
+
+  SchedulerStats GetStats() const;
+
+private:
+  static constexpr unsigned kSlotBits = 6;
+  static constexpr std::size_t kSlots = std::size_t{1} << kSlotBits;
+  static constexpr std::size_t kLevels = 4;
+
+  struct Timer {
+    typedef boost::intrusive::list_member_hook<
+        boost::intrusive::link_mode<boost::intrusive::auto_unlink>>
+        Hook;
+    Hook hook; // wheel slot or due list
+    TimerId id{0};
+    std::uint64_t expiry{0}; // tick
+    std::uint64_t period{1}; // ticks
+    Callback fire;
+    bool firing{false};
+  };
+  typedef boost::intrusive::list<
+      Timer, boost::intrusive::member_hook<Timer, Timer::Hook, &Timer::hook>,
+      boost::intrusive::constant_time_size<false>>
+      TimerList;
+
+  // With mutex held:
+  void InsertLocked(Timer &timer);
+  void TickLocked(); // cascade, move the current slot to `due`, next tick
+  void FireDueLocked(std::unique_lock<std::mutex> &lock);
+  void Run(); // scheduler thread
+  std::chrono::steady_clock::time_point TickStart(std::uint64_t tick) const;
+
+  const SchedulerConfig config;
+  const std::chrono::steady_clock::time_point origin; // tick 0
+
+  mutable std::mutex mutex;
+  std::condition_variable wake;        // thread: new timer, stop
+  std::condition_variable fireDone;    // Remove: callback returned
+  std::array<std::array<TimerList, kSlots>, kLevels> wheel;
+  // Bit per slot that may hold timers (Remove() leaves bits set).
+  std::array<std::uint64_t, kLevels> occupied{};
+  TimerList due; // reached their tick, not fired yet (maxBatch)
+  std::uint64_t current{0}; // next tick to process
+  std::unordered_map<TimerId, std::unique_ptr<Timer>> timers;
+  TimerId nextId{1};
+  SchedulerStats stats;
+  bool stopping{false};
+  std::thread thread;
+};
+
+namespace detail {
+// Delay from `now` to the next multiple of `period` since the system clock
+// epoch, in (0, period].
+std::chrono::milliseconds AlignedDelay(std::chrono::system_clock::time_point now,
+                                       std::chrono::milliseconds period);
+} // namespace detail
+
+} // namespace ctm
+
+#endif // RESET_SCHEDULER_HPP
@@ -0,0 +1,377 @@
+#include "SignalTap.hpp"
+#include <algorithm>
+#include <barrier>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace ctm // ctm == CrossRoad Traffic Monitoring
+{
+
+namespace {
+std::atomic<std::uint64_t> nextTapId{1};
+
+// Last tap/buffer used by this thread, so Record() only takes the registry
+// lock the first time a thread records into a tap.
+struct TapThreadCache {
+  std::uint64_t tapId{0};
+  void *buffer{nullptr};
+};
+thread_local TapThreadCache tapCache;
+} // namespace
+
+SignalTap::SignalTap(const std::string &path, std::size_t recordsPerThread,
+                     std::chrono::milliseconds flushInterval)
+    : tapId{nextTapId.fetch_add(1)},
+      recordsPerThread{
+          std::bit_ceil(std::max<std::size_t>(recordsPerThread, 2))},
+      flushInterval{flushInterval}, openedAt{std::chrono::steady_clock::now()} {
+  file = std::fopen(path.c_str(), "wb");
+  if (!file)
+    return;
+
+  SignalTraceHeader header{};
+  std::memcpy(header.magic, kSignalTraceMagic, sizeof(header.magic));
+  header.version = kSignalTraceVersion;
+  header.recordSize = sizeof(SignalTraceRecord);
+  header.openedAtUnixNs = static_cast<std::uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::system_clock::now().time_since_epoch())
+          .count());
+  std::fwrite(&header, sizeof(header), 1, file);
+
+  open = true;
+  writer = std::thread([this] { WriterLoop(); });
+}
+
+SignalTap::~SignalTap() { Close(); }
+
+SignalTap::ThreadBuffer *SignalTap::BufferForThisThread() {
+  if (tapCache.tapId == tapId)
+    return static_cast<ThreadBuffer *>(tapCache.buffer);
+
+  std::lock_guard<std::mutex> lock(buffersMutex);
+  const auto self = std::this_thread::get_id();
+  ThreadBuffer *buffer = nullptr;
+  for (auto &b : buffers) {
+    if (b->owner == self) {
+      buffer = b.get();
+      break;
+    }
+  }
+  if (!buffer) {
+    buffers.push_back(std::make_unique<ThreadBuffer>(recordsPerThread));
+    buffer = buffers.back().get();
+    buffer->owner = self;
+  }
+  tapCache.tapId = tapId;
+  tapCache.buffer = buffer;
+  return buffer;
+}
+
+std::uint32_t SignalTap::Record(SignalKind kind, SignalOutcome outcome,
+                                CameraId camera,
+                                std::string_view id) noexcept {
+  const std::uint32_t number =
+      IsVehicleKind(kind)
+          ? sequence.load(std::memory_order_acquire)
+          : sequence.fetch_add(1, std::memory_order_acq_rel) + 1;
+  Record(kind, outcome, camera, id, number);
+  return number;
+}
+
+void SignalTap::Record(SignalKind kind, SignalOutcome outcome,
+                       CameraId camera, std::string_view id,
+                       std::uint32_t number) noexcept {
+  if (!open.load(std::memory_order_relaxed))
+    return;
+  ThreadBuffer *buffer = BufferForThisThread();
+
+  // Single producer: only this thread moves head. The writer's tail is only
+  // re-read when the ring looks full, so the hot path stays on lines this
+  // thread owns.
+  const std::uint64_t head = buffer->head.load(std::memory_order_relaxed);
+  if (head - buffer->cachedTail == buffer->capacity) {
+    buffer->cachedTail = buffer->tail.load(std::memory_order_acquire);
+    if (head - buffer->cachedTail == buffer->capacity) {
+      buffer->dropped.store(
+          buffer->dropped.load(std::memory_order_relaxed) + 1,
+          std::memory_order_relaxed);
+      return;
+    }
+  }
+
+  SignalTraceRecord &r = buffer->records[head & (buffer->capacity - 1)];
+  r.timestampNs = static_cast<std::uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now() - openedAt)
+          .count());
+  r.sequence = number;
+  r.kind = kind;
+  r.outcome = outcome;
+  r.camera = camera;
+  r.idLength =
+      static_cast<std::uint8_t>(std::min(id.size(), kTraceIdCapacity));
+  std::memcpy(r.id, id.data(), r.idLength);
+  buffer->head.store(head + 1, std::memory_order_release);
+}
+
+void SignalTap::WriterLoop() {
+  std::unique_lock<std::mutex> lock(writerMutex);
+  while (!writerCv.wait_for(lock, flushInterval, [this] { return stopping; })) {
+    Drain();
+  }
+}
+
+void SignalTap::Drain() {
+  std::lock_guard<std::mutex> lock(buffersMutex);
+  std::uint64_t dropped = 0;
+  for (auto &b : buffers) {
+    const std::uint64_t tail = b->tail.load(std::memory_order_relaxed);
+    const std::uint64_t head = b->head.load(std::memory_order_acquire);
+    std::uint64_t pos = tail;
+    // At most two contiguous pieces when the ring wraps.
+    while (pos != head) {
+      const std::size_t index = pos & (b->capacity - 1);
+      const std::size_t n = static_cast<std::size_t>(
+          std::min<std::uint64_t>(head - pos, b->capacity - index));
+      std::fwrite(&b->records[index], sizeof(SignalTraceRecord), n, file);
+      pos += n;
+    }
+    b->tail.store(head, std::memory_order_release);
+    written.fetch_add(head - tail, std::memory_order_relaxed);
+    dropped += b->dropped.load(std::memory_order_relaxed);
+  }
+  // Keep the header's count current, so a trace cut short by a crash still
+  // tells whether it is complete.
+  if (dropped != droppedInHeader) {
+    std::fseek(file, offsetof(SignalTraceHeader, droppedRecords), SEEK_SET);
+    std::fwrite(&dropped, sizeof(dropped), 1, file);
+    std::fseek(file, 0, SEEK_END);
+    droppedInHeader = dropped;
+  }
+  std::fflush(file);
+}
+
+void SignalTap::Close() {
+  if (!open.exchange(false))
+    return;
+  {
+    std::lock_guard<std::mutex> lock(writerMutex);
+    stopping = true;
+  }
+  writerCv.notify_one();
+  writer.join();
+  Drain();
+  std::fclose(file);
+  file = nullptr;
+}
+
+std::uint64_t SignalTap::GetWrittenCount() const {
+  return written.load(std::memory_order_relaxed);
+}
+
+std::uint64_t SignalTap::GetDroppedCount() const {
+  std::lock_guard<std::mutex> lock(buffersMutex);
+  std::uint64_t dropped = 0;
+  for (auto &b : buffers)
+    dropped += b->dropped.load(std::memory_order_relaxed);
+  return dropped;
+}
+
+// Replay driver
+namespace {
+// Record layout of versions 1 and 2, after a header without droppedRecords.
+struct SignalTraceRecordV2 {
+  std::uint64_t timestampNs;
+  SignalKind kind;
+  SignalOutcome outcome;
+  CameraId camera;
+  std::uint8_t idLength;
+  char id[36];
+};
+static_assert(sizeof(SignalTraceRecordV2) == 48, "version 2 record layout");
+constexpr std::size_t kHeaderSizeV2 =
+    offsetof(SignalTraceHeader, droppedRecords);
+} // namespace
+
+bool ReadSignalTrace(const std::string &path,
+                     std::vector<SignalTraceRecord> &records,
+                     std::uint64_t *droppedRecords) {
+  records.clear();
+  if (droppedRecords)
+    *droppedRecords = 0;
+  std::FILE *in = std::fopen(path.c_str(), "rb");
+  if (!in)
+    return false;
+
+  SignalTraceHeader header{};
+  bool valid =
+      std::fread(&header, kHeaderSizeV2, 1, in) == 1 &&
+      std::memcmp(header.magic, kSignalTraceMagic, sizeof(header.magic)) ==
+          0 &&
+      header.version >= 1 && header.version <= kSignalTraceVersion;
+  const bool legacy = valid && header.version < 3;
+  if (valid && legacy) {
+    valid = header.recordSize == sizeof(SignalTraceRecordV2);
+  } else if (valid) {
+    valid = header.recordSize == sizeof(SignalTraceRecord) &&
+            std::fread(&header.droppedRecords, sizeof(header.droppedRecords),
+                       1, in) == 1;
+  }
+  if (valid && legacy) {
+    SignalTraceRecordV2 old;
+    while (std::fread(&old, sizeof(old), 1, in) == 1) {
+      SignalTraceRecord r{};
+      r.timestampNs = old.timestampNs;
+      r.kind = old.kind;
+      r.outcome = old.outcome;
+      r.camera = old.camera;
+      r.idLength = static_cast<std::uint8_t>(
+          std::min<std::size_t>(old.idLength, kTraceIdCapacity));
+      std::memcpy(r.id, old.id, r.idLength);
+      records.push_back(r);
+    }
+  } else if (valid) {
+    SignalTraceRecord r;
+    while (std::fread(&r, sizeof(r), 1, in) == 1)
+      records.push_back(r);
+  }
+  std::fclose(in);
+
+  // Rings are drained per thread, restore the applied order: by sequence
+  // number, each control record before the vehicle records that carry its
+  // number (all sequence numbers are 0 before version 3).
+  const bool sequenced = header.version >= 3;
+  std::stable_sort(records.begin(), records.end(),
+                   [sequenced](const SignalTraceRecord &a,
+                               const SignalTraceRecord &b) {
+                     const bool aVehicle = IsVehicleKind(a.kind);
+                     const bool bVehicle = IsVehicleKind(b.kind);
+                     if (a.sequence != b.sequence)
+                       return a.sequence < b.sequence;
+                     if (aVehicle != bVehicle && sequenced)
+                       return !aVehicle;
+                     return a.timestampNs < b.timestampNs;
+                   });
+  if (droppedRecords)
+    *droppedRecords = header.droppedRecords;
+  return valid && header.droppedRecords == 0;
+}
+
+namespace {
+void replayRecord(CrossroadTrafficMonitoring &monitor,
+                  const SignalTraceRecord &r) {
+  switch (r.kind) {
+  case SignalKind::Bicycle:
+    monitor.OnSignal(Bicycle(std::string(r.Id()), r.camera));
+    break;
+  case SignalKind::Car:
+    monitor.OnSignal(Car(std::string(r.Id()), r.camera));
+    break;
+  case SignalKind::Scooter:
+    monitor.OnSignal(Scooter(std::string(r.Id()), r.camera));
+    break;
+  case SignalKind::Error:
+    monitor.OnSignal();
+    break;
+  case SignalKind::Reset:
+    monitor.OnSignal(ResetSignal{});
+    break;
+  case SignalKind::Start:
+    monitor.Start();
+    break;
+  case SignalKind::Stop:
+    monitor.Stop();
+    break;
+  }
+}
+
+// Same mixing as IngestPipeline::ShardFor, so a plate's partition does not
+// depend on the quality of the standard library's string hash.
+std::size_t partitionFor(std::string_view id, std::size_t partitions) {
+  std::uint64_t h = std::hash<std::string_view>{}(id);
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  return static_cast<std::size_t>(h % partitions);
+}
+} // namespace
+
+void ReplaySignalTrace(CrossroadTrafficMonitoring &monitor,
+                       const std::vector<SignalTraceRecord> &records) {
+  for (const auto &r : records)
+    replayRecord(monitor, r);
+}
+
+ParallelReplayStats
+ReplaySignalTraceParallel(const std::vector<CrossroadTrafficMonitoring *> &monitors,
+                          const std::vector<SignalTraceRecord> &records,
+                          std::size_t threads) {
+  ParallelReplayStats stats;
+  if (monitors.empty())
+    return stats;
+  threads = std::clamp<std::size_t>(threads, 1, 254);
+  const std::size_t n = records.size();
+
+  // Partition of every record (kControl for barriers), computed up front so
+  // replaying only compares one byte per record.
+  constexpr std::uint8_t kControl = 0xff;
+  std::vector<std::uint8_t> partition(n);
+  // Control record ending each segment (n for the last one).
+  std::vector<std::size_t> barriers;
+  for (std::size_t i = 0; i < n; ++i) {
+    if (IsVehicleKind(records[i].kind)) {
+      partition[i] =
+          static_cast<std::uint8_t>(partitionFor(records[i].Id(), threads));
+    } else {
+      partition[i] = kControl;
+      barriers.push_back(i);
+    }
+  }
+  barriers.push_back(n);
+
+  std::barrier sync(static_cast<std::ptrdiff_t>(threads));
+  auto replay = [&](std::size_t t) {
+    std::size_t begin = 0;
+    for (std::size_t end : barriers) {
+      for (std::size_t i = begin; i < end; ++i) {
+        if (partition[i] != t)
+          continue;
+        const SignalTraceRecord &r = records[i];
+        const std::size_t shard =
+            monitors.size() == 1 ? 0 : partitionFor(r.Id(), monitors.size());
+        replayRecord(*monitors[shard], r);
+      }
+      if (end == n)
+        break;
+      // Everyone finished the segment: thread 0 applies the control record
+      // while the others wait for it.
+      sync.arrive_and_wait();
+      if (t == 0) {
+        for (CrossroadTrafficMonitoring *m : monitors)
+          replayRecord(*m, records[end]);
+      }
+      sync.arrive_and_wait();
+      begin = end + 1;
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for (std::size_t t = 1; t < threads; ++t)
+    workers.emplace_back(replay, t);
+  replay(0);
+  for (auto &w : workers)
+    w.join();
+
+  stats.controlRecords = barriers.size() - 1;
+  stats.vehicleRecords = n - stats.controlRecords;
+  stats.segments = barriers.size();
+  return stats;
+}
+
+} // namespace ctm
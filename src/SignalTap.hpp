@@ -0,0 +1,216 @@
+#ifndef SIGNAL_TAP_HPP
+#define SIGNAL_TAP_HPP
+
+#include "CrossroadTrafficMonitoring.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace ctm // ctm == CrossRoad Traffic Monitoring
+{
+// Kind of recorded call: OnSignal, or a control call (Start, Stop, Reset;
+// Reset stands for every reset the monitor applied: Reset(),
+// OnSignal(ResetSignal), periodic and scheduled). The vehicle kinds share
+// values with VehicleCategory.
+enum class SignalKind : std::uint8_t {
+  Bicycle,
+  Car,
+  Scooter,
+  Error,
+  Reset,
+  Start, // since trace version 2
+  Stop
+};
+
+inline bool IsVehicleKind(SignalKind kind) {
+  return kind == SignalKind::Bicycle || kind == SignalKind::Car ||
+         kind == SignalKind::Scooter;
+}
+
+inline SignalKind ToSignalKind(VehicleCategory cat) {
+  return static_cast<SignalKind>(cat);
+}
+
+//-----------------------------------------------------------
+// Binary trace format:
+//    - SignalTraceHeader
+//    - SignalTraceRecord * N, grouped per recording thread
+// Records are in host byte order. ReadSignalTrace() returns them in the
+// order the monitors applied them:
+//    - Every control record takes the next sequence number of the tap,
+//      under the monitor's lock.
+//    - A vehicle record carries the sequence number of the last control
+//      record applied before it, and sorts after it; among themselves
+//      vehicle records sort by timestamp (taken under the lock, except in
+//      IngestMode::LockFree where signals of one period commute).
+// Version 1 and 2 traces (no sequence numbers, IDs up to 36 bytes, version
+// 1 without Start/Stop records) are still read, sorted by timestamp.
+//-----------------------------------------------------------
+static constexpr char kSignalTraceMagic[8] = {'C', 'T', 'M', 'T',
+                                              'R', 'A', 'C', 'E'};
+static constexpr std::uint32_t kSignalTraceVersion = 3;
+static constexpr std::size_t kTraceIdCapacity = 32;
+
+struct SignalTraceHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t recordSize;
+  std::uint64_t openedAtUnixNs; // wall clock when the tap was opened
+  std::uint64_t droppedRecords; // since version 3, rewritten on every flush
+};
+
+struct SignalTraceRecord {
+  std::uint64_t timestampNs; // since the tap was opened (steady clock)
+  std::uint32_t sequence;    // since version 3, see above
+  SignalKind kind;
+  SignalOutcome outcome;
+  CameraId camera;
+  std::uint8_t idLength; // stored length, IDs are cut at kTraceIdCapacity
+  char id[kTraceIdCapacity];
+
+  std::string_view Id() const { return {id, idLength}; }
+};
+static_assert(sizeof(SignalTraceRecord) == 48, "trace record layout");
+
+//-----------------------------------------------------------
+// SignalTap: records every OnSignal call of the monitors it is attached to
+// (see CrossroadTrafficMonitoring::SetSignalTap).
+//
+// Each recording thread gets its own single-producer ring, so recording a
+// vehicle signal is a clock read plus a 48 byte copy with no shared writes;
+// only control records bump the shared sequence number. A background thread
+// drains all rings into the file every flush interval. When a ring is full
+// the event is dropped and counted in the header, the caller is never
+// blocked.
+//-----------------------------------------------------------
+class SignalTap {
+public:
+  // recordsPerThread is rounded up to a power of two.
+  explicit SignalTap(
+      const std::string &path, std::size_t recordsPerThread = 4096,
+      std::chrono::milliseconds flushInterval = std::chrono::milliseconds(10));
+  ~SignalTap();
+
+  SignalTap(const SignalTap &) = delete;
+  SignalTap &operator=(const SignalTap &) = delete;
+
+  // false if the file could not be created; Record() is then a no-op.
+  bool IsOpen() const { return open.load(std::memory_order_relaxed); }
+
+  // Under the recording monitor's lock: a control kind takes the next
+  // sequence number, a vehicle kind the current one. Returns it.
+  std::uint32_t Record(SignalKind kind, SignalOutcome outcome,
+                       CameraId camera, std::string_view id) noexcept;
+  // With the sequence number the caller read while the signal was applied
+  // (IngestMode::LockFree, see CrossroadTrafficMonitoring::CountLockFree).
+  void Record(SignalKind kind, SignalOutcome outcome, CameraId camera,
+              std::string_view id, std::uint32_t number) noexcept;
+  // Sequence number of the last control record.
+  std::uint32_t Sequence() const {
+    return sequence.load(std::memory_order_acquire);
+  }
+
+  // Drain the remaining events and close the file. Detach the tap from all
+  // monitors first, events recorded during Close() may be lost.
+  void Close();
+
+  std::uint64_t GetWrittenCount() const;
+  std::uint64_t GetDroppedCount() const;
+
+private:
+  struct ThreadBuffer {
+    explicit ThreadBuffer(std::size_t capacity) // power of two
+        : records(new SignalTraceRecord[capacity]), capacity(capacity) {}
+    std::unique_ptr<SignalTraceRecord[]> records;
+    const std::size_t capacity;
+    std::thread::id owner;
+    alignas(64) std::atomic<std::uint64_t> head{0}; // written by owner
+    std::atomic<std::uint64_t> dropped{0};          // written by owner
+    std::uint64_t cachedTail{0}; // owner's last view of tail
+    alignas(64) std::atomic<std::uint64_t> tail{0}; // written by writer
+  };
+
+  ThreadBuffer *BufferForThisThread();
+  void WriterLoop();
+  void Drain(); // writer thread (or Close) only
+
+  const std::uint64_t tapId; // process-unique, keys the thread-local cache
+  const std::size_t recordsPerThread;
+  const std::chrono::milliseconds flushInterval;
+  const std::chrono::steady_clock::time_point openedAt;
+
+  std::FILE *file{nullptr};
+  std::atomic<bool> open{false};
+  std::atomic<std::uint64_t> written{0};
+  std::atomic<std::uint32_t> sequence{0};
+  std::uint64_t droppedInHeader{0}; // writer thread (or Close) only
+
+  mutable std::mutex buffersMutex;
+  std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+
+  std::mutex writerMutex;
+  std::condition_variable writerCv;
+  bool stopping{false};
+  std::thread writer;
+};
+
+//-----------------------------------------------------------
+// Replay driver
+//-----------------------------------------------------------
+
+// Read a trace written by SignalTap, in applied order. Returns false if the
+// file is missing or not a trace, and also if the tap dropped records: the
+// ones read are still returned, but replaying them does not reproduce the
+// recorded monitor. droppedRecords, if given, receives the count.
+bool ReadSignalTrace(const std::string &path,
+                     std::vector<SignalTraceRecord> &records,
+                     std::uint64_t *droppedRecords = nullptr);
+
+// Feed recorded calls back into a monitor in order, as fast as possible.
+// The monitor should be in the state the recording started in (started
+// first for version 1 traces, which do not record Start()).
+void ReplaySignalTrace(CrossroadTrafficMonitoring &monitor,
+                       const std::vector<SignalTraceRecord> &records);
+
+struct ParallelReplayStats {
+  std::uint64_t vehicleRecords{0};
+  std::uint64_t controlRecords{0}; // Start, Stop, Reset, camera errors
+  std::uint64_t segments{0};       // runs of vehicle records between them
+};
+
+//-----------------------------------------------------------
+// Recovery replay on `threads` threads, e.g. to rebuild monitors from a
+// long trace at startup.
+//
+//    - Vehicle records are partitioned by a hash of their ID, so every
+//      plate is replayed by one thread and in trace order. A record goes to
+//      monitors[hash % monitors.size()]: pass one monitor (best with
+//      IngestMode::LockFree) or one per shard.
+//    - Control records change the state every later signal depends on, so
+//      they are barriers: all threads finish the segment before it, then the
+//      record is applied to every monitor, then the next segment starts.
+//      A camera error thus counts once per monitor (each one has to enter
+//      the Error state): with several shards do not sum errorCount, take
+//      the largest cameraErrors as PartitionedMonitor::GetTotals() does.
+//
+// Within a segment signals of different plates commute, so the counts come
+// out as with ReplaySignalTrace(). Only which plates get in when the pool
+// runs out may differ.
+//-----------------------------------------------------------
+ParallelReplayStats
+ReplaySignalTraceParallel(const std::vector<CrossroadTrafficMonitoring *> &monitors,
+                          const std::vector<SignalTraceRecord> &records,
+                          std::size_t threads);
+
+} // namespace ctm
+
+#endif // SIGNAL_TAP_HPP
@@ -0,0 +1,76 @@
+#ifndef SPSC_QUEUE_HPP
+#define SPSC_QUEUE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ctm // ctm == CrossRoad Traffic Monitoring
+{
+//-----------------------------------------------------------
+// Bounded single-producer/single-consumer queue. Each side keeps a cached
+// copy of the other side's index and only re-reads it when the queue looks
+// full (producer) or empty (consumer), so a steady stream touches the shared
+// lines once per wrap rather than once per item. Items are moved in and out;
+// queues of batches (std::vector) hand over many items per operation.
+//-----------------------------------------------------------
+template <typename T> class SpscQueue {
+public:
+  // capacity is rounded up to a power of two.
+  explicit SpscQueue(std::size_t capacity)
+      : capacity{std::bit_ceil(std::max<std::size_t>(capacity, 2))},
+        slots(this->capacity) {}
+
+  SpscQueue(const SpscQueue &) = delete;
+  SpscQueue &operator=(const SpscQueue &) = delete;
+
+  // Producer only. false (and `item` untouched) when full.
+  bool TryPush(T &item) {
+    const std::uint64_t h = head.load(std::memory_order_relaxed);
+    if (h - cachedTail == capacity) {
+      cachedTail = tail.load(std::memory_order_acquire);
+      if (h - cachedTail == capacity)
+        return false;
+    }
+    slots[h & (capacity - 1)] = std::move(item);
+    head.store(h + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer only. false when empty.
+  bool TryPop(T &item) {
+    const std::uint64_t t = tail.load(std::memory_order_relaxed);
+    if (t == cachedHead) {
+      cachedHead = head.load(std::memory_order_acquire);
+      if (t == cachedHead)
+        return false;
+    }
+    item = std::move(slots[t & (capacity - 1)]);
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Items queued, from any thread (a snapshot).
+  std::size_t Size() const {
+    const std::uint64_t t = tail.load(std::memory_order_acquire);
+    const std::uint64_t h = head.load(std::memory_order_acquire);
+    return static_cast<std::size_t>(h - std::min(t, h));
+  }
+
+  std::size_t Capacity() const { return capacity; }
+
+private:
+  const std::size_t capacity;
+  std::vector<T> slots;
+  alignas(64) std::atomic<std::uint64_t> head{0}; // written by producer
+  std::uint64_t cachedTail{0};                    // producer's view of tail
+  alignas(64) std::atomic<std::uint64_t> tail{0}; // written by consumer
+  std::uint64_t cachedHead{0};                    // consumer's view of head
+};
+
+} // namespace ctm
+
+#endif // SPSC_QUEUE_HPP
@@ -0,0 +1,274 @@
+#include "Watchlist.hpp"
+#include "PlateCanonicalizer.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <limits>
+
+namespace ctm // ctm == CrossRoad Traffic Monitoring
+{
+
+namespace {
+// Listed plates are stored with a one byte length.
+constexpr std::size_t kMaxListedLength = std::numeric_limits<std::uint8_t>::max();
+
+std::uint64_t hashPlate(std::string_view plate) {
+  return std::hash<std::string_view>{}(plate);
+}
+
+// Second, independent-looking hash for the Bloom filter, so that its bits
+// are not correlated with the table index.
+std::uint64_t bloomHash(std::uint64_t h) {
+  h ^= h >> 31;
+  h *= 0xbf58476d1ce4e5b9ULL;
+  h ^= h >> 29;
+  return h;
+}
+} // namespace
+
+//-----------------------------------------------------------
+// Watchlist
+//-----------------------------------------------------------
+Watchlist::Watchlist(const std::vector<std::string> &plates, bool canonicalize)
+    : canonical{canonicalize} {
+  // ~16 filter bits per plate, table load factor <= 0.5.
+  bloomBlocks = std::bit_ceil(std::max<std::size_t>(
+      1, (plates.size() * 16 + 511) / 512));
+  bloom.assign(bloomBlocks * kBloomWordsPerBlock, 0);
+  slots.assign(std::bit_ceil(std::max<std::size_t>(16, plates.size() * 2)), 0);
+  arena.reserve(plates.size() * 8);
+
+  std::string canonicalPlate;
+  for (const std::string &raw : plates) {
+    std::string_view plate = raw;
+    if (canonical) {
+      if (CanonicalizePlate(raw, canonicalPlate) != PlateStatus::Ok) {
+        ++skipped;
+        continue;
+      }
+      plate = canonicalPlate;
+    }
+    if (plate.empty() || plate.size() > kMaxListedLength) {
+      ++skipped;
+      continue;
+    }
+    const std::uint64_t h = hashPlate(plate);
+    if (!Insert(plate, h)) {
+      ++skipped;
+      continue;
+    }
+    const std::uint64_t b = bloomHash(h);
+    std::uint64_t *block = &bloom[((b >> 36) & (bloomBlocks - 1)) *
+                                  kBloomWordsPerBlock];
+    for (unsigned i = 0; i < 4; ++i) {
+      const unsigned bit = (b >> (9 * i)) & 511;
+      block[bit >> 6] |= std::uint64_t{1} << (bit & 63);
+    }
+    ++size;
+  }
+  arena.shrink_to_fit();
+}
+
+bool Watchlist::Insert(std::string_view plate, std::uint64_t hash) {
+  const std::size_t mask = slots.size() - 1;
+  const std::uint64_t tag = hash >> 32;
+  for (std::size_t i = hash & mask;; i = (i + 1) & mask) {
+    const std::uint64_t slot = slots[i];
+    if (slot == 0) {
+      const std::size_t offset = arena.size();
+      if (offset >= std::numeric_limits<std::uint32_t>::max())
+        return false; // arena offsets are 32 bit
+      arena.push_back(static_cast<char>(plate.size()));
+      arena.insert(arena.end(), plate.begin(), plate.end());
+      slots[i] = (tag << 32) | (offset + 1);
+      return true;
+    }
+    if ((slot >> 32) == tag) {
+      const char *listed = &arena[(slot & 0xffffffffu) - 1];
+      if (static_cast<std::uint8_t>(listed[0]) == plate.size() &&
+          std::memcmp(listed + 1, plate.data(), plate.size()) == 0)
+        return false; // duplicate
+    }
+  }
+}
+
+bool Watchlist::MayContain(std::uint64_t hash) const {
+  const std::uint64_t b = bloomHash(hash);
+  const std::uint64_t *block =
+      &bloom[((b >> 36) & (bloomBlocks - 1)) * kBloomWordsPerBlock];
+  for (unsigned i = 0; i < 4; ++i) {
+    const unsigned bit = (b >> (9 * i)) & 511;
+    if (!(block[bit >> 6] & (std::uint64_t{1} << (bit & 63))))
+      return false;
+  }
+  return true;
+}
+
+bool Watchlist::Contains(std::string_view plate) const {
+  if (plate.empty() || plate.size() > kMaxListedLength)
+    return false;
+  const std::uint64_t hash = hashPlate(plate);
+  if (!MayContain(hash))
+    return false;
+  const std::size_t mask = slots.size() - 1;
+  const std::uint64_t tag = hash >> 32;
+  for (std::size_t i = hash & mask;; i = (i + 1) & mask) {
+    const std::uint64_t slot = slots[i];
+    if (slot == 0)
+      return false;
+    if ((slot >> 32) != tag)
+      continue;
+    const char *listed = &arena[(slot & 0xffffffffu) - 1];
+    if (static_cast<std::uint8_t>(listed[0]) == plate.size() &&
+        std::memcmp(listed + 1, plate.data(), plate.size()) == 0)
+      return true;
+  }
+}
+
+std::size_t Watchlist::MemoryBytes() const {
+  return sizeof(*this) + bloom.capacity() * sizeof(std::uint64_t) +
+         slots.capacity() * sizeof(std::uint64_t) + arena.capacity();
+}
+
+//-----------------------------------------------------------
+// WatchlistAlerts
+//-----------------------------------------------------------
+WatchlistAlerts::WatchlistAlerts(Callback callback, std::size_t queueCapacity,
+                                 std::chrono::milliseconds deliveryInterval)
+    : callback{std::move(callback)}, deliveryInterval{deliveryInterval},
+      capacity{std::bit_ceil(std::max<std::size_t>(2, queueCapacity))},
+      cells{std::make_unique<Cell[]>(capacity)} {
+  for (std::size_t i = 0; i < capacity; ++i)
+    cells[i].sequence.store(i, std::memory_order_relaxed);
+  delivery = std::thread([this] { DeliveryLoop(); });
+}
+
+WatchlistAlerts::~WatchlistAlerts() {
+  {
+    std::lock_guard<std::mutex> lock(deliveryMutex);
+    stopping = true;
+  }
+  deliveryCv.notify_one();
+  delivery.join();
+  delete current.load(std::memory_order_acquire);
+}
+
+void WatchlistAlerts::Swap(std::unique_ptr<const Watchlist> next) {
+  std::lock_guard<std::mutex> lock(swapMutex);
+  const Watchlist *old =
+      current.exchange(next.release(), std::memory_order_acq_rel);
+  if (old)
+    retired.emplace_back(std::unique_ptr<const Watchlist>(old),
+                         epochs.CurrentEpoch());
+  ReclaimRetired();
+}
+
+void WatchlistAlerts::ReclaimRetired() {
+  // Two advances make everything retired before this call safe, unless a
+  // checking thread is still pinned; the delivery thread retries later.
+  epochs.TryAdvance();
+  epochs.TryAdvance();
+  std::erase_if(retired,
+                [&](const auto &entry) { return epochs.IsSafe(entry.second); });
+}
+
+bool WatchlistAlerts::Check(VehicleCategory category, std::string_view id,
+                            CameraId camera) noexcept {
+  if (!current.load(std::memory_order_relaxed))
+    return false; // nothing to check, skip the pin
+  const auto guard = epochs.Pin();
+  const Watchlist *list = current.load(std::memory_order_acquire);
+  if (!list)
+    return false;
+
+  std::string_view plate = id;
+  std::string canonicalPlate; // fits the small string buffer, no allocation
+  if (list->Canonical()) {
+    if (CanonicalizePlate(id, canonicalPlate) != PlateStatus::Ok)
+      return false;
+    plate = canonicalPlate;
+  }
+  if (!list->Contains(plate))
+    return false;
+
+  matches.fetch_add(1, std::memory_order_relaxed);
+  WatchlistMatch match;
+  match.at = std::chrono::system_clock::now();
+  match.category = category;
+  match.camera = camera;
+  match.idLength =
+      static_cast<std::uint8_t>(std::min(plate.size(), kMatchIdCapacity));
+  std::memcpy(match.id, plate.data(), match.idLength);
+  if (!Enqueue(match))
+    dropped.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+// Bounded MPMC queue after Dmitry Vyukov, used with a single consumer: every
+// cell carries a sequence number telling producers and the consumer whose
+// turn it is, so a push is one CAS on enqueuePos plus a copy.
+bool WatchlistAlerts::Enqueue(const WatchlistMatch &match) noexcept {
+  std::uint64_t pos = enqueuePos.load(std::memory_order_relaxed);
+  for (;;) {
+    Cell &cell = cells[pos & (capacity - 1)];
+    const std::uint64_t seq = cell.sequence.load(std::memory_order_acquire);
+    const auto diff =
+        static_cast<std::int64_t>(seq) - static_cast<std::int64_t>(pos);
+    if (diff == 0) {
+      if (enqueuePos.compare_exchange_weak(pos, pos + 1,
+                                           std::memory_order_relaxed)) {
+        cell.match = match;
+        cell.sequence.store(pos + 1, std::memory_order_release);
+        return true;
+      }
+    } else if (diff < 0) {
+      return false; // full
+    } else {
+      pos = enqueuePos.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+bool WatchlistAlerts::Dequeue(WatchlistMatch &match) noexcept {
+  Cell &cell = cells[dequeuePos & (capacity - 1)];
+  if (cell.sequence.load(std::memory_order_acquire) != dequeuePos + 1)
+    return false;
+  match = cell.match;
+  cell.sequence.store(dequeuePos + capacity, std::memory_order_release);
+  ++dequeuePos;
+  return true;
+}
+
+void WatchlistAlerts::DeliveryLoop() {
+  bool stop = false;
+  while (!stop) {
+    {
+      std::unique_lock<std::mutex> lock(deliveryMutex);
+      deliveryCv.wait_for(lock, deliveryInterval, [&] { return stopping; });
+      stop = stopping;
+    }
+    WatchlistMatch match;
+    while (Dequeue(match)) {
+      if (callback)
+        callback(match);
+      delivered.fetch_add(1, std::memory_order_release);
+    }
+    std::lock_guard<std::mutex> lock(swapMutex);
+    if (!retired.empty())
+      ReclaimRetired();
+  }
+}
+
+std::uint64_t WatchlistAlerts::GetMatchCount() const {
+  return matches.load(std::memory_order_relaxed);
+}
+
+std::uint64_t WatchlistAlerts::GetDroppedCount() const {
+  return dropped.load(std::memory_order_relaxed);
+}
+
+std::uint64_t WatchlistAlerts::GetDeliveredCount() const {
+  return delivered.load(std::memory_order_acquire);
+}
+
+} // namespace ctm
@@ -0,0 +1,149 @@
+#ifndef WATCHLIST_HPP
+#define WATCHLIST_HPP
+
+#include "CrossroadTrafficMonitoring.hpp"
+#include "EpochReclamation.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace ctm // ctm == CrossRoad Traffic Monitoring
+{
+//-----------------------------------------------------------
+// Immutable set of watched plates, built once and then only read.
+//
+//    - A blocked Bloom filter (one cache line per plate, 4 bits) rejects
+//      almost every plate that is not listed with a single memory access.
+//    - Plates that pass are looked up in an open-addressing table of
+//      (hash tag, arena offset) slots and compared byte-wise against a
+//      packed arena of the listed plates, so there are no false positives.
+// Contains() never allocates. Sized for lists of up to a few million
+// plates (about 30 bytes per plate).
+//-----------------------------------------------------------
+class Watchlist {
+public:
+  // With `canonicalize`, plates are canonicalized (see PlateCanonicalizer)
+  // both here and when checked; malformed plates are skipped.
+  explicit Watchlist(const std::vector<std::string> &plates,
+                     bool canonicalize = true);
+
+  // `plate` must already be in the list's form (canonical if Canonical()).
+  bool Contains(std::string_view plate) const;
+
+  bool Canonical() const { return canonical; }
+  std::size_t Size() const { return size; }
+  std::size_t SkippedCount() const { return skipped; } // malformed, duplicate
+  std::size_t MemoryBytes() const;
+
+private:
+  static constexpr std::size_t kBloomWordsPerBlock = 8; // 64 bytes
+
+  bool MayContain(std::uint64_t hash) const;
+  bool Insert(std::string_view plate, std::uint64_t hash);
+
+  bool canonical;
+  std::size_t size{0};
+  std::size_t skipped{0};
+  std::vector<std::uint64_t> bloom; // blocks of kBloomWordsPerBlock words
+  std::size_t bloomBlocks{1};
+  std::vector<std::uint64_t> slots; // (tag << 32) | (arena offset + 1)
+  std::vector<char> arena;          // length byte + plate, back to back
+};
+
+// One watchlist hit. IDs longer than kMatchIdCapacity are cut.
+static constexpr std::size_t kMatchIdCapacity = 31;
+struct WatchlistMatch {
+  std::chrono::system_clock::time_point at{};
+  VehicleCategory category{VehicleCategory::Bicycle};
+  CameraId camera{0};
+  std::uint8_t idLength{0};
+  char id[kMatchIdCapacity]{};
+
+  std::string_view Id() const { return {id, idLength}; }
+};
+
+//-----------------------------------------------------------
+// Watchlist checking for monitors (see
+// CrossroadTrafficMonitoring::SetWatchlistAlerts): every accepted vehicle
+// signal is checked against the current list, and hits are delivered to
+// `callback` on a dedicated thread.
+//
+//    - Swap() replaces the list atomically while signals are checked. The
+//      old list is freed once no checking thread can still read it
+//      (epoch-based reclamation).
+//    - Hits go through a bounded multi-producer queue. When it is full the
+//      hit is dropped and counted: ingestion never waits for the callback.
+//-----------------------------------------------------------
+class WatchlistAlerts {
+public:
+  using Callback = std::function<void(const WatchlistMatch &)>;
+
+  // queueCapacity is rounded up to a power of two.
+  explicit WatchlistAlerts(Callback callback, std::size_t queueCapacity = 4096,
+                           std::chrono::milliseconds deliveryInterval =
+                               std::chrono::milliseconds(1));
+  ~WatchlistAlerts(); // delivers what is queued, then stops
+
+  WatchlistAlerts(const WatchlistAlerts &) = delete;
+  WatchlistAlerts &operator=(const WatchlistAlerts &) = delete;
+
+  // Install a new list (nullptr: check nothing). Thread-safe.
+  void Swap(std::unique_ptr<const Watchlist> next);
+
+  // Check one accepted signal; true (and queued) on a hit. Thread-safe and
+  // wait-free apart from the epoch pin.
+  bool Check(VehicleCategory category, std::string_view id,
+             CameraId camera) noexcept;
+
+  std::uint64_t GetMatchCount() const;     // hits, delivered or not
+  std::uint64_t GetDroppedCount() const;   // hits lost to a full queue
+  std::uint64_t GetDeliveredCount() const; // callback returned
+
+private:
+  struct Cell {
+    std::atomic<std::uint64_t> sequence{0};
+    WatchlistMatch match;
+  };
+
+  bool Enqueue(const WatchlistMatch &match) noexcept;
+  bool Dequeue(WatchlistMatch &match) noexcept; // delivery thread only
+  void DeliveryLoop();
+  void ReclaimRetired(); // swapMutex held
+
+  Callback callback;
+  const std::chrono::milliseconds deliveryInterval;
+
+  EpochManager epochs;
+  std::atomic<const Watchlist *> current{nullptr};
+  std::mutex swapMutex;
+  std::vector<std::pair<std::unique_ptr<const Watchlist>, std::uint64_t>>
+      retired; // list, retire epoch
+
+  const std::size_t capacity;
+  std::unique_ptr<Cell[]> cells;
+  alignas(64) std::atomic<std::uint64_t> enqueuePos{0};
+  alignas(64) std::uint64_t dequeuePos{0};
+
+  alignas(64) std::atomic<std::uint64_t> matches{0};
+  std::atomic<std::uint64_t> dropped{0};
+  std::atomic<std::uint64_t> delivered{0};
+
+  std::mutex deliveryMutex;
+  std::condition_variable deliveryCv;
+  bool stopping{false};
+  std::thread delivery;
+};
+
+} // namespace ctm
+
+#endif // WATCHLIST_HPP
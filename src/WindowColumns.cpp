@@ -0,0 +1,219 @@
+#include "WindowColumns.hpp"
+#include <algorithm>
+#include <bit>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace ctm // ctm == CrossRoad Traffic Monitoring
+{
+namespace detail {
+
+void AddColumnScalar(std::uint32_t *acc, const std::uint32_t *column,
+                     std::size_t n) {
+  for (std::size_t i = 0; i < n; ++i)
+    acc[i] += column[i];
+}
+
+void MaxColumnScalar(std::uint32_t *acc, const std::uint32_t *column,
+                     std::size_t n) {
+  for (std::size_t i = 0; i < n; ++i)
+    acc[i] = std::max(acc[i], column[i]);
+}
+
+void AddPresenceScalar(std::uint32_t *acc, const std::uint32_t *column,
+                       std::size_t n) {
+  for (std::size_t i = 0; i < n; ++i)
+    acc[i] += column[i] != 0;
+}
+
+std::size_t SelectAtLeastScalar(const std::uint32_t *values, std::size_t n,
+                                std::uint32_t threshold, std::uint32_t *out) {
+  std::size_t count = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    if (values[i] >= threshold)
+      out[count++] = static_cast<std::uint32_t>(i);
+  }
+  return count;
+}
+
+#if defined(__SSE2__)
+namespace {
+__m128i load(const std::uint32_t *p) {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+}
+void store(std::uint32_t *p, __m128i x) {
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(p), x);
+}
+// SSE2 only compares signed lanes: flipping the sign bit of both sides
+// turns an unsigned comparison into a signed one.
+__m128i signBit() { return _mm_set1_epi32(static_cast<int>(0x80000000u)); }
+} // namespace
+
+void AddColumnSimd(std::uint32_t *acc, const std::uint32_t *column,
+                   std::size_t n) {
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+    store(acc + i, _mm_add_epi32(load(acc + i), load(column + i)));
+  AddColumnScalar(acc + i, column + i, n - i);
+}
+
+void MaxColumnSimd(std::uint32_t *acc, const std::uint32_t *column,
+                   std::size_t n) {
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const __m128i a = load(acc + i);
+    const __m128i c = load(column + i);
+    const __m128i greater = _mm_cmpgt_epi32(_mm_xor_si128(c, signBit()),
+                                            _mm_xor_si128(a, signBit()));
+    store(acc + i, _mm_or_si128(_mm_and_si128(greater, c),
+                                _mm_andnot_si128(greater, a)));
+  }
+  MaxColumnScalar(acc + i, column + i, n - i);
+}
+
+void AddPresenceSimd(std::uint32_t *acc, const std::uint32_t *column,
+                     std::size_t n) {
+  const __m128i one = _mm_set1_epi32(1);
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const __m128i zero =
+        _mm_cmpeq_epi32(load(column + i), _mm_setzero_si128());
+    store(acc + i, _mm_add_epi32(load(acc + i), _mm_andnot_si128(zero, one)));
+  }
+  AddPresenceScalar(acc + i, column + i, n - i);
+}
+
+std::size_t SelectAtLeastSimd(const std::uint32_t *values, std::size_t n,
+                              std::uint32_t threshold, std::uint32_t *out) {
+  if (threshold == 0) {
+    for (std::size_t i = 0; i < n; ++i)
+      out[i] = static_cast<std::uint32_t>(i);
+    return n;
+  }
+  // values >= threshold  <=>  values > threshold - 1
+  const __m128i bound = _mm_xor_si128(
+      _mm_set1_epi32(static_cast<int>(threshold - 1)), signBit());
+  std::size_t count = 0;
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const __m128i above =
+        _mm_cmpgt_epi32(_mm_xor_si128(load(values + i), signBit()), bound);
+    for (unsigned m = static_cast<unsigned>(
+             _mm_movemask_ps(_mm_castsi128_ps(above)));
+         m != 0; m &= m - 1)
+      out[count++] = static_cast<std::uint32_t>(i + std::countr_zero(m));
+  }
+  for (; i < n; ++i) {
+    if (values[i] >= threshold)
+      out[count++] = static_cast<std::uint32_t>(i);
+  }
+  return count;
+}
+#else
+void AddColumnSimd(std::uint32_t *acc, const std::uint32_t *column,
+                   std::size_t n) {
+  AddColumnScalar(acc, column, n);
+}
+
+void MaxColumnSimd(std::uint32_t *acc, const std::uint32_t *column,
+                   std::size_t n) {
+  MaxColumnScalar(acc, column, n);
+}
+
+void AddPresenceSimd(std::uint32_t *acc, const std::uint32_t *column,
+                     std::size_t n) {
+  AddPresenceScalar(acc, column, n);
+}
+
+std::size_t SelectAtLeastSimd(const std::uint32_t *values, std::size_t n,
+                              std::uint32_t threshold, std::uint32_t *out) {
+  return SelectAtLeastScalar(values, n, threshold, out);
+}
+#endif
+
+} // namespace detail
+
+WindowColumns::WindowColumns(std::size_t keepWindows)
+    : keepWindows{keepWindows} {}
+
+void WindowColumns::Increment(std::uint32_t index, std::uint32_t by) {
+  if (index >= open.size())
+    open.resize(std::max<std::size_t>(index + 1, open.size() * 2));
+  open[index] += by;
+}
+
+std::uint64_t WindowColumns::Close() {
+  const std::size_t length = open.size();
+  // Trailing zeros come from the doubling above; drop them.
+  while (!open.empty() && open.back() == 0)
+    open.pop_back();
+  open.shrink_to_fit();
+  closed.push_back(std::move(open));
+  if (closed.size() > keepWindows)
+    closed.pop_front();
+  open.assign(length, 0);
+  return openWindow++;
+}
+
+const std::vector<std::uint32_t> *
+WindowColumns::Column(std::uint64_t window) const {
+  if (window == openWindow)
+    return &open;
+  if (window > openWindow || openWindow - window > closed.size())
+    return nullptr;
+  return &closed[closed.size() - (openWindow - window)];
+}
+
+std::vector<std::uint32_t>
+WindowColumns::Combine(const std::vector<std::uint64_t> &windows,
+                       Kernel kernel) const {
+  std::vector<const std::vector<std::uint32_t> *> columns;
+  std::size_t length = 0;
+  for (std::uint64_t w : windows) {
+    if (const auto *column = Column(w)) {
+      columns.push_back(column);
+      length = std::max(length, column->size());
+    }
+  }
+  std::vector<std::uint32_t> result(length, 0);
+  for (const auto *column : columns)
+    kernel(result.data(), column->data(), column->size());
+  return result;
+}
+
+std::vector<std::uint32_t>
+WindowColumns::Sum(const std::vector<std::uint64_t> &windows) const {
+  return Combine(windows, detail::AddColumnSimd);
+}
+
+std::vector<std::uint32_t>
+WindowColumns::Max(const std::vector<std::uint64_t> &windows) const {
+  return Combine(windows, detail::MaxColumnSimd);
+}
+
+std::vector<std::uint32_t>
+WindowColumns::WindowsSeen(const std::vector<std::uint64_t> &windows) const {
+  return Combine(windows, detail::AddPresenceSimd);
+}
+
+PresenceBitmap WindowColumns::AtLeast(const std::vector<std::uint32_t> &values,
+                                      std::uint32_t threshold) {
+  std::vector<std::uint32_t> indices(values.size());
+  indices.resize(detail::SelectAtLeastSimd(values.data(), values.size(),
+                                           threshold, indices.data()));
+  PresenceBitmap bitmap;
+  for (std::uint32_t index : indices) // ascending: appends to the last container
+    bitmap.Add(index);
+  return bitmap;
+}
+
+std::size_t WindowColumns::MemoryBytes() const {
+  std::size_t bytes = sizeof(*this) + open.capacity() * sizeof(std::uint32_t);
+  for (const auto &column : closed)
+    bytes += column.capacity() * sizeof(std::uint32_t);
+  return bytes;
+}
+
+} // namespace ctm
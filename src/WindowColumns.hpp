@@ -0,0 +1,91 @@
+#ifndef WINDOW_COLUMNS_HPP
+#define WINDOW_COLUMNS_HPP
+
+#include "PresenceBitmap.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace ctm // ctm == CrossRoad Traffic Monitoring
+{
+//-----------------------------------------------------------
+// Per-period sighting counters stored column-wise: one flat uint32 array
+// per period, indexed by a dense, stable plate index (the monitor's, see
+// MonitorConfig::plateIndexPeriods, or a KnownPlates index). "Sightings per
+// plate this week" is then a pass over contiguous arrays rather than a
+// lookup per plate and period.
+//    - The open period's column grows to the highest index counted; a new
+//      period starts at the previous one's length, so recurring plates do
+//      not grow it again.
+//    - The last keepWindows closed periods are kept. A column shorter than
+//      another simply has zeros past its end.
+// Sum, Max and WindowsSeen combine columns 4 counters at a time with SSE2
+// when available (scalar otherwise); AtLeast selects the indices of a
+// result at or above a threshold.
+//
+// Not thread-safe: PresenceHistory serializes access to its store.
+//-----------------------------------------------------------
+class WindowColumns {
+public:
+  explicit WindowColumns(std::size_t keepWindows);
+
+  void Increment(std::uint32_t index, std::uint32_t by = 1); // open period
+  // Close the open period (its number is returned) and open the next.
+  std::uint64_t Close();
+  std::uint64_t OpenWindow() const { return openWindow; }
+
+  // Column of one period (the open one included); nullptr if not kept.
+  const std::vector<std::uint32_t> *Column(std::uint64_t window) const;
+
+  // Per index, over the given periods (not kept ones count as zeros):
+  std::vector<std::uint32_t> Sum(const std::vector<std::uint64_t> &windows) const;
+  std::vector<std::uint32_t> Max(const std::vector<std::uint64_t> &windows) const;
+  // number of periods with a nonzero count
+  std::vector<std::uint32_t>
+  WindowsSeen(const std::vector<std::uint64_t> &windows) const;
+
+  // Indices whose value is >= threshold (threshold 0 selects every index).
+  static PresenceBitmap AtLeast(const std::vector<std::uint32_t> &values,
+                                std::uint32_t threshold);
+
+  std::size_t MemoryBytes() const;
+
+private:
+  using Kernel = void (*)(std::uint32_t *, const std::uint32_t *, std::size_t);
+  std::vector<std::uint32_t>
+  Combine(const std::vector<std::uint64_t> &windows, Kernel kernel) const;
+
+  const std::size_t keepWindows;
+  std::vector<std::uint32_t> open;
+  std::uint64_t openWindow{0};
+  std::deque<std::vector<std::uint32_t>> closed; // oldest first
+};
+
+namespace detail {
+// Column kernels, exposed for tests so the SSE2 and the scalar versions can
+// be checked against each other. Each combines `column` into `acc` over `n`
+// counters; sums wrap at 2^32.
+void AddColumnScalar(std::uint32_t *acc, const std::uint32_t *column,
+                     std::size_t n);
+void AddColumnSimd(std::uint32_t *acc, const std::uint32_t *column,
+                   std::size_t n);
+void MaxColumnScalar(std::uint32_t *acc, const std::uint32_t *column,
+                     std::size_t n);
+void MaxColumnSimd(std::uint32_t *acc, const std::uint32_t *column,
+                   std::size_t n);
+void AddPresenceScalar(std::uint32_t *acc, const std::uint32_t *column,
+                       std::size_t n); // +1 where column is nonzero
+void AddPresenceSimd(std::uint32_t *acc, const std::uint32_t *column,
+                     std::size_t n);
+// Indices i < n with values[i] >= threshold, ascending, into `out` (room
+// for n); returns how many.
+std::size_t SelectAtLeastScalar(const std::uint32_t *values, std::size_t n,
+                                std::uint32_t threshold, std::uint32_t *out);
+std::size_t SelectAtLeastSimd(const std::uint32_t *values, std::size_t n,
+                              std::uint32_t threshold, std::uint32_t *out);
+} // namespace detail
+
+} // namespace ctm
+
+#endif // WINDOW_COLUMNS_HPP
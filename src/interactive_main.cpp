@@ -1,9 +1,18 @@
 #include "CrossroadTrafficMonitoring.hpp"
+#include <array>
+#include <atomic>
+#include <bit>
 #include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
 #include <iostream>
 #include <limits>
+#include <mutex>
+#include <random>
 #include <string>
 #include <thread>
+#include <vector>
 
 using namespace ctm;
 
@@ -16,6 +25,8 @@ void displayMenu() {
   std::cout << "5. Signal Error\n";
   std::cout << "6. Display Statistics\n";
   std::cout << "7. Display Error Count\n";
+  std::cout << "8. Live Dashboard\n";
+  std::cout << "9. Start/Stop Camera Simulation\n";
   std::cout << "0. Exit\n";
   std::cout << "Select an option: ";
 }
@@ -33,9 +44,273 @@ T getValidInput(const std::string& prompt) {
   return value;
 }
 
+//-----------------------------------------------------------
+// Camera simulation: N threads, each acting as one camera, sending vehicle
+// signals at a fixed rate (or as fast as possible) while the menu keeps
+// running. OnSignal latencies go into a log2 histogram so throughput and
+// percentiles can be reported live.
+//-----------------------------------------------------------
+class CameraSimulation {
+public:
+  struct Report {
+    double throughput{0};        // signals per second over the interval
+    std::uint64_t p50Ns{0};      // upper bound of the p50 bucket
+    std::uint64_t p99Ns{0};      // upper bound of the p99 bucket
+    std::uint64_t maxNs{0};      // upper bound of the highest used bucket
+    std::uint64_t totalSignals{0};
+  };
+
+  static constexpr std::size_t kBuckets = 64; // bucket b: [2^(b-1), 2^b) ns
+  using Buckets = std::array<std::uint64_t, kBuckets>;
+
+  // Where a report starts. Every reader keeps its own, so the reporter
+  // thread and the dashboard don't reset each other's interval.
+  struct Baseline {
+    Buckets buckets{};
+    std::chrono::steady_clock::time_point time{};
+  };
+
+  explicit CameraSimulation(CrossroadTrafficMonitoring &monitor)
+      : monitor(monitor) {}
+  ~CameraSimulation() { Stop(); }
+
+  bool IsRunning() const { return !cameras.empty(); }
+
+  // ratePerCamera == 0 => send as fast as possible.
+  // reportEvery == 0 => no live printing (the dashboard still shows it).
+  void Start(unsigned cameraCount, unsigned ratePerCamera,
+             std::chrono::milliseconds reportEvery) {
+    Stop();
+    stopping = false;
+    runBaseline = Mark();
+    for (unsigned i = 0; i < cameraCount; ++i) {
+      cameras.emplace_back([this, i, ratePerCamera] {
+        RunCamera(static_cast<CameraId>(i), ratePerCamera);
+      });
+    }
+    if (reportEvery.count() > 0) {
+      reporter = std::thread([this, reportEvery] {
+        Baseline since = Mark();
+        std::unique_lock<std::mutex> lock(stopMutex);
+        while (!stopCv.wait_for(lock, reportEvery,
+                                [this] { return stopping.load(); })) {
+          const Report r = ReportSince(since);
+          if (!reporterPaused.load(std::memory_order_relaxed))
+            Print("[Sim] ", r);
+        }
+      });
+    }
+  }
+
+  void Stop() {
+    {
+      std::lock_guard<std::mutex> lock(stopMutex);
+      stopping = true;
+    }
+    stopCv.notify_all();
+    if (reporter.joinable())
+      reporter.join();
+    for (auto &t : cameras)
+      t.join();
+    cameras.clear();
+  }
+
+  // Keep the reporter thread quiet (e.g. while the dashboard owns the
+  // screen); it still moves its baseline along.
+  void PauseReporter(bool paused) { reporterPaused = paused; }
+
+  Baseline Mark() const {
+    return Baseline{Snapshot(), std::chrono::steady_clock::now()};
+  }
+
+  // Throughput and latencies since `since`, which then moves to now.
+  Report ReportSince(Baseline &since) const {
+    const Baseline now = Mark();
+    Buckets delta{};
+    std::uint64_t n = 0;
+    for (std::size_t b = 0; b < kBuckets; ++b) {
+      delta[b] = now.buckets[b] - since.buckets[b];
+      n += delta[b];
+    }
+    Report r;
+    r.throughput =
+        n / std::chrono::duration<double>(now.time - since.time).count();
+    r.p50Ns = Percentile(delta, n, 0.50);
+    r.p99Ns = Percentile(delta, n, 0.99);
+    r.maxNs = Percentile(delta, n, 1.0);
+    for (std::uint64_t c : now.buckets)
+      r.totalSignals += c;
+    since = now;
+    return r;
+  }
+
+  // The whole run so far.
+  Report RunReport() const {
+    Baseline since = runBaseline;
+    return ReportSince(since);
+  }
+
+  static void Print(const char *prefix, const Report &r) {
+    std::printf("%s%.0f signals/s, latency p50 <%llu ns, p99 <%llu ns, "
+                "max <%llu ns (%llu sent)\n",
+                prefix, r.throughput, static_cast<unsigned long long>(r.p50Ns),
+                static_cast<unsigned long long>(r.p99Ns),
+                static_cast<unsigned long long>(r.maxNs),
+                static_cast<unsigned long long>(r.totalSignals));
+    std::fflush(stdout);
+  }
+
+private:
+  static constexpr unsigned kDistinctPlates = 300; // x3 categories < pool
+
+  void RunCamera(CameraId camera, unsigned ratePerCamera) {
+    std::mt19937 rng(1234u + camera);
+    std::uniform_int_distribution<unsigned> plate(0, kDistinctPlates - 1);
+    std::uniform_int_distribution<int> category(0, 2);
+    const auto interval =
+        ratePerCamera ? std::chrono::nanoseconds(1000000000LL / ratePerCamera)
+                      : std::chrono::nanoseconds(0);
+    auto next = std::chrono::steady_clock::now();
+
+    while (!stopping.load(std::memory_order_relaxed)) {
+      const std::string id = "SIM-" + std::to_string(plate(rng));
+      const int cat = category(rng);
+
+      const auto start = std::chrono::steady_clock::now();
+      if (cat == 0) {
+        monitor.OnSignal(Bicycle(id, camera));
+      } else if (cat == 1) {
+        monitor.OnSignal(Car(id, camera));
+      } else {
+        monitor.OnSignal(Scooter(id, camera));
+      }
+      const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::steady_clock::now() - start)
+                          .count();
+      const auto bucket = std::bit_width(static_cast<std::uint64_t>(ns));
+      histogram[std::min<std::size_t>(bucket, kBuckets - 1)].fetch_add(
+          1, std::memory_order_relaxed);
+
+      if (ratePerCamera) {
+        next += interval;
+        std::this_thread::sleep_until(next);
+      }
+    }
+  }
+
+  Buckets Snapshot() const {
+    Buckets b{};
+    for (std::size_t i = 0; i < kBuckets; ++i)
+      b[i] = histogram[i].load(std::memory_order_relaxed);
+    return b;
+  }
+
+  static std::uint64_t Percentile(const Buckets &b, std::uint64_t n,
+                                  double q) {
+    if (n == 0)
+      return 0;
+    const auto rank = static_cast<std::uint64_t>(q * (n - 1)) + 1;
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < kBuckets; ++i) {
+      seen += b[i];
+      if (seen >= rank)
+        return std::uint64_t{1} << i;
+    }
+    return std::uint64_t{1} << (kBuckets - 1);
+  }
+
+  CrossroadTrafficMonitoring &monitor;
+  std::array<std::atomic<std::uint64_t>, kBuckets> histogram{};
+  std::vector<std::thread> cameras;
+  std::thread reporter;
+  std::atomic<bool> stopping{false};
+  std::mutex stopMutex;
+  std::condition_variable stopCv;
+  std::atomic<bool> reporterPaused{false};
+  Baseline runBaseline;
+};
+
+// Live top-style view. Redraws every `refresh` until Enter is pressed. Each
+// frame only fetches the O(1) totals and the top-N list, never the full
+// table, so watching the monitor doesn't load it.
+void runDashboard(CrossroadTrafficMonitoring &monitor,
+                  std::chrono::milliseconds refresh, std::size_t topN,
+                  CameraSimulation &simulation) {
+  std::mutex m;
+  std::condition_variable cv;
+  bool running = true;
+
+  simulation.PauseReporter(true); // its lines would tear the screen
+  std::thread view([&] {
+    MonitorTotals last = monitor.GetTotals();
+    auto lastTime = std::chrono::steady_clock::now();
+    CameraSimulation::Baseline simSince = simulation.Mark();
+    std::unique_lock<std::mutex> lock(m);
+    while (!cv.wait_for(lock, refresh, [&] { return !running; })) {
+      const MonitorTotals totals = monitor.GetTotals();
+      const auto top = monitor.GetTopVehicles(topN);
+      const auto now = std::chrono::steady_clock::now();
+      const double seconds =
+          std::chrono::duration<double>(now - lastTime).count();
+      const double throughput =
+          (totals.acceptedSignals - last.acceptedSignals) / seconds;
+      last = totals;
+      lastTime = now;
+
+      std::cout << "\033[2J\033[H"; // clear screen, cursor home
+      std::cout << "--- Live Dashboard (refresh " << refresh.count()
+                << " ms, press Enter to return) ---\n";
+      std::cout << "State: " << ToString(totals.state)
+                << "   Errors: " << totals.errorCount << "\n";
+      std::printf("Throughput: %.1f signals/s   Pool: %zu / %zu (%.1f%%)\n",
+                  throughput, totals.poolInUse, totals.poolCapacity,
+                  100.0 * totals.poolInUse / totals.poolCapacity);
+      std::fflush(stdout);
+
+      std::cout << "\nCategory   Vehicles   Sightings\n";
+      for (auto cat : {VehicleCategory::Bicycle, VehicleCategory::Car,
+                       VehicleCategory::Scooter}) {
+        const auto i = static_cast<std::size_t>(cat);
+        std::printf("%-10s %8zu   %9llu\n", ToString(cat),
+                    totals.uniqueVehicles[i],
+                    static_cast<unsigned long long>(totals.sightings[i]));
+      }
+      std::fflush(stdout);
+
+      if (simulation.IsRunning()) {
+        CameraSimulation::Print("Simulation: ",
+                                simulation.ReportSince(simSince));
+      }
+
+      std::cout << "\nTop " << topN << " vehicles:\n";
+      if (top.empty()) {
+        std::cout << "(No vehicles recorded)\n";
+      }
+      for (const auto &v : top) {
+        std::cout << v.id << " - " << ToString(v.category) << " (" << v.count
+                  << ")\n";
+      }
+      std::cout << std::flush;
+    }
+  });
+
+  // Wait for Enter (drop the rest of the line the menu choice was on first).
+  std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+  std::string line;
+  std::getline(std::cin, line);
+  {
+    std::lock_guard<std::mutex> lock(m);
+    running = false;
+  }
+  cv.notify_one();
+  view.join();
+  simulation.PauseReporter(false);
+}
+
 int main() {
   CrossroadTrafficMonitoring monitor(std::chrono::milliseconds(
       600000)); // 10-minute period for auto-reset, can be changed as desired.
+  CameraSimulation simulation(monitor);
   int choice;
 
   do {
@@ -252,6 +527,48 @@ int main() {
       std::cout << "Error Count: " << monitor.GetErrorCount() << "\n";
       break;
 
+    case 8: {
+      // Live dashboard
+      int refreshMs = getValidInput<int>("Refresh interval in ms: ");
+      int topN = getValidInput<int>("Number of top vehicles to show: ");
+      if (refreshMs <= 0 || topN < 0) {
+        std::cout << "Invalid dashboard settings.\n";
+        break;
+      }
+      runDashboard(monitor, std::chrono::milliseconds(refreshMs),
+                   static_cast<std::size_t>(topN), simulation);
+      break;
+    }
+
+    case 9: {
+      // Multi-threaded camera simulation, runs in the background
+      if (simulation.IsRunning()) {
+        CameraSimulation::Print("[Sim] whole run: ", simulation.RunReport());
+        simulation.Stop();
+        std::cout << "Camera simulation stopped.\n";
+        break;
+      }
+      int cameras = getValidInput<int>("Number of camera threads: ");
+      int rate = getValidInput<int>(
+          "Signals per second per camera (0 = as fast as possible): ");
+      int reportMs = getValidInput<int>(
+          "Print live stats every N ms (0 = only in the dashboard): ");
+      if (cameras <= 0 || cameras > 256 || rate < 0 || reportMs < 0) {
+        std::cout << "Invalid simulation settings.\n";
+        break;
+      }
+      if (monitor.GetCurrentState() != State::Active) {
+        std::cout << "Note: monitor is not Active, signals will not be "
+                     "counted.\n";
+      }
+      simulation.Start(static_cast<unsigned>(cameras),
+                       static_cast<unsigned>(rate),
+                       std::chrono::milliseconds(reportMs));
+      std::cout << "Camera simulation started with " << cameras
+                << " cameras. Select 9 again to stop.\n";
+      break;
+    }
+
     case 0:
       std::cout << "Exiting program.\n";
       break;
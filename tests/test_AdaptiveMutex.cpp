@@ -0,0 +1,80 @@
+#include "AdaptiveMutex.hpp"
+#include "CrossroadTrafficMonitoring.hpp"
+#include <chrono>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace ctm;
+
+//-----------------------------------------------------------------------------
+// Test Suite: Adaptive (spin-then-park) mutex
+//-----------------------------------------------------------------------------
+
+TEST(AdaptiveMutex, MutualExclusionWhenOversubscribed) {
+  std::cout << "\n[TEST] MutualExclusionWhenOversubscribed\n";
+  // More threads than cores: waiters must fall through to parking and still
+  // be woken, and no increment may be lost.
+  AdaptiveMutex lock;
+  std::uint64_t counter = 0; // protected by lock
+  constexpr int kThreads = 16;
+  constexpr int kIncrements = 20000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&] {
+      for (int i = 0; i < kIncrements; ++i) {
+        std::lock_guard<AdaptiveMutex> guard(lock);
+        ++counter;
+      }
+    });
+  }
+  for (auto &t : threads)
+    t.join();
+  std::cout << "  Counter: " << counter
+            << " (Expected: " << kThreads * kIncrements << ")\n";
+  EXPECT_EQ(counter, std::uint64_t{kThreads * kIncrements});
+  EXPECT_GE(lock.SpinBudget(), AdaptiveMutex::MIN_SPIN);
+  EXPECT_LE(lock.SpinBudget(), AdaptiveMutex::MAX_SPIN);
+}
+
+TEST(AdaptiveMutex, TryLockAndParkedWaiter) {
+  std::cout << "\n[TEST] TryLockAndParkedWaiter\n";
+  AdaptiveMutex lock;
+  ASSERT_TRUE(lock.try_lock());
+  EXPECT_FALSE(lock.try_lock());
+
+  // Held well past any spin budget, so the waiter parks and must be woken.
+  std::atomic<bool> acquired{false};
+  std::thread waiter([&] {
+    std::lock_guard<AdaptiveMutex> guard(lock);
+    acquired = true;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_FALSE(acquired.load());
+  lock.unlock();
+  waiter.join();
+  EXPECT_TRUE(acquired.load());
+  EXPECT_TRUE(lock.try_lock());
+  lock.unlock();
+}
+
+TEST(AdaptiveMutex, MonitorWithSpinThenParkPolicy) {
+  std::cout << "\n[TEST] MonitorWithSpinThenParkPolicy\n";
+  MonitorConfig config;
+  config.lockPolicy = LockPolicy::SpinThenPark;
+  CrossroadTrafficMonitoring monitor(std::chrono::hours(24), config);
+  monitor.Start();
+  std::vector<std::thread> cameras;
+  for (int t = 0; t < 4; ++t) {
+    cameras.emplace_back([&monitor] {
+      for (int i = 0; i < 1000; ++i)
+        monitor.OnSignal(Car("SP" + std::to_string(i % 10)));
+    });
+  }
+  for (auto &c : cameras)
+    c.join();
+  EXPECT_EQ(monitor.GetTotals().acceptedSignals, 4000u);
+  EXPECT_EQ(monitor.GetVehicleCount(VehicleCategory::Car, "SP3"), 400u);
+}
@@ -0,0 +1,174 @@
+#include "CrossroadTrafficMonitoring.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace ctm;
+
+namespace {
+MonitorConfig lockFree(StorageLayout layout = StorageLayout::PerCategory) {
+  MonitorConfig config;
+  config.ingest = IngestMode::LockFree;
+  config.layout = layout;
+  return config;
+}
+
+// The same deterministic mix of signals for both modes.
+void feed(CrossroadTrafficMonitoring &monitor) {
+  for (int i = 0; i < 300; ++i) {
+    const std::string id = "P" + std::to_string((i * 7) % 40);
+    switch (i % 3) {
+    case 0:
+      monitor.OnSignal(Car(id));
+      break;
+    case 1:
+      monitor.OnSignal(Bicycle(id));
+      break;
+    default:
+      monitor.OnSignal(Scooter(id));
+      break;
+    }
+  }
+}
+} // namespace
+
+//-----------------------------------------------------------------------------
+// Test Suite: Lock-free ingestion (IngestMode::LockFree)
+//-----------------------------------------------------------------------------
+
+TEST(ConcurrentVehicleIndex, MatchesMutexMode) {
+  std::cout << "\n[TEST] MatchesMutexMode\n";
+  for (auto layout : {StorageLayout::PerCategory, StorageLayout::PerPlate}) {
+    MonitorConfig mutexConfig;
+    mutexConfig.layout = layout;
+    CrossroadTrafficMonitoring expected(std::chrono::hours(1), mutexConfig);
+    CrossroadTrafficMonitoring actual(std::chrono::hours(1), lockFree(layout));
+    expected.Start();
+    actual.Start();
+    feed(expected);
+    feed(actual);
+
+    // Same lines; lock-free mode orders one ID's categories like PerPlate
+    // (category order) rather than by first sighting.
+    auto lines = actual.GetStatistics();
+    auto expectedLines = expected.GetStatistics();
+    if (layout == StorageLayout::PerPlate) {
+      EXPECT_EQ(lines, expectedLines);
+    }
+    std::sort(lines.begin(), lines.end());
+    std::sort(expectedLines.begin(), expectedLines.end());
+    EXPECT_EQ(lines, expectedLines);
+    EXPECT_EQ(actual.GetStatistics(VehicleCategory::Car).size(),
+              expected.GetStatistics(VehicleCategory::Car).size());
+    const auto top = actual.GetTopVehicles(5);
+    const auto expectedTop = expected.GetTopVehicles(5);
+    ASSERT_EQ(top.size(), expectedTop.size());
+    for (std::size_t i = 0; i < top.size(); ++i) {
+      EXPECT_EQ(top[i].id, expectedTop[i].id);
+      EXPECT_EQ(top[i].count, expectedTop[i].count);
+    }
+    EXPECT_EQ(actual.GetVehicleCount("P7").perCategory,
+              expected.GetVehicleCount("P7").perCategory);
+    EXPECT_EQ(actual.GetVehicleCount(VehicleCategory::Car, "P0"),
+              expected.GetVehicleCount(VehicleCategory::Car, "P0"));
+
+    const MonitorTotals totals = actual.GetTotals();
+    const MonitorTotals expectedTotals = expected.GetTotals();
+    std::cout << "  Layout " << static_cast<int>(layout) << ": pool in use "
+              << totals.poolInUse << " (Expected: " << expectedTotals.poolInUse
+              << ")\n";
+    EXPECT_EQ(totals.uniqueVehicles, expectedTotals.uniqueVehicles);
+    EXPECT_EQ(totals.sightings, expectedTotals.sightings);
+    EXPECT_EQ(totals.acceptedSignals, expectedTotals.acceptedSignals);
+    EXPECT_EQ(totals.poolInUse, expectedTotals.poolInUse);
+  }
+}
+
+TEST(ConcurrentVehicleIndex, ConcurrentIngestCountsEverySignal) {
+  std::cout << "\n[TEST] ConcurrentIngestCountsEverySignal\n";
+  CrossroadTrafficMonitoring monitor(std::chrono::hours(1), lockFree());
+  monitor.Start();
+
+  // Every thread hits the same plates, so inserts race on the same keys.
+  constexpr int kThreads = 8;
+  constexpr int kSignals = 3000;
+  constexpr int kPlates = 64;
+  std::vector<std::thread> cameras;
+  for (int t = 0; t < kThreads; ++t) {
+    cameras.emplace_back([&monitor, t] {
+      for (int i = 0; i < kSignals; ++i) {
+        const std::string id = "CAM" + std::to_string((i + t) % kPlates);
+        if (i % 2 == 0)
+          monitor.OnSignal(Car(id, static_cast<CameraId>(t)));
+        else
+          monitor.OnSignal(Bicycle(id, static_cast<CameraId>(t)));
+      }
+    });
+  }
+  for (auto &c : cameras)
+    c.join();
+
+  const MonitorTotals totals = monitor.GetTotals();
+  std::cout << "  Accepted: " << totals.acceptedSignals
+            << " (Expected: " << kThreads * kSignals << ")\n";
+  EXPECT_EQ(totals.acceptedSignals, std::uint64_t{kThreads * kSignals});
+  EXPECT_EQ(totals.uniqueVehicles[1], std::size_t{kPlates}); // Car
+  EXPECT_EQ(totals.uniqueVehicles[0], std::size_t{kPlates}); // Bicycle
+  EXPECT_EQ(totals.poolInUse, std::size_t{2 * kPlates});     // no duplicates
+
+  const auto stats = monitor.GetStatistics();
+  EXPECT_EQ(stats.size(), std::size_t{2 * kPlates});
+  EXPECT_TRUE(std::is_sorted(stats.begin(), stats.end()));
+  unsigned sum = 0;
+  for (int p = 0; p < kPlates; ++p)
+    sum += monitor.GetVehicleCount("CAM" + std::to_string(p)).Total();
+  EXPECT_EQ(sum, unsigned{kThreads * kSignals});
+}
+
+TEST(ConcurrentVehicleIndex, ResetDuringIngestAndPoolReuse) {
+  std::cout << "\n[TEST] ResetDuringIngestAndPoolReuse\n";
+  CrossroadTrafficMonitoring monitor(std::chrono::hours(1), lockFree());
+  monitor.Start();
+
+  // Resets race with ingestion and readers; vehicles are recycled through
+  // the pool many times over.
+  std::atomic<bool> stop{false};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&, t] {
+      for (int i = 0; !stop.load(); ++i)
+        monitor.OnSignal(Scooter("S" + std::to_string((i * 13 + t) % 700)));
+    });
+  }
+  threads.emplace_back([&] {
+    while (!stop.load())
+      (void)monitor.GetStatistics();
+  });
+  for (int r = 0; r < 50; ++r) {
+    monitor.Reset();
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  }
+  stop = true;
+  for (auto &t : threads)
+    t.join();
+
+  // Once quiet, a reset leaves an empty monitor and the whole pool usable.
+  monitor.Reset();
+  EXPECT_TRUE(monitor.GetStatistics().empty());
+  EXPECT_EQ(monitor.GetTotals().poolInUse, 0u);
+  EXPECT_EQ(monitor.GetMemoryUsage().idHeapLiveBytes, 0u);
+  for (int i = 0; i < 1000; ++i)
+    monitor.OnSignal(Car("FILL" + std::to_string(i)));
+  EXPECT_EQ(monitor.GetErrorCount(), 0u);
+  monitor.OnSignal(Car("ONE-TOO-MANY"));
+  std::cout << "  Errors after overfilling: " << monitor.GetErrorCount()
+            << " (Expected: 1)\n";
+  EXPECT_EQ(monitor.GetErrorCount(), 1u);
+  EXPECT_EQ(monitor.GetTotals().poolInUse, 1000u);
+  EXPECT_GT(monitor.GetMemoryUsage().heapIndexBytes, 0u);
+}
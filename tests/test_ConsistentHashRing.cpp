@@ -0,0 +1,87 @@
+#include "ConsistentHashRing.hpp"
+#include <gtest/gtest.h>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace ctm;
+
+//-----------------------------------------------------------------------------
+// Test Suite: ConsistentHashRing
+//-----------------------------------------------------------------------------
+
+namespace {
+std::vector<std::string> makeKeys(std::size_t count) {
+  std::vector<std::string> keys;
+  for (std::size_t k = 0; k < count; ++k)
+    keys.push_back("PL" + std::to_string(k));
+  return keys;
+}
+} // namespace
+
+TEST(ConsistentHashRing, SpreadsKeysEvenly) {
+  std::cout << "\n[TEST] SpreadsKeysEvenly\n";
+  ConsistentHashRing ring;
+  for (ConsistentHashRing::NodeId node : {3u, 1u, 7u, 5u})
+    ring.AddNode(node);
+  ring.AddNode(1); // already there
+  EXPECT_EQ(ring.Nodes(), (std::vector<ConsistentHashRing::NodeId>{1, 3, 5, 7}));
+
+  const std::vector<std::string> keys = makeKeys(20000);
+  std::map<ConsistentHashRing::NodeId, std::size_t> share;
+  for (const std::string &key : keys)
+    ++share[ring.NodeFor(key)];
+  for (const auto &[node, count] : share) {
+    std::cout << "  node " << node << ": " << count
+              << " keys (Expected: about 5000)\n";
+    EXPECT_GT(count, 4000u);
+    EXPECT_LT(count, 6000u);
+  }
+  // Stable across instances (and processes: no std::hash).
+  ConsistentHashRing other;
+  for (ConsistentHashRing::NodeId node : {1u, 3u, 5u, 7u})
+    other.AddNode(node);
+  for (const std::string &key : keys)
+    ASSERT_EQ(other.NodeFor(key), ring.NodeFor(key));
+}
+
+TEST(ConsistentHashRing, MovesOnlyTheKeysOfTheChangedNode) {
+  std::cout << "\n[TEST] MovesOnlyTheKeysOfTheChangedNode\n";
+  ConsistentHashRing ring;
+  for (ConsistentHashRing::NodeId node = 0; node < 4; ++node)
+    ring.AddNode(node);
+  const std::vector<std::string> keys = makeKeys(20000);
+  std::vector<ConsistentHashRing::NodeId> before;
+  for (const std::string &key : keys)
+    before.push_back(ring.NodeFor(key));
+
+  ring.AddNode(4);
+  std::size_t moved = 0;
+  for (std::size_t k = 0; k < keys.size(); ++k) {
+    const auto now = ring.NodeFor(keys[k]);
+    if (now != before[k]) {
+      EXPECT_EQ(now, 4u); // only to the new node
+      ++moved;
+    }
+  }
+  std::cout << "  moved on add: " << moved << " (Expected: about 4000)\n";
+  EXPECT_GT(moved, 3000u);
+  EXPECT_LT(moved, 5000u);
+
+  ring.RemoveNode(4);
+  for (std::size_t k = 0; k < keys.size(); ++k)
+    ASSERT_EQ(ring.NodeFor(keys[k]), before[k]); // back where they were
+
+  ring.RemoveNode(2);
+  for (std::size_t k = 0; k < keys.size(); ++k) {
+    if (before[k] != 2)
+      ASSERT_EQ(ring.NodeFor(keys[k]), before[k]); // only node 2's keys move
+    else
+      ASSERT_NE(ring.NodeFor(keys[k]), 2u);
+  }
+  ring.RemoveNode(0);
+  ring.RemoveNode(1);
+  ring.RemoveNode(3);
+  EXPECT_TRUE(ring.Empty());
+}
@@ -0,0 +1,240 @@
+#include "CrdtReplica.hpp"
+#include "CrossroadTrafficMonitoring.hpp"
+#include "KnownPlates.hpp"
+#include <algorithm>
+#include <climits>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace ctm;
+
+//-----------------------------------------------------------------------------
+// Test Suite: CrdtReplica
+//-----------------------------------------------------------------------------
+
+TEST(CrdtReplica, GCounterMergeIsOrderInsensitive) {
+  std::cout << "\n[TEST] GCounterMergeIsOrderInsensitive\n";
+  std::mt19937 rng(122);
+  for (int round = 0; round < 200; ++round) {
+    GCounter a, b, c;
+    for (GCounter *counter : {&a, &b, &c}) {
+      for (int i = rng() % 6; i > 0; --i)
+        counter->Increment(rng() % 4, rng() % 5);
+    }
+    GCounter ab = a, ba = b, abc1 = a, abc2 = c, twice = a;
+    ab.Merge(b);
+    ba.Merge(a);
+    EXPECT_EQ(ab, ba); // commutative
+    abc1.Merge(b);
+    abc1.Merge(c);
+    GCounter bc = b;
+    bc.Merge(c);
+    abc2 = a;
+    abc2.Merge(bc);
+    EXPECT_EQ(abc1, abc2); // associative
+    twice.Merge(b);
+    EXPECT_FALSE(twice.Merge(b)); // idempotent
+    EXPECT_EQ(twice, ab);
+    EXPECT_GE(ab.Value(), std::max(a.Value(), b.Value()));
+  }
+  GCounter counter;
+  counter.Increment(7, 2);
+  counter.Increment(3);
+  EXPECT_EQ(counter.Value(), 3u);
+  EXPECT_EQ(counter.Get(7), 2u);
+  EXPECT_FALSE(counter.Raise(7, 1));
+  EXPECT_TRUE(counter.Raise(7, 5));
+  EXPECT_EQ(counter.Value(), 6u);
+}
+
+TEST(CrdtReplica, RedundantNodesConvergeThroughDeltas) {
+  std::cout << "\n[TEST] RedundantNodesConvergeThroughDeltas\n";
+  constexpr std::size_t kNodes = 3;
+  MonitorConfig config;
+  config.canonicalizePlates = true;
+  std::vector<std::unique_ptr<CrossroadTrafficMonitoring>> monitors;
+  std::vector<std::unique_ptr<CrdtReplica>> replicas;
+  for (NodeId n = 0; n < kNodes; ++n) {
+    monitors.push_back(
+        std::make_unique<CrossroadTrafficMonitoring>(std::chrono::hours(1),
+                                                     config));
+    replicas.push_back(std::make_unique<CrdtReplica>(100 + n));
+    monitors[n]->SetCrdtReplica(replicas[n].get());
+    monitors[n]->Start();
+  }
+
+  // Each node sees part of the district's traffic; gossip rounds exchange
+  // deltas that are lost, duplicated and reordered.
+  std::mt19937 rng(1220);
+  std::vector<std::string> pending[kNodes]; // inboxes
+  std::vector<std::size_t> expected(20);   // cars per plate, all nodes
+  for (int round = 0; round < 30; ++round) {
+    for (int s = 0; s < 40; ++s) {
+      const std::size_t node = rng() % kNodes, plate = rng() % expected.size();
+      monitors[node]->OnSignal(Car("car-" + std::to_string(plate)));
+      ++expected[plate];
+    }
+    for (std::size_t from = 0; from < kNodes; ++from) {
+      const std::string delta = replicas[from]->TakeDelta();
+      for (std::size_t to = 0; to < kNodes; ++to) {
+        if (to == from || delta.empty() || rng() % 5 == 0)
+          continue; // lost
+        pending[to].push_back(delta);
+        if (rng() % 4 == 0)
+          pending[to].push_back(delta); // duplicated
+      }
+    }
+    for (std::size_t to = 0; to < kNodes; ++to) {
+      std::shuffle(pending[to].begin(), pending[to].end(), rng);
+      if (round % 2 == 0)
+        continue; // delivered late
+      for (const std::string &delta : pending[to])
+        EXPECT_TRUE(replicas[to]->Merge(delta));
+      pending[to].clear();
+    }
+  }
+  // Lost deltas are repaired by one anti-entropy pass of full states.
+  for (std::size_t from = 0; from < kNodes; ++from) {
+    const std::string state = replicas[from]->Serialize();
+    for (std::size_t to = 0; to < kNodes; ++to)
+      EXPECT_TRUE(replicas[to]->Merge(state));
+  }
+
+  const std::vector<std::string> stats = replicas[0]->GetStatistics();
+  for (std::size_t n = 1; n < kNodes; ++n)
+    EXPECT_EQ(replicas[n]->GetStatistics(), stats);
+  for (std::size_t plate = 0; plate < expected.size(); ++plate) {
+    const std::string id = "CAR" + std::to_string(plate);
+    std::uint64_t perNode = 0;
+    for (NodeId n = 0; n < kNodes; ++n)
+      perNode += replicas[2]->GetNodeCount(100 + n, VehicleCategory::Car, id);
+    EXPECT_EQ(replicas[1]->GetVehicleCount(id).Total(), expected[plate]) << id;
+    EXPECT_EQ(perNode, expected[plate]) << id;
+  }
+  std::cout << "  CAR7 on node 0: " << replicas[0]->GetVehicleCount("CAR7").Total()
+            << " (Expected: " << expected[7] << ")\n";
+
+  // A node joining late catches up from one full state.
+  CrdtReplica late(200);
+  late.BeginEpoch(replicas[1]->Epoch()); // as its monitor would
+  EXPECT_TRUE(late.Merge(replicas[1]->Serialize()));
+  EXPECT_EQ(late.GetStatistics(), stats);
+  EXPECT_EQ(late.GetStats().plates, expected.size());
+  for (auto &monitor : monitors)
+    monitor->SetCrdtReplica(nullptr);
+}
+
+TEST(CrdtReplica, RejectsMalformedPayloads) {
+  std::cout << "\n[TEST] RejectsMalformedPayloads\n";
+  CrdtReplica source(1);
+  source.Record(VehicleCategory::Car, "AB1");
+  source.Record(VehicleCategory::Car, "AB1");
+  source.Record(VehicleCategory::Scooter, "AB1");
+  source.Record(VehicleCategory::Bicycle, "XY2");
+  const std::string payload = source.TakeDelta();
+  EXPECT_TRUE(source.TakeDelta().empty()); // nothing changed since
+
+  CrdtReplica target(2);
+  for (std::size_t length = 0; length < payload.size(); ++length)
+    EXPECT_FALSE(target.Merge(payload.substr(0, length))) << length;
+  EXPECT_FALSE(target.Merge(payload + '\0')); // trailing bytes
+  std::string badVersion = payload;
+  badVersion[4] = 9;
+  EXPECT_FALSE(target.Merge(badVersion));
+  EXPECT_TRUE(target.GetStatistics().empty());
+  EXPECT_EQ(target.GetStats().payloadsRejected, payload.size() + 2);
+
+  EXPECT_TRUE(target.Merge(payload));
+  EXPECT_TRUE(target.Merge(payload));
+  EXPECT_EQ(target.GetStatistics(),
+            (std::vector<std::string>{"AB1 - Car (2)", "AB1 - Scooter (1)",
+                                      "XY2 - Bicycle (1)"}));
+  EXPECT_EQ(target.GetStats().entriesRaised, 3u);
+  // Merged counts travel on in the receiver's next delta.
+  CrdtReplica third(3);
+  EXPECT_TRUE(third.Merge(target.TakeDelta()));
+  EXPECT_EQ(third.GetVehicleCount("AB1").Total(), 3u);
+}
+
+TEST(CrdtReplica, EpochsFollowMonitorResets) {
+  std::cout << "\n[TEST] EpochsFollowMonitorResets\n";
+  for (IngestMode mode : {IngestMode::Mutex, IngestMode::LockFree}) {
+    MonitorConfig config;
+    config.ingest = mode;
+    config.canonicalizePlates = true;
+    config.errorBufferCapacity = 4;
+    config.knownPlates =
+        std::make_shared<const KnownPlates>(std::vector<std::string>{"FL1"});
+    CrossroadTrafficMonitoring monitor(std::chrono::hours(1), config);
+    CrdtReplica replica(1);
+    monitor.SetCrdtReplica(&replica);
+    monitor.Start();
+    const std::uint64_t first = replica.Epoch();
+    EXPECT_GT(first, 0u); // wall-clock period
+
+    monitor.OnSignal(Car("ab-1"));
+    monitor.OnSignal(Car("fl 1"));
+    monitor.Reset();
+    const std::uint64_t second = replica.Epoch();
+    EXPECT_GT(second, first);
+    EXPECT_EQ(replica.GetVehicleCount("AB1", first).Total(), 1u);
+    EXPECT_EQ(replica.GetVehicleCount("FL1", first).Total(), 1u);
+    EXPECT_TRUE(replica.GetStatistics().empty()); // the new period
+
+    // A buffered signal is replayed into the period after the reset.
+    monitor.OnSignal();
+    monitor.OnSignal(Car("AB.1"));
+    monitor.Reset();
+    monitor.SetCrdtReplica(nullptr);
+    // (Expected: the first period is dropped, the empty second one holds
+    // nothing)
+    std::cout << "  Epochs holding counts: " << replica.GetStats().epochs
+              << " (Expected: 1)\n";
+    EXPECT_EQ(replica.GetStats().epochs, 1u);
+    EXPECT_EQ(replica.GetVehicleCount("AB1", first).Total(), 0u);
+    EXPECT_EQ(replica.GetStatistics(),
+              std::vector<std::string>{"AB1 - Car (1)"});
+  }
+}
+
+TEST(CrdtReplica, SkipsOldEpochsAndSaturatesCounts) {
+  std::cout << "\n[TEST] SkipsOldEpochsAndSaturatesCounts\n";
+  CrdtReplica old(1);
+  old.BeginEpoch(5);
+  old.Record(VehicleCategory::Car, "AB1");
+  const std::string stale = old.Serialize();
+
+  CrdtReplica replica(2);
+  replica.BeginEpoch(7);
+  EXPECT_TRUE(replica.Merge(stale)); // well formed, but not kept
+  EXPECT_EQ(replica.GetStats().platesSkipped, 1u);
+  EXPECT_EQ(replica.GetStats().plates, 0u);
+
+  // Epochs 6 and 7 are kept; 8 (one ahead) is accepted too.
+  replica.Record(6, VehicleCategory::Car, "AB1");
+  replica.Record(8, VehicleCategory::Car, "AB1");
+  replica.Record(9, VehicleCategory::Car, "AB1");
+  EXPECT_EQ(replica.GetVehicleCount("AB1", 6).Total(), 1u);
+  EXPECT_EQ(replica.GetVehicleCount("AB1", 8).Total(), 1u);
+  EXPECT_EQ(replica.GetVehicleCount("AB1", 9).Total(), 0u);
+  replica.BeginEpoch(8);
+  EXPECT_EQ(replica.GetVehicleCount("AB1", 6).Total(), 0u);
+  EXPECT_EQ(replica.GetVehicleCount("AB1").Total(), 1u);
+
+  // A count beyond 32 bits: exact per node, saturated in VehicleCount.
+  CrdtReplica busy(3);
+  busy.BeginEpoch(8);
+  // version 2, sender 9, one epoch: 8, one plate: "AB1", Car, one entry:
+  // node 9, count 2^33
+  const std::string huge("CRDT\x02\x09\x01\x08\x01\x03" "AB1"
+                         "\x02\x01\x09\x80\x80\x80\x80\x20",
+                         21);
+  EXPECT_TRUE(busy.Merge(huge));
+  EXPECT_EQ(busy.GetNodeCount(9, VehicleCategory::Car, "AB1"),
+            std::uint64_t{1} << 33);
+  EXPECT_EQ(busy.GetVehicleCount("AB1").perCategory[1], UINT_MAX);
+}
@@ -2,6 +2,7 @@
 #include <chrono>
 #include <gtest/gtest.h>
 #include <iostream>
+#include <random>
 #include <thread>
 
 using namespace ctm;
@@ -394,4 +395,786 @@ TEST(DataValidation, TestMaxVehiclesCapacity) {
   std::cout << "  Expect errorCount still=1, Actual=" << monitor.GetErrorCount()
             << std::endl;
   EXPECT_EQ(monitor.GetErrorCount(), 1u);
-}
\ No newline at end of file
+}
+//-----------------------------------------------------------------------------
+// Test Suite: Totals and Top Vehicles
+//-----------------------------------------------------------------------------
+
+TEST(Totals, TrackCountsErrorsAndPoolOccupancy) {
+  std::cout << "\n[TEST] TrackCountsErrorsAndPoolOccupancy\n";
+  CrossroadTrafficMonitoring monitor(std::chrono::hours(24));
+  monitor.Start();
+
+  monitor.OnSignal(Car("C1"));
+  monitor.OnSignal(Car("C1"));
+  monitor.OnSignal(Car("C2"));
+  monitor.OnSignal(Scooter("S1"));
+
+  MonitorTotals totals = monitor.GetTotals();
+  std::cout << "  Cars: " << totals.uniqueVehicles[1] << " vehicles, "
+            << totals.sightings[1] << " sightings (Expected: 2, 3)\n";
+  EXPECT_EQ(totals.state, State::Active);
+  EXPECT_EQ(totals.uniqueVehicles[static_cast<std::size_t>(VehicleCategory::Car)], 2u);
+  EXPECT_EQ(totals.sightings[static_cast<std::size_t>(VehicleCategory::Car)], 3u);
+  EXPECT_EQ(totals.uniqueVehicles[static_cast<std::size_t>(VehicleCategory::Scooter)], 1u);
+  EXPECT_EQ(totals.uniqueVehicles[static_cast<std::size_t>(VehicleCategory::Bicycle)], 0u);
+  EXPECT_EQ(totals.acceptedSignals, 4u);
+  EXPECT_EQ(totals.poolInUse, 3u);
+  EXPECT_EQ(totals.poolCapacity, 1000u);
+
+  monitor.OnSignal();
+  monitor.OnSignal(Car("C1")); // error state, not accepted
+  totals = monitor.GetTotals();
+  EXPECT_EQ(totals.state, State::Error);
+  EXPECT_EQ(totals.errorCount, 2u);
+  EXPECT_EQ(totals.acceptedSignals, 4u);
+
+  std::cout << "  Resetting: period totals clear, accepted signals do not\n";
+  monitor.Reset();
+  totals = monitor.GetTotals();
+  EXPECT_EQ(totals.sightings[static_cast<std::size_t>(VehicleCategory::Car)], 0u);
+  EXPECT_EQ(totals.poolInUse, 0u);
+  EXPECT_EQ(totals.acceptedSignals, 4u);
+}
+
+TEST(Totals, TopVehiclesOrderedByCountThenId) {
+  std::cout << "\n[TEST] TopVehiclesOrderedByCountThenId\n";
+  CrossroadTrafficMonitoring monitor(std::chrono::hours(24));
+  monitor.Start();
+
+  for (int i = 0; i < 3; ++i)
+    monitor.OnSignal(Bicycle("B"));
+  for (int i = 0; i < 2; ++i) {
+    monitor.OnSignal(Car("D"));
+    monitor.OnSignal(Car("A"));
+  }
+  monitor.OnSignal(Scooter("Z"));
+
+  const auto top = monitor.GetTopVehicles(3);
+  ASSERT_EQ(top.size(), 3u);
+  std::cout << "  Top: " << top[0].id << ", " << top[1].id << ", "
+            << top[2].id << " (Expected: B, A, D)\n";
+  EXPECT_EQ(top[0].id, "B");
+  EXPECT_EQ(top[0].count, 3u);
+  EXPECT_EQ(top[1].id, "A");
+  EXPECT_EQ(top[1].category, VehicleCategory::Car);
+  EXPECT_EQ(top[2].id, "D");
+
+  EXPECT_EQ(monitor.GetTopVehicles(10).size(), 4u);
+  EXPECT_TRUE(monitor.GetTopVehicles(0).empty());
+}
+
+TEST(Totals, RunningTopListMatchesFullWalk) {
+  std::cout << "\n[TEST] RunningTopListMatchesFullWalk\n";
+  for (StorageLayout layout :
+       {StorageLayout::PerCategory, StorageLayout::PerPlate}) {
+    MonitorConfig config;
+    config.layout = layout;
+    config.plateRetentionPeriods = 2;
+    CrossroadTrafficMonitoring monitor(std::chrono::hours(24), config);
+    monitor.Start();
+
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> plate(0, 199);
+    std::uniform_int_distribution<int> category(0, 2);
+    for (int i = 0; i < 20000; ++i) {
+      const std::string id = "P" + std::to_string(plate(rng) * plate(rng) / 200);
+      switch (category(rng)) {
+      case 0:
+        monitor.OnSignal(Bicycle(id));
+        break;
+      case 1:
+        monitor.OnSignal(Car(id));
+        break;
+      default:
+        monitor.OnSignal(Scooter(id));
+      }
+      if (i % 997 == 0)
+        monitor.CompactStep(8); // moves entries that are on the top list
+      if (i == 12000)
+        monitor.Reset();
+    }
+
+    // 32 comes from the running list, longer lists from a walk
+    const auto running = monitor.GetTopVehicles(32);
+    auto walked = monitor.GetTopVehicles(500);
+    ASSERT_EQ(running.size(), 32u);
+    walked.resize(32);
+    std::cout << "  Top: " << running[0].id << " (" << running[0].count
+              << "), walk: " << walked[0].id << " (" << walked[0].count
+              << ")\n";
+    for (std::size_t i = 0; i < running.size(); ++i) {
+      EXPECT_EQ(running[i].id, walked[i].id);
+      EXPECT_EQ(running[i].category, walked[i].category);
+      EXPECT_EQ(running[i].count, walked[i].count);
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+// Test Suite: PerPlate Storage Layout
+//-----------------------------------------------------------------------------
+
+static MonitorConfig perPlateConfig() {
+  MonitorConfig config;
+  config.layout = StorageLayout::PerPlate;
+  return config;
+}
+
+TEST(PerPlateLayout, SameIdDifferentCategoriesSharesOneEntry) {
+  std::cout << "\n[TEST] SameIdDifferentCategoriesSharesOneEntry\n";
+  CrossroadTrafficMonitoring monitor(std::chrono::hours(24), perPlateConfig());
+  monitor.Start();
+
+  // Seen as a Scooter first: output is still in category order.
+  monitor.OnSignal(Scooter("ID-123"));
+  monitor.OnSignal(Car("ID-123"));
+  monitor.OnSignal(Bicycle("ID-123"));
+  monitor.OnSignal(Car("ID-123"));
+  monitor.OnSignal(Car("AAA"));
+
+  const auto allStats = monitor.GetStatistics();
+  ASSERT_EQ(allStats.size(), 4u);
+  EXPECT_EQ(allStats[0], "AAA - Car (1)");
+  EXPECT_EQ(allStats[1], "ID-123 - Bicycle (1)");
+  EXPECT_EQ(allStats[2], "ID-123 - Car (2)");
+  EXPECT_EQ(allStats[3], "ID-123 - Scooter (1)");
+
+  const auto cars = monitor.GetStatistics(VehicleCategory::Car);
+  ASSERT_EQ(cars.size(), 2u);
+  EXPECT_EQ(cars[0], "AAA - Car (1)");
+  EXPECT_EQ(cars[1], "ID-123 - Car (2)");
+  EXPECT_EQ(monitor.GetStatistics(VehicleCategory::Scooter).size(), 1u);
+
+  const MonitorTotals totals = monitor.GetTotals();
+  std::cout << "  Pool entries used: " << totals.poolInUse
+            << " (Expected: 2)\n";
+  EXPECT_EQ(totals.poolInUse, 2u);
+  EXPECT_EQ(totals.uniqueVehicles[static_cast<std::size_t>(VehicleCategory::Car)], 2u);
+  EXPECT_EQ(totals.uniqueVehicles[static_cast<std::size_t>(VehicleCategory::Bicycle)], 1u);
+
+  const auto top = monitor.GetTopVehicles(1);
+  ASSERT_EQ(top.size(), 1u);
+  EXPECT_EQ(top[0].id, "ID-123");
+  EXPECT_EQ(top[0].category, VehicleCategory::Car);
+  EXPECT_EQ(top[0].count, 2u);
+
+  monitor.Reset();
+  EXPECT_TRUE(monitor.GetStatistics().empty());
+  EXPECT_EQ(monitor.GetTotals().poolInUse, 0u);
+}
+
+TEST(PerPlateLayout, CapacityCountsPlatesNotCategories) {
+  std::cout << "\n[TEST] CapacityCountsPlatesNotCategories\n";
+  CrossroadTrafficMonitoring monitor(std::chrono::hours(24), perPlateConfig());
+  monitor.Start();
+
+  for (int i = 0; i < 1000; ++i) {
+    const std::string id = "ID-" + std::to_string(i);
+    monitor.OnSignal(Bicycle(id));
+    monitor.OnSignal(Car(id));
+    monitor.OnSignal(Scooter(id));
+  }
+  std::cout << "  Entries: " << monitor.GetStatistics().size()
+            << " (Expected: 3000), errors: " << monitor.GetErrorCount() << "\n";
+  EXPECT_EQ(monitor.GetStatistics().size(), 3000u);
+  EXPECT_EQ(monitor.GetErrorCount(), 0u);
+
+  monitor.OnSignal(Car("ID-1000"));
+  EXPECT_EQ(monitor.GetErrorCount(), 1u);
+}
+
+//-----------------------------------------------------------------------------
+// Test Suite: Point Queries
+//-----------------------------------------------------------------------------
+
+TEST(PointQueries, GetVehicleCountByIdAndCategory) {
+  std::cout << "\n[TEST] GetVehicleCountByIdAndCategory\n";
+  for (StorageLayout layout :
+       {StorageLayout::PerCategory, StorageLayout::PerPlate}) {
+    MonitorConfig config;
+    config.layout = layout;
+    CrossroadTrafficMonitoring monitor(std::chrono::hours(24), config);
+    monitor.Start();
+
+    monitor.OnSignal(Car("X-1"));
+    monitor.OnSignal(Car("X-1"));
+    monitor.OnSignal(Scooter("X-1"));
+    monitor.OnSignal(Bicycle("Y-2"));
+
+    const VehicleCount x = monitor.GetVehicleCount("X-1");
+    std::cout << "  X-1 total: " << x.Total() << " (Expected: 3)\n";
+    EXPECT_TRUE(x.Found());
+    EXPECT_EQ(x.Total(), 3u);
+    EXPECT_EQ(x.perCategory[static_cast<std::size_t>(VehicleCategory::Car)], 2u);
+    EXPECT_EQ(x.perCategory[static_cast<std::size_t>(VehicleCategory::Scooter)], 1u);
+    EXPECT_EQ(x.perCategory[static_cast<std::size_t>(VehicleCategory::Bicycle)], 0u);
+
+    EXPECT_EQ(monitor.GetVehicleCount(VehicleCategory::Car, "X-1"), 2u);
+    EXPECT_EQ(monitor.GetVehicleCount(VehicleCategory::Bicycle, "X-1"), 0u);
+    EXPECT_EQ(monitor.GetVehicleCount(VehicleCategory::Bicycle, "Y-2"), 1u);
+    EXPECT_FALSE(monitor.GetVehicleCount("NOPE").Found());
+
+    monitor.Reset();
+    EXPECT_FALSE(monitor.GetVehicleCount("X-1").Found());
+  }
+}
+
+TEST(PointQueries, QueriesAreCanonicalizedLikeSignals) {
+  std::cout << "\n[TEST] QueriesAreCanonicalizedLikeSignals\n";
+  MonitorConfig config;
+  config.canonicalizePlates = true;
+  CrossroadTrafficMonitoring monitor(std::chrono::hours(24), config);
+  monitor.Start();
+
+  monitor.OnSignal(Car("ab-123"));
+  EXPECT_EQ(monitor.GetVehicleCount(VehicleCategory::Car, "AB 123"), 1u);
+  EXPECT_EQ(monitor.GetVehicleCount("Ab.123").Total(), 1u);
+  EXPECT_FALSE(monitor.GetVehicleCount("AB_123").Found());
+}
+
+TEST(PointQueries, FullPoolStaysConsistent) {
+  std::cout << "\n[TEST] FullPoolStaysConsistent\n";
+  CrossroadTrafficMonitoring monitor(std::chrono::hours(24));
+  monitor.Start();
+  for (int round = 0; round < 2; ++round) {
+    for (int i = 0; i < 1000; ++i)
+      monitor.OnSignal(Car("ID-" + std::to_string(i)));
+  }
+  for (int i = 0; i < 1000; i += 97) {
+    EXPECT_EQ(monitor.GetVehicleCount(VehicleCategory::Car,
+                                      "ID-" + std::to_string(i)),
+              2u);
+  }
+  monitor.Reset();
+  monitor.OnSignal(Car("ID-5"));
+  EXPECT_EQ(monitor.GetVehicleCount(VehicleCategory::Car, "ID-5"), 1u);
+  EXPECT_EQ(monitor.GetVehicleCount(VehicleCategory::Car, "ID-6"), 0u);
+}
+
+//-----------------------------------------------------------------------------
+// Test Suite: Plate Hand-off
+//-----------------------------------------------------------------------------
+
+TEST(PlateHandOff, ExportEraseImportMovesCounts) {
+  std::cout << "\n[TEST] ExportEraseImportMovesCounts\n";
+  for (StorageLayout layout :
+       {StorageLayout::PerCategory, StorageLayout::PerPlate}) {
+    MonitorConfig config;
+    config.layout = layout;
+    CrossroadTrafficMonitoring from(std::chrono::hours(24), config);
+    CrossroadTrafficMonitoring to(std::chrono::hours(24), config);
+    from.Start();
+    to.Start();
+    // 40 plates, so the top board (32 pairs) is full
+    for (int i = 0; i < 40; ++i) {
+      for (int n = 0; n <= i; ++n)
+        from.OnSignal(Car("P - " + std::to_string(i)));
+    }
+    from.OnSignal(Scooter("P - 39"));
+    from.OnSignal();                 // camera error
+    from.OnSignal(Car("P - 0"));     // Error state: not counted, an error
+    to.OnSignal(Bicycle("OTHER"));
+    const MonitorTotals before = from.GetTotals();
+
+    std::vector<VehicleStats> moving;
+    for (const VehicleStats &s : from.ExportVehicles()) {
+      if (s.id == "P - 39" || s.id == "P - 38")
+        moving.push_back(s);
+    }
+    ASSERT_EQ(moving.size(), 3u);
+    EXPECT_TRUE(from.EraseVehicles({"P - 39", "P - 38", "NOPE"}));
+    EXPECT_TRUE(to.ImportVehicles(moving));
+    EXPECT_TRUE(to.ImportVehicles(moving)); // adds up
+
+    // (Expected: the plates left with their counts, nothing else changed)
+    const MonitorTotals after = from.GetTotals();
+    EXPECT_EQ(after.state, State::Error);
+    EXPECT_EQ(after.errorCount, 2u);
+    EXPECT_EQ(after.cameraErrors, 1u);
+    EXPECT_EQ(after.acceptedSignals, before.acceptedSignals);
+    EXPECT_EQ(after.uniqueVehicles[1], 38u);
+    EXPECT_EQ(after.uniqueVehicles[2], 0u);
+    EXPECT_EQ(after.sightings[1], before.sightings[1] - 40 - 39);
+    EXPECT_FALSE(from.GetVehicleCount("P - 39").Found());
+    EXPECT_EQ(from.GetStatistics().size(), 38u);
+    const auto top = from.GetTopVehicles(1);
+    ASSERT_EQ(top.size(), 1u);
+    EXPECT_EQ(top[0].id, "P - 37");
+    EXPECT_EQ(from.GetTopVehicles(32).back().id, "P - 6");
+
+    EXPECT_EQ(to.GetVehicleCount(VehicleCategory::Car, "P - 39"), 80u);
+    EXPECT_EQ(to.GetVehicleCount(VehicleCategory::Scooter, "P - 39"), 2u);
+    EXPECT_EQ(to.GetTotals().uniqueVehicles[1], 2u);
+    EXPECT_EQ(to.GetTotals().sightings[1], 80u + 78u);
+    EXPECT_EQ(to.GetTotals().acceptedSignals, 1u);
+    EXPECT_EQ(to.GetTopVehicles(1)[0].id, "P - 39");
+    EXPECT_EQ(to.GetStatistics(),
+              (std::vector<std::string>{"OTHER - Bicycle (1)",
+                                        "P - 38 - Car (78)",
+                                        "P - 39 - Car (80)",
+                                        "P - 39 - Scooter (2)"}));
+  }
+
+  // The lock-free index only exports.
+  MonitorConfig config;
+  config.ingest = IngestMode::LockFree;
+  CrossroadTrafficMonitoring lockFree(std::chrono::hours(24), config);
+  lockFree.Start();
+  lockFree.OnSignal(Car("A"));
+  EXPECT_EQ(lockFree.ExportVehicles().size(), 1u);
+  EXPECT_FALSE(lockFree.ImportVehicles({{"B", VehicleCategory::Car, 1}}));
+  EXPECT_FALSE(lockFree.EraseVehicles({"A"}));
+}
+
+//-----------------------------------------------------------------------------
+// Test Suite: Memory Usage
+//-----------------------------------------------------------------------------
+
+TEST(MemoryUsage, TracksPoolAndOutOfLineIds) {
+  std::cout << "\n[TEST] TracksPoolAndOutOfLineIds\n";
+  CrossroadTrafficMonitoring monitor(std::chrono::hours(24));
+  monitor.Start();
+
+  const MemoryUsage empty = monitor.GetMemoryUsage();
+  std::cout << "  Instance: " << empty.instanceBytes << " bytes, pool: "
+            << empty.poolReservedBytes << " bytes\n";
+  EXPECT_EQ(empty.instanceBytes, sizeof(CrossroadTrafficMonitoring));
+  EXPECT_GT(empty.poolReservedBytes, 0u);
+  EXPECT_LE(empty.poolReservedBytes + empty.indexBytes, empty.instanceBytes);
+  EXPECT_EQ(empty.poolLiveBytes, 0u);
+  EXPECT_EQ(empty.idHeapReservedBytes, 0u);
+  EXPECT_EQ(empty.ReservedBytes(), empty.instanceBytes);
+
+  const std::string longId(40, 'L'); // does not fit the small string buffer
+  monitor.OnSignal(Car("SHORT"));
+  monitor.OnSignal(Car(longId));
+  monitor.OnSignal(Car(longId));
+
+  const MemoryUsage used = monitor.GetMemoryUsage();
+  EXPECT_EQ(used.poolLiveBytes * 500, used.poolReservedBytes); // 2 of 1000
+  EXPECT_EQ(used.idHeapLiveBytes, longId.size() + 1);
+  EXPECT_GE(used.idHeapReservedBytes, used.idHeapLiveBytes);
+  EXPECT_GT(used.LiveBytes(), empty.LiveBytes());
+  EXPECT_LE(used.LiveBytes(), used.ReservedBytes());
+
+  std::cout << "  After reset, the ID buffer is kept for reuse\n";
+  monitor.Reset();
+  const MemoryUsage reset = monitor.GetMemoryUsage();
+  EXPECT_EQ(reset.poolLiveBytes, 0u);
+  EXPECT_EQ(reset.idHeapLiveBytes, 0u);
+  EXPECT_EQ(reset.idHeapReservedBytes, used.idHeapReservedBytes);
+}
+
+//-----------------------------------------------------------------------------
+// Test Suite: Flat Combining (IngestMode::FlatCombining)
+//-----------------------------------------------------------------------------
+
+TEST(FlatCombining, SameResultsAsMutexMode) {
+  std::cout << "\n[TEST] SameResultsAsMutexMode\n";
+  MonitorConfig config;
+  config.ingest = IngestMode::FlatCombining;
+  CrossroadTrafficMonitoring expected(std::chrono::hours(24));
+  CrossroadTrafficMonitoring actual(std::chrono::hours(24), config);
+  for (auto *m : {&expected, &actual}) {
+    m->OnSignal(Car("IGNORED")); // Init: ignored
+    m->Start();
+    for (int i = 0; i < 200; ++i) {
+      const std::string id = "FC" + std::to_string((i * 11) % 30);
+      if (i % 3 == 0)
+        m->OnSignal(Scooter(id));
+      else
+        m->OnSignal(Car(id));
+    }
+    m->OnSignal();               // camera error
+    m->OnSignal(Car("IN-ERROR")); // counted as an error
+  }
+  EXPECT_EQ(actual.GetStatistics(), expected.GetStatistics());
+  EXPECT_EQ(actual.GetStatistics(VehicleCategory::Car),
+            expected.GetStatistics(VehicleCategory::Car));
+  EXPECT_EQ(actual.GetErrorCount(), expected.GetErrorCount());
+  EXPECT_EQ(actual.GetCurrentState(), State::Error);
+  std::cout << "  Errors: " << actual.GetErrorCount() << " (Expected: "
+            << expected.GetErrorCount() << ")\n";
+}
+
+TEST(FlatCombining, ConcurrentSignalsAllApplied) {
+  std::cout << "\n[TEST] ConcurrentSignalsAllApplied\n";
+  MonitorConfig config;
+  config.ingest = IngestMode::FlatCombining;
+  CrossroadTrafficMonitoring monitor(std::chrono::hours(24), config);
+  monitor.Start();
+
+  constexpr int kThreads = 8;
+  constexpr int kSignals = 2000;
+  std::vector<std::thread> cameras;
+  for (int t = 0; t < kThreads; ++t) {
+    cameras.emplace_back([&monitor, t] {
+      for (int i = 0; i < kSignals; ++i)
+        monitor.OnSignal(Bicycle("FC" + std::to_string((i + t) % 50)));
+    });
+  }
+  for (auto &c : cameras)
+    c.join();
+
+  const MonitorTotals totals = monitor.GetTotals();
+  std::cout << "  Accepted: " << totals.acceptedSignals
+            << " (Expected: " << kThreads * kSignals << ")\n";
+  EXPECT_EQ(totals.acceptedSignals, std::uint64_t{kThreads * kSignals});
+  EXPECT_EQ(totals.uniqueVehicles[0], 50u);
+  EXPECT_EQ(monitor.GetVehicleCount(VehicleCategory::Bicycle, "FC7"),
+            unsigned{kThreads * kSignals / 50});
+}
+
+//-----------------------------------------------------------------------------
+// Test Suite: Error Buffer (MonitorConfig::errorBufferCapacity)
+//-----------------------------------------------------------------------------
+
+TEST(ErrorBuffer, SignalsInErrorStateCountedAfterReset) {
+  std::cout << "\n[TEST] SignalsInErrorStateCountedAfterReset\n";
+  for (IngestMode mode : {IngestMode::Mutex, IngestMode::LockFree,
+                          IngestMode::FlatCombining}) {
+    MonitorConfig config;
+    config.ingest = mode;
+    config.canonicalizePlates = true;
+    config.errorBufferCapacity = 8;
+    CrossroadTrafficMonitoring monitor(std::chrono::hours(24), config);
+    monitor.Start();
+    monitor.OnSignal(Car("ab-1"));
+    monitor.OnSignal(); // camera error
+    monitor.OnSignal(Car("AB 1"));
+    monitor.OnSignal(Scooter("S1"));
+    monitor.OnSignal(Car("bad#plate", 2));
+    EXPECT_EQ(monitor.GetErrorCount(), 4u); // still counted as errors
+    EXPECT_EQ(monitor.GetErrorBufferStats().buffered, 3u);
+    EXPECT_EQ(monitor.GetStatistics(), std::vector<std::string>{"AB1 - Car (1)"});
+
+    monitor.Reset();
+    // The period before the reset is gone, the buffered signals count.
+    EXPECT_EQ(monitor.GetCurrentState(), State::Active);
+    EXPECT_EQ(monitor.GetStatistics(),
+              (std::vector<std::string>{"AB1 - Car (1)", "S1 - Scooter (1)"}));
+    EXPECT_EQ(monitor.GetRejectedPlateCount(2), 1u);
+    EXPECT_EQ(monitor.GetErrorCount(), 0u);
+    const ErrorBufferStats stats = monitor.GetErrorBufferStats();
+    std::cout << "  Replayed: " << stats.replayed << " (Expected: 3)\n";
+    EXPECT_EQ(stats.buffered, 0u);
+    EXPECT_EQ(stats.replayed, 3u);
+    EXPECT_EQ(stats.overflowed, 0u);
+  }
+}
+
+TEST(ErrorBuffer, OverflowPolicies) {
+  std::cout << "\n[TEST] OverflowPolicies\n";
+  for (ErrorBufferPolicy policy :
+       {ErrorBufferPolicy::DropNewest, ErrorBufferPolicy::DropOldest}) {
+    MonitorConfig config;
+    config.errorBufferCapacity = 3;
+    config.errorBufferPolicy = policy;
+    CrossroadTrafficMonitoring monitor(std::chrono::hours(24), config);
+    monitor.Start();
+    monitor.OnSignal();
+    for (int i = 1; i <= 5; ++i)
+      monitor.OnSignal(Bicycle("B" + std::to_string(i)));
+    EXPECT_EQ(monitor.GetErrorBufferStats().overflowed, 2u);
+    EXPECT_EQ(monitor.GetErrorBufferStats().buffered, 3u);
+
+    monitor.OnSignal(ResetSignal{});
+    const std::vector<std::string> expected =
+        policy == ErrorBufferPolicy::DropNewest
+            ? std::vector<std::string>{"B1 - Bicycle (1)", "B2 - Bicycle (1)",
+                                       "B3 - Bicycle (1)"}
+            : std::vector<std::string>{"B3 - Bicycle (1)", "B4 - Bicycle (1)",
+                                       "B5 - Bicycle (1)"};
+    EXPECT_EQ(monitor.GetStatistics(), expected);
+    // Slots are reserved up front and reported.
+    EXPECT_GE(monitor.GetMemoryUsage().errorBufferBytes,
+              3 * sizeof(std::string));
+  }
+
+  // Disabled by default: Error state still loses the signal.
+  CrossroadTrafficMonitoring monitor(std::chrono::hours(24));
+  monitor.Start();
+  monitor.OnSignal();
+  monitor.OnSignal(Car("LOST"));
+  monitor.Reset();
+  EXPECT_TRUE(monitor.GetStatistics().empty());
+  EXPECT_EQ(monitor.GetMemoryUsage().errorBufferBytes, 0u);
+}
+
+//-----------------------------------------------------------------------------
+// Test Suite: Plate Retention (MonitorConfig::plateRetentionPeriods)
+//-----------------------------------------------------------------------------
+
+TEST(PlateRetention, RecurringPlatesSurviveResets) {
+  std::cout << "\n[TEST] RecurringPlatesSurviveResets\n";
+  for (IngestMode mode : {IngestMode::Mutex, IngestMode::FlatCombining}) {
+    MonitorConfig config;
+    config.ingest = mode;
+    config.plateRetentionPeriods = 2;
+    CrossroadTrafficMonitoring monitor(std::chrono::hours(24), config);
+    monitor.Start();
+    monitor.OnSignal(Car("A1"));
+    monitor.OnSignal(Car("B1"));
+    monitor.OnSignal(Bicycle("C1"));
+
+    monitor.Reset(); // period 1: everything idle, nothing counted
+    MonitorTotals totals = monitor.GetTotals();
+    EXPECT_TRUE(monitor.GetStatistics().empty());
+    EXPECT_TRUE(monitor.GetStatistics(VehicleCategory::Car).empty());
+    EXPECT_EQ(totals.poolInUse, 3u);
+    EXPECT_EQ(totals.poolIdle, 3u);
+    EXPECT_EQ(monitor.GetVehicleCount(VehicleCategory::Car, "A1"), 0u);
+
+    monitor.OnSignal(Car("A1"));
+    monitor.OnSignal(Car("A1"));
+    monitor.OnSignal(Car("D1"));
+    totals = monitor.GetTotals();
+    EXPECT_EQ(monitor.GetStatistics(VehicleCategory::Car),
+              (std::vector<std::string>{"A1 - Car (2)", "D1 - Car (1)"}));
+    EXPECT_EQ(totals.uniqueVehicles[1], 2u); // a recurring plate is new again
+    EXPECT_EQ(totals.sightings[1], 3u);
+    EXPECT_EQ(totals.poolIdle, 2u);
+
+    monitor.Reset(); // period 2: B1, C1 idle for 2 periods, still kept
+    EXPECT_EQ(monitor.GetTotals().poolInUse, 4u);
+    monitor.Reset(); // period 3: B1, C1 freed, A1 and D1 kept
+    totals = monitor.GetTotals();
+    std::cout << "  Pool in use: " << totals.poolInUse << " (Expected: 2)\n";
+    EXPECT_EQ(totals.poolInUse, 2u);
+    EXPECT_EQ(totals.poolIdle, 2u);
+    monitor.OnSignal(Bicycle("C1"));
+    monitor.OnSignal(Car("A1"));
+    EXPECT_EQ(monitor.GetStatistics(),
+              (std::vector<std::string>{"A1 - Car (1)", "C1 - Bicycle (1)"}));
+    EXPECT_EQ(monitor.GetTopVehicles(5).size(), 2u);
+  }
+
+  // Ignored in LockFree mode: a reset frees everything.
+  MonitorConfig config;
+  config.ingest = IngestMode::LockFree;
+  config.plateRetentionPeriods = 2;
+  CrossroadTrafficMonitoring monitor(std::chrono::hours(24), config);
+  monitor.Start();
+  monitor.OnSignal(Car("A1"));
+  monitor.Reset();
+  EXPECT_EQ(monitor.GetTotals().poolInUse, 0u);
+  EXPECT_EQ(monitor.GetTotals().poolIdle, 0u);
+}
+
+TEST(PlateRetention, FullPoolFreesLongestIdlePlates) {
+  std::cout << "\n[TEST] FullPoolFreesLongestIdlePlates\n";
+  MonitorConfig config;
+  config.layout = StorageLayout::PerPlate;
+  config.plateRetentionPeriods = 5;
+  CrossroadTrafficMonitoring monitor(std::chrono::hours(24), config);
+  monitor.Start();
+  for (int i = 0; i < 1000; ++i)
+    monitor.OnSignal(Car("P" + std::to_string(i)));
+  monitor.Reset();
+
+  for (int i = 0; i < 10; ++i)
+    monitor.OnSignal(Scooter("P" + std::to_string(i))); // recurring
+  for (int i = 0; i < 10; ++i)
+    monitor.OnSignal(Car("N" + std::to_string(i))); // new, pool full
+  MonitorTotals totals = monitor.GetTotals();
+  std::cout << "  Errors: " << totals.errorCount
+            << ", idle: " << totals.poolIdle << " (Expected: 0, 980)\n";
+  EXPECT_EQ(totals.errorCount, 0u);
+  EXPECT_EQ(totals.poolInUse, 1000u);
+  EXPECT_EQ(totals.poolIdle, 980u);
+  EXPECT_EQ(totals.uniqueVehicles[1], 10u);
+  EXPECT_EQ(totals.uniqueVehicles[2], 10u);
+  EXPECT_EQ(monitor.GetStatistics().size(), 20u);
+
+  // Idle plates are freed oldest first; with none idle the pool is exhausted.
+  monitor.Reset();
+  for (int i = 0; i < 1000; ++i)
+    monitor.OnSignal(Bicycle("Q" + std::to_string(i)));
+  monitor.OnSignal(Bicycle("LAST"));
+  totals = monitor.GetTotals();
+  EXPECT_EQ(totals.poolIdle, 0u);
+  EXPECT_EQ(totals.errorCount, 1u);
+  EXPECT_EQ(monitor.GetVehicleCount(VehicleCategory::Bicycle, "LAST"), 0u);
+}
+
+//-----------------------------------------------------------------------------
+// Test Suite: Pool Compaction (CompactStep)
+//-----------------------------------------------------------------------------
+
+TEST(PoolCompaction, LiveVehiclesEndUpInADensePrefix) {
+  std::cout << "\n[TEST] LiveVehiclesEndUpInADensePrefix\n";
+  for (StorageLayout layout :
+       {StorageLayout::PerCategory, StorageLayout::PerPlate}) {
+    MonitorConfig config;
+    config.layout = layout;
+    config.plateRetentionPeriods = 1;
+    CrossroadTrafficMonitoring monitor(std::chrono::hours(24), config);
+    monitor.Start();
+    for (int i = 0; i < 900; ++i) {
+      monitor.OnSignal(Car("P" + std::to_string(i)));
+      if (i % 3 == 0)
+        monitor.OnSignal(Scooter("P" + std::to_string(i)));
+    }
+    // Churn: only every 10th plate recurs, the rest expire.
+    monitor.Reset();
+    for (int i = 0; i < 900; i += 10)
+      monitor.OnSignal(Car("P" + std::to_string(i)));
+    monitor.Reset();
+    for (int i = 0; i < 900; i += 10)
+      monitor.OnSignal(Car("P" + std::to_string(i)));
+
+    const std::vector<std::string> stats = monitor.GetStatistics();
+    const std::vector<std::string> cars =
+        monitor.GetStatistics(VehicleCategory::Car);
+    const MonitorTotals totals = monitor.GetTotals();
+    const MemoryUsage before = monitor.GetMemoryUsage();
+    EXPECT_GT(before.poolSpanBytes, 5 * before.poolLiveBytes);
+
+    std::size_t steps = 0, moved = 0;
+    while (const std::size_t step = monitor.CompactStep(8)) {
+      EXPECT_LE(step, 8u);
+      moved += step;
+      ++steps;
+      // Between steps everything reads as before.
+      if (steps % 5 == 0) {
+        EXPECT_EQ(monitor.GetStatistics(), stats);
+      }
+    }
+    const MemoryUsage after = monitor.GetMemoryUsage();
+    std::cout << "  Moved " << moved << " vehicles in " << steps
+              << " steps, span " << before.poolSpanBytes << " -> "
+              << after.poolSpanBytes << " bytes\n";
+    EXPECT_EQ(after.poolSpanBytes, after.poolLiveBytes);
+    EXPECT_EQ(after.idHeapReservedBytes, before.idHeapReservedBytes);
+    EXPECT_EQ(monitor.GetStatistics(), stats);
+    EXPECT_EQ(monitor.GetStatistics(VehicleCategory::Car), cars);
+    EXPECT_EQ(monitor.GetTotals().poolInUse, totals.poolInUse);
+    EXPECT_EQ(monitor.GetVehicleCount("P890").perCategory,
+              (std::array<unsigned, kCategoryCount>{0, 1, 0}));
+
+    // Relocated vehicles keep counting, and age out as before.
+    monitor.OnSignal(Car("P890"));
+    EXPECT_EQ(monitor.GetVehicleCount(VehicleCategory::Car, "P890"), 2u);
+    monitor.OnSignal(Car("NEW"));
+    EXPECT_EQ(monitor.GetMemoryUsage().poolSpanBytes,
+              monitor.GetMemoryUsage().poolLiveBytes); // lowest free entry
+    monitor.Reset();
+    monitor.Reset();
+    EXPECT_EQ(monitor.GetTotals().poolInUse, 0u);
+    EXPECT_EQ(monitor.CompactStep(), 0u);
+  }
+
+  // The lock-free index owns its pool: nothing to do.
+  MonitorConfig config;
+  config.ingest = IngestMode::LockFree;
+  CrossroadTrafficMonitoring monitor(std::chrono::hours(24), config);
+  monitor.Start();
+  monitor.OnSignal(Car("A1"));
+  EXPECT_EQ(monitor.CompactStep(), 0u);
+  EXPECT_EQ(monitor.GetMemoryUsage().poolSpanBytes, 0u);
+}
+
+//-----------------------------------------------------------------------------
+// Test Suite: Pool Regions (MonitorConfig::poolSplit)
+//-----------------------------------------------------------------------------
+
+TEST(PoolRegions, CategoriesAllocateFromTheirOwnRegion) {
+  std::cout << "\n[TEST] CategoriesAllocateFromTheirOwnRegion\n";
+  MonitorConfig config;
+  config.poolSplit = {1, 2, 1};
+  CrossroadTrafficMonitoring split(std::chrono::hours(24), config);
+  CrossroadTrafficMonitoring shared(std::chrono::hours(24));
+  for (auto *monitor : {&split, &shared}) {
+    monitor->Start();
+    for (int i = 0; i < 200; ++i) { // interleaved arrivals
+      monitor->OnSignal(Car("C" + std::to_string(i)));
+      monitor->OnSignal(Bicycle("B" + std::to_string(i)));
+      monitor->OnSignal(Scooter("S" + std::to_string(i % 50)));
+    }
+  }
+  PoolRegions regions = split.GetPoolRegions();
+  EXPECT_EQ(regions.begin, (std::array<std::size_t, kCategoryCount>{0, 250, 750}));
+  EXPECT_EQ(regions.size, (std::array<std::size_t, kCategoryCount>{250, 500, 250}));
+  EXPECT_EQ(regions.live, (std::array<std::size_t, kCategoryCount>{200, 200, 50}));
+  EXPECT_EQ(regions.borrowed, (std::array<std::size_t, kCategoryCount>{}));
+  EXPECT_EQ(shared.GetPoolRegions().size[1], 1000u);
+  for (std::size_t c = 0; c < kCategoryCount; ++c) {
+    const auto cat = static_cast<VehicleCategory>(c);
+    EXPECT_EQ(split.GetStatistics(cat), shared.GetStatistics(cat));
+  }
+  EXPECT_EQ(split.GetStatistics(), shared.GetStatistics());
+
+  // A full region borrows: the pool still holds MAX_VEHICLES in total.
+  for (int i = 200; i < 700; ++i)
+    split.OnSignal(Bicycle("B" + std::to_string(i)));
+  regions = split.GetPoolRegions();
+  std::cout << "  Borrowed bicycles: " << regions.borrowed[0]
+            << " (Expected: 450)\n";
+  EXPECT_EQ(regions.borrowed[0], 450u);
+  EXPECT_EQ(regions.borrows, 450u);
+  EXPECT_EQ(split.GetErrorCount(), 0u);
+  EXPECT_EQ(split.GetTotals().poolInUse, 950u);
+  split.Reset();
+  EXPECT_EQ(split.GetPoolRegions().borrowed[0], 0u);
+}
+
+TEST(PoolRegions, CompactionBringsBorrowedEntriesHome) {
+  std::cout << "\n[TEST] CompactionBringsBorrowedEntriesHome\n";
+  MonitorConfig config;
+  config.poolSplit = {1, 1, 2};
+  config.plateRetentionPeriods = 1;
+  CrossroadTrafficMonitoring monitor(std::chrono::hours(24), config);
+  monitor.Start();
+  for (int i = 0; i < 400; ++i)
+    monitor.OnSignal(Car("C" + std::to_string(i))); // 150 borrowed
+  monitor.Reset();
+  for (int i = 0; i < 400; i += 4) // the others expire at the next reset
+    monitor.OnSignal(Car("C" + std::to_string(i)));
+  monitor.Reset();
+  PoolRegions regions = monitor.GetPoolRegions();
+  EXPECT_EQ(regions.live[1], 100u);
+  EXPECT_GT(regions.borrowed[1], 0u);
+  const std::vector<std::string> stats = monitor.GetStatistics();
+
+  std::size_t moved = 0;
+  while (const std::size_t step = monitor.CompactStep(16))
+    moved += step;
+  regions = monitor.GetPoolRegions();
+  std::cout << "  Moved " << moved << ", borrowed " << regions.borrowed[1]
+            << " (Expected: 0)\n";
+  EXPECT_EQ(regions.borrowed[1], 0u);
+  EXPECT_EQ(monitor.GetStatistics(), stats);
+  // Dense in its region: the next car goes right behind the others.
+  monitor.OnSignal(Car("NEW"));
+  const MemoryUsage usage = monitor.GetMemoryUsage(); // 1000 entries
+  EXPECT_EQ(usage.poolSpanBytes,
+            usage.poolReservedBytes / 1000 * (regions.begin[1] + 101));
+}
+
+TEST(PoolRegions, AdaptiveSplitFollowsTraffic) {
+  std::cout << "\n[TEST] AdaptiveSplitFollowsTraffic\n";
+  MonitorConfig config;
+  config.adaptivePoolSplit = true;
+  config.layout = StorageLayout::PerPlate;
+  CrossroadTrafficMonitoring monitor(std::chrono::hours(24), config);
+  monitor.Start();
+  EXPECT_EQ(monitor.GetPoolRegions().size[1], 333u); // even start
+  for (int period = 0; period < 6; ++period) {
+    for (int i = 0; i < 600; ++i)
+      monitor.OnSignal(Car("C" + std::to_string(i)));
+    for (int i = 0; i < 100; ++i) {
+      monitor.OnSignal(Bicycle("B" + std::to_string(i)));
+      monitor.OnSignal(Scooter("S" + std::to_string(i)));
+    }
+    EXPECT_EQ(monitor.GetErrorCount(), 0u);
+    monitor.Reset();
+  }
+  const PoolRegions regions = monitor.GetPoolRegions();
+  std::cout << "  Car region: " << regions.size[1]
+            << " entries (Expected: about 750)\n";
+  EXPECT_GT(regions.size[1], 700u);
+  EXPECT_LT(regions.size[1], 800u);
+  EXPECT_EQ(regions.size[0] + regions.size[1] + regions.size[2], 1000u);
+  EXPECT_GE(regions.rebalances, 1u);
+}
@@ -0,0 +1,131 @@
+#include "CrossroadTrafficMonitoring.hpp"
+#include "EpochReclamation.hpp"
+#include <atomic>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace ctm;
+
+namespace {
+struct Node {
+  Node *next{nullptr};
+  std::uint64_t retiredAt{0};
+  std::atomic<int> value{0};
+};
+using NodeRetiredList = RetiredList<Node, &Node::next, &Node::retiredAt>;
+} // namespace
+
+//-----------------------------------------------------------------------------
+// Test Suite: Epoch Reclamation
+//-----------------------------------------------------------------------------
+
+TEST(EpochReclamation, PinnedReaderBlocksReclaim) {
+  std::cout << "\n[TEST] PinnedReaderBlocksReclaim\n";
+  EpochManager epochs;
+  NodeRetiredList retired;
+  Node a, b;
+  std::size_t reclaimed = 0;
+  auto count = [&](Node *) { ++reclaimed; };
+
+  {
+    auto guard = epochs.Pin();
+    retired.Retire(&a, epochs.CurrentEpoch());
+    // The reader may hold `a`: at most one advance, never reclaimed.
+    for (int i = 0; i < 5; ++i)
+      epochs.TryAdvance();
+    retired.ReclaimSafe(epochs, count);
+    std::cout << "  Reclaimed while pinned: " << reclaimed << " (Expected: 0)\n";
+    EXPECT_EQ(reclaimed, 0u);
+    EXPECT_EQ(retired.Size(), 1u);
+  }
+
+  // Unpinned: two advances make `a` safe.
+  retired.Retire(&b, epochs.CurrentEpoch());
+  EXPECT_TRUE(epochs.TryAdvance());
+  EXPECT_TRUE(epochs.TryAdvance());
+  retired.ReclaimSafe(epochs, count);
+  std::cout << "  Reclaimed after unpin: " << reclaimed << "\n";
+  EXPECT_GE(reclaimed, 1u);
+  EXPECT_TRUE(epochs.TryAdvance());
+  retired.ReclaimSafe(epochs, count);
+  EXPECT_EQ(reclaimed, 2u);
+  EXPECT_EQ(retired.Size(), 0u);
+}
+
+TEST(EpochReclamation, ReadersNeverSeeReusedObjects) {
+  std::cout << "\n[TEST] ReadersNeverSeeReusedObjects\n";
+  // A writer keeps publishing a node, retiring the previous one and reusing
+  // reclaimed nodes. A reclaimed node is poisoned (-1) before reuse; readers
+  // must never observe the poison through the published pointer.
+  EpochManager epochs;
+  NodeRetiredList retired;
+  std::vector<Node> nodes(16);
+  std::vector<Node *> free;
+  for (auto &n : nodes)
+    free.push_back(&n);
+
+  std::atomic<Node *> published{nullptr};
+  std::atomic<bool> stop{false};
+  std::atomic<long> poisonSeen{0};
+
+  std::vector<std::thread> readers;
+  for (int t = 0; t < 3; ++t) {
+    readers.emplace_back([&] {
+      while (!stop.load()) {
+        auto guard = epochs.Pin();
+        Node *n = published.load(std::memory_order_acquire);
+        if (n && n->value.load() < 0)
+          ++poisonSeen;
+      }
+    });
+  }
+
+  for (int i = 1; i < 20000; ++i) {
+    retired.ReclaimSafe(epochs, [&](Node *n) {
+      n->value.store(-1);
+      free.push_back(n);
+    });
+    if (free.empty()) {
+      epochs.TryAdvance();
+      continue;
+    }
+    Node *n = free.back();
+    free.pop_back();
+    n->value.store(i);
+    Node *old = published.exchange(n, std::memory_order_acq_rel);
+    if (old)
+      retired.Retire(old, epochs.CurrentEpoch());
+    epochs.TryAdvance();
+  }
+  stop = true;
+  for (auto &r : readers)
+    r.join();
+
+  std::cout << "  Poison observed: " << poisonSeen << " (Expected: 0)\n";
+  EXPECT_EQ(poisonSeen.load(), 0);
+}
+
+TEST(EpochReclamation, MonitorReusesRetiredVehicles) {
+  std::cout << "\n[TEST] MonitorReusesRetiredVehicles\n";
+  CrossroadTrafficMonitoring monitor(std::chrono::hours(24));
+  monitor.Start();
+  for (int i = 0; i < 1000; ++i)
+    monitor.OnSignal(Car("A-" + std::to_string(i)));
+
+  monitor.Reset();
+  const MemoryUsage afterReset = monitor.GetMemoryUsage();
+  std::cout << "  Retired after reset: " << afterReset.poolRetiredBytes
+            << " bytes\n";
+  EXPECT_EQ(afterReset.poolRetiredBytes, afterReset.poolReservedBytes);
+
+  // The pool is full of retired entries; with no reader pinned they are
+  // reclaimed as soon as the free list runs dry.
+  for (int i = 0; i < 1000; ++i)
+    monitor.OnSignal(Car("B-" + std::to_string(i)));
+  EXPECT_EQ(monitor.GetErrorCount(), 0u);
+  EXPECT_EQ(monitor.GetStatistics().size(), 1000u);
+  EXPECT_EQ(monitor.GetMemoryUsage().poolRetiredBytes, 0u);
+}
@@ -0,0 +1,134 @@
+#include "EventTimeWindows.hpp"
+#include <chrono>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace ctm;
+using namespace std::chrono_literals;
+
+namespace {
+// Minute-long windows starting at a round time.
+const EventTime kBase = EventTime(std::chrono::hours(24 * 20000));
+
+WindowConfig minuteWindows() {
+  WindowConfig config;
+  config.windowSize = 60s;
+  config.maxOutOfOrder = 5s;
+  config.allowedLateness = 30s;
+  config.retainedWindows = 2;
+  return config;
+}
+} // namespace
+
+//-----------------------------------------------------------------------------
+// Test Suite: Event-time windows
+//-----------------------------------------------------------------------------
+
+TEST(EventTimeWindows, SignalsGoToTheirEventTimeWindow) {
+  std::cout << "\n[TEST] SignalsGoToTheirEventTimeWindow\n";
+  EventTimeWindows windows(minuteWindows());
+  EXPECT_EQ(windows.OnSignal(Car("A1"), kBase + 10s), WindowOutcome::OnTime);
+  EXPECT_EQ(windows.OnSignal(Car("A1"), kBase + 50s), WindowOutcome::OnTime);
+  // Out of order, but within maxOutOfOrder of the newest event: on time.
+  EXPECT_EQ(windows.OnSignal(Bicycle("B1"), kBase + 47s),
+            WindowOutcome::OnTime);
+  EXPECT_EQ(windows.OnSignal(Car("A1"), kBase + 70s), WindowOutcome::OnTime);
+
+  EXPECT_EQ(windows.GetStatistics(kBase),
+            (std::vector<std::string>{"A1 - Car (2)", "B1 - Bicycle (1)"}));
+  EXPECT_EQ(windows.GetStatistics(kBase + 60s),
+            (std::vector<std::string>{"A1 - Car (1)"}));
+  EXPECT_EQ(windows.GetWatermark(), kBase + 65s);
+
+  const auto summaries = windows.GetWindows();
+  ASSERT_EQ(summaries.size(), 2u);
+  std::cout << "  First window: " << ToString(summaries[0].state)
+            << " (Expected: Closed)\n";
+  EXPECT_EQ(summaries[0].state, WindowState::Closed); // watermark 65s >= 60s
+  EXPECT_EQ(summaries[0].end, kBase + 60s);
+  EXPECT_EQ(summaries[0].totals.acceptedSignals, 3u);
+  EXPECT_EQ(summaries[1].state, WindowState::Open);
+}
+
+TEST(EventTimeWindows, LateEventsAmendOrDrop) {
+  std::cout << "\n[TEST] LateEventsAmendOrDrop\n";
+  EventTimeWindows windows(minuteWindows());
+  windows.OnSignal(Car("A1"), kBase + 10s);
+  windows.OnSignal(Car("A1"), kBase + 80s); // watermark 75s, window 0 closed
+
+  // Behind the watermark, window still open: late.
+  EXPECT_EQ(windows.OnSignal(Car("L1"), kBase + 62s), WindowOutcome::Late);
+  // Window 0 closed 15s ago, within the 30s lateness: amended.
+  EXPECT_EQ(windows.OnSignal(Scooter("L2"), kBase + 20s),
+            WindowOutcome::Amended);
+  EXPECT_EQ(windows.GetStatistics(kBase),
+            (std::vector<std::string>{"A1 - Car (1)", "L2 - Scooter (1)"}));
+
+  // Watermark 95s: window 0 is finalized, its events are dropped.
+  windows.AdvanceWatermark(kBase + 95s);
+  EXPECT_EQ(windows.OnSignal(Car("L3"), kBase + 30s), WindowOutcome::Dropped);
+  windows.AdvanceWatermark(kBase + 90s); // never moves back
+  EXPECT_EQ(windows.GetWatermark(), kBase + 95s);
+
+  const LatenessMetrics m = windows.GetLatenessMetrics();
+  std::cout << "  On time " << m.onTime << ", late " << m.late << ", amended "
+            << m.amended << ", dropped " << m.dropped << "\n";
+  EXPECT_EQ(m.onTime, 2u);
+  EXPECT_EQ(m.late, 1u);
+  EXPECT_EQ(m.amended, 1u);
+  EXPECT_EQ(m.dropped, 1u);
+  EXPECT_EQ(m.maxLateness, 55s);
+
+  const auto summaries = windows.GetWindows();
+  ASSERT_EQ(summaries.size(), 2u);
+  EXPECT_EQ(summaries[0].state, WindowState::Finalized);
+  EXPECT_EQ(summaries[0].amendments, 1u);
+  EXPECT_EQ(summaries[1].lateSignals, 1u);
+}
+
+TEST(EventTimeWindows, FinalizedWindowsAreBounded) {
+  std::cout << "\n[TEST] FinalizedWindowsAreBounded\n";
+  EventTimeWindows windows(minuteWindows());
+  for (int minute = 0; minute < 10; ++minute)
+    windows.OnSignal(Car("M" + std::to_string(minute)),
+                     kBase + std::chrono::minutes(minute) + 1s);
+  // Watermark at 9m -4s: windows 0..7 are finalized, 8 closed, 9 open.
+  const auto summaries = windows.GetWindows();
+  std::cout << "  Retained windows: " << summaries.size()
+            << " (Expected: 4)\n";
+  ASSERT_EQ(summaries.size(), 4u); // 2 finalized + closed + open
+  EXPECT_EQ(summaries[0].start, kBase + 6min);
+  EXPECT_TRUE(windows.GetStatistics(kBase).empty());
+  EXPECT_EQ(windows.GetStatistics(kBase + 9min),
+            (std::vector<std::string>{"M9 - Car (1)"}));
+}
+
+TEST(EventTimeWindows, FarFutureEventsAreRejected) {
+  std::cout << "\n[TEST] FarFutureEventsAreRejected\n";
+  WindowConfig config = minuteWindows();
+  config.maxFutureSkew = 10min;
+  EventTimeWindows windows(config);
+  // The first event sets the watermark, whatever its time.
+  EXPECT_EQ(windows.OnSignal(Car("A1"), kBase + 10s), WindowOutcome::OnTime);
+  // A camera clock a day ahead must not finalize the current windows.
+  EXPECT_EQ(windows.OnSignal(Car("F1"), kBase + 24h), WindowOutcome::Rejected);
+  EXPECT_EQ(windows.GetWatermark(), kBase + 5s);
+  EXPECT_EQ(windows.OnSignal(Car("A2"), kBase + 20s), WindowOutcome::OnTime);
+  // Within the skew of the newest event time (10s): accepted.
+  EXPECT_EQ(windows.OnSignal(Car("A3"), kBase + 10s + 10min),
+            WindowOutcome::OnTime);
+
+  const LatenessMetrics m = windows.GetLatenessMetrics();
+  std::cout << "  Rejected: " << m.rejected << " (Expected: 1)\n";
+  EXPECT_EQ(m.rejected, 1u);
+  EXPECT_EQ(m.onTime, 3u);
+  EXPECT_TRUE(windows.GetStatistics(kBase + 24h).empty());
+
+  // Zero disables the check.
+  config.maxFutureSkew = 0ms;
+  EventTimeWindows unbounded(config);
+  unbounded.OnSignal(Car("A1"), kBase + 10s);
+  EXPECT_EQ(unbounded.OnSignal(Car("F1"), kBase + 24h), WindowOutcome::OnTime);
+}
@@ -0,0 +1,154 @@
+#include "CrossroadTrafficMonitoring.hpp"
+#include "IngestPipeline.hpp"
+#include <chrono>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace ctm;
+
+namespace {
+const char *kKinds[] = {"Car", "Bicycle", "Scooter"};
+
+std::vector<std::string> makeFrames(int source, int count) {
+  std::vector<std::string> frames;
+  for (int i = 0; i < count; ++i) {
+    const int plate = (i * 7 + source) % 90;
+    frames.push_back(std::string(kKinds[plate % 3]) + ",ab-" +
+                     std::to_string(plate) + "," + std::to_string(source));
+  }
+  return frames;
+}
+} // namespace
+
+//-----------------------------------------------------------------------------
+// Test Suite: Ingest Pipeline
+//-----------------------------------------------------------------------------
+
+TEST(IngestPipeline, MatchesSingleMonitor) {
+  std::cout << "\n[TEST] MatchesSingleMonitor\n";
+  PipelineConfig config;
+  config.decoders = 3;
+  config.routers = 2;
+  config.shards = 4;
+  config.batchSize = 8;
+  IngestPipeline pipeline(config);
+
+  MonitorConfig monitorConfig;
+  monitorConfig.canonicalizePlates = true;
+  CrossroadTrafficMonitoring reference(std::chrono::hours(1), monitorConfig);
+  reference.Start();
+
+  // One producer thread per source.
+  std::vector<std::thread> producers;
+  for (int s = 0; s < 3; ++s) {
+    producers.emplace_back([&pipeline, s] {
+      for (int round = 0; round < 20; ++round)
+        pipeline.Submit(s, makeFrames(s, 50));
+    });
+    for (int round = 0; round < 20; ++round) {
+      for (int i = 0; i < 50; ++i) {
+        const int plate = (i * 7 + s) % 90;
+        const std::string id = "ab-" + std::to_string(plate);
+        if (plate % 3 == 0)
+          reference.OnSignal(Car(id));
+        else if (plate % 3 == 1)
+          reference.OnSignal(Bicycle(id));
+        else
+          reference.OnSignal(Scooter(id));
+      }
+    }
+  }
+  for (auto &p : producers)
+    p.join();
+  pipeline.Flush();
+
+  // Plates are unique per category here, so line order is fully determined.
+  EXPECT_EQ(pipeline.GetStatistics(), reference.GetStatistics());
+  const MonitorTotals totals = pipeline.GetTotals();
+  std::cout << "  Accepted: " << totals.acceptedSignals << " (Expected: 3000)\n";
+  EXPECT_EQ(totals.acceptedSignals, 3000u);
+  EXPECT_EQ(totals.sightings, reference.GetTotals().sightings);
+  EXPECT_EQ(pipeline.GetVehicleCount("AB 7").Total(),
+            reference.GetVehicleCount("AB7").Total());
+
+  // Every plate lives in exactly one shard.
+  std::size_t shardLines = 0;
+  for (std::size_t s = 0; s < pipeline.ShardCount(); ++s)
+    shardLines += pipeline.Shard(s).GetStatistics().size();
+  EXPECT_EQ(shardLines, reference.GetStatistics().size());
+}
+
+TEST(IngestPipeline, MalformedFramesAndRejectedPlates) {
+  std::cout << "\n[TEST] MalformedFramesAndRejectedPlates\n";
+  IngestPipeline pipeline;
+  pipeline.Submit(0, {"Car,AB1", "Truck,AB2", "Car", "Car,", "Car,AB3,300",
+                      "Car,A*B", "Scooter,xy-9,12"});
+  pipeline.Flush();
+  const PipelineMetrics metrics = pipeline.GetMetrics();
+  std::cout << "  Malformed: " << metrics.malformedFrames
+            << " (Expected: 4), rejected: " << metrics.rejectedPlates
+            << " (Expected: 1)\n";
+  EXPECT_EQ(metrics.submittedFrames, 7u);
+  EXPECT_EQ(metrics.malformedFrames, 4u);
+  EXPECT_EQ(metrics.rejectedPlates, 1u);
+  EXPECT_EQ(metrics.appliedSignals, 2u);
+  EXPECT_EQ(pipeline.GetStatistics(),
+            (std::vector<std::string>{"AB1 - Car (1)", "XY9 - Scooter (1)"}));
+}
+
+TEST(IngestPipeline, StageMetricsAndStop) {
+  std::cout << "\n[TEST] StageMetricsAndStop\n";
+  PipelineConfig config;
+  config.batchSize = 16;
+  config.queueBatches = 2; // small queues exercise backpressure
+  IngestPipeline pipeline(config);
+  for (int round = 0; round < 40; ++round)
+    pipeline.Submit(round % 2, makeFrames(round % 2, 100));
+  pipeline.Stop(); // drains everything queued before stopping
+  pipeline.Stop(); // idempotent
+
+  const PipelineMetrics metrics = pipeline.GetMetrics();
+  for (std::size_t s = 0; s < kPipelineStageCount; ++s) {
+    const StageMetrics &m = metrics.stages[s];
+    std::cout << "  " << ToString(static_cast<PipelineStage>(s))
+              << ": items " << m.items << ", batches " << m.batches
+              << ", max depth " << m.maxQueueDepth << ", mean latency "
+              << m.meanLatencyNs << " ns\n";
+    EXPECT_EQ(m.items, 4000u);
+    EXPECT_GT(m.batches, 0u);
+    EXPECT_EQ(m.queueDepth, 0u);
+    EXPECT_LE(m.maxQueueDepth, 2u);
+    EXPECT_GE(m.maxLatencyNs, m.meanLatencyNs);
+  }
+  EXPECT_EQ(metrics.appliedSignals, 4000u);
+  EXPECT_EQ(pipeline.GetTotals().acceptedSignals, 4000u);
+}
+
+TEST(IngestPipeline, SubmitAfterStopReturnsFalse) {
+  std::cout << "\n[TEST] SubmitAfterStopReturnsFalse\n";
+  PipelineConfig config;
+  config.queueBatches = 1;
+  IngestPipeline pipeline(config);
+
+  // A source racing Stop(): every Submit either lands or is refused.
+  std::uint64_t accepted = 0;
+  std::thread source([&] {
+    while (pipeline.Submit(0, makeFrames(0, 20)))
+      accepted += 20;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  pipeline.Stop();
+  source.join();
+
+  // Nothing reaches a stopped decoder, so these would block on a full queue
+  for (int i = 0; i < 10; ++i)
+    EXPECT_FALSE(pipeline.Submit(0, makeFrames(0, 20)));
+  pipeline.Flush(); // everything accepted was applied
+
+  std::cout << "  Accepted " << accepted << " frames before Stop()\n";
+  EXPECT_EQ(pipeline.GetMetrics().submittedFrames, accepted);
+  EXPECT_EQ(pipeline.GetTotals().acceptedSignals, accepted);
+}
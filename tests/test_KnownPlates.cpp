@@ -0,0 +1,147 @@
+#include "CrossroadTrafficMonitoring.hpp"
+#include "KnownPlates.hpp"
+#include <chrono>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace ctm;
+
+namespace {
+std::vector<std::string> fleet(std::size_t n) {
+  std::vector<std::string> plates;
+  for (std::size_t i = 0; i < n; ++i)
+    plates.push_back("FL" + std::to_string(i));
+  return plates;
+}
+} // namespace
+
+//-----------------------------------------------------------------------------
+// Test Suite: Known plates (minimal perfect hash)
+//-----------------------------------------------------------------------------
+
+TEST(KnownPlates, DenseIndicesAndExactLookups) {
+  std::cout << "\n[TEST] DenseIndicesAndExactLookups\n";
+  const std::size_t n = 200000;
+  KnownPlates known(fleet(n));
+  ASSERT_EQ(known.Size(), n);
+  std::cout << "  Hash: " << static_cast<double>(known.HashBits()) / n
+            << " bits per plate, total " << known.MemoryBytes() / 1024
+            << " KiB\n";
+  EXPECT_LT(known.HashBits(), n * 6);
+
+  // Every plate gets its own index in [0, n).
+  std::vector<bool> used(n, false);
+  for (std::size_t i = 0; i < n; ++i) {
+    const std::string plate = "FL" + std::to_string(i);
+    const std::uint32_t index = known.Find(plate);
+    ASSERT_LT(index, n);
+    EXPECT_FALSE(used[index]);
+    used[index] = true;
+    EXPECT_EQ(known.Plate(index), plate);
+  }
+  // Unlisted plates are rejected by the compare.
+  std::size_t falseHits = 0;
+  for (std::size_t i = 0; i < n; ++i)
+    falseHits += known.Find("XX" + std::to_string(i)) != KnownPlates::npos;
+  EXPECT_EQ(falseHits, 0u);
+
+  // Alphabetical() walks the plates in order.
+  const auto &order = known.Alphabetical();
+  for (std::size_t i = 1; i < order.size(); ++i)
+    ASSERT_LT(known.Plate(order[i - 1]), known.Plate(order[i]));
+
+  KnownPlates canonical({"ab-1", "AB 1", "c#3", "cd.2"});
+  EXPECT_EQ(canonical.Size(), 2u);
+  EXPECT_EQ(canonical.SkippedCount(), 2u);
+  EXPECT_NE(canonical.Find("AB1"), KnownPlates::npos);
+  EXPECT_EQ(KnownPlates({}).Find("AB1"), KnownPlates::npos);
+}
+
+TEST(KnownPlates, MonitorCountsFleetOutsideThePool) {
+  std::cout << "\n[TEST] MonitorCountsFleetOutsideThePool\n";
+  for (IngestMode mode : {IngestMode::Mutex, IngestMode::LockFree}) {
+    MonitorConfig config;
+    config.ingest = mode;
+    config.canonicalizePlates = true;
+    config.knownPlates = std::make_shared<const KnownPlates>(fleet(5000));
+    CrossroadTrafficMonitoring monitor(std::chrono::hours(24), config);
+    monitor.Start();
+    // More fleet plates than the pool holds, plus a few visitors.
+    for (int i = 0; i < 5000; ++i)
+      monitor.OnSignal(Car("fl" + std::to_string(i)));
+    monitor.OnSignal(Car("FL-7"));
+    monitor.OnSignal(Scooter("FL7"));
+    monitor.OnSignal(Car("VISITOR"));
+    monitor.OnSignal(Bicycle("AAA"));
+
+    const MonitorTotals totals = monitor.GetTotals();
+    EXPECT_EQ(totals.uniqueVehicles[1], 5001u);
+    EXPECT_EQ(totals.uniqueVehicles[2], 1u);
+    EXPECT_EQ(totals.acceptedSignals, 5004u);
+    EXPECT_EQ(totals.poolInUse, 2u); // only the visitors
+    std::cout << "  Pool in use: " << totals.poolInUse << " (Expected: 2)\n";
+
+    EXPECT_EQ(monitor.GetVehicleCount(VehicleCategory::Car, "FL7"), 2u);
+    EXPECT_EQ(monitor.GetVehicleCount("fl 7").Total(), 3u);
+    EXPECT_EQ(monitor.GetVehicleCount(VehicleCategory::Car, "VISITOR"), 1u);
+
+    const auto lines = monitor.GetStatistics();
+    ASSERT_EQ(lines.size(), 5003u);
+    EXPECT_EQ(lines.front(), "AAA - Bicycle (1)");
+    EXPECT_EQ(lines.back(), "VISITOR - Car (1)");
+    EXPECT_TRUE(std::is_sorted(lines.begin(), lines.end()));
+    EXPECT_EQ(monitor.GetStatistics(VehicleCategory::Scooter),
+              std::vector<std::string>{"FL7 - Scooter (1)"});
+    EXPECT_EQ(monitor.GetStatistics(VehicleCategory::Bicycle),
+              std::vector<std::string>{"AAA - Bicycle (1)"});
+    const auto top = monitor.GetTopVehicles(1);
+    ASSERT_EQ(top.size(), 1u);
+    EXPECT_EQ(top[0].id, "FL7");
+    EXPECT_GT(monitor.GetMemoryUsage().knownPlatesBytes, 5000u * 12);
+
+    monitor.Reset();
+    EXPECT_TRUE(monitor.GetStatistics().empty());
+    EXPECT_EQ(monitor.GetVehicleCount("FL7").Total(), 0u);
+  }
+}
+
+TEST(KnownPlates, ConcurrentLockFreeCounting) {
+  std::cout << "\n[TEST] ConcurrentLockFreeCounting\n";
+  MonitorConfig config;
+  config.ingest = IngestMode::LockFree;
+  config.knownPlates = std::make_shared<const KnownPlates>(fleet(100), false);
+  CrossroadTrafficMonitoring monitor(std::chrono::hours(24), config);
+  monitor.Start();
+  std::vector<std::thread> cameras;
+  for (int t = 0; t < 4; ++t) {
+    cameras.emplace_back([&monitor] {
+      for (int i = 0; i < 5000; ++i)
+        monitor.OnSignal(Car("FL" + std::to_string(i % 100)));
+    });
+  }
+  for (auto &c : cameras)
+    c.join();
+  EXPECT_EQ(monitor.GetVehicleCount(VehicleCategory::Car, "FL42"), 200u);
+  EXPECT_EQ(monitor.GetTotals().acceptedSignals, 20000u);
+  EXPECT_EQ(monitor.GetTotals().uniqueVehicles[1], 100u);
+}
+
+TEST(KnownPlates, CanonicalizationMustMatchTheMonitor) {
+  std::cout << "\n[TEST] CanonicalizationMustMatchTheMonitor\n";
+  MonitorConfig config;
+  config.knownPlates = std::make_shared<const KnownPlates>(fleet(10));
+  // (Expected: a canonical list on a raw-ID monitor never matches "fl-1")
+  EXPECT_THROW(CrossroadTrafficMonitoring(std::chrono::hours(24), config),
+               std::invalid_argument);
+  config.canonicalizePlates = true;
+  EXPECT_NO_THROW(CrossroadTrafficMonitoring(std::chrono::hours(24), config));
+  config.knownPlates = std::make_shared<const KnownPlates>(fleet(10), false);
+  EXPECT_THROW(CrossroadTrafficMonitoring(std::chrono::hours(24), config),
+               std::invalid_argument);
+}
@@ -0,0 +1,188 @@
+#include "CrossroadTrafficMonitoring.hpp"
+#include "PartitionedMonitor.hpp"
+#include <gtest/gtest.h>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace ctm;
+
+//-----------------------------------------------------------------------------
+// Test Suite: PartitionedMonitor
+//-----------------------------------------------------------------------------
+
+namespace {
+void expectSameCounts(const MonitorTotals &a, const MonitorTotals &b) {
+  EXPECT_EQ(a.state, b.state);
+  EXPECT_EQ(a.errorCount, b.errorCount);
+  EXPECT_EQ(a.uniqueVehicles, b.uniqueVehicles);
+  EXPECT_EQ(a.sightings, b.sightings);
+}
+} // namespace
+
+TEST(PartitionedMonitor, MatchesASingleMonitor) {
+  std::cout << "\n[TEST] MatchesASingleMonitor\n";
+  MonitorConfig single;
+  single.canonicalizePlates = true;
+  CrossroadTrafficMonitoring reference(std::chrono::hours(1), single);
+  PartitionConfig config;
+  config.workers = 3;
+  config.period = std::chrono::hours(1);
+  config.batchSize = 16;
+  PartitionedMonitor partitioned(config);
+
+  reference.Start();
+  partitioned.Start();
+  std::mt19937 rng(123);
+  for (int s = 0; s < 3000; ++s) {
+    const std::string id = (s % 97 == 0 ? "bad plate " : "pl-") +
+                           std::to_string(rng() % 300);
+    switch (rng() % 3) {
+    case 0:
+      reference.OnSignal(Bicycle(id));
+      partitioned.OnSignal(Bicycle(id));
+      break;
+    case 1:
+      reference.OnSignal(Car(id));
+      partitioned.OnSignal(Car(id));
+      break;
+    default:
+      reference.OnSignal(Scooter(id));
+      partitioned.OnSignal(Scooter(id));
+      break;
+    }
+  }
+  EXPECT_EQ(partitioned.GetStatistics(), reference.GetStatistics());
+  expectSameCounts(partitioned.GetTotals(), reference.GetTotals());
+  EXPECT_EQ(partitioned.GetTotals().acceptedSignals,
+            reference.GetTotals().acceptedSignals);
+  EXPECT_EQ(partitioned.GetStats().rejectedPlates,
+            reference.GetRejectedPlateCount());
+  for (const char *id : {"PL7", "pl 42", "nope"})
+    EXPECT_EQ(partitioned.GetVehicleCount(id).perCategory,
+              reference.GetVehicleCount(id).perCategory)
+        << id;
+  const PartitionStats stats = partitioned.GetStats();
+  std::cout << "  " << stats.signalsSent << " signals in " << stats.batchesSent
+            << " batches to " << stats.workers << " workers\n";
+  EXPECT_EQ(stats.workers, 3u);
+
+  // Control signals reach every worker; an error is reported once.
+  reference.OnSignal();
+  partitioned.OnSignal();
+  expectSameCounts(partitioned.GetTotals(), reference.GetTotals());
+  reference.Reset();
+  partitioned.Reset();
+  reference.Stop();
+  partitioned.Stop();
+  expectSameCounts(partitioned.GetTotals(), reference.GetTotals());
+  EXPECT_TRUE(partitioned.GetStatistics().empty());
+}
+
+TEST(PartitionedMonitor, AddAndRemoveWorkersKeepCounts) {
+  std::cout << "\n[TEST] AddAndRemoveWorkersKeepCounts\n";
+  PartitionConfig config;
+  config.workers = 4;
+  config.period = std::chrono::hours(1);
+  config.layout = StorageLayout::PerPlate;
+  PartitionedMonitor partitioned(config);
+  partitioned.Start();
+  // More plates than one monitor holds (1000).
+  constexpr std::size_t kPlates = 2000;
+  for (std::size_t p = 0; p < kPlates; ++p) {
+    partitioned.OnSignal(Car("CAR" + std::to_string(p)));
+    if (p % 4 == 0)
+      partitioned.OnSignal(Scooter("CAR" + std::to_string(p)));
+  }
+  const std::vector<std::string> stats = partitioned.GetStatistics();
+  const MonitorTotals totals = partitioned.GetTotals();
+  EXPECT_EQ(totals.uniqueVehicles[static_cast<std::size_t>(VehicleCategory::Car)],
+            kPlates);
+  EXPECT_EQ(stats.size(), kPlates + kPlates / 4);
+
+  const std::uint32_t added = partitioned.AddWorker();
+  EXPECT_EQ(partitioned.Workers(),
+            (std::vector<std::uint32_t>{0, 1, 2, 3, added}));
+  const std::uint64_t movedIn = partitioned.GetStats().platesMoved;
+  std::cout << "  moved to the new worker: " << movedIn
+            << " (Expected: about " << kPlates / 5 << ")\n";
+  EXPECT_GT(movedIn, kPlates / 5 / 2);
+  EXPECT_LT(movedIn, kPlates / 5 * 2);
+  EXPECT_EQ(partitioned.GetStatistics(), stats);
+  expectSameCounts(partitioned.GetTotals(), totals);
+
+  // Counting goes on where the ring now sends each plate.
+  std::size_t onNewWorker = 0;
+  for (std::size_t p = 0; p < kPlates; ++p)
+    onNewWorker += partitioned.WorkerFor("CAR" + std::to_string(p)) == added;
+  EXPECT_EQ(onNewWorker, movedIn);
+  partitioned.OnSignal(Car("car-8"));
+  EXPECT_EQ(partitioned.GetVehicleCount("CAR8").Total(), 3u);
+
+  EXPECT_FALSE(partitioned.RemoveWorker(99));
+  EXPECT_TRUE(partitioned.RemoveWorker(1));
+  EXPECT_EQ(partitioned.Workers(),
+            (std::vector<std::uint32_t>{0, 2, 3, added}));
+  EXPECT_EQ(partitioned.GetVehicleCount("CAR8").Total(), 3u);
+  EXPECT_EQ(partitioned.GetTotals().sightings,
+            [&] {
+              auto s = totals.sightings;
+              ++s[static_cast<std::size_t>(VehicleCategory::Car)];
+              return s;
+            }());
+  std::cout << "  moved in total: " << partitioned.GetStats().platesMoved
+            << "\n";
+
+  // A new worker follows the others' state.
+  partitioned.Stop();
+  partitioned.AddWorker();
+  EXPECT_EQ(partitioned.GetTotals().state, State::Stopped);
+  EXPECT_EQ(partitioned.GetVehicleCount("CAR8").Total(), 3u);
+}
+
+TEST(PartitionedMonitor, HandOffKeepsIdsStateAndErrors) {
+  std::cout << "\n[TEST] HandOffKeepsIdsStateAndErrors\n";
+  CrossroadTrafficMonitoring reference(std::chrono::hours(1));
+  PartitionConfig config;
+  config.workers = 2;
+  config.period = std::chrono::hours(1);
+  config.canonicalizePlates = false; // IDs as sent, separators included
+  PartitionedMonitor partitioned(config);
+  reference.Start();
+  partitioned.Start();
+  for (int i = 0; i < 200; ++i) {
+    const std::string id = "a - b (" + std::to_string(i) + ")";
+    reference.OnSignal(Car(id));
+    partitioned.OnSignal(Car(id));
+  }
+  const MonitorTotals before = partitioned.GetTotals();
+  partitioned.AddWorker();
+  EXPECT_GT(partitioned.GetStats().platesMoved, 0u);
+  EXPECT_EQ(partitioned.GetStatistics(), reference.GetStatistics());
+  // (Expected: moving plates is not counting them again)
+  EXPECT_EQ(partitioned.GetTotals().acceptedSignals, before.acceptedSignals);
+
+  // One camera error, then signals each worker counts as its own error.
+  reference.OnSignal();
+  partitioned.OnSignal();
+  for (int i = 0; i < 5; ++i) {
+    reference.OnSignal(Bicycle("E" + std::to_string(i)));
+    partitioned.OnSignal(Bicycle("E" + std::to_string(i)));
+  }
+  const MonitorTotals totals = partitioned.GetTotals();
+  std::cout << "  errors: " << totals.errorCount << ", camera errors: "
+            << totals.cameraErrors << " (Expected: 6, 1)\n";
+  expectSameCounts(totals, reference.GetTotals());
+  EXPECT_EQ(totals.cameraErrors, 1u);
+
+  // Moving plates keeps the Error state and the errors of the workers
+  // left; the removed worker's own errors go with it.
+  EXPECT_TRUE(partitioned.RemoveWorker(0));
+  const MonitorTotals after = partitioned.GetTotals();
+  EXPECT_EQ(after.state, State::Error);
+  EXPECT_EQ(after.cameraErrors, 1u);
+  EXPECT_LE(after.errorCount, totals.errorCount);
+  EXPECT_EQ(after.sightings, reference.GetTotals().sightings);
+  EXPECT_EQ(partitioned.GetStatistics(), reference.GetStatistics());
+}
@@ -0,0 +1,140 @@
+#include "CrossroadTrafficMonitoring.hpp"
+#include "PlateCanonicalizer.hpp"
+#include <chrono>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <random>
+#include <string>
+
+using namespace ctm;
+
+//-----------------------------------------------------------------------------
+// Test Suite: Plate Canonicalization
+//-----------------------------------------------------------------------------
+
+TEST(PlateCanonicalization, FoldsCaseAndStripsSeparators) {
+    std::cout << "\n[TEST] FoldsCaseAndStripsSeparators\n";
+    const char *inputs[] = {"ab-123", "AB 123", "a.b-1 2 3", "AB123"};
+    for (const char *raw : inputs) {
+        std::string out;
+        const PlateStatus status = CanonicalizePlate(raw, out);
+        std::cout << "  '" << raw << "' -> '" << out << "' ("
+                  << ToString(status) << ")\n";
+        EXPECT_EQ(status, PlateStatus::Ok);
+        EXPECT_EQ(out, "AB123");
+    }
+}
+
+TEST(PlateCanonicalization, RejectsMalformedPlates) {
+    std::cout << "\n[TEST] RejectsMalformedPlates\n";
+    std::string out;
+    EXPECT_EQ(CanonicalizePlate("", out), PlateStatus::Empty);
+    EXPECT_EQ(CanonicalizePlate(" - ", out), PlateStatus::Empty);
+    EXPECT_EQ(CanonicalizePlate("AB_123", out), PlateStatus::InvalidCharacter);
+    EXPECT_EQ(CanonicalizePlate("AB\xC3\x84" "12", out),
+              PlateStatus::InvalidCharacter);
+    EXPECT_EQ(CanonicalizePlate("0123456789ABCDEF", out), PlateStatus::TooLong);
+    // Separators do not count towards the length limit.
+    EXPECT_EQ(CanonicalizePlate("0-1-2-3-4-5-6-7-8-9-A-B-C-D-E", out),
+              PlateStatus::Ok);
+    EXPECT_EQ(out, "0123456789ABCDE");
+}
+
+TEST(PlateCanonicalization, SimdMatchesScalar) {
+    std::cout << "\n[TEST] SimdMatchesScalar\n";
+    // Every single character, in every position of short and long inputs,
+    // so both the full 16-byte blocks and the padded tails are covered.
+    for (int c = 1; c < 256; ++c) {
+        for (std::size_t len : {1u, 7u, 15u, 16u, 17u, 33u}) {
+            for (std::size_t at = 0; at < len; at += 5) {
+                std::string raw(len, '-');
+                for (std::size_t i = 0; i < len; i += 3)
+                    raw[i] = 'a';
+                raw[at] = static_cast<char>(c);
+
+                char scalarOut[MAX_PLATE_LENGTH];
+                char simdOut[MAX_PLATE_LENGTH];
+                std::size_t scalarLen = 0, simdLen = 0;
+                const auto scalar =
+                    detail::CanonicalizePlateScalar(raw, scalarOut, scalarLen);
+                const auto simd =
+                    detail::CanonicalizePlateSimd(raw, simdOut, simdLen);
+                ASSERT_EQ(scalar, simd) << "char=" << c << " len=" << len;
+                if (scalar == PlateStatus::Ok) {
+                    ASSERT_EQ(std::string(scalarOut, scalarLen),
+                              std::string(simdOut, simdLen));
+                }
+            }
+        }
+    }
+}
+
+TEST(PlateCanonicalization, SimdMatchesScalarStatusOrder) {
+    std::cout << "\n[TEST] SimdMatchesScalarStatusOrder\n";
+    // Length overflow and an invalid character in one input: both report
+    // whichever the input reaches first.
+    const std::string cases[] = {
+        "ABCDE-FGHIJ-----AAAAAA!", // too long before the '!'
+        "ABCDE-FGHIJ-----AAAA!AA", // '!' first
+        "ABCDEFGHIJKLMNO!",        // '!' right at the limit
+        "ABCDEFGHIJKLMNOP!",       // limit exceeded inside the chunk
+        "!ABCDEFGHIJKLMNOPQRS",    // '!' before everything
+    };
+    for (const std::string &raw : cases) {
+        char scalarOut[MAX_PLATE_LENGTH];
+        char simdOut[MAX_PLATE_LENGTH];
+        std::size_t scalarLen = 0, simdLen = 0;
+        const auto scalar =
+            detail::CanonicalizePlateScalar(raw, scalarOut, scalarLen);
+        const auto simd = detail::CanonicalizePlateSimd(raw, simdOut, simdLen);
+        std::cout << "  '" << raw << "' -> " << ToString(simd)
+                  << " (Expected: " << ToString(scalar) << ")\n";
+        EXPECT_EQ(scalar, simd) << raw;
+    }
+    // Random mixes of kept, separator and invalid characters.
+    std::mt19937 rng(101);
+    const char alphabet[] = "aZ9-. !";
+    for (int round = 0; round < 20000; ++round) {
+        std::string raw(rng() % 40, ' ');
+        for (char &c : raw)
+            c = alphabet[rng() % 7];
+        char scalarOut[MAX_PLATE_LENGTH];
+        char simdOut[MAX_PLATE_LENGTH];
+        std::size_t scalarLen = 0, simdLen = 0;
+        ASSERT_EQ(detail::CanonicalizePlateScalar(raw, scalarOut, scalarLen),
+                  detail::CanonicalizePlateSimd(raw, simdOut, simdLen))
+            << raw;
+    }
+}
+
+TEST(PlateCanonicalization, MonitorMergesSpellingsAndCountsRejections) {
+    std::cout << "\n[TEST] MonitorMergesSpellingsAndCountsRejections\n";
+    MonitorConfig config;
+    config.canonicalizePlates = true;
+    CrossroadTrafficMonitoring monitor(std::chrono::hours(24), config);
+    monitor.Start();
+
+    monitor.OnSignal(Car("ab-123", 1));
+    monitor.OnSignal(Car("AB 123", 2));
+    monitor.OnSignal(Car("AB123", 2));
+    monitor.OnSignal(Car("AB_123", 2));
+    monitor.OnSignal(Bicycle("", 7));
+
+    const auto stats = monitor.GetStatistics();
+    std::cout << "  Expected 1 entry, Actual: " << stats.size() << "\n";
+    ASSERT_EQ(stats.size(), 1u);
+    EXPECT_EQ(stats[0], "AB123 - Car (3)");
+
+    std::cout << "  Rejections camera 2: " << monitor.GetRejectedPlateCount(2)
+              << ", camera 7: " << monitor.GetRejectedPlateCount(7) << "\n";
+    EXPECT_EQ(monitor.GetRejectedPlateCount(1), 0u);
+    EXPECT_EQ(monitor.GetRejectedPlateCount(2), 1u);
+    EXPECT_EQ(monitor.GetRejectedPlateCount(7), 1u);
+    EXPECT_EQ(monitor.GetRejectedPlateCount(), 2u);
+    // Malformed plates are not camera errors.
+    EXPECT_EQ(monitor.GetErrorCount(), 0u);
+    EXPECT_EQ(monitor.GetCurrentState(), State::Active);
+
+    monitor.Reset();
+    EXPECT_EQ(monitor.GetRejectedPlateCount(), 0u);
+}
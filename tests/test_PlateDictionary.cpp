@@ -0,0 +1,126 @@
+#include "CrossroadTrafficMonitoring.hpp"
+#include "KnownPlates.hpp"
+#include "PlateDictionary.hpp"
+#include <chrono>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace ctm;
+
+//-----------------------------------------------------------------------------
+// Test Suite: Plate dictionary
+//-----------------------------------------------------------------------------
+
+TEST(PlateDictionary, IndicesAreDenseAndStable) {
+  std::cout << "\n[TEST] IndicesAreDenseAndStable\n";
+  PlateDictionary dictionary(2, 10);
+  EXPECT_EQ(dictionary.Acquire("AAA"), 10u);
+  EXPECT_EQ(dictionary.Acquire("BBB"), 11u);
+  EXPECT_EQ(dictionary.Acquire("AAA"), 10u);
+  EXPECT_EQ(dictionary.Find("BBB"), 11u);
+  EXPECT_EQ(dictionary.Find("CCC"), PlateDictionary::npos);
+  EXPECT_EQ(dictionary.Plate(11), "BBB");
+  EXPECT_EQ(dictionary.Plate(3), ""); // below firstIndex
+  EXPECT_EQ(dictionary.Size(), 2u);
+
+  // Seen every other period: kept.
+  for (int period = 0; period < 6; ++period) {
+    EXPECT_EQ(dictionary.NextPeriod(), 0u);
+    if (period % 2 == 1) {
+      EXPECT_EQ(dictionary.Acquire("AAA"), 10u);
+    }
+    EXPECT_EQ(dictionary.Acquire("BBB"), 11u);
+  }
+}
+
+TEST(PlateDictionary, EvictsAfterKeepPeriodsAndReusesIndices) {
+  std::cout << "\n[TEST] EvictsAfterKeepPeriodsAndReusesIndices\n";
+  PlateDictionary dictionary(2);
+  const std::uint32_t a = dictionary.Acquire("AAA"); // period 0
+  dictionary.Acquire("BBB");
+  // (Expected: AAA last seen in period 0 survives periods 1 and 2, and is
+  // evicted when period 3 opens)
+  EXPECT_EQ(dictionary.NextPeriod(), 0u);
+  dictionary.Acquire("BBB");
+  EXPECT_EQ(dictionary.NextPeriod(), 0u);
+  dictionary.Acquire("BBB");
+  EXPECT_EQ(dictionary.NextPeriod(), 1u);
+  EXPECT_EQ(dictionary.Find("AAA"), PlateDictionary::npos);
+  EXPECT_EQ(dictionary.Plate(a), "");
+  EXPECT_EQ(dictionary.Size(), 1u);
+
+  // The freed index goes to the next new plate.
+  EXPECT_EQ(dictionary.Acquire("CCC"), a);
+  EXPECT_EQ(dictionary.Plate(a), "CCC");
+  EXPECT_GT(dictionary.MemoryBytes(), 0u);
+}
+
+TEST(PlateDictionary, MonitorIndexSurvivesResetsAndCompaction) {
+  std::cout << "\n[TEST] MonitorIndexSurvivesResetsAndCompaction\n";
+  for (IngestMode mode : {IngestMode::Mutex, IngestMode::LockFree}) {
+    MonitorConfig config;
+    config.ingest = mode;
+    config.plateIndexPeriods = 2;
+    config.poolSplit = {1, 1, 1};
+    CrossroadTrafficMonitoring monitor(std::chrono::hours(24), config);
+    monitor.Start();
+    EXPECT_EQ(monitor.GetPlateIndex("AAA"), PlateDictionary::npos);
+    for (int i = 0; i < 50; ++i)
+      monitor.OnSignal(Car("C" + std::to_string(i)));
+    monitor.OnSignal(Car("AAA"));
+    monitor.OnSignal(Bicycle("AAA")); // same plate, same index
+    const std::uint32_t index = monitor.GetPlateIndex("AAA");
+    ASSERT_NE(index, PlateDictionary::npos);
+    EXPECT_EQ(monitor.GetIndexedPlate(index), "AAA");
+
+    // Pool entries move and are freed; the index stays.
+    monitor.CompactStep();
+    monitor.Reset();
+    monitor.OnSignal(Scooter("AAA"));
+    EXPECT_EQ(monitor.GetPlateIndex("AAA"), index);
+    EXPECT_GT(monitor.GetMemoryUsage().plateIndexBytes, 0u);
+
+    // (Expected: unseen for more than 2 periods, C0 loses its index)
+    EXPECT_NE(monitor.GetPlateIndex("C0"), PlateDictionary::npos);
+    monitor.Reset();
+    monitor.Reset();
+    EXPECT_EQ(monitor.GetPlateIndex("C0"), PlateDictionary::npos);
+    EXPECT_EQ(monitor.GetPlateIndex("AAA"), index);
+    monitor.Reset();
+    EXPECT_EQ(monitor.GetPlateIndex("AAA"), PlateDictionary::npos);
+  }
+}
+
+TEST(PlateDictionary, MonitorWithRetentionAndKnownPlates) {
+  std::cout << "\n[TEST] MonitorWithRetentionAndKnownPlates\n";
+  MonitorConfig config;
+  config.canonicalizePlates = true;
+  config.plateRetentionPeriods = 5;
+  config.plateIndexPeriods = 1;
+  config.knownPlates =
+      std::make_shared<const KnownPlates>(std::vector<std::string>{"FL1"});
+  CrossroadTrafficMonitoring monitor(std::chrono::hours(24), config);
+  monitor.Start();
+
+  // Known plates keep their KnownPlates index, the others follow them.
+  monitor.OnSignal(Car("fl-1"));
+  monitor.OnSignal(Car("ab 1"));
+  EXPECT_EQ(monitor.GetPlateIndex("FL1"), 0u);
+  EXPECT_EQ(monitor.GetIndexedPlate(0), "FL1");
+  EXPECT_EQ(monitor.GetPlateIndex("ab-1"), 1u);
+  EXPECT_EQ(monitor.GetIndexedPlate(1), "AB1");
+
+  // A retained plate idle for longer than plateIndexPeriods gets an index
+  // again when it is next seen.
+  monitor.Reset();
+  monitor.Reset();
+  EXPECT_EQ(monitor.GetPlateIndex("AB1"), PlateDictionary::npos);
+  monitor.OnSignal(Car("CD2")); // takes the freed index
+  monitor.OnSignal(Car("AB1"));
+  EXPECT_EQ(monitor.GetPlateIndex("CD2"), 1u);
+  EXPECT_EQ(monitor.GetPlateIndex("AB1"), 2u);
+  EXPECT_EQ(monitor.GetVehicleCount(VehicleCategory::Car, "AB1"), 1u);
+}
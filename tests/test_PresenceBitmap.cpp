@@ -0,0 +1,180 @@
+#include "CrossroadTrafficMonitoring.hpp"
+#include "PresenceBitmap.hpp"
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace ctm;
+
+namespace {
+// `n` random values below `range`.
+std::set<std::uint32_t> randomSet(std::mt19937 &rng, std::size_t n,
+                                  std::uint32_t range) {
+  std::uniform_int_distribution<std::uint32_t> value(0, range - 1);
+  std::set<std::uint32_t> values;
+  while (values.size() < n)
+    values.insert(value(rng));
+  return values;
+}
+
+PresenceBitmap toBitmap(const std::set<std::uint32_t> &values) {
+  PresenceBitmap bitmap;
+  for (std::uint32_t v : values)
+    bitmap.Add(v);
+  return bitmap;
+}
+
+std::vector<std::uint16_t> randomArray(std::mt19937 &rng, std::size_t n) {
+  std::vector<std::uint16_t> array;
+  for (std::uint32_t v : randomSet(rng, n, 65536))
+    array.push_back(static_cast<std::uint16_t>(v));
+  return array;
+}
+} // namespace
+
+//-----------------------------------------------------------------------------
+// Test Suite: PresenceBitmap
+//-----------------------------------------------------------------------------
+
+TEST(PresenceBitmap, MatchesStdSetOperations) {
+  std::cout << "\n[TEST] MatchesStdSetOperations\n";
+  std::mt19937 rng(119);
+  // (size, range): sparse arrays, dense bitmaps, and both in one bitmap
+  const std::vector<std::pair<std::size_t, std::uint32_t>> shapes = {
+      {500, 1u << 22}, {30000, 3u * 65536}, {5000, 65536}, {4096, 65536}};
+  for (const auto &[sizeA, rangeA] : shapes) {
+    for (const auto &[sizeB, rangeB] : shapes) {
+      const auto a = randomSet(rng, sizeA, rangeA);
+      const auto b = randomSet(rng, sizeB, rangeB);
+      const PresenceBitmap ba = toBitmap(a), bb = toBitmap(b);
+
+      std::vector<std::uint32_t> both, either;
+      std::set_intersection(a.begin(), a.end(), b.begin(), b.end(),
+                            std::back_inserter(both));
+      std::set_union(a.begin(), a.end(), b.begin(), b.end(),
+                     std::back_inserter(either));
+      EXPECT_EQ(ba.Cardinality(), a.size());
+      EXPECT_EQ(ba.ToVector(), std::vector<std::uint32_t>(a.begin(), a.end()));
+      EXPECT_EQ(PresenceBitmap::And(ba, bb).ToVector(), both);
+      EXPECT_EQ(PresenceBitmap::Or(ba, bb).ToVector(), either);
+      EXPECT_EQ(PresenceBitmap::AndCardinality(ba, bb), both.size());
+      // Results are in the same form as a bitmap built value by value.
+      EXPECT_EQ(PresenceBitmap::And(ba, bb),
+                toBitmap(std::set<std::uint32_t>(both.begin(), both.end())));
+      EXPECT_EQ(PresenceBitmap::Or(ba, bb),
+                toBitmap(std::set<std::uint32_t>(either.begin(), either.end())));
+    }
+  }
+
+  PresenceBitmap bitmap;
+  bitmap.Add(7);
+  bitmap.Add(7);
+  bitmap.Add(1u << 20);
+  EXPECT_EQ(bitmap.Cardinality(), 2u);
+  EXPECT_TRUE(bitmap.Contains(1u << 20));
+  EXPECT_FALSE(bitmap.Contains(8));
+  EXPECT_TRUE(PresenceBitmap::And(bitmap, PresenceBitmap{}).Empty());
+
+  // Dense sets are far smaller than a sorted vector of indices.
+  const PresenceBitmap dense = toBitmap(randomSet(rng, 60000, 65536));
+  std::cout << "  60000 dense values: " << dense.MemoryBytes() << " bytes\n";
+  EXPECT_LT(dense.MemoryBytes(), 60000 * sizeof(std::uint32_t) / 10);
+}
+
+TEST(PresenceBitmap, SimdKernelsMatchScalar) {
+  std::cout << "\n[TEST] SimdKernelsMatchScalar\n";
+  std::mt19937 rng(1190);
+  for (std::size_t na : {0, 1, 7, 8, 9, 64, 333, 4096}) {
+    for (std::size_t nb : {0, 5, 8, 100, 1000, 4096}) {
+      const auto a = randomArray(rng, na);
+      const auto b = randomArray(rng, nb);
+      std::vector<std::uint16_t> scalar(std::min(na, nb)), simd(scalar.size());
+      const std::size_t ns = detail::IntersectArraysScalar(
+          a.data(), na, b.data(), nb, scalar.data());
+      const std::size_t nv =
+          detail::IntersectArraysSimd(a.data(), na, b.data(), nb, simd.data());
+      ASSERT_EQ(ns, nv) << na << " x " << nb;
+      scalar.resize(ns);
+      simd.resize(nv);
+      EXPECT_EQ(scalar, simd);
+    }
+  }
+
+  std::vector<std::uint64_t> a(1024), b(1024), out1(1024), out2(1024);
+  for (std::size_t w = 0; w < a.size(); ++w) {
+    a[w] = (std::uint64_t{rng()} << 32) | rng();
+    b[w] = (std::uint64_t{rng()} << 32) | rng();
+  }
+  EXPECT_EQ(detail::AndWordsScalar(a.data(), b.data(), out1.data(), 1024),
+            detail::AndWordsSimd(a.data(), b.data(), out2.data(), 1024));
+  EXPECT_EQ(out1, out2);
+  EXPECT_EQ(detail::AndWordsSimd(a.data(), b.data(), nullptr, 1024),
+            detail::AndWordsScalar(a.data(), b.data(), nullptr, 1024));
+  EXPECT_EQ(detail::OrWordsScalar(a.data(), b.data(), out1.data(), 1024),
+            detail::OrWordsSimd(a.data(), b.data(), out2.data(), 1024));
+  EXPECT_EQ(out1, out2);
+}
+
+TEST(PresenceBitmap, MonitorPeriodsAnswerSetQueries) {
+  std::cout << "\n[TEST] MonitorPeriodsAnswerSetQueries\n";
+  MonitorConfig config;
+  config.canonicalizePlates = true;
+  config.errorBufferCapacity = 4;
+  config.plateIndexPeriods = 3;
+  CrossroadTrafficMonitoring monitor(std::chrono::hours(24), config);
+  PresenceHistory history(3);
+  // (Expected: a history kept longer than the plate indices is refused)
+  PresenceHistory tooLong(4);
+  EXPECT_FALSE(monitor.SetPresenceHistory(&tooLong));
+  EXPECT_FALSE(CrossroadTrafficMonitoring(std::chrono::hours(24))
+                   .SetPresenceHistory(&history));
+  ASSERT_TRUE(monitor.SetPresenceHistory(&history));
+  monitor.Start();
+
+  // Period 0 ("8:00")
+  monitor.OnSignal(Car("ab-1"));
+  monitor.OnSignal(Car("B2"));
+  monitor.OnSignal(Bicycle("C3"));
+  monitor.OnSignal(Car("bad#"));
+  monitor.Reset();
+  // Period 1 ("17:00"), a camera glitch buffers D4 for after the reset
+  monitor.OnSignal(Car("AB 1"));
+  monitor.OnSignal(Scooter("C3"));
+  monitor.OnSignal();
+  monitor.OnSignal(Car("D4"));
+  monitor.Reset();
+  // Period 2: D4 replayed
+  monitor.OnSignal(Car("C3"));
+  EXPECT_TRUE(history.Window(2).Empty()); // open until the reset
+  monitor.Reset();
+
+  EXPECT_EQ(history.OpenWindow(), 3u);
+  EXPECT_EQ(history.ClosedWindows(), (std::vector<std::uint64_t>{0, 1, 2}));
+  const std::vector<std::string> both =
+      monitor.GetIndexedPlates(history.SeenInAll({0, 1}));
+  std::cout << "  Seen in periods 0 and 1: " << both.size() << " (Expected: 2)\n";
+  EXPECT_EQ(both, (std::vector<std::string>{"AB1", "C3"}));
+  EXPECT_EQ(history.CountSeenInAll({0, 1}), 2u);
+  EXPECT_EQ(monitor.GetIndexedPlates(history.SeenInAll({0, 1, 2})),
+            std::vector<std::string>{"C3"});
+  EXPECT_EQ(monitor.GetIndexedPlates(history.SeenInAny({1, 2})),
+            (std::vector<std::string>{"AB1", "C3", "D4"}));
+  EXPECT_EQ(monitor.GetIndexedPlates(history.Window(2)),
+            (std::vector<std::string>{"C3", "D4"}));
+  EXPECT_EQ(monitor.GetPlateIndex("ab.1"), 0u);
+  EXPECT_TRUE(history.Window(2).Contains(monitor.GetPlateIndex("D4")));
+  EXPECT_EQ(monitor.GetPlateIndex("ZZ9"), UINT32_MAX);
+
+  // Only the last three closed periods are kept.
+  monitor.Reset();
+  monitor.SetPresenceHistory(nullptr);
+  EXPECT_TRUE(history.Window(0).Empty());
+  EXPECT_EQ(history.CountSeenInAll({0, 1}), 0u);
+  EXPECT_EQ(history.Window(2).Cardinality(), 2u);
+  EXPECT_TRUE(history.Window(3).Empty());
+}
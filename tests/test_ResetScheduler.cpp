@@ -0,0 +1,162 @@
+#include "CrossroadTrafficMonitoring.hpp"
+#include "ResetScheduler.hpp"
+#include <atomic>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace ctm;
+using namespace std::chrono_literals;
+
+namespace {
+SchedulerConfig manualConfig() {
+  SchedulerConfig config;
+  config.startThread = false;
+  return config;
+}
+} // namespace
+
+//-----------------------------------------------------------------------------
+// Test Suite: ResetScheduler
+//-----------------------------------------------------------------------------
+
+TEST(ResetScheduler, FiresOnCadenceAtEveryLevel) {
+  std::cout << "\n[TEST] FiresOnCadenceAtEveryLevel\n";
+  SchedulerConfig config = manualConfig();
+  config.tick = 100ms;
+  ResetScheduler scheduler(config);
+  const auto start = scheduler.Now();
+  // 100 ms ticks: level 0 (5 s), 1 (5 min), 2 (2 h), 3 (3 days) and beyond
+  // the wheel's 19 days (20 days).
+  const std::vector<std::chrono::milliseconds> periods = {5s, 5min, 2h, 72h,
+                                                          480h};
+  const auto end = start + 961h;
+  std::vector<std::vector<std::chrono::steady_clock::time_point>> fires(
+      periods.size());
+  for (std::size_t i = 0; i < periods.size(); ++i)
+    scheduler.Add(periods[i],
+                  [&, i] { fires[i].push_back(scheduler.Now() - 100ms); });
+
+  // Uneven steps, so ticks are reached both one by one and in bulk.
+  std::mt19937 rng(121);
+  auto now = start;
+  while (now < end) {
+    now = std::min(end, now + std::chrono::milliseconds(
+                                  rng() % 2 ? rng() % 500 : rng() % 40000000));
+    scheduler.AdvanceTo(now);
+  }
+  for (std::size_t i = 0; i < periods.size(); ++i) {
+    ASSERT_EQ(fires[i].size(), static_cast<std::size_t>(961h / periods[i]))
+        << periods[i].count();
+    for (std::size_t n = 0; n < fires[i].size(); ++n)
+      ASSERT_EQ(fires[i][n] - start, periods[i] * (n + 1)) << periods[i].count();
+  }
+  std::cout << "  3 day timer fired " << fires[3].size()
+            << " times (Expected: 13)\n";
+  EXPECT_EQ(scheduler.GetStats().skipped, 0u);
+}
+
+TEST(ResetScheduler, SpreadsAndLimitsBatches) {
+  std::cout << "\n[TEST] SpreadsAndLimitsBatches\n";
+  SchedulerConfig config = manualConfig();
+  config.spread = 1s;
+  config.maxBatch = 4;
+  ResetScheduler scheduler(config);
+  const auto start = scheduler.Now();
+  std::vector<std::chrono::steady_clock::time_point> fired(500);
+  std::vector<ResetScheduler::TimerId> ids;
+  for (std::size_t i = 0; i < fired.size(); ++i)
+    ids.push_back(
+        scheduler.Add(1min, [&, i] { fired[i] = scheduler.Now() - 10ms; }));
+
+  scheduler.AdvanceTo(start + 1min + 2s);
+  std::set<std::chrono::steady_clock::time_point> ticks;
+  for (const auto &at : fired) {
+    EXPECT_GE(at, start + 1min);
+    EXPECT_LT(at, start + 1min + 1500ms); // some wait for a later tick
+    ticks.insert(at);
+  }
+  const SchedulerStats stats = scheduler.GetStats();
+  std::cout << "  500 timers over " << ticks.size() << " ticks, largest batch "
+            << stats.maxBatchSize << " (Expected: <= 4)\n";
+  EXPECT_GT(ticks.size(), 60u);
+  EXPECT_LE(stats.maxBatchSize, 4u);
+  EXPECT_EQ(stats.fired, 500u);
+  EXPECT_GT(stats.deferred, 0u);
+
+  // Removed timers stop firing.
+  for (std::size_t i = 0; i < 250; ++i)
+    scheduler.Remove(ids[i]);
+  scheduler.Remove(ids[0]); // unknown by now
+  scheduler.AdvanceTo(start + 2min + 2s);
+  EXPECT_EQ(scheduler.GetStats().fired, 750u);
+  EXPECT_EQ(scheduler.GetStats().timers, 250u);
+
+  // Wall-clock alignment: the delay to the next boundary.
+  const std::chrono::system_clock::time_point at{123h + 59min + 30s};
+  EXPECT_EQ(detail::AlignedDelay(at, 1h), 30s);
+  EXPECT_EQ(detail::AlignedDelay(at, 15min), 30s);
+  EXPECT_EQ(detail::AlignedDelay(at + 30s, 1h), 1h);
+}
+
+TEST(ResetScheduler, DrivesMonitorResets) {
+  std::cout << "\n[TEST] DrivesMonitorResets\n";
+  ResetScheduler scheduler(manualConfig());
+  const auto start = scheduler.Now();
+  MonitorConfig config;
+  config.resetScheduler = &scheduler;
+  auto active = std::make_unique<CrossroadTrafficMonitoring>(1h, config);
+  CrossroadTrafficMonitoring stopped(1h, config);
+  CrossroadTrafficMonitoring idle(1h, config); // never started
+  active->Start();
+  stopped.Start();
+  active->OnSignal(Car("A1"));
+  active->OnSignal(Car("A1"));
+  stopped.OnSignal(Car("S1"));
+  stopped.Stop();
+
+  scheduler.AdvanceTo(start + 59min);
+  EXPECT_EQ(active->GetVehicleCount("A1").Total(), 2u);
+  scheduler.AdvanceTo(start + 1h);
+  std::cout << "  After the hour: " << active->GetVehicleCount("A1").Total()
+            << " sightings of A1 (Expected: 0)\n";
+  EXPECT_EQ(active->GetVehicleCount("A1").Total(), 0u);
+  EXPECT_EQ(stopped.GetCurrentState(), State::Stopped);
+  EXPECT_EQ(stopped.GetVehicleCount("S1").Total(), 1u);
+  EXPECT_EQ(idle.GetCurrentState(), State::Init);
+
+  // A manual reset does not move the cadence.
+  active->OnSignal(Car("A1"));
+  scheduler.AdvanceTo(start + 90min);
+  active->Reset();
+  active->OnSignal(Car("A1"));
+  scheduler.AdvanceTo(start + 2h);
+  EXPECT_EQ(active->GetVehicleCount("A1").Total(), 0u);
+
+  active.reset();
+  EXPECT_EQ(scheduler.GetStats().timers, 2u);
+  scheduler.AdvanceTo(start + 3h);
+  EXPECT_EQ(scheduler.GetStats().fired, 8u); // 2 x 3 hours + 2 before removal
+}
+
+TEST(ResetScheduler, ThreadFiresResets) {
+  std::cout << "\n[TEST] ThreadFiresResets\n";
+  SchedulerConfig schedulerConfig;
+  schedulerConfig.tick = 1ms;
+  ResetScheduler scheduler(schedulerConfig);
+  MonitorConfig config;
+  config.resetScheduler = &scheduler;
+  CrossroadTrafficMonitoring monitor(20ms, config);
+  monitor.Start();
+  monitor.OnSignal(Bicycle("B1"));
+  const auto deadline = std::chrono::steady_clock::now() + 5s;
+  while (monitor.GetVehicleCount("B1").Total() != 0 &&
+         std::chrono::steady_clock::now() < deadline)
+    std::this_thread::sleep_for(1ms);
+  EXPECT_EQ(monitor.GetVehicleCount("B1").Total(), 0u);
+  EXPECT_GE(scheduler.GetStats().fired, 1u);
+}
@@ -0,0 +1,380 @@
+#include "CrossroadTrafficMonitoring.hpp"
+#include "SignalTap.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace ctm;
+
+// Trace file next to the test binary, removed at the end of each test.
+static std::string tracePath(const char *name) {
+    return std::string("signal_tap_") + name + ".trace";
+}
+
+//-----------------------------------------------------------------------------
+// Test Suite: Signal Tap
+//-----------------------------------------------------------------------------
+
+TEST(SignalTap, RecordsEveryCallWithOutcome) {
+    std::cout << "\n[TEST] RecordsEveryCallWithOutcome\n";
+    const std::string path = tracePath("outcomes");
+    {
+        SignalTap tap(path);
+        ASSERT_TRUE(tap.IsOpen());
+        CrossroadTrafficMonitoring monitor(std::chrono::hours(24));
+        monitor.SetSignalTap(&tap);
+
+        monitor.OnSignal(Car("IGNORED"));     // Init => ignored
+        monitor.Start();                      // control call
+        monitor.OnSignal(Car("C1", 3));       // new
+        monitor.OnSignal(Car("C1", 4));       // counted
+        monitor.OnSignal();                   // camera error
+        monitor.OnSignal(Bicycle("B1"));      // error state
+        monitor.OnSignal(ResetSignal{});      // reset
+        monitor.SetSignalTap(nullptr);
+        monitor.OnSignal(Car("UNTAPPED"));
+        tap.Close();
+        std::cout << "  Written: " << tap.GetWrittenCount() << " (Expected: 7)\n";
+        EXPECT_EQ(tap.GetWrittenCount(), 7u);
+        EXPECT_EQ(tap.GetDroppedCount(), 0u);
+    }
+
+    std::vector<SignalTraceRecord> records;
+    ASSERT_TRUE(ReadSignalTrace(path, records));
+    ASSERT_EQ(records.size(), 7u);
+    EXPECT_EQ(records[0].outcome, SignalOutcome::Ignored);
+    EXPECT_EQ(records[0].Id(), "IGNORED");
+    EXPECT_EQ(records[1].kind, SignalKind::Start);
+    EXPECT_EQ(records[1].outcome, SignalOutcome::StateChange);
+    EXPECT_EQ(records[2].kind, SignalKind::Car);
+    EXPECT_EQ(records[2].outcome, SignalOutcome::NewVehicle);
+    EXPECT_EQ(records[2].camera, 3);
+    EXPECT_EQ(records[3].outcome, SignalOutcome::Counted);
+    EXPECT_EQ(records[4].kind, SignalKind::Error);
+    EXPECT_EQ(records[4].outcome, SignalOutcome::Error);
+    EXPECT_EQ(records[5].kind, SignalKind::Bicycle);
+    EXPECT_EQ(records[5].outcome, SignalOutcome::Error);
+    EXPECT_EQ(records[6].kind, SignalKind::Reset);
+    for (std::size_t i = 1; i < records.size(); ++i) {
+        EXPECT_LE(records[i - 1].timestampNs, records[i].timestampNs);
+        EXPECT_LE(records[i - 1].sequence, records[i].sequence);
+    }
+    // (Expected: control records number 1, 2, 3; vehicle records carry the
+    // number of the last one)
+    EXPECT_EQ(records[0].sequence, 0u);
+    EXPECT_EQ(records[1].sequence, 1u);
+    EXPECT_EQ(records[3].sequence, 1u);
+    EXPECT_EQ(records[6].sequence, 3u);
+    std::remove(path.c_str());
+}
+
+TEST(SignalTap, MultiThreadedCaptureReplaysToSameStatistics) {
+    std::cout << "\n[TEST] MultiThreadedCaptureReplaysToSameStatistics\n";
+    const std::string path = tracePath("replay");
+    CrossroadTrafficMonitoring monitor(std::chrono::hours(24));
+    monitor.Start();
+    {
+        // Small rings drained often, so the writer wraps them many times.
+        SignalTap tap(path, 256, std::chrono::milliseconds(1));
+        monitor.SetSignalTap(&tap);
+        std::vector<std::thread> cameras;
+        for (int t = 0; t < 4; ++t) {
+            cameras.emplace_back([&monitor, t] {
+                for (int i = 0; i < 2000; ++i) {
+                    const std::string id = "P-" + std::to_string(i % 50);
+                    if (t % 2)
+                        monitor.OnSignal(Car(id, static_cast<CameraId>(t)));
+                    else
+                        monitor.OnSignal(Scooter(id, static_cast<CameraId>(t)));
+                    if (i % 64 == 0)
+                        std::this_thread::sleep_for(std::chrono::microseconds(200));
+                }
+            });
+        }
+        for (auto &c : cameras)
+            c.join();
+        monitor.SetSignalTap(nullptr);
+        tap.Close();
+        std::cout << "  Written: " << tap.GetWrittenCount()
+                  << ", dropped: " << tap.GetDroppedCount() << "\n";
+        EXPECT_EQ(tap.GetWrittenCount() + tap.GetDroppedCount(), 8000u);
+        if (tap.GetDroppedCount() != 0)
+            GTEST_SKIP() << "writer fell behind, replay comparison skipped";
+    }
+
+    std::vector<SignalTraceRecord> records;
+    ASSERT_TRUE(ReadSignalTrace(path, records));
+    ASSERT_EQ(records.size(), 8000u);
+
+    CrossroadTrafficMonitoring replayed(std::chrono::hours(24));
+    replayed.Start();
+    ReplaySignalTrace(replayed, records);
+    // Same ID in two categories is listed in insertion order, which depends
+    // on thread interleaving, so compare the entries independent of order.
+    auto expected = monitor.GetStatistics();
+    auto actual = replayed.GetStatistics();
+    std::sort(expected.begin(), expected.end());
+    std::sort(actual.begin(), actual.end());
+    EXPECT_EQ(actual, expected);
+    std::remove(path.c_str());
+}
+
+TEST(SignalTap, ConcurrentResetsReplayInAppliedOrder) {
+    std::cout << "\n[TEST] ConcurrentResetsReplayInAppliedOrder\n";
+    for (IngestMode mode : {IngestMode::Mutex, IngestMode::FlatCombining,
+                            IngestMode::LockFree}) {
+        const std::string path = tracePath("resets");
+        MonitorConfig config;
+        config.ingest = mode;
+        CrossroadTrafficMonitoring monitor(std::chrono::hours(24), config);
+        std::uint64_t dropped = 0;
+        {
+            SignalTap tap(path, 1 << 14, std::chrono::milliseconds(1));
+            monitor.SetSignalTap(&tap);
+            monitor.Start();
+            std::atomic<bool> done{false};
+            std::vector<std::thread> cameras;
+            for (int t = 0; t < 4; ++t) {
+                cameras.emplace_back([&monitor, t] {
+                    for (int i = 0; i < 3000; ++i)
+                        monitor.OnSignal(Car("P-" + std::to_string(i % 40),
+                                             static_cast<CameraId>(t)));
+                });
+            }
+            std::thread resets([&] {
+                while (!done.load()) {
+                    monitor.Reset();
+                    std::this_thread::sleep_for(std::chrono::microseconds(300));
+                }
+            });
+            for (auto &c : cameras)
+                c.join();
+            done = true;
+            resets.join();
+            monitor.SetSignalTap(nullptr);
+            tap.Close();
+            dropped = tap.GetDroppedCount();
+        }
+        std::vector<SignalTraceRecord> records;
+        std::uint64_t droppedInHeader = 0;
+        const bool complete = ReadSignalTrace(path, records, &droppedInHeader);
+        std::remove(path.c_str());
+        EXPECT_EQ(droppedInHeader, dropped);
+        if (!complete)
+            GTEST_SKIP() << "writer fell behind, replay comparison skipped";
+
+        // (Expected: the last period counts exactly what the monitor did)
+        CrossroadTrafficMonitoring replayed(std::chrono::hours(24));
+        ReplaySignalTrace(replayed, records);
+        auto expected = monitor.GetStatistics();
+        auto actual = replayed.GetStatistics();
+        std::sort(expected.begin(), expected.end());
+        std::sort(actual.begin(), actual.end());
+        std::cout << "  Mode " << static_cast<int>(mode) << ": " << records.size()
+                  << " records, " << actual.size() << " lines\n";
+        EXPECT_EQ(actual, expected);
+    }
+}
+
+TEST(SignalTap, PeriodicResetsAreRecorded) {
+    std::cout << "\n[TEST] PeriodicResetsAreRecorded\n";
+    const std::string path = tracePath("periodic");
+    CrossroadTrafficMonitoring monitor(std::chrono::milliseconds(50));
+    {
+        SignalTap tap(path);
+        monitor.SetSignalTap(&tap);
+        monitor.Start();
+        monitor.OnSignal(Car("OLD"));
+        std::this_thread::sleep_for(std::chrono::milliseconds(80));
+        monitor.OnSignal(Car("NEW")); // resets first
+        monitor.SetSignalTap(nullptr);
+        tap.Close();
+    }
+    std::vector<SignalTraceRecord> records;
+    ASSERT_TRUE(ReadSignalTrace(path, records));
+    ASSERT_EQ(records.size(), 4u);
+    EXPECT_EQ(records[2].kind, SignalKind::Reset);
+    EXPECT_EQ(records[3].Id(), "NEW");
+
+    // (Expected: replayed without a period, OLD is gone all the same)
+    CrossroadTrafficMonitoring replayed(std::chrono::hours(24));
+    ReplaySignalTrace(replayed, records);
+    EXPECT_EQ(replayed.GetStatistics(), monitor.GetStatistics());
+    EXPECT_EQ(replayed.GetVehicleCount(VehicleCategory::Car, "OLD"), 0u);
+    std::remove(path.c_str());
+}
+
+TEST(SignalTap, DroppedRecordsMarkTheTraceIncomplete) {
+    std::cout << "\n[TEST] DroppedRecordsMarkTheTraceIncomplete\n";
+    const std::string path = tracePath("dropped");
+    {
+        // Two-record ring, not drained before Close().
+        SignalTap tap(path, 2, std::chrono::hours(1));
+        CrossroadTrafficMonitoring monitor(std::chrono::hours(24));
+        monitor.SetSignalTap(&tap);
+        monitor.Start();
+        for (int i = 0; i < 9; ++i)
+            monitor.OnSignal(Car("C" + std::to_string(i)));
+        monitor.SetSignalTap(nullptr);
+        tap.Close();
+        EXPECT_EQ(tap.GetDroppedCount(), 8u);
+    }
+    std::vector<SignalTraceRecord> records;
+    std::uint64_t dropped = 0;
+    EXPECT_FALSE(ReadSignalTrace(path, records, &dropped));
+    std::cout << "  Read: " << records.size() << ", dropped: " << dropped
+              << " (Expected: 2, 8)\n";
+    EXPECT_EQ(dropped, 8u);
+    EXPECT_EQ(records.size(), 2u);
+    std::remove(path.c_str());
+}
+
+TEST(SignalTap, ReadsVersion2Traces) {
+    std::cout << "\n[TEST] ReadsVersion2Traces\n";
+    const std::string path = tracePath("v2");
+    std::FILE *f = std::fopen(path.c_str(), "wb");
+    ASSERT_NE(f, nullptr);
+    SignalTraceHeader header{};
+    std::memcpy(header.magic, kSignalTraceMagic, sizeof(header.magic));
+    header.version = 2;
+    header.recordSize = 48;
+    std::fwrite(&header, offsetof(SignalTraceHeader, droppedRecords), 1, f);
+    // timestamp, kind, outcome, camera, idLength, id[36]; written out of
+    // timestamp order, as by two recording threads
+    auto writeRecord = [f](std::uint64_t timestampNs, SignalKind kind,
+                           const std::string &id) {
+        unsigned char raw[48] = {};
+        std::memcpy(raw, &timestampNs, sizeof(timestampNs));
+        raw[8] = static_cast<unsigned char>(kind);
+        raw[11] = static_cast<unsigned char>(id.size());
+        std::memcpy(raw + 12, id.data(), id.size());
+        std::fwrite(raw, sizeof(raw), 1, f);
+    };
+    writeRecord(20, SignalKind::Car, std::string(36, 'X'));
+    writeRecord(10, SignalKind::Start, {});
+    std::fclose(f);
+
+    std::vector<SignalTraceRecord> records;
+    ASSERT_TRUE(ReadSignalTrace(path, records));
+    ASSERT_EQ(records.size(), 2u);
+    EXPECT_EQ(records[0].kind, SignalKind::Start);
+    EXPECT_EQ(records[1].Id(), std::string(kTraceIdCapacity, 'X'));
+    std::remove(path.c_str());
+}
+
+TEST(SignalTap, RejectsMissingOrForeignFiles) {
+    std::cout << "\n[TEST] RejectsMissingOrForeignFiles\n";
+    std::vector<SignalTraceRecord> records;
+    EXPECT_FALSE(ReadSignalTrace("does_not_exist.trace", records));
+
+    const std::string path = tracePath("foreign");
+    std::FILE *f = std::fopen(path.c_str(), "wb");
+    std::fputs("definitely not a trace file", f);
+    std::fclose(f);
+    EXPECT_FALSE(ReadSignalTrace(path, records));
+    EXPECT_TRUE(records.empty());
+    std::remove(path.c_str());
+}
+
+// Synthetic trace: vehicle records with control records in between.
+static SignalTraceRecord traceRecord(SignalKind kind, const std::string &id = {}) {
+    SignalTraceRecord r{};
+    r.kind = kind;
+    r.idLength = static_cast<std::uint8_t>(id.size());
+    std::memcpy(r.id, id.data(), id.size());
+    return r;
+}
+
+TEST(SignalTap, ParallelReplayMatchesSequentialReplay) {
+    std::cout << "\n[TEST] ParallelReplayMatchesSequentialReplay\n";
+    std::vector<SignalTraceRecord> records;
+    records.push_back(traceRecord(SignalKind::Start));
+    for (int i = 0; i < 3000; ++i) {
+        const auto kind = static_cast<SignalKind>(i % 3);
+        records.push_back(traceRecord(kind, "R" + std::to_string(i % 97)));
+        if (i == 1000)
+            records.push_back(traceRecord(SignalKind::Reset));
+        if (i == 1500)
+            records.push_back(traceRecord(SignalKind::Error)); // rest: errors
+        if (i == 2000)
+            records.push_back(traceRecord(SignalKind::Reset));
+        if (i == 2900)
+            records.push_back(traceRecord(SignalKind::Stop)); // rest: ignored
+    }
+
+    CrossroadTrafficMonitoring expected(std::chrono::hours(24));
+    ReplaySignalTrace(expected, records);
+
+    for (std::size_t threads : {1, 3, 8}) {
+        CrossroadTrafficMonitoring single(std::chrono::hours(24));
+        const ParallelReplayStats stats =
+            ReplaySignalTraceParallel({&single}, records, threads);
+        EXPECT_EQ(stats.controlRecords, 5u);
+        EXPECT_EQ(stats.vehicleRecords, 3000u);
+        EXPECT_EQ(stats.segments, 6u);
+        EXPECT_EQ(single.GetStatistics(), expected.GetStatistics());
+        EXPECT_EQ(single.GetErrorCount(), expected.GetErrorCount());
+        EXPECT_EQ(single.GetCurrentState(), State::Stopped);
+
+        // Sharded: every plate lives in exactly one shard.
+        MonitorConfig config;
+        config.ingest = IngestMode::LockFree;
+        CrossroadTrafficMonitoring a(std::chrono::hours(24), config);
+        CrossroadTrafficMonitoring b(std::chrono::hours(24), config);
+        ReplaySignalTraceParallel({&a, &b}, records, threads);
+        std::vector<std::string> merged = a.GetStatistics();
+        for (const auto &line : b.GetStatistics())
+            merged.push_back(line);
+        std::sort(merged.begin(), merged.end());
+        auto sorted = expected.GetStatistics();
+        std::sort(sorted.begin(), sorted.end());
+        EXPECT_EQ(merged, sorted);
+        // every shard saw each camera error
+        EXPECT_EQ(a.GetTotals().cameraErrors,
+                  expected.GetTotals().cameraErrors);
+        EXPECT_EQ(b.GetTotals().cameraErrors,
+                  expected.GetTotals().cameraErrors);
+    }
+    std::cout << "  Lines: " << expected.GetStatistics().size()
+              << ", errors: " << expected.GetErrorCount() << "\n";
+}
+
+TEST(SignalTap, ControlCallsRecordedAndReplayed) {
+    std::cout << "\n[TEST] ControlCallsRecordedAndReplayed\n";
+    const std::string path = tracePath("control");
+    CrossroadTrafficMonitoring monitor(std::chrono::hours(24));
+    {
+        SignalTap tap(path);
+        monitor.SetSignalTap(&tap);
+        monitor.Start();
+        monitor.OnSignal(Car("C1"));
+        monitor.Reset();
+        monitor.OnSignal(Car("C2"));
+        monitor.Stop();
+        monitor.Stop(); // no transition
+        monitor.SetSignalTap(nullptr);
+        tap.Close();
+    }
+    std::vector<SignalTraceRecord> records;
+    ASSERT_TRUE(ReadSignalTrace(path, records));
+    ASSERT_EQ(records.size(), 6u);
+    EXPECT_EQ(records[2].kind, SignalKind::Reset);
+    EXPECT_EQ(records[4].kind, SignalKind::Stop);
+    EXPECT_EQ(records[4].outcome, SignalOutcome::StateChange);
+    EXPECT_EQ(records[5].outcome, SignalOutcome::Ignored);
+
+    // Replayed from Init: the recorded Start() is enough.
+    CrossroadTrafficMonitoring replayed(std::chrono::hours(24));
+    ReplaySignalTraceParallel({&replayed}, records, 2);
+    EXPECT_EQ(replayed.GetStatistics(), monitor.GetStatistics());
+    EXPECT_EQ(replayed.GetCurrentState(), State::Stopped);
+    std::remove(path.c_str());
+}
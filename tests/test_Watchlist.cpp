@@ -0,0 +1,207 @@
+#include "CrossroadTrafficMonitoring.hpp"
+#include "Watchlist.hpp"
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace ctm;
+using namespace std::chrono_literals;
+
+namespace {
+std::vector<std::string> numberedPlates(const char *prefix, std::size_t n) {
+  std::vector<std::string> plates;
+  plates.reserve(n);
+  for (std::size_t i = 0; i < n; ++i)
+    plates.push_back(prefix + std::to_string(i));
+  return plates;
+}
+
+// Wait until every queued match went through the callback.
+void waitDelivered(const WatchlistAlerts &alerts, std::uint64_t expected) {
+  const auto deadline = std::chrono::steady_clock::now() + 5s;
+  while (alerts.GetDeliveredCount() < expected &&
+         std::chrono::steady_clock::now() < deadline)
+    std::this_thread::sleep_for(1ms);
+}
+} // namespace
+
+//-----------------------------------------------------------------------------
+// Test Suite: Watchlist
+//-----------------------------------------------------------------------------
+
+TEST(Watchlist, ExactMembershipWithoutFalsePositives) {
+  std::cout << "\n[TEST] ExactMembershipWithoutFalsePositives\n";
+  const std::size_t n = 100000;
+  Watchlist list(numberedPlates("W", n));
+  EXPECT_EQ(list.Size(), n);
+  EXPECT_EQ(list.SkippedCount(), 0u);
+  std::cout << "  Memory: " << list.MemoryBytes() / 1024 << " KiB for " << n
+            << " plates\n";
+  EXPECT_LT(list.MemoryBytes(), n * 40);
+
+  std::size_t hits = 0, falsePositives = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    hits += list.Contains("W" + std::to_string(i));
+    falsePositives += list.Contains("X" + std::to_string(i));
+  }
+  std::cout << "  Hits: " << hits << ", false positives: " << falsePositives
+            << " (Expected: " << n << ", 0)\n";
+  EXPECT_EQ(hits, n);
+  EXPECT_EQ(falsePositives, 0u);
+  EXPECT_FALSE(list.Contains(""));
+
+  // Canonical list: raw forms are canonicalized, malformed and duplicate
+  // plates skipped.
+  Watchlist canonical({"ab-123", "AB 123", "x#1", "cd.9"});
+  EXPECT_EQ(canonical.Size(), 2u);
+  EXPECT_EQ(canonical.SkippedCount(), 2u);
+  EXPECT_TRUE(canonical.Contains("AB123"));
+  EXPECT_TRUE(canonical.Contains("CD9"));
+  EXPECT_FALSE(canonical.Contains("ab-123")); // callers pass canonical plates
+
+  Watchlist raw({"ab-123"}, false);
+  EXPECT_TRUE(raw.Contains("ab-123"));
+  EXPECT_FALSE(raw.Contains("AB123"));
+}
+
+TEST(Watchlist, MonitorDeliversMatchesOfAcceptedSignals) {
+  std::cout << "\n[TEST] MonitorDeliversMatchesOfAcceptedSignals\n";
+  std::mutex matchesMutex;
+  std::vector<WatchlistMatch> delivered;
+  WatchlistAlerts alerts([&](const WatchlistMatch &m) {
+    std::lock_guard<std::mutex> lock(matchesMutex);
+    delivered.push_back(m);
+  });
+  alerts.Swap(std::make_unique<Watchlist>(
+      std::vector<std::string>{"AB123", "STOLEN1"}));
+
+  CrossroadTrafficMonitoring monitor(std::chrono::hours(24));
+  monitor.SetWatchlistAlerts(&alerts);
+  monitor.OnSignal(Car("ab-123"));      // Init => ignored, not checked
+  monitor.Start();
+  monitor.OnSignal(Car("ab-123", 7));   // new vehicle => match
+  monitor.OnSignal(Car("AB 123", 8));   // counted => match
+  monitor.OnSignal(Bicycle("OTHER"));   // not listed
+  monitor.OnSignal();                   // camera error
+  monitor.OnSignal(Scooter("stolen1")); // Error state => not checked
+  monitor.SetWatchlistAlerts(nullptr);
+
+  waitDelivered(alerts, 2);
+  std::lock_guard<std::mutex> lock(matchesMutex);
+  std::cout << "  Delivered: " << delivered.size() << " (Expected: 2)\n";
+  ASSERT_EQ(delivered.size(), 2u);
+  EXPECT_EQ(delivered[0].Id(), "AB123");
+  EXPECT_EQ(delivered[0].category, VehicleCategory::Car);
+  EXPECT_EQ(delivered[0].camera, 7);
+  EXPECT_EQ(delivered[1].camera, 8);
+  EXPECT_EQ(alerts.GetMatchCount(), 2u);
+  EXPECT_EQ(alerts.GetDroppedCount(), 0u);
+}
+
+TEST(Watchlist, ReplayedSignalsAreChecked) {
+  std::cout << "\n[TEST] ReplayedSignalsAreChecked\n";
+  for (IngestMode mode : {IngestMode::Mutex, IngestMode::LockFree}) {
+    std::mutex matchesMutex;
+    std::vector<WatchlistMatch> delivered;
+    WatchlistAlerts alerts([&](const WatchlistMatch &m) {
+      std::lock_guard<std::mutex> lock(matchesMutex);
+      delivered.push_back(m);
+    });
+    alerts.Swap(std::make_unique<Watchlist>(
+        std::vector<std::string>{"STOLEN1"}));
+
+    MonitorConfig config;
+    config.ingest = mode;
+    config.canonicalizePlates = true;
+    config.errorBufferCapacity = 4;
+    CrossroadTrafficMonitoring monitor(std::chrono::hours(24), config);
+    monitor.SetWatchlistAlerts(&alerts);
+    monitor.Start();
+    monitor.OnSignal();                      // camera error
+    monitor.OnSignal(Scooter("stolen-1", 3)); // buffered, not checked yet
+    EXPECT_EQ(alerts.GetMatchCount(), 0u);
+    monitor.Reset(); // replayed => match
+    monitor.SetWatchlistAlerts(nullptr);
+
+    waitDelivered(alerts, 1);
+    std::lock_guard<std::mutex> lock(matchesMutex);
+    std::cout << "  Delivered after replay: " << delivered.size()
+              << " (Expected: 1)\n";
+    ASSERT_EQ(delivered.size(), 1u);
+    EXPECT_EQ(delivered[0].Id(), "STOLEN1");
+    EXPECT_EQ(delivered[0].category, VehicleCategory::Scooter);
+    EXPECT_EQ(delivered[0].camera, 3);
+  }
+}
+
+TEST(Watchlist, HotSwapWhileIngesting) {
+  std::cout << "\n[TEST] HotSwapWhileIngesting\n";
+  std::atomic<std::uint64_t> callbacks{0};
+  WatchlistAlerts alerts([&](const WatchlistMatch &) { ++callbacks; }, 1 << 16);
+  CrossroadTrafficMonitoring monitor(std::chrono::hours(24));
+  monitor.SetWatchlistAlerts(&alerts);
+  monitor.Start();
+
+  std::atomic<bool> stop{false};
+  std::vector<std::thread> writers;
+  for (int t = 0; t < 3; ++t) {
+    writers.emplace_back([&, t] {
+      for (std::size_t i = 0; !stop.load(); ++i)
+        monitor.OnSignal(Car("P" + std::to_string((i * 3 + t) % 500)));
+    });
+  }
+  for (int i = 0; i < 50; ++i) {
+    alerts.Swap(std::make_unique<Watchlist>(
+        numberedPlates(i % 2 ? "P" : "Q", 100)));
+    std::this_thread::sleep_for(1ms);
+  }
+  alerts.Swap(nullptr);
+  std::this_thread::sleep_for(5ms); // checks still holding the old list
+  const std::uint64_t matchesBefore = alerts.GetMatchCount();
+  std::this_thread::sleep_for(5ms);
+  stop = true;
+  for (auto &w : writers)
+    w.join();
+  monitor.SetWatchlistAlerts(nullptr);
+
+  std::cout << "  Matches: " << alerts.GetMatchCount()
+            << ", dropped: " << alerts.GetDroppedCount() << "\n";
+  EXPECT_EQ(alerts.GetMatchCount(), matchesBefore); // no list, no matches
+  waitDelivered(alerts, alerts.GetMatchCount() - alerts.GetDroppedCount());
+  EXPECT_EQ(callbacks.load() + alerts.GetDroppedCount(),
+            alerts.GetMatchCount());
+}
+
+TEST(Watchlist, SlowCallbackNeverBlocksIngestion) {
+  std::cout << "\n[TEST] SlowCallbackNeverBlocksIngestion\n";
+  std::promise<void> release;
+  std::shared_future<void> released = release.get_future().share();
+  WatchlistAlerts alerts([released](const WatchlistMatch &) { released.wait(); },
+                         8);
+  alerts.Swap(std::make_unique<Watchlist>(std::vector<std::string>{"HOT1"}));
+
+  CrossroadTrafficMonitoring monitor(std::chrono::hours(24));
+  monitor.SetWatchlistAlerts(&alerts);
+  monitor.Start();
+  for (int i = 0; i < 100; ++i)
+    monitor.OnSignal(Car("HOT1"));
+  monitor.SetWatchlistAlerts(nullptr);
+
+  // The callback is stuck on the first match: at most the queue plus that
+  // one are kept, the rest is dropped.
+  std::cout << "  Dropped: " << alerts.GetDroppedCount()
+            << " (Expected: >= 91)\n";
+  EXPECT_EQ(alerts.GetMatchCount(), 100u);
+  EXPECT_GE(alerts.GetDroppedCount(), 91u);
+  EXPECT_EQ(monitor.GetVehicleCount(VehicleCategory::Car, "HOT1"), 100u);
+  release.set_value();
+  waitDelivered(alerts, 100 - alerts.GetDroppedCount());
+  EXPECT_EQ(alerts.GetDeliveredCount() + alerts.GetDroppedCount(), 100u);
+}
@@ -0,0 +1,130 @@
+#include "CrossroadTrafficMonitoring.hpp"
+#include "KnownPlates.hpp"
+#include "PresenceBitmap.hpp"
+#include "WindowColumns.hpp"
+#include <gtest/gtest.h>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace ctm;
+
+//-----------------------------------------------------------------------------
+// Test Suite: WindowColumns
+//-----------------------------------------------------------------------------
+
+TEST(WindowColumns, SimdKernelsMatchScalar) {
+  std::cout << "\n[TEST] SimdKernelsMatchScalar\n";
+  std::mt19937 rng(120);
+  for (std::size_t n : {0, 1, 3, 4, 5, 64, 1001}) {
+    std::vector<std::uint32_t> column(n), start(n);
+    for (std::size_t i = 0; i < n; ++i) {
+      // Zeros, small counts and values above 2^31 (unsigned compares).
+      column[i] = i % 5 == 0 ? 0 : i % 7 == 0 ? 0x80000000u + rng() % 9 : rng() % 9;
+      start[i] = i % 3 == 0 ? 0xfffffff0u : rng() % 9;
+    }
+    using Kernel = void (*)(std::uint32_t *, const std::uint32_t *, std::size_t);
+    const std::pair<Kernel, Kernel> kernels[] = {
+        {detail::AddColumnScalar, detail::AddColumnSimd},
+        {detail::MaxColumnScalar, detail::MaxColumnSimd},
+        {detail::AddPresenceScalar, detail::AddPresenceSimd}};
+    for (const auto &[scalar, simd] : kernels) {
+      std::vector<std::uint32_t> a = start, b = start;
+      scalar(a.data(), column.data(), n);
+      simd(b.data(), column.data(), n);
+      EXPECT_EQ(a, b) << n;
+    }
+    for (std::uint32_t threshold : {0u, 1u, 5u, 0x80000000u, 0xffffffffu}) {
+      std::vector<std::uint32_t> a(n), b(n);
+      a.resize(detail::SelectAtLeastScalar(column.data(), n, threshold, a.data()));
+      b.resize(detail::SelectAtLeastSimd(column.data(), n, threshold, b.data()));
+      EXPECT_EQ(a, b) << n << " >= " << threshold;
+    }
+  }
+}
+
+TEST(WindowColumns, AggregatesAcrossPeriods) {
+  std::cout << "\n[TEST] AggregatesAcrossPeriods\n";
+  WindowColumns columns(2);
+  columns.Increment(0);
+  columns.Increment(0);
+  columns.Increment(5);
+  EXPECT_EQ(columns.Close(), 0u); // period 0: {0: 2, 5: 1}
+  columns.Increment(1);
+  columns.Increment(0);
+  EXPECT_EQ(columns.Close(), 1u); // period 1: {0: 1, 1: 1}
+  columns.Increment(9);           // period 2, open: {9: 1}
+
+  EXPECT_EQ(columns.Column(0)->size(), 6u);
+  const std::vector<std::uint64_t> all = {0, 1, 2};
+  const std::vector<std::uint32_t> sum = columns.Sum(all);
+  ASSERT_GE(sum.size(), 10u); // the open column may have grown further
+  EXPECT_EQ(sum[0], 3u);
+  EXPECT_EQ(sum[1], 1u);
+  EXPECT_EQ(sum[5], 1u);
+  EXPECT_EQ(sum[9], 1u);
+  EXPECT_EQ(columns.Max(all)[0], 2u);
+  EXPECT_EQ(columns.WindowsSeen(all)[0], 2u);
+  EXPECT_EQ(WindowColumns::AtLeast(sum, 2).ToVector(),
+            std::vector<std::uint32_t>{0});
+  EXPECT_EQ(WindowColumns::AtLeast(sum, 1).Cardinality(), 4u);
+
+  // Only two closed periods are kept; dropped ones count as zeros.
+  columns.Close();
+  EXPECT_EQ(columns.Column(0), nullptr);
+  EXPECT_EQ(columns.Sum(all)[0], 1u);
+}
+
+TEST(WindowColumns, WeeklyTotalsFromMonitorPeriods) {
+  std::cout << "\n[TEST] WeeklyTotalsFromMonitorPeriods\n";
+  for (IngestMode mode : {IngestMode::Mutex, IngestMode::LockFree}) {
+    MonitorConfig config;
+    config.ingest = mode;
+    config.canonicalizePlates = true;
+    config.plateIndexPeriods = 7;
+    // the courier is a fleet plate, counted outside the pool
+    config.knownPlates = std::make_shared<const KnownPlates>(
+        std::vector<std::string>{"COURIER7"});
+    CrossroadTrafficMonitoring monitor(std::chrono::hours(24), config);
+    PresenceHistory history(7, true);
+    ASSERT_TRUE(monitor.SetPresenceHistory(&history));
+    monitor.Start();
+    // Five "days": a commuter twice a day, a courier on two days only.
+    for (int day = 0; day < 5; ++day) {
+      monitor.OnSignal(Car("COMMUTER1"));
+      monitor.OnSignal(Bicycle("commuter-1"));
+      if (day == 1 || day == 3) {
+        for (int i = 0; i < 6; ++i)
+          monitor.OnSignal(Scooter("COURIER7"));
+      }
+      monitor.OnSignal(Bicycle("VISITOR" + std::to_string(day)));
+      monitor.Reset();
+    }
+    monitor.SetPresenceHistory(nullptr);
+
+    const std::vector<std::uint64_t> week = history.ClosedWindows();
+    ASSERT_EQ(week.size(), 5u);
+    const std::vector<std::uint32_t> total = history.SumCounts(week);
+    EXPECT_EQ(total[monitor.GetPlateIndex("COMMUTER1")], 10u);
+    EXPECT_EQ(total[monitor.GetPlateIndex("COURIER7")], 12u);
+    EXPECT_EQ(history.MaxCounts(week)[monitor.GetPlateIndex("COURIER7")], 6u);
+
+    const std::vector<std::string> frequent =
+        monitor.GetIndexedPlates(WindowColumns::AtLeast(total, 10));
+    const std::vector<std::string> everyDay = monitor.GetIndexedPlates(
+        WindowColumns::AtLeast(history.WindowsSeen(week), 5));
+    std::cout << "  >= 10 sightings: " << frequent.size()
+              << ", every day: " << everyDay.size() << " (Expected: 2, 1)\n";
+    EXPECT_EQ(frequent, (std::vector<std::string>{"COMMUTER1", "COURIER7"}));
+    EXPECT_EQ(everyDay, std::vector<std::string>{"COMMUTER1"});
+  }
+
+  // Without countSightings there are no counters.
+  PresenceHistory presenceOnly;
+  presenceOnly.CloseWindow({0}, {1});
+  EXPECT_TRUE(presenceOnly.SumCounts({0}).empty());
+  EXPECT_EQ(presenceOnly.Window(0).Cardinality(), 1u);
+}